@@ -0,0 +1,37 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	drawNormalShaded_fs4x.glsl
+	Output color shaded by view-facing normal.
+*/
+
+#version 450
+
+in vec4 vNormal;
+
+uniform vec4 uColor;
+
+layout (location = 0) out vec4 rtFragColor;
+
+void main()
+{
+	float facing = abs(normalize(vNormal.xyz).z);
+	rtFragColor = vec4(uColor.rgb * (0.25 + 0.75 * facing), uColor.a);
+}
@@ -0,0 +1,94 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	passNormal_skinBaked_transform_instanced_vs4x.glsl
+	Skin with baked palettes looked up per instance and pass view normal.
+*/
+
+#version 450
+
+// two instances per uvec4 fill a 64 KiB block (a3animationBake_instanceBlockMax)
+#define MAX_INSTANCES 8192
+
+// one uvec4 per clip fills a 64 KiB block (a3animationBake_clipMax)
+#define MAX_CLIPS 4096
+
+// spacing between instances laid out in a grid (skeleton units)
+#define INSTANCE_SPACING 300.0
+
+layout (location = 0) in vec4 aPosition;
+layout (location = 1) in vec4 aBlendWeights;
+layout (location = 2) in vec4 aNormal;
+layout (location = 7) in ivec4 aBlendIndices;
+
+// instance i: xy (even) or zw (odd) of element i / 2 = clip, float bits of time
+uniform ubBakeInstance {
+	uvec4 uBakeInstance[MAX_INSTANCES / 2];
+};
+
+// clip: x = first frame, y = frame count, zw = float bits of rate, duration
+uniform ubBakeClip {
+	uvec4 uBakeClip[MAX_CLIPS];
+};
+
+// palette rows: texel (3n + r, frame) is row r of node n's mat3x4
+uniform sampler2D uBakePalette;
+
+uniform mat4 uMVP, uMV_nrm;
+uniform int uIndex;		// index of first instance in block
+uniform int uCount;		// instances per row
+
+out vec4 vNormal;
+
+flat out int vVertexID;
+flat out int vInstanceID;
+
+void main()
+{
+	uvec2 inst = (gl_InstanceID & 1) != 0 ? uBakeInstance[gl_InstanceID >> 1].zw : uBakeInstance[gl_InstanceID >> 1].xy;
+	uvec4 clip = uBakeClip[inst.x];
+	float t = mod(uintBitsToFloat(inst.y), uintBitsToFloat(clip.w));
+	int frame = int(clip.x + min(uint(t * uintBitsToFloat(clip.z)), clip.y - 1u));
+
+	// blend palette rows by weight
+	vec4 r0 = vec4(0.0), r1 = vec4(0.0), r2 = vec4(0.0);
+	for (int i = 0; i < 4; ++i)
+	{
+		int n = 3 * aBlendIndices[i];
+		float w = aBlendWeights[i];
+		r0 += w * texelFetch(uBakePalette, ivec2(n + 0, frame), 0);
+		r1 += w * texelFetch(uBakePalette, ivec2(n + 1, frame), 0);
+		r2 += w * texelFetch(uBakePalette, ivec2(n + 2, frame), 0);
+	}
+	vec3 position = vec3(dot(r0, aPosition), dot(r1, aPosition), dot(r2, aPosition));
+	vec3 normal = vec3(dot(r0.xyz, aNormal.xyz), dot(r1.xyz, aNormal.xyz), dot(r2.xyz, aNormal.xyz));
+
+	// grid on the ground (x/z) plane
+	int index = uIndex + gl_InstanceID;
+	int columns = max(uCount, 1);
+	vec2 cell = vec2(index % columns, index / columns) - 0.5 * float(columns - 1);
+	position.xz += cell * INSTANCE_SPACING;
+
+	gl_Position = uMVP * vec4(position, 1.0);
+	vNormal = uMV_nrm * vec4(normal, 0.0);
+
+	vVertexID = gl_VertexID;
+	vInstanceID = gl_InstanceID;
+}
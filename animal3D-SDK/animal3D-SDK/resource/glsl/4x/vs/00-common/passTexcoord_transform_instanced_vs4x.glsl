@@ -24,17 +24,38 @@
 
 #version 450
 
-#define MAX_INSTANCES 256
+// one vec4 per sprite fills a 64 KiB block (a3sprite_instanceBlockMax)
+#define MAX_INSTANCES 4096
+
+// spacing between sprites laid out in a grid
+#define SPRITE_SPACING 1.25
 
 layout (location = 0) in vec4 aPosition;
+layout (location = 8) in vec4 aTexcoord;
+
+// atlas rect per sprite: xy = cell offset, zw = cell size
+uniform ubSprite {
+	vec4 uSpriteRect[MAX_INSTANCES];
+};
+
+uniform mat4 uMVP;
+uniform int uIndex;		// batch index of first sprite in block
+uniform int uCount;		// sprites per row
+
+out vec4 vTexcoord;
 
 flat out int vVertexID;
 flat out int vInstanceID;
 
 void main()
 {
-	// DUMMY OUTPUT: directly assign input position to output position
-	gl_Position = aPosition;
+	vec4 rect = uSpriteRect[gl_InstanceID];
+	int index = uIndex + gl_InstanceID;
+	int columns = max(uCount, 1);
+	vec2 cell = vec2(index % columns, index / columns) - 0.5 * float(columns - 1);
+
+	gl_Position = uMVP * vec4(aPosition.xy + cell * SPRITE_SPACING, aPosition.zw);
+	vTexcoord = vec4(rect.xy + aTexcoord.xy * rect.zw, 0.0, 1.0);
 
 	vVertexID = gl_VertexID;
 	vInstanceID = gl_InstanceID;
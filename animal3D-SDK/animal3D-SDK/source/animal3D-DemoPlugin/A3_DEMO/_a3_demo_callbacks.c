@@ -114,6 +114,7 @@ void a3demo_unloadValidate(a3_DemoState const* demoState);
 //-----------------------------------------------------------------------------
 
 void a3starter_load(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMode);
+void a3starter_unload(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMode);
 
 void a3starter_loadValidate(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMode);
 
@@ -156,6 +157,9 @@ void a3demo_load(a3_DemoState* demoState)
 
 void a3demo_unload(a3_DemoState* demoState)
 {
+	// demo modes first so they drop references to shared objects
+	a3starter_unload(demoState, demoState->demoMode0_starter);
+
 	a3demo_unloadGeometry(demoState);
 	a3demo_unloadShaders(demoState);
 	a3demo_unloadTextures(demoState);
@@ -39,6 +39,7 @@ extern "C"
 {
 #else	// !__cplusplus
 	typedef struct a3_DemoStateShaderProgram	a3_DemoStateShaderProgram;
+	typedef enum a3_DemoStateShaderProgramBlockBinding	a3_DemoStateShaderProgramBlockBinding;
 #endif	// __cplusplus
 
 
@@ -81,6 +82,10 @@ extern "C"
 				uTex_nm, uTex_hm,			// named texture map handles for intermediate shading
 				uTex_ramp_dm, uTex_ramp_sm,	// named texture map handles for ramps
 				uImage00, uImage01, uImage02, uImage03, uImage04, uImage05, uImage06, uImage07;	// generic texture handles
+
+			a3i32
+				// animation texture handles
+				uBakePalette;				// baked skinning palettes
 		};
 
 		// uniform blocks
@@ -90,10 +95,24 @@ extern "C"
 				ubTransformStack,	// matrix stack block
 				ubTransformMVPB,	// model-view-projection-bias matrix block
 				ubTransformMVP;		// model-view-projection matrix block
+			a3i32
+				// animation uniform block handles
+				ubSprite,			// sprite atlas rect block
+				ubBakeInstance,		// baked instance (clip, time) block
+				ubBakeClip;			// baked clip table block
 		};
 	};
 
 
+	// uniform block bindings used by animation
+	enum a3_DemoStateShaderProgramBlockBinding
+	{
+		demoProg_blockSprite = 2,	// after the transformation blocks
+		demoProg_blockBakeInstance,
+		demoProg_blockBakeClip,
+	};
+
+
 //-----------------------------------------------------------------------------
 
 
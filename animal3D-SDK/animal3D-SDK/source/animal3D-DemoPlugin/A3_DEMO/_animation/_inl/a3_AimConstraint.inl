@@ -0,0 +1,65 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AimConstraint.inl
+	Implementation of inline aim constraint operations.
+*/
+
+
+#ifdef __ANIMAL3D_AIMCONSTRAINT_H
+#ifndef __ANIMAL3D_AIMCONSTRAINT_INL
+#define __ANIMAL3D_AIMCONSTRAINT_INL
+
+
+//-----------------------------------------------------------------------------
+
+// set target of instance constraint
+inline a3i32 a3aimConstraintBatchSetTarget(a3_AimConstraintBatch *batch, const a3ui32 instanceIndex, const a3ui32 constraintIndex, const a3real *target)
+{
+	if (batch && batch->data && instanceIndex < batch->instanceCount && constraintIndex < batch->constraintCount && target)
+	{
+		const a3ui32 slot = batch->slot[instanceIndex * batch->constraintCount + constraintIndex];
+		batch->target[slot] = target[0];
+		batch->target[slot + batch->slotStride] = target[1];
+		batch->target[slot + batch->slotStride * 2] = target[2];
+		return slot;
+	}
+	return -1;
+}
+
+
+// set weight of instance constraint
+inline a3i32 a3aimConstraintBatchSetWeight(a3_AimConstraintBatch *batch, const a3ui32 instanceIndex, const a3ui32 constraintIndex, const a3real weight)
+{
+	if (batch && batch->data && instanceIndex < batch->instanceCount && constraintIndex < batch->constraintCount)
+	{
+		const a3ui32 slot = batch->slot[instanceIndex * batch->constraintCount + constraintIndex];
+		batch->weight[slot] = a3clamp(a3real_zero, a3real_one, weight);
+		return slot;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_AIMCONSTRAINT_INL
+#endif	// __ANIMAL3D_AIMCONSTRAINT_H
\ No newline at end of file
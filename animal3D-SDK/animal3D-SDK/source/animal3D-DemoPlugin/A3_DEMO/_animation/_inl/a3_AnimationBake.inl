@@ -0,0 +1,62 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBake.inl
+	Implementation of inline baked animation operations.
+*/
+
+
+#ifdef __ANIMAL3D_ANIMATIONBAKE_H
+#ifndef __ANIMAL3D_ANIMATIONBAKE_INL
+#define __ANIMAL3D_ANIMATIONBAKE_INL
+
+
+//-----------------------------------------------------------------------------
+
+// get frame row of clip at time
+inline a3i32 a3animationBakeGetFrame(const a3_AnimationBake *bake, const a3ui32 clipIndex, const a3real time)
+{
+	if (bake && bake->data && clipIndex < bake->clipCount)
+	{
+		const a3_AnimationBakeClip *clip = bake->clip + clipIndex;
+		a3real t = time - clip->duration * (a3real)(a3i32)(time / clip->duration);
+		a3ui32 f;
+		if (t < a3real_zero)
+			t += clip->duration;
+		f = (a3ui32)(t * clip->frameRate);
+		return (a3i32)(clip->frameFirst + a3minimum(f, clip->frameCount - 1));
+	}
+	return -1;
+}
+
+// get palette of frame row
+inline const a3real *a3animationBakeGetPalette(const a3_AnimationBake *bake, const a3ui32 frame)
+{
+	if (bake && bake->data && frame < bake->frameCount)
+		return (bake->palette + frame * bake->nodeCount * a3hierarchyPalette_mat3x4);
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_ANIMATIONBAKE_INL
+#endif	// __ANIMAL3D_ANIMATIONBAKE_H
\ No newline at end of file
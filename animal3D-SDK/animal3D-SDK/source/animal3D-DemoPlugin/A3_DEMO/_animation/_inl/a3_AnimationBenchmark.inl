@@ -0,0 +1,78 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBenchmark.inl
+	Implementation of inline animation benchmark operations.
+*/
+
+
+#ifdef __ANIMAL3D_ANIMATIONBENCHMARK_H
+#ifndef __ANIMAL3D_ANIMATIONBENCHMARK_INL
+#define __ANIMAL3D_ANIMATIONBENCHMARK_INL
+
+
+//-----------------------------------------------------------------------------
+
+// reset benchmark result
+inline a3i32 a3animationBenchmarkReset(a3_AnimationBenchmark *benchmark_out, const a3byte *name, const a3ui32 instanceCount, const a3ui32 iterations)
+{
+	if (benchmark_out && iterations)
+	{
+		benchmark_out->name = name;
+		benchmark_out->variantCount = 0;
+		benchmark_out->errorMax = 0.0;
+		benchmark_out->instanceCount = instanceCount;
+		benchmark_out->iterations = iterations;
+		return 1;
+	}
+	return -1;
+}
+
+// begin timing a variant
+inline a3i32 a3animationBenchmarkStart(a3_Timer *timer)
+{
+	// continuous timer: every update is a tick
+	a3timerSet(timer, 0.0);
+	return a3timerStart(timer);
+}
+
+// finish timing a variant
+inline a3i32 a3animationBenchmarkStop(a3_AnimationBenchmark *benchmark, a3_Timer *timer, const a3byte *variantName)
+{
+	a3timerUpdate(timer);
+	a3timerStop(timer);
+	if (benchmark && benchmark->variantCount < a3benchmark_variantMax)
+	{
+		benchmark->variantName[benchmark->variantCount] = variantName;
+		benchmark->variantTime[benchmark->variantCount] = timer->totalTime / (a3f64)benchmark->iterations;
+		benchmark->variantThreads[benchmark->variantCount] = 1;
+		benchmark->variantSolverIterations[benchmark->variantCount] = 0.0;
+		return ++benchmark->variantCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_ANIMATIONBENCHMARK_INL
+#endif	// __ANIMAL3D_ANIMATIONBENCHMARK_H
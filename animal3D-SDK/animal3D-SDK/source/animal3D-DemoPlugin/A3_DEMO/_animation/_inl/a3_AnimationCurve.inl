@@ -0,0 +1,51 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationCurve.inl
+	Implementation of inline curve track operations.
+*/
+
+
+#ifdef __ANIMAL3D_ANIMATIONCURVE_H
+#ifndef __ANIMAL3D_ANIMATIONCURVE_INL
+#define __ANIMAL3D_ANIMATIONCURVE_INL
+
+
+//-----------------------------------------------------------------------------
+
+// evaluate every track for each clip controller
+inline a3i32 a3animationCurveSetEvaluateClipControllers(a3real *value_out, a3ui32 *cursor, const a3_AnimationCurveSet *curveSet, const a3_ClipController *clipCtrl, const a3ui32 controllerCount)
+{
+	a3ui32 i;
+	if (value_out && cursor && curveSet && curveSet->data && clipCtrl)
+	{
+		for (i = 0; i < controllerCount; ++i, ++clipCtrl, value_out += curveSet->trackStride, cursor += curveSet->trackStride)
+			a3animationCurveSetEvaluate(value_out, cursor, curveSet, &clipCtrl->clip_time, 1);
+		return curveSet->trackCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_ANIMATIONCURVE_INL
+#endif	// __ANIMAL3D_ANIMATIONCURVE_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyPoseCompression.inl
+	Implementation of inline quantized pose group operations.
+*/
+
+
+#ifdef __ANIMAL3D_HIERARCHYPOSECOMPRESSION_H
+#ifndef __ANIMAL3D_HIERARCHYPOSECOMPRESSION_INL
+#define __ANIMAL3D_HIERARCHYPOSECOMPRESSION_INL
+
+
+//-----------------------------------------------------------------------------
+
+// decompress single pose into hierarchy pose via structure-of-arrays pose
+inline a3i32 a3hierarchyPoseGroupCompressedDecodePose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_tmp, const a3_HierarchyPoseGroupCompressed *compressed, const a3ui32 poseIndex)
+{
+	if (a3hierarchyPoseGroupCompressedDecode(pose_tmp, compressed, poseIndex) >= 0)
+		return a3hierarchyPoseSoALoad(pose_out, pose_tmp);
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_HIERARCHYPOSECOMPRESSION_INL
+#endif	// __ANIMAL3D_HIERARCHYPOSECOMPRESSION_H
@@ -0,0 +1,60 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyRecorder.inl
+	Implementation of inline hierarchy playback operations.
+*/
+
+
+#ifdef __ANIMAL3D_HIERARCHYRECORDER_H
+#ifndef __ANIMAL3D_HIERARCHYRECORDER_INL
+#define __ANIMAL3D_HIERARCHYRECORDER_INL
+
+
+//-----------------------------------------------------------------------------
+
+// get frame poses
+inline const a3_SpatialPose *a3hierarchyPlayerGetFrame(const a3_HierarchyPlayer *player, const a3ui32 frameIndex)
+{
+	if (player && player->data && frameIndex < player->frameCount)
+		return (player->frame + frameIndex * player->hierarchy->numNodes);
+	return 0;
+}
+
+
+// apply frame to state
+inline a3i32 a3hierarchyPlayerApply(const a3_HierarchyPlayer *player, const a3_HierarchyState *state, const a3ui32 frameIndex)
+{
+	if (player && player->data && frameIndex < player->frameCount && state && state->poseGroup && state->poseGroup->hierarchy == player->hierarchy)
+	{
+		a3_HierarchyPose pose[1];
+		pose->spatialPose = player->frame + frameIndex * player->hierarchy->numNodes;
+		a3hierarchyPoseCopy(state->localHPose, pose, player->hierarchy->numNodes);
+		return a3hierarchyStateSetAllDirty(state);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_HIERARCHYRECORDER_INL
+#endif	// __ANIMAL3D_HIERARCHYRECORDER_H
\ No newline at end of file
@@ -30,6 +30,44 @@
 
 //-----------------------------------------------------------------------------
 
+// reset hierarchy pose to identity
+inline a3i32 a3hierarchyPoseReset(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount)
+{
+	a3ui32 i;
+	if (pose_inout && pose_inout->spatialPose)
+	{
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseReset(pose_inout->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// copy hierarchy pose
+inline a3i32 a3hierarchyPoseCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	a3ui32 i;
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseCopy(pose_out->spatialPose + i, pose_in->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// convert channels to matrices for all nodes in hierarchy pose
+inline a3i32 a3hierarchyPoseConvert(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount)
+{
+	a3ui32 i;
+	if (pose_inout && pose_inout->spatialPose)
+	{
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseConvert(pose_inout->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -53,21 +91,85 @@ inline a3i32 a3hierarchyPoseGroupGetNodePoseOffsetIndex(const a3_HierarchyPoseGr
 
 //-----------------------------------------------------------------------------
 
-// update inverse object-space matrices
-inline a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state, const a3boolean usingScale)
+// flag node's local pose as changed
+inline a3i32 a3hierarchyStateSetNodeDirty(const a3_HierarchyState *state, const a3ui32 nodeIndex)
+{
+	if (state && state->poseGroup && nodeIndex < state->poseGroup->hierarchy->numNodes)
+	{
+		state->localDirty[nodeIndex] = 1;
+		return nodeIndex;
+	}
+	return -1;
+}
+
+// flag all nodes as changed
+inline a3i32 a3hierarchyStateSetAllDirty(const a3_HierarchyState *state)
+{
+	a3ui32 i;
+	if (state && state->poseGroup)
+	{
+		for (i = 0; i < state->poseGroup->hierarchy->numNodes; ++i)
+			state->localDirty[i] = 1;
+		return i;
+	}
+	return -1;
+}
+
+// get number of instance palettes that fit in uniform block
+inline a3i32 a3hierarchyPaletteGetInstanceCapacity(const a3_HierarchyPaletteLayout layout, const a3ui32 nodeCount, const a3ui32 blockSize)
 {
+	if ((layout == a3hierarchyPalette_dualquat || layout == a3hierarchyPalette_mat3x4 || layout == a3hierarchyPalette_mat4) && nodeCount)
+		return (blockSize / (sizeof(a3real) * layout * nodeCount));
 	return -1;
 }
 
-// update bind-to-current given bind-pose object-space transforms
-inline a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse)
+// get first element of node's matrix streams
+inline a3real *a3hierarchyStateBatchGetNodeTransform(const a3real *transform, const a3_HierarchyStateBatch *batch, const a3ui32 nodeIndex)
 {
+	return ((a3real *)transform + nodeIndex * 16 * batch->instanceStride);
+}
+
+// update inverse object-space matrices
+inline a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state, const a3boolean usingScale)
+{
+	a3ui32 i;
+	if (state && state->poseGroup)
+	{
+		// scale mode picks the cheapest valid inverse
+		const a3ui32 nodeCount = state->poseGroup->hierarchy->numNodes;
+		const a3_SpatialPose *objectPose = state->objectHPose->spatialPose;
+		a3mat4 *objectInv = state->objectSpaceInverse->transform;
+		if (!usingScale || state->poseGroup->scaleMode == a3hierarchyScale_none)
+			for (i = 0; i < nodeCount; ++i)
+				a3real4x4TransformInverseIgnoreScale(objectInv[i].m, objectPose[i].transform.m);
+		else if (state->poseGroup->scaleMode == a3hierarchyScale_uniform)
+			for (i = 0; i < nodeCount; ++i)
+				a3real4x4TransformInverseUniformScale(objectInv[i].m, objectPose[i].transform.m);
+		else
+			for (i = 0; i < nodeCount; ++i)
+				a3real4x4TransformInverse(objectInv[i].m, objectPose[i].transform.m);
+		return nodeCount;
+	}
 	return -1;
 }
 
 
 //-----------------------------------------------------------------------------
 
+#ifdef A3_HIERARCHY_SIMD
+// four quaternion products
+inline void a3hierarchyQuatProduct4(__m128 *q_out, const __m128 *qL, const __m128 *qR)
+{
+	const __m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qL[3], qR[0]), _mm_mul_ps(qL[0], qR[3])), _mm_mul_ps(qL[1], qR[2])), _mm_mul_ps(qL[2], qR[1]));
+	const __m128 y = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(qL[3], qR[1]), _mm_mul_ps(qL[0], qR[2])), _mm_mul_ps(qL[1], qR[3])), _mm_mul_ps(qL[2], qR[0]));
+	const __m128 z = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(qL[3], qR[2]), _mm_mul_ps(qL[0], qR[1])), _mm_mul_ps(qL[1], qR[0])), _mm_mul_ps(qL[2], qR[3]));
+	const __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(qL[3], qR[3]), _mm_mul_ps(qL[0], qR[0])), _mm_mul_ps(qL[1], qR[1])), _mm_mul_ps(qL[2], qR[2]));
+	q_out[0] = x;
+	q_out[1] = y;
+	q_out[2] = z;
+	q_out[3] = w;
+}
+#endif	// A3_HIERARCHY_SIMD
 
 
 //-----------------------------------------------------------------------------
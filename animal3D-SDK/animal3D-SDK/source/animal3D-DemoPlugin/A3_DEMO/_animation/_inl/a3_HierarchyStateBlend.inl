@@ -30,6 +30,83 @@
 
 //-----------------------------------------------------------------------------
 
+// set sample source
+inline a3i32 a3hierarchyBlendSourceSet(a3_HierarchyBlendSource *source_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 pose0, const a3ui32 pose1, const a3real param)
+{
+	if (source_out && poseGroup && pose0 < poseGroup->hposeCount && pose1 < poseGroup->hposeCount)
+	{
+		source_out->poseGroup = poseGroup;
+		source_out->pose0 = pose0;
+		source_out->pose1 = pose1;
+		source_out->param = param;
+		return 1;
+	}
+	return -1;
+}
+
+// set sample source from clip controller
+inline a3i32 a3hierarchyBlendSourceSetClipController(a3_HierarchyBlendSource *source_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipController *clipCtrl)
+{
+	if (source_out && poseGroup && clipCtrl && clipCtrl->clip_pool)
+	{
+		const a3_Clip *clip = clipCtrl->clip_pool->clip + clipCtrl->clip;
+		const a3_Keyframe *keyframe = clip->keyframe_pool->keyframe;
+		const a3ui32 k = clipCtrl->keyframe;
+		const a3real param = clipCtrl->keyframe_time * keyframe[k].duration_inverse;
+
+		// keyframe time runs from the start of the current keyframe in 
+		//	both directions; reverse heads for the previous keyframe, so 
+		//	its parameter counts down from the end of the current one
+		if (clipCtrl->playback_direction < 0)
+		{
+			const a3ui32 next = k > clip->first_keyframe ? k - 1 : clip->last_keyframe;
+			return a3hierarchyBlendSourceSet(source_out, poseGroup, keyframe[k].data, keyframe[next].data, a3real_one - param);
+		}
+		else
+		{
+			const a3ui32 next = k < clip->last_keyframe ? k + 1 : clip->first_keyframe;
+			return a3hierarchyBlendSourceSet(source_out, poseGroup, keyframe[k].data, keyframe[next].data, param);
+		}
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// reset cache statistics
+inline a3i32 a3hierarchyBlendCacheResetStats(a3_HierarchyBlendCache *cache)
+{
+	if (cache && cache->data)
+	{
+		cache->hitCount = cache->missCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// cache hit rate
+inline a3real a3hierarchyBlendCacheHitRate(const a3_HierarchyBlendCache *cache)
+{
+	if (cache && cache->hitCount + cache->missCount)
+		return (a3real)cache->hitCount / (a3real)(cache->hitCount + cache->missCount);
+	return a3real_zero;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// set weight of named subtree
+inline a3i32 a3hierarchyBlendMaskSetSubtreeName(a3_HierarchyBlendMask *mask, const a3byte rootName[a3node_nameSize], const a3real weight)
+{
+	if (mask && mask->hierarchy && rootName)
+	{
+		const a3i32 rootIndex = a3hierarchyGetNodeIndex(mask->hierarchy, rootName);
+		if (rootIndex >= 0)
+			return a3hierarchyBlendMaskSetSubtree(mask, rootIndex, weight);
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
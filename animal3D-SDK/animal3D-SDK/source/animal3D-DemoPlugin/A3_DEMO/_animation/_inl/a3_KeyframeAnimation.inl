@@ -33,7 +33,7 @@
 inline a3i32 a3clipCalculateDuration(a3_Clip* clip)
 {
 	// error checking keyframes are valid
-	if ((clip->first_keyframe >= clip->last_keyframe) || !clip)
+	if (!clip || (clip->first_keyframe > clip->last_keyframe))
 		return -1;
 
 	// loop through keyframes and sum up durations
@@ -64,8 +64,8 @@ inline a3i32 a3clipDistributeDuration(a3_Clip* clip, const a3real newClipDuratio
 	clip->duration = newClipDuration;
 	clip->duration_inverse = 1 / newClipDuration;
 
-	// +1 to make it inclusive? maybe
-	a3real keyframe_duration = (clip->last_keyframe - clip->first_keyframe + 1) * clip->duration_inverse;
+	// split evenly over keyframes, first and last inclusive
+	a3real keyframe_duration = newClipDuration / (a3real)(clip->last_keyframe - clip->first_keyframe + 1);
 	a3real inverse = 1 / keyframe_duration;
 
 	// loop through keyframes and set durations
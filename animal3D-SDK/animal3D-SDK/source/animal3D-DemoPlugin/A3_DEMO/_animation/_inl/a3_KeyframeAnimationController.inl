@@ -62,7 +62,7 @@ inline a3i32 a3clipControllerUpdate(a3_ClipController* clipCtrl, const a3real dt
 			//Case: Forward Terminus
 			//If passed end of clip, set clip time to start of clip by subtracting clip duration from clip time
 			//Set keyframe index to first keyframe in clip
-			if (clipCtrl->clip_time >= current_clip->duration && clipCtrl->keyframe == current_clip->last_keyframe)
+			if (clipCtrl->keyframe > current_clip->last_keyframe)
 			{
 				clipCtrl->clip_time -= current_clip->duration;
 				clipCtrl->keyframe = current_clip->first_keyframe;
@@ -73,19 +73,20 @@ inline a3i32 a3clipControllerUpdate(a3_ClipController* clipCtrl, const a3real dt
 	{
 		//Reverse
 		//Case: Reverse && Reverse Skip
-		//Rewind to last keyframe time and decrement keyframe index
-		while (clipCtrl->keyframe_time < current_clip->keyframe_pool->keyframe[clipCtrl->keyframe].duration)
+		//Rewind to previous keyframe while time is before the start of the current one
+		while (clipCtrl->keyframe_time < 0)
 		{
-			clipCtrl->keyframe_time += current_clip->keyframe_pool->keyframe[clipCtrl->keyframe].duration;
-			clipCtrl->keyframe--;
 			//Case: Reverse Terminus
-			//If reached start of clip, set clip time to end of clip by adding clip duration to clip time
+			//If rewinding past the first keyframe, set clip time to end of clip by adding clip duration to clip time
 			//Set keyframe index to last keyframe in clip
-			if (clipCtrl->clip_time < current_clip->duration && clipCtrl->keyframe == current_clip->first_keyframe)
+			if (clipCtrl->keyframe <= current_clip->first_keyframe)
 			{
 				clipCtrl->clip_time += current_clip->duration;
 				clipCtrl->keyframe = current_clip->last_keyframe;
 			}
+			else
+				clipCtrl->keyframe--;
+			clipCtrl->keyframe_time += current_clip->keyframe_pool->keyframe[clipCtrl->keyframe].duration;
 		}
 	}
 	//Stopped
@@ -97,8 +98,8 @@ inline a3i32 a3clipControllerUpdate(a3_ClipController* clipCtrl, const a3real dt
 
 	//Post-Resolution
 	
-	//Normalize keyframe and clip time/parameters
-	clipCtrl->keyframe_param = clipCtrl->keyframe_time * current_clip->duration_inverse;
+	//Normalize keyframe time by keyframe duration and clip time by clip duration
+	clipCtrl->keyframe_param = clipCtrl->keyframe_time * current_clip->keyframe_pool->keyframe[clipCtrl->keyframe].duration_inverse;
 	clipCtrl->clip_param = clipCtrl->clip_time * current_clip->duration_inverse;
 
 	return 1;
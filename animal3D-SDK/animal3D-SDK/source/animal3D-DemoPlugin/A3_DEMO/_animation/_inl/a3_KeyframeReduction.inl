@@ -0,0 +1,54 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_KeyframeReduction.inl
+	Implementation of inline keyframe reduction operations.
+*/
+
+
+#ifdef __ANIMAL3D_KEYFRAMEREDUCTION_H
+#ifndef __ANIMAL3D_KEYFRAMEREDUCTION_INL
+#define __ANIMAL3D_KEYFRAMEREDUCTION_INL
+
+
+//-----------------------------------------------------------------------------
+
+// get clip of node's track
+inline const a3_Clip *a3keyframeReductionGetTrack(const a3_KeyframeReduction *reduction, const a3ui32 nodeIndex, const a3_KeyframeReductionTrack track)
+{
+	if (reduction && reduction->data && nodeIndex < reduction->nodeCount && track < a3keyframeReduction_trackCount)
+		return (reduction->trackPool->clip + nodeIndex * a3keyframeReduction_trackCount + track);
+	return 0;
+}
+
+// sample every track into hierarchy pose via structure-of-arrays pose
+inline a3i32 a3keyframeReductionSamplePose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_tmp, a3ui32 *cursor, const a3_KeyframeReduction *reduction, const a3real time)
+{
+	if (a3keyframeReductionSample(pose_tmp, cursor, reduction, time) >= 0)
+		return a3hierarchyPoseSoALoad(pose_out, pose_tmp);
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_KEYFRAMEREDUCTION_INL
+#endif	// __ANIMAL3D_KEYFRAMEREDUCTION_H
\ No newline at end of file
@@ -37,6 +37,13 @@ inline a3i32 a3kinematicsSolveForward(const a3_HierarchyState *hierarchyState)
 }
 
 
+// batched FK solver
+inline a3i32 a3kinematicsSolveForwardBatch(const a3_HierarchyStateBatch *batch)
+{
+	return a3kinematicsSolveForwardBatchPartial(batch, 0, batch->hierarchy->numNodes);
+}
+
+
 //-----------------------------------------------------------------------------
 
 // IK solver
@@ -46,6 +53,27 @@ inline a3i32 a3kinematicsSolveInverse(const a3_HierarchyState *hierarchyState)
 }
 
 
+// batched IK solver
+inline a3i32 a3kinematicsSolveInverseBatch(const a3_HierarchyStateBatch *batch, const a3_HierarchyScaleMode scaleMode)
+{
+	return a3kinematicsSolveInverseBatchPartial(batch, 0, batch->hierarchy->numNodes, scaleMode);
+}
+
+
+//-----------------------------------------------------------------------------
+
+// discard chain's previous solution
+inline a3i32 a3kinematicsChainResetWarmStart(a3_KinematicsChain *chain)
+{
+	if (chain && chain->hierarchy)
+	{
+		chain->warm = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
 //-----------------------------------------------------------------------------
 
 
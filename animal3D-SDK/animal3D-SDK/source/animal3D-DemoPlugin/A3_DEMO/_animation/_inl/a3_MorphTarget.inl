@@ -0,0 +1,62 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MorphTarget.inl
+	Implementation of inline morph target operations.
+*/
+
+
+#ifdef __ANIMAL3D_MORPHTARGET_H
+#ifndef __ANIMAL3D_MORPHTARGET_INL
+#define __ANIMAL3D_MORPHTARGET_INL
+
+
+//-----------------------------------------------------------------------------
+
+// set target's weight
+inline a3i32 a3morphEngineSetWeight(a3_MorphEngine *engine, const a3ui32 targetIndex, const a3real weight)
+{
+	if (engine && engine->data && targetIndex < engine->targetCount)
+	{
+		engine->weight[targetIndex] = weight;
+		return 1;
+	}
+	return -1;
+}
+
+// set all weights
+inline a3i32 a3morphEngineSetWeights(a3_MorphEngine *engine, const a3real *weightList)
+{
+	if (engine && engine->data && weightList)
+	{
+		a3ui32 i;
+		for (i = 0; i < engine->targetCount; ++i)
+			engine->weight[i] = weightList[i];
+		return engine->targetCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_MORPHTARGET_INL
+#endif	// __ANIMAL3D_MORPHTARGET_H
\ No newline at end of file
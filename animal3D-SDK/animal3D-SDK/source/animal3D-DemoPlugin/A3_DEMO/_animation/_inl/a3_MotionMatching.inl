@@ -0,0 +1,59 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MotionMatching.inl
+	Implementation of inline motion matching operations.
+*/
+
+
+#ifdef __ANIMAL3D_MOTIONMATCHING_H
+#ifndef __ANIMAL3D_MOTIONMATCHING_INL
+#define __ANIMAL3D_MOTIONMATCHING_INL
+
+
+//-----------------------------------------------------------------------------
+
+// get normalized feature row of entry
+inline const a3real *a3motionMatchingDatabaseGetFeature(const a3_MotionMatchingDatabase *database, const a3ui32 entryIndex)
+{
+	if (database && database->data && entryIndex < database->entryCount)
+		return (database->feature + entryIndex * database->dimStride);
+	return 0;
+}
+
+// normalize raw feature vector
+inline a3i32 a3motionMatchingDatabaseNormalize(const a3_MotionMatchingDatabase *database, a3real *feature_out, const a3real *feature_in)
+{
+	a3ui32 i;
+	if (database && database->data && feature_out && feature_in)
+	{
+		for (i = 0; i < database->dim; ++i)
+			feature_out[i] = (feature_in[i] - database->mean[i]) * database->scale[i];
+		return database->dim;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_MOTIONMATCHING_INL
+#endif	// __ANIMAL3D_MOTIONMATCHING_H
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_Skinning.inl
+	Implementation of inline skinning operations.
+*/
+
+
+#ifdef __ANIMAL3D_SKINNING_H
+#ifndef __ANIMAL3D_SKINNING_INL
+#define __ANIMAL3D_SKINNING_INL
+
+
+//-----------------------------------------------------------------------------
+
+// DLB for one vertex
+inline a3i32 a3skinningBlendDualQuat(a3real *Q_out, const a3real *palette, const a3real *blendWeight, const a3i32 *blendIndex)
+{
+	const a3real *Q, *Q0 = palette + blendIndex[0] * a3hierarchyPalette_dualquat;
+	a3real w, lengthInv;
+	a3ui32 i, j;
+	for (j = 0; j < 8; ++j)
+		Q_out[j] = a3real_zero;
+	for (i = 0; i < a3skinning_influenceMax; ++i)
+	{
+		// antipodal entries describe the same transform; flip so the sum 
+		//	takes the short way
+		Q = palette + blendIndex[i] * a3hierarchyPalette_dualquat;
+		w = blendWeight[i];
+		if (Q[0] * Q0[0] + Q[1] * Q0[1] + Q[2] * Q0[2] + Q[3] * Q0[3] < a3real_zero)
+			w = -w;
+		for (j = 0; j < 8; ++j)
+			Q_out[j] += Q[j] * w;
+	}
+	lengthInv = a3recipsafe(a3sqrt(Q_out[0] * Q_out[0] + Q_out[1] * Q_out[1] + Q_out[2] * Q_out[2] + Q_out[3] * Q_out[3]));
+	for (j = 0; j < 8; ++j)
+		Q_out[j] *= lengthInv;
+	return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// merge influence into point's sorted list
+inline a3i32 a3skinningWeightsAddInfluence(a3_SkinningWeights *weights, const a3ui32 pointIndex, const a3i32 nodeIndex, const a3real weight)
+{
+	if (weights && weights->data && pointIndex < weights->pointCount && nodeIndex >= 0)
+	{
+		a3real *blendWeight = weights->blendWeight + pointIndex * a3skinning_influenceMax;
+		a3i32 *blendIndex = weights->blendIndex + pointIndex * a3skinning_influenceMax;
+		a3real w = weight;
+		a3ui32 i, j;
+
+		if (w <= a3real_zero)
+			return 0;
+
+		// same node already listed (e.g. another shape sharing the point): 
+		//	accumulate and take it out to be re-inserted in order
+		for (i = 0; i < a3skinning_influenceMax && blendWeight[i] > a3real_zero; ++i)
+			if (blendIndex[i] == nodeIndex)
+			{
+				w += blendWeight[i];
+				for (j = i; j + 1 < a3skinning_influenceMax; ++j)
+				{
+					blendWeight[j] = blendWeight[j + 1];
+					blendIndex[j] = blendIndex[j + 1];
+				}
+				blendWeight[j] = a3real_zero;
+				blendIndex[j] = 0;
+				break;
+			}
+
+		// find slot, shift weaker entries down; weakest falls off the end
+		for (i = 0; i < a3skinning_influenceMax && blendWeight[i] >= w; ++i);
+		if (i == a3skinning_influenceMax)
+		{
+			++weights->droppedCount;
+			return 0;
+		}
+		if (blendWeight[a3skinning_influenceMax - 1] > a3real_zero)
+			++weights->droppedCount;
+		for (j = a3skinning_influenceMax - 1; j > i; --j)
+		{
+			blendWeight[j] = blendWeight[j - 1];
+			blendIndex[j] = blendIndex[j - 1];
+		}
+		blendWeight[i] = w;
+		blendIndex[i] = nodeIndex;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_SKINNING_INL
+#endif	// __ANIMAL3D_SKINNING_H
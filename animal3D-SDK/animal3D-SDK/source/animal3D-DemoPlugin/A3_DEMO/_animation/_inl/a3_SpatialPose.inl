@@ -28,6 +28,85 @@
 #define __ANIMAL3D_SPATIALPOSE_INL
 
 
+//-----------------------------------------------------------------------------
+
+// reset single node pose to identity
+inline a3i32 a3spatialPoseReset(a3_SpatialPose *spatialPose)
+{
+	if (spatialPose)
+	{
+		spatialPose->transform = a3mat4_identity;
+		a3quatSetIdentity(spatialPose->orientation.v);
+		a3real4Set(spatialPose->scale.v, a3real_one, a3real_one, a3real_one, a3real_zero);
+		a3real4Set(spatialPose->translation.v, a3real_zero, a3real_zero, a3real_zero, a3real_zero);
+		return 1;
+	}
+	return -1;
+}
+
+// set rotation of pose from Euler angles in degrees
+inline a3i32 a3spatialPoseSetRotation(a3_SpatialPose *spatialPose, const a3real rx_degrees, const a3real ry_degrees, const a3real rz_degrees, const a3_SpatialPoseEulerOrder order)
+{
+	if (spatialPose)
+	{
+		if (order == a3poseEulerOrder_zyx)
+			a3quatSetEulerZYX(spatialPose->orientation.v, rx_degrees, ry_degrees, rz_degrees);
+		else
+			a3quatSetEulerXYZ(spatialPose->orientation.v, rx_degrees, ry_degrees, rz_degrees);
+		return 1;
+	}
+	return -1;
+}
+
+// set scale of pose
+inline a3i32 a3spatialPoseSetScale(a3_SpatialPose *spatialPose, const a3real sx, const a3real sy, const a3real sz)
+{
+	if (spatialPose)
+	{
+		a3real4Set(spatialPose->scale.v, sx, sy, sz, a3real_zero);
+		return 1;
+	}
+	return -1;
+}
+
+// set translation of pose
+inline a3i32 a3spatialPoseSetTranslation(a3_SpatialPose *spatialPose, const a3real tx, const a3real ty, const a3real tz)
+{
+	if (spatialPose)
+	{
+		a3real4Set(spatialPose->translation.v, tx, ty, tz, a3real_zero);
+		return 1;
+	}
+	return -1;
+}
+
+// copy single node pose
+inline a3i32 a3spatialPoseCopy(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		*spatialPose_out = *spatialPose_in;
+		return 1;
+	}
+	return -1;
+}
+
+// convert single node pose channels to matrix: transform = T * R * S
+inline a3i32 a3spatialPoseConvert(a3_SpatialPose *spatialPose)
+{
+	if (spatialPose)
+	{
+		// rotation and translation, then scale the basis columns
+		a3quatConvertToMat4Translate(spatialPose->transform.m, spatialPose->orientation.v, spatialPose->translation.v);
+		a3real3MulS(spatialPose->transform.m[0], spatialPose->scale.x);
+		a3real3MulS(spatialPose->transform.m[1], spatialPose->scale.y);
+		a3real3MulS(spatialPose->transform.m[2], spatialPose->scale.z);
+		return 1;
+	}
+	return -1;
+}
+
+
 //-----------------------------------------------------------------------------
 
 
@@ -0,0 +1,63 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpringBone.inl
+	Implementation of inline spring bone operations.
+*/
+
+
+#ifdef __ANIMAL3D_SPRINGBONE_H
+#ifndef __ANIMAL3D_SPRINGBONE_INL
+#define __ANIMAL3D_SPRINGBONE_INL
+
+
+//-----------------------------------------------------------------------------
+
+// set object-space gravity
+inline a3i32 a3springBoneSystemSetGravity(a3_SpringBoneSystem *system, const a3real *gravity)
+{
+	if (system && system->data && gravity)
+	{
+		system->gravity.x = gravity[0];
+		system->gravity.y = gravity[1];
+		system->gravity.z = gravity[2];
+		return 1;
+	}
+	return -1;
+}
+
+
+// discard simulation state
+inline a3i32 a3springBoneSystemReset(a3_SpringBoneSystem *system)
+{
+	if (system && system->data)
+	{
+		system->initialized = a3false;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_SPRINGBONE_INL
+#endif	// __ANIMAL3D_SPRINGBONE_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpriteAnimation.inl
+	Implementation of inline sprite animation operations.
+*/
+
+
+#ifdef __ANIMAL3D_SPRITEANIMATION_H
+#ifndef __ANIMAL3D_SPRITEANIMATION_INL
+#define __ANIMAL3D_SPRITEANIMATION_INL
+
+
+//-----------------------------------------------------------------------------
+
+// set sprite's playback rate
+inline a3i32 a3spriteAnimationBatchSetRate(a3_SpriteAnimationBatch *batch, const a3ui32 spriteIndex, const a3real rate)
+{
+	if (batch && batch->data && spriteIndex < batch->spriteCount)
+	{
+		batch->rate[spriteIndex] = rate;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+#endif	// !__ANIMAL3D_SPRITEANIMATION_INL
+#endif	// __ANIMAL3D_SPRITEANIMATION_H
\ No newline at end of file
@@ -0,0 +1,444 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AimConstraint.c
+	Implementation of batched aim constraints.
+*/
+
+#include "../a3_AimConstraint.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// transform direction by upper 3x3 of matrix
+inline void a3aimConstraintInternalTransformDirection(a3real *v_out, const a3real4x4p m, const a3real3p v)
+{
+	v_out[0] = m[0][0] * v[0] + m[1][0] * v[1] + m[2][0] * v[2];
+	v_out[1] = m[0][1] * v[0] + m[1][1] * v[1] + m[2][1] * v[2];
+	v_out[2] = m[0][2] * v[0] + m[1][2] * v[1] + m[2][2] * v[2];
+}
+
+// gather current axes and target directions of slots in range
+inline void a3aimConstraintInternalGather(a3_AimConstraintBatch *batch, const a3_HierarchyState *stateArray, const a3ui32 first, const a3ui32 count)
+{
+	const a3ui32 stride = batch->slotStride;
+	const a3_AimConstraint *constraint;
+	a3_SpatialPose *objectPose;
+	a3real v[3];
+	a3ui32 i, end, j;
+	for (i = first, end = first + count; i < end; ++i)
+	{
+		constraint = batch->constraint + batch->index[i];
+		objectPose = stateArray[batch->instance[i]].objectHPose->spatialPose + constraint->node;
+		a3aimConstraintInternalTransformDirection(v, objectPose->transform.m, constraint->aimAxis.v);
+		for (j = 0; j < 3; ++j)
+			batch->aim[i + stride * j] = v[j];
+		a3aimConstraintInternalTransformDirection(v, objectPose->transform.m, constraint->upAxis.v);
+		for (j = 0; j < 3; ++j)
+		{
+			batch->upAxis[i + stride * j] = v[j];
+			batch->direction[i + stride * j] = batch->target[i + stride * j] - objectPose->transform.m[3][j];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef A3_HIERARCHY_SIMD
+// select per lane: mask ? a : b
+#define a3aimConstraintInternalSelect(mask, a, b)	_mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+
+// four dot products of 3-vectors
+inline __m128 a3aimConstraintInternalDot4(const __m128 *a, const __m128 *b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+// four cross products of 3-vectors
+inline void a3aimConstraintInternalCross4(__m128 *v_out, const __m128 *a, const __m128 *b)
+{
+	const __m128 x = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+	const __m128 y = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+	const __m128 z = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+	v_out[0] = x;
+	v_out[1] = y;
+	v_out[2] = z;
+}
+
+// four vectors minus their components along unit axes
+inline void a3aimConstraintInternalReject4(__m128 *v_out, const __m128 *v, const __m128 *unitAxis)
+{
+	const __m128 d = a3aimConstraintInternalDot4(v, unitAxis);
+	v_out[0] = _mm_sub_ps(v[0], _mm_mul_ps(unitAxis[0], d));
+	v_out[1] = _mm_sub_ps(v[1], _mm_mul_ps(unitAxis[1], d));
+	v_out[2] = _mm_sub_ps(v[2], _mm_mul_ps(unitAxis[2], d));
+}
+
+// scale vectors (or quaternions) of n elements per lane
+inline void a3aimConstraintInternalScale4(__m128 *v, const __m128 s, const a3ui32 n)
+{
+	a3ui32 j;
+	for (j = 0; j < n; ++j)
+		v[j] = _mm_mul_ps(v[j], s);
+}
+
+// inverse length of vectors (or quaternions), guarding against zero
+inline __m128 a3aimConstraintInternalLengthInv4(const __m128 lenSq)
+{
+	return _mm_div_ps(_mm_set1_ps(a3real_one), _mm_sqrt_ps(_mm_max_ps(lenSq, _mm_set1_ps(1.0e-30f))));
+}
+
+// rotate four vectors by unit quaternions: v + 2w (q x v) + 2 q x (q x v)
+inline void a3aimConstraintInternalRotate4(__m128 *v_out, const __m128 *q, const __m128 *v)
+{
+	__m128 t[3], u[3];
+	a3aimConstraintInternalCross4(t, q, v);
+	a3aimConstraintInternalScale4(t, _mm_set1_ps(a3real_two), 3);
+	a3aimConstraintInternalCross4(u, q, t);
+	v_out[0] = _mm_add_ps(_mm_add_ps(v[0], _mm_mul_ps(q[3], t[0])), u[0]);
+	v_out[1] = _mm_add_ps(_mm_add_ps(v[1], _mm_mul_ps(q[3], t[1])), u[1]);
+	v_out[2] = _mm_add_ps(_mm_add_ps(v[2], _mm_mul_ps(q[3], t[2])), u[2]);
+}
+#endif	// A3_HIERARCHY_SIMD
+
+// build rotations of slots in range (padded to SIMD width)
+inline void a3aimConstraintInternalSolveRange(a3_AimConstraintBatch *batch, const a3ui32 first, const a3ui32 count)
+{
+	const a3ui32 stride = batch->slotStride, end = first + count;
+	const a3real epsilon = (a3real)1.0e-6;
+	a3ui32 i, j;
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(a3real_one), eps = _mm_set1_ps(epsilon), sign = _mm_set1_ps(-0.0f);
+	__m128 a[3], d[3], u[3], t[3], q[4], r[4], p[3], lenSq, m, n, c;
+	for (i = first; i < end; i += 4)
+	{
+		for (j = 0; j < 3; ++j)
+		{
+			a[j] = _mm_load_ps(batch->aim + i + stride * j);
+			d[j] = _mm_load_ps(batch->direction + i + stride * j);
+			u[j] = _mm_load_ps(batch->upAxis + i + stride * j);
+			t[j] = _mm_load_ps(batch->up + i + stride * j);
+		}
+		a3aimConstraintInternalScale4(a, a3aimConstraintInternalLengthInv4(a3aimConstraintInternalDot4(a, a)), 3);
+		a3aimConstraintInternalScale4(u, a3aimConstraintInternalLengthInv4(a3aimConstraintInternalDot4(u, u)), 3);
+
+		// direction to target; target on the node keeps the current aim
+		lenSq = a3aimConstraintInternalDot4(d, d);
+		m = _mm_cmpgt_ps(lenSq, _mm_mul_ps(eps, eps));
+		a3aimConstraintInternalScale4(d, a3aimConstraintInternalLengthInv4(lenSq), 3);
+		for (j = 0; j < 3; ++j)
+			d[j] = a3aimConstraintInternalSelect(m, d[j], a[j]);
+
+		// swing: delta quaternion (a x d, 1 + a . d); opposite vectors 
+		//	turn half way about the up axis made perpendicular to the aim
+		a3aimConstraintInternalCross4(q, a, d);
+		q[3] = _mm_add_ps(one, a3aimConstraintInternalDot4(a, d));
+		m = _mm_cmplt_ps(q[3], eps);
+		a3aimConstraintInternalReject4(p, u, a);
+		a3aimConstraintInternalScale4(p, a3aimConstraintInternalLengthInv4(a3aimConstraintInternalDot4(p, p)), 3);
+		for (j = 0; j < 3; ++j)
+			q[j] = a3aimConstraintInternalSelect(m, p[j], q[j]);
+		q[3] = a3aimConstraintInternalSelect(m, zero, q[3]);
+		a3aimConstraintInternalScale4(q, a3aimConstraintInternalLengthInv4(_mm_add_ps(a3aimConstraintInternalDot4(q, q), _mm_mul_ps(q[3], q[3]))), 4);
+
+		// clamp: slerp from identity stopping at the limit keeps the axis, 
+		//	with half-angle cosine and sine of the limit
+		c = _mm_load_ps(batch->limitCos + i);
+		m = _mm_cmplt_ps(q[3], c);
+		n = _mm_mul_ps(_mm_load_ps(batch->limitSin + i), a3aimConstraintInternalLengthInv4(_mm_sub_ps(one, _mm_mul_ps(q[3], q[3]))));
+		for (j = 0; j < 3; ++j)
+			q[j] = a3aimConstraintInternalSelect(m, _mm_mul_ps(q[j], n), q[j]);
+		q[3] = a3aimConstraintInternalSelect(m, c, q[3]);
+
+		// twist: delta quaternion about the swung aim between the swung 
+		//	up axis and up direction, both projected off the aim; no twist 
+		//	if either projection vanishes, half turn if they are opposite
+		a3aimConstraintInternalRotate4(a, q, a);
+		a3aimConstraintInternalRotate4(u, q, u);
+		a3aimConstraintInternalReject4(u, u, a);
+		a3aimConstraintInternalReject4(t, t, a);
+		lenSq = _mm_mul_ps(a3aimConstraintInternalDot4(u, u), a3aimConstraintInternalDot4(t, t));
+		a3aimConstraintInternalCross4(r, u, t);
+		r[3] = _mm_add_ps(_mm_sqrt_ps(lenSq), a3aimConstraintInternalDot4(u, t));
+		m = _mm_cmpgt_ps(_mm_add_ps(a3aimConstraintInternalDot4(r, r), _mm_mul_ps(r[3], r[3])), _mm_mul_ps(lenSq, eps));
+		n = _mm_cmpgt_ps(lenSq, _mm_mul_ps(eps, eps));
+		for (j = 0; j < 3; ++j)
+			r[j] = _mm_and_ps(n, a3aimConstraintInternalSelect(m, r[j], a[j]));
+		r[3] = a3aimConstraintInternalSelect(n, _mm_and_ps(m, r[3]), one);
+		a3aimConstraintInternalScale4(r, a3aimConstraintInternalLengthInv4(_mm_add_ps(a3aimConstraintInternalDot4(r, r), _mm_mul_ps(r[3], r[3]))), 4);
+
+		// total, shortest way round, weighted toward identity
+		a3hierarchyQuatProduct4(q, r, q);
+		m = _mm_and_ps(_mm_cmplt_ps(q[3], zero), sign);
+		c = _mm_load_ps(batch->weight + i);
+		for (j = 0; j < 3; ++j)
+			q[j] = _mm_mul_ps(_mm_xor_ps(q[j], m), c);
+		q[3] = _mm_add_ps(_mm_mul_ps(_mm_xor_ps(q[3], m), c), _mm_sub_ps(one, c));
+		a3aimConstraintInternalScale4(q, a3aimConstraintInternalLengthInv4(_mm_add_ps(a3aimConstraintInternalDot4(q, q), _mm_mul_ps(q[3], q[3]))), 4);
+		for (j = 0; j < 4; ++j)
+			_mm_store_ps(batch->rotation + i + stride * j, q[j]);
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3real a[3], d[3], u[3], t[3], p[3], q[4], r[4], s, w;
+	for (i = first; i < end; ++i)
+	{
+		for (j = 0; j < 3; ++j)
+		{
+			a[j] = batch->aim[i + stride * j];
+			d[j] = batch->direction[i + stride * j];
+			u[j] = batch->upAxis[i + stride * j];
+			t[j] = batch->up[i + stride * j];
+		}
+		a3real3MulS(a, a3recipsafe(a3real3Length(a)));
+		a3real3MulS(u, a3recipsafe(a3real3Length(u)));
+
+		// direction to target; target on the node keeps the current aim
+		s = a3real3LengthSquared(d);
+		if (s > epsilon * epsilon)
+			a3real3MulS(d, a3recip(a3sqrt(s)));
+		else
+			a3real3SetReal3(d, a);
+
+		// swing; opposite vectors turn half way about the up axis made 
+		//	perpendicular to the aim
+		if (a3real3Dot(a, d) > epsilon - a3real_one)
+			a3quatSetVectorDelta(q, a, d);
+		else
+		{
+			a3real3Diff(p, u, a3real3ProductS(p, a, a3real3Dot(u, a)));
+			a3real3ProductS(q, p, a3recipsafe(a3real3Length(p)));
+			q[3] = a3real_zero;
+		}
+
+		// clamp: slerp from identity, stopping at the limit
+		if (q[3] < batch->limitCos[i])
+		{
+			a3quatSetReal4(r, q);
+			a3quatSlerpUnitIdentityQ0(q, r, batch->constraint[batch->index[i]].angleLimit / (a3acosd(r[3]) * a3real_two));
+		}
+
+		// twist about the swung aim
+		a3quatVec3GetRotatedIgnoreScale(p, a, q);
+		a3real3SetReal3(a, p);
+		a3quatVec3GetRotatedIgnoreScale(p, u, q);
+		a3real3Diff(u, p, a3real3ProductS(u, a, a3real3Dot(p, a)));
+		a3real3SetReal3(p, t);
+		a3real3Diff(t, p, a3real3ProductS(t, a, a3real3Dot(p, a)));
+		s = a3real3LengthSquared(u) * a3real3LengthSquared(t);
+		a3quatSetIdentity(r);
+		if (s > epsilon * epsilon)
+		{
+			a3real3Normalize(u);
+			a3real3Normalize(t);
+			if (a3real3Dot(u, t) > epsilon - a3real_one)
+				a3quatSetVectorDelta(r, u, t);
+			else
+			{
+				a3real3SetReal3(r, a);
+				r[3] = a3real_zero;
+			}
+		}
+
+		// total, shortest way round, weighted toward identity
+		a3quatProduct(q, r, q);
+		s = q[3] < a3real_zero ? -batch->weight[i] : batch->weight[i];
+		w = a3real_one - batch->weight[i];
+		q[0] *= s;
+		q[1] *= s;
+		q[2] *= s;
+		q[3] = q[3] * s + w;
+		s = a3recipsafe(a3sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]));
+		for (j = 0; j < 4; ++j)
+			batch->rotation[i + stride * j] = q[j] * s;
+	}
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// rotate nodes of slots in range about themselves, recover locals and 
+//	refresh their subtrees
+inline void a3aimConstraintInternalApply(const a3_AimConstraintBatch *batch, const a3_HierarchyState *stateArray, const a3ui32 first, const a3ui32 count)
+{
+	const a3ui32 stride = batch->slotStride;
+	const a3_HierarchyState *state;
+	a3_SpatialPose *objectPose, *localPose;
+	a3mat4 parentInv;
+	a3real q[4];
+	a3ui32 i, end, j, node;
+	a3i32 parentIndex;
+	for (i = first, end = first + count; i < end; ++i)
+	{
+		state = stateArray + batch->instance[i];
+		objectPose = state->objectHPose->spatialPose;
+		localPose = state->localHPose->spatialPose;
+		node = batch->constraint[batch->index[i]].node;
+		parentIndex = batch->hierarchy->nodes[node].parentIndex;
+		for (j = 0; j < 4; ++j)
+			q[j] = batch->rotation[i + stride * j];
+		for (j = 0; j < 3; ++j)
+			a3quatVec3RotateIgnoreScale(objectPose[node].transform.m[j], q);
+		if (parentIndex >= 0)
+		{
+			a3kinematicsTransformInverse(&parentInv, &objectPose[parentIndex].transform, state->poseGroup->scaleMode);
+			a3real4x4Product(localPose[node].transform.m, parentInv.m, objectPose[node].transform.m);
+		}
+		else
+			a3real4x4SetReal4x4(localPose[node].transform.m, objectPose[node].transform.m);
+		a3kinematicsSolveForwardPartial(state, node, state->subtreeEnd[node] - node);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create batch
+a3i32 a3aimConstraintBatchCreate(a3_AimConstraintBatch *batch_out, const a3_Hierarchy *hierarchy, const a3_AimConstraint *constraint, const a3ui32 constraintCount, const a3ui32 instanceCount)
+{
+	if (batch_out && !batch_out->data && hierarchy && hierarchy->nodes && constraint && constraintCount && instanceCount)
+	{
+		a3ui32 stage[a3aimConstraint_constraintMax], stages, stride, count, s, k, c, i, j;
+		a3real limit;
+		size_t dataSize;
+
+		// validate: distinct nodes; stage is number of constrained ancestors
+		if (constraintCount > a3aimConstraint_constraintMax)
+			return -1;
+		for (c = stages = 0; c < constraintCount; ++c)
+		{
+			if (constraint[c].node >= hierarchy->numNodes)
+				return -1;
+			for (i = stage[c] = 0; i < constraintCount; ++i)
+				if (i == c)
+					continue;
+				else if (constraint[i].node == constraint[c].node)
+					return -1;
+				else if (a3hierarchyIsAncestorNode(hierarchy, constraint[i].node, constraint[c].node) > 0)
+					++stage[c];
+			stages = a3maximum(stages, stage[c] + 1);
+		}
+		if (stages > a3aimConstraint_stageMax)
+			return -1;
+
+		// stages: every instance of every constraint at that depth, padded
+		for (s = stride = 0; s < stages; ++s)
+		{
+			for (c = count = 0; c < constraintCount; ++c)
+				count += (stage[c] == s);
+			batch_out->stageStart[s] = stride;
+			batch_out->stageCount[s] = count * instanceCount;
+			stride += (count * instanceCount + 3) / 4 * 4;
+		}
+		batch_out->stageStart[stages] = stride;
+
+		// streams (aligned), then constraints and slot indices
+		dataSize = sizeof(a3real) * stride * 22 + 16 + sizeof(a3_AimConstraint) * constraintCount + sizeof(a3ui32) * (stride * 2 + instanceCount * constraintCount);
+		batch_out->data = malloc(dataSize);
+		if (!batch_out->data)
+			return -1;
+		memset(batch_out->data, 0, dataSize);
+		batch_out->target = (a3real *)(((size_t)batch_out->data + 15) & ~(size_t)15);
+		batch_out->aim = batch_out->target + stride * 3;
+		batch_out->upAxis = batch_out->aim + stride * 3;
+		batch_out->direction = batch_out->upAxis + stride * 3;
+		batch_out->up = batch_out->direction + stride * 3;
+		batch_out->limitCos = batch_out->up + stride * 3;
+		batch_out->limitSin = batch_out->limitCos + stride;
+		batch_out->weight = batch_out->limitSin + stride;
+		batch_out->rotation = batch_out->weight + stride;
+		batch_out->constraint = (a3_AimConstraint *)(batch_out->rotation + stride * 4);
+		batch_out->instance = (a3ui32 *)(batch_out->constraint + constraintCount);
+		batch_out->index = batch_out->instance + stride;
+		batch_out->slot = batch_out->index + stride;
+		memcpy(batch_out->constraint, constraint, sizeof(a3_AimConstraint) * constraintCount);
+
+		// slots: stage-major, then instance, then constraint
+		for (s = 0; s < stages; ++s)
+			for (k = 0, i = batch_out->stageStart[s]; k < instanceCount; ++k)
+				for (c = 0; c < constraintCount; ++c)
+					if (stage[c] == s)
+					{
+						limit = a3clamp(a3real_zero, (a3real)180.0, constraint[c].angleLimit);
+						batch_out->constraint[c].angleLimit = limit;
+						batch_out->instance[i] = k;
+						batch_out->index[i] = c;
+						batch_out->limitCos[i] = a3cosd(limit * a3real_half);
+						batch_out->limitSin[i] = a3sind(limit * a3real_half);
+						batch_out->weight[i] = a3clamp(a3real_zero, a3real_one, constraint[c].weight);
+						for (j = 0; j < 3; ++j)
+							batch_out->up[i + stride * j] = constraint[c].up.v[j];
+						batch_out->slot[k * constraintCount + c] = i++;
+					}
+
+		batch_out->hierarchy = hierarchy;
+		batch_out->constraintCount = constraintCount;
+		batch_out->instanceCount = instanceCount;
+		batch_out->stages = stages;
+		batch_out->slotCount = instanceCount * constraintCount;
+		batch_out->slotStride = stride;
+		return batch_out->slotCount;
+	}
+	return -1;
+}
+
+// release batch
+a3i32 a3aimConstraintBatchRelease(a3_AimConstraintBatch *batch)
+{
+	if (batch && batch->data)
+	{
+		free(batch->data);
+		batch->data = 0;
+		batch->constraint = 0;
+		batch->instance = batch->index = batch->slot = 0;
+		batch->target = batch->aim = batch->upAxis = batch->direction = batch->up = 0;
+		batch->limitCos = batch->limitSin = batch->weight = batch->rotation = 0;
+		batch->hierarchy = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// solve all constraints
+a3i32 a3aimConstraintBatchSolve(a3_AimConstraintBatch *batch, const a3_HierarchyState *stateArray)
+{
+	if (batch && batch->data && stateArray)
+	{
+		a3ui32 k, s, first;
+		for (k = 0; k < batch->instanceCount; ++k)
+			if (!stateArray[k].poseGroup || stateArray[k].poseGroup->hierarchy != batch->hierarchy)
+				return -1;
+
+		// stages in order, so nested nodes see their parents' results
+		for (s = 0; s < batch->stages; ++s)
+		{
+			first = batch->stageStart[s];
+			a3aimConstraintInternalGather(batch, stateArray, first, batch->stageCount[s]);
+			a3aimConstraintInternalSolveRange(batch, first, batch->stageStart[s + 1] - first);
+			a3aimConstraintInternalApply(batch, stateArray, first, batch->stageCount[s]);
+		}
+		return batch->slotCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,232 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBake.c
+	Implementation of baked animation for GPU-instanced crowds.
+*/
+
+#include "../a3_AnimationBake.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// duration of pose clip as sum of its keyframes; zero if clip is invalid 
+//	for the pose group
+inline a3real a3animationBakeInternalClipDuration(const a3_HierarchyPoseGroup *poseGroup, const a3_Clip *clip)
+{
+	const a3_Keyframe *keyframe;
+	a3real duration = a3real_zero;
+	a3ui32 k;
+	if (!clip->keyframe_pool || clip->first_keyframe > clip->last_keyframe || clip->last_keyframe >= clip->keyframe_pool->count)
+		return a3real_zero;
+	for (k = clip->first_keyframe, keyframe = clip->keyframe_pool->keyframe + k; k <= clip->last_keyframe; ++k, ++keyframe)
+	{
+		if (keyframe->data >= poseGroup->hposeCount || keyframe->duration <= a3real_zero)
+			return a3real_zero;
+		duration += keyframe->duration;
+	}
+	return duration;
+}
+
+// wrap time into [0, duration)
+inline a3real a3animationBakeInternalWrap(const a3real time, const a3real duration)
+{
+	a3real t = time - duration * (a3real)(a3i32)(time / duration);
+	if (t < a3real_zero)
+		t += duration;
+	return (t < duration ? t : a3real_zero);
+}
+
+
+//-----------------------------------------------------------------------------
+
+// bake clips
+a3i32 a3animationBakeCreate(a3_AnimationBake *bake_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *clipIndexList_opt, const a3ui32 clipCount, const a3real frameRate, const a3_HierarchyTransform *objectSpaceBindInverse)
+{
+	if (bake_out && !bake_out->data && poseGroup && poseGroup->hierarchy && clipPool && clipPool->clip && 
+		clipCount && clipCount <= a3animationBake_clipMax && frameRate > a3real_zero && objectSpaceBindInverse && objectSpaceBindInverse->transform)
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		const a3ui32 paletteSize = nodeCount * a3hierarchyPalette_mat3x4;
+		a3_HierarchyState state[1] = { 0 };
+		a3_AnimationBakeClip *bakeClip;
+		const a3_Clip *clip;
+		a3real *palette, duration;
+		a3ui32 c, f, clipIndex, frameCount;
+		size_t dataSize;
+
+		// validate clips and count frames: the rate is adjusted per clip 
+		//	so that frames evenly span the loop
+		for (c = frameCount = 0; c < clipCount; ++c)
+		{
+			clipIndex = clipIndexList_opt ? clipIndexList_opt[c] : c;
+			if (clipIndex >= clipPool->count)
+				return -1;
+			duration = a3animationBakeInternalClipDuration(poseGroup, clipPool->clip + clipIndex);
+			if (duration <= a3real_zero)
+				return -1;
+			frameCount += a3maximum((a3ui32)(duration * frameRate + a3real_half), 1);
+		}
+
+		// aligned palettes first so texture uploads read straight from here
+		dataSize = sizeof(a3real) * paletteSize * frameCount + sizeof(a3_AnimationBakeClip) * clipCount + 16;
+		bake_out->data = malloc(dataSize);
+		if (!bake_out->data)
+			return -1;
+		if (a3hierarchyStateCreate(state, poseGroup) < 0)
+		{
+			free(bake_out->data);
+			bake_out->data = 0;
+			return -1;
+		}
+		bake_out->palette = (a3real *)(((size_t)bake_out->data + 15) & ~(size_t)15);
+		bake_out->clip = (a3_AnimationBakeClip *)(bake_out->palette + paletteSize * frameCount);
+		bake_out->hierarchy = poseGroup->hierarchy;
+		bake_out->nodeCount = nodeCount;
+		bake_out->frameCount = frameCount;
+		bake_out->clipCount = clipCount;
+		bake_out->textureWidth = nodeCount * 3;
+		bake_out->textureHeight = frameCount;
+
+		// every frame: sample, forward kinematics, palette row
+		for (c = frameCount = 0, palette = bake_out->palette; c < clipCount; ++c)
+		{
+			clip = clipPool->clip + (clipIndexList_opt ? clipIndexList_opt[c] : c);
+			bakeClip = bake_out->clip + c;
+			bakeClip->duration = a3animationBakeInternalClipDuration(poseGroup, clip);
+			bakeClip->frameFirst = frameCount;
+			bakeClip->frameCount = a3maximum((a3ui32)(bakeClip->duration * frameRate + a3real_half), 1);
+			bakeClip->frameRate = (a3real)bakeClip->frameCount / bakeClip->duration;
+			for (f = 0; f < bakeClip->frameCount; ++f, palette += paletteSize)
+			{
+				a3animationBakeSampleClip(state->samplePoseSoA, poseGroup, clip, (a3real)f / bakeClip->frameRate);
+				a3hierarchyPoseSoALoad(state->localHPose, state->samplePoseSoA);
+				a3hierarchyPoseConvert(state->localHPose, nodeCount);
+				a3kinematicsSolveForward(state);
+				a3hierarchyStateUpdateObjectBindToCurrent(state, objectSpaceBindInverse, palette, a3hierarchyPalette_mat3x4);
+			}
+			frameCount += bakeClip->frameCount;
+		}
+		a3hierarchyStateRelease(state);
+		return frameCount;
+	}
+	return -1;
+}
+
+// release baked animation
+a3i32 a3animationBakeRelease(a3_AnimationBake *bake)
+{
+	if (bake && bake->data)
+	{
+		free(bake->data);
+		memset(bake, 0, sizeof(a3_AnimationBake));
+		return 1;
+	}
+	return -1;
+}
+
+// sample pose clip at time
+a3i32 a3animationBakeSampleClip(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseGroup *poseGroup, const a3_Clip *clip, const a3real time)
+{
+	if (pose_out && poseGroup && clip)
+	{
+		const a3real duration = a3animationBakeInternalClipDuration(poseGroup, clip);
+		const a3_Keyframe *keyframe;
+		a3_HierarchyBlendSource source[1];
+		a3real t;
+		a3ui32 k;
+		if (duration <= a3real_zero)
+			return -1;
+
+		// find keyframe containing time; last blends back to first
+		t = a3animationBakeInternalWrap(time, duration);
+		keyframe = clip->keyframe_pool->keyframe;
+		for (k = clip->first_keyframe; k < clip->last_keyframe && t >= keyframe[k].duration; ++k)
+			t -= keyframe[k].duration;
+		a3hierarchyBlendSourceSet(source, poseGroup, keyframe[k].data,
+			keyframe[k < clip->last_keyframe ? k + 1 : clip->first_keyframe].data, a3minimum(t / keyframe[k].duration, a3real_one));
+		return a3hierarchyBlendSourceSample(pose_out, source);
+	}
+	return -1;
+}
+
+// create palette texture
+a3i32 a3animationBakeCreateTexture(const a3_AnimationBake *bake, a3_Texture *texture_out, const a3byte name_opt[32])
+{
+	if (bake && bake->data && texture_out)
+	{
+		a3_TexturePixelFormatDescriptor pixelFormat[1];
+		a3textureCreatePixelFormatDescriptor(pixelFormat, a3tex_rgba32F);
+		return a3textureCreateFromData(texture_out, name_opt, pixelFormat, bake->textureWidth, bake->textureHeight, bake->palette, a3false);
+	}
+	return -1;
+}
+
+// upload clip table
+a3i32 a3animationBakeUploadClipTable(const a3_AnimationBake *bake, a3_UniformBuffer *clipBuffer)
+{
+	if (bake && bake->data && clipBuffer)
+		return a3bufferRefill(clipBuffer, 0, bake->clipCount * a3animationBake_clipSize, bake->clip);
+	return -1;
+}
+
+// advance instances
+a3i32 a3animationBakeUpdateInstances(const a3_AnimationBake *bake, a3_AnimationBakeInstance *instance, const a3ui32 instanceCount, const a3real dt)
+{
+	if (bake && bake->data && instance)
+	{
+		a3ui32 i;
+		for (i = 0; i < instanceCount; ++i, ++instance)
+		{
+			if (instance->clip >= bake->clipCount)
+				return -1;
+			instance->time = a3animationBakeInternalWrap(instance->time + dt, bake->clip[instance->clip].duration);
+		}
+		return instanceCount;
+	}
+	return -1;
+}
+
+// draw instances
+a3i32 a3animationBakeRender(const a3_AnimationBake *bake, const a3_AnimationBakeInstance *instance, const a3ui32 instanceCount, a3_UniformBuffer *instanceBuffer, const a3ui32 unifBlockBinding, const a3ui32 blockSize, const a3i32 unifFirstLocation)
+{
+	if (bake && bake->data && instance && instanceBuffer && blockSize && blockSize <= a3animationBake_instanceBlockMax)
+	{
+		a3ui32 first, count, draws;
+		for (first = draws = 0; first < instanceCount; first += count, ++draws)
+		{
+			count = a3minimum(blockSize, instanceCount - first);
+			if (a3bufferRefill(instanceBuffer, 0, count * a3animationBake_instanceSize, instance + first) <= 0)
+				return -1;
+			a3shaderUniformBufferActivate(instanceBuffer, unifBlockBinding);
+			if (unifFirstLocation >= 0)
+				a3shaderUniformSendInt(a3unif_single, unifFirstLocation, 1, (a3i32 *)&first);
+			a3vertexDrawableRenderActiveInstanced(count);
+		}
+		return draws;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
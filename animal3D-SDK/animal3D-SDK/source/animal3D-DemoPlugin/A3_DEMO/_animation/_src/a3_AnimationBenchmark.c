@@ -0,0 +1,918 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBenchmark.c
+	Implementation of animation kernel timing comparisons.
+*/
+
+#include "../a3_AnimationBenchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// time forward kinematics for instances of a pose group
+a3i32 a3animationBenchmarkForwardKinematics(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 instanceCount, const a3ui32 iterations)
+{
+	if (benchmark_out && poseGroup && poseGroup->hierarchy && instanceCount && iterations)
+	{
+		const a3_Hierarchy *hierarchy = poseGroup->hierarchy;
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		a3_HierarchyStateBatch batch[1] = { 0 };
+		a3_HierarchyTransform local[1], object[1];
+		a3_Timer timer[1] = { 0 };
+		a3mat4 *localTransform, *objectTransform;
+		a3ui32 n, k, i;
+		a3i32 parentIndex;
+
+		// naive data: one matrix set per instance, each a different frame
+		local->transform = (a3mat4 *)malloc(sizeof(a3mat4) * nodeCount * instanceCount * 2);
+		if (!local->transform)
+			return -1;
+		object->transform = local->transform + nodeCount * instanceCount;
+		if (a3hierarchyStateBatchCreate(batch, hierarchy, instanceCount) < 0)
+		{
+			free(local->transform);
+			return -1;
+		}
+		for (k = 0; k < instanceCount; ++k)
+		{
+			for (i = 0; i < nodeCount; ++i)
+				local->transform[k * nodeCount + i] = poseGroup->hpose[k % poseGroup->hposeCount].spatialPose[i].transform;
+			a3hierarchyStateBatchStoreLocal(batch, k, poseGroup->hpose + k % poseGroup->hposeCount);
+		}
+
+		a3animationBenchmarkReset(benchmark_out, "forward kinematics", instanceCount, iterations);
+
+		// naive: per instance, per node, general matrix product
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			for (k = 0; k < instanceCount; ++k)
+			{
+				localTransform = local->transform + k * nodeCount;
+				objectTransform = object->transform + k * nodeCount;
+				for (i = 0; i < nodeCount; ++i)
+				{
+					parentIndex = hierarchy->nodes[i].parentIndex;
+					if (parentIndex >= 0)
+						a3real4x4Product(objectTransform[i].m, objectTransform[parentIndex].m, localTransform[i].m);
+					else
+						objectTransform[i] = localTransform[i];
+				}
+			}
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "naive a3real4x4Product");
+
+		// batched: per node, SIMD across instances
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3kinematicsSolveForwardBatch(batch);
+		a3animationBenchmarkStop(benchmark_out, timer, "batched SIMD");
+
+		a3hierarchyStateBatchRelease(batch);
+		free(local->transform);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time serial versus level-parallel forward kinematics
+a3i32 a3animationBenchmarkForwardKinematicsParallel(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, a3_KinematicsWorkerPool *pool, const a3ui32 iterations)
+{
+	if (benchmark_out && poseGroup && poseGroup->hierarchy && pool && pool->hierarchy == poseGroup->hierarchy && iterations)
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		a3_HierarchyState state[2] = { 0 };
+		a3_Timer timer[1] = { 0 };
+		a3ui32 n, i;
+
+		if (a3hierarchyStateCreate(state + 0, poseGroup) < 0)
+			return -1;
+		if (a3hierarchyStateCreate(state + 1, poseGroup) < 0)
+		{
+			a3hierarchyStateRelease(state + 0);
+			return -1;
+		}
+		a3hierarchyPoseCopy(state[0].localHPose, poseGroup->hpose, nodeCount);
+		a3hierarchyPoseCopy(state[1].localHPose, poseGroup->hpose, nodeCount);
+
+		a3animationBenchmarkReset(benchmark_out, "forward kinematics (level-parallel)", nodeCount, iterations);
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3kinematicsSolveForward(state + 0);
+		a3animationBenchmarkStop(benchmark_out, timer, "serial");
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3kinematicsSolveForwardParallel(pool, state + 1);
+		a3animationBenchmarkStop(benchmark_out, timer, "level-parallel");
+
+		// outputs must be bit-identical: each node is the same product of 
+		//	the same inputs, only the thread differs; count nodes whose local 
+		//	or object pose is not, and fail if there are any
+		for (i = 0; i < nodeCount; ++i)
+			if (memcmp(state[0].localHPose->spatialPose + i, state[1].localHPose->spatialPose + i, sizeof(a3_SpatialPose)) ||
+				memcmp(state[0].objectHPose->spatialPose + i, state[1].objectHPose->spatialPose + i, sizeof(a3_SpatialPose)))
+				benchmark_out->errorMax += 1.0;
+
+		a3hierarchyStateRelease(state + 1);
+		a3hierarchyStateRelease(state + 0);
+		return (benchmark_out->errorMax == 0.0) ? benchmark_out->variantCount : -1;
+	}
+	return -1;
+}
+
+
+// time CPU skinning
+a3i32 a3animationBenchmarkSkinning(a3_AnimationBenchmark *benchmark_out, a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout, const a3ui32 iterations)
+{
+	if (benchmark_out && engine && engine->geom && palette && iterations &&
+		(layout == a3hierarchyPalette_mat4 || layout == a3hierarchyPalette_mat3x4))
+	{
+		const a3ui32 vertexCount = engine->vertexCount;
+		a3_Timer timer[1] = { 0 };
+		a3real *reference, m[4][3];
+		const a3real *position, *P;
+		a3f64 diff;
+		a3ui32 n, i, j, r, v;
+
+		reference = (a3real *)malloc(sizeof(a3real) * 3 * vertexCount);
+		if (!reference)
+			return -1;
+
+		a3animationBenchmarkReset(benchmark_out, "linear blend skinning", vertexCount, iterations);
+
+		// reference: scalar blend and transform, positions only
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			for (i = 0, position = engine->position; i < vertexCount; ++i, position += 3)
+			{
+				for (j = 0; j < 4; ++j)
+					for (r = 0; r < 3; ++r)
+						m[j][r] = a3real_zero;
+				for (v = 0; v < a3skinning_influenceMax; ++v)
+				{
+					P = palette + engine->blendIndex[i * 4 + v] * layout;
+					for (j = 0; j < 4; ++j)
+						for (r = 0; r < 3; ++r)
+							m[j][r] += engine->blendWeight[i * 4 + v] * (layout == a3hierarchyPalette_mat4 ? P[j * 4 + r] : P[r * 4 + j]);
+				}
+				for (r = 0; r < 3; ++r)
+					reference[i * 3 + r] = m[0][r] * position[0] + m[1][r] * position[1] + m[2][r] * position[2] + m[3][r];
+			}
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "scalar reference (positions)");
+
+		// engine kernel on calling thread, all attributes
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3skinningEngineDeformRange(engine, palette, layout, 0, vertexCount);
+		a3animationBenchmarkStop(benchmark_out, timer, "SIMD, 1 thread");
+
+		// engine across workers
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3skinningEngineDeform(engine, palette, layout);
+		if (a3animationBenchmarkStop(benchmark_out, timer, "SIMD, caller + workers") > 0)
+			benchmark_out->variantThreads[benchmark_out->variantCount - 1] = engine->workerCount + 1;
+
+		for (i = 0; i < vertexCount * 3; ++i)
+		{
+			diff = (a3f64)(reference[i] - engine->positionOut[i]);
+			diff = diff >= 0.0 ? diff : -diff;
+			benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, diff);
+		}
+
+		free(reference);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time two-bone IK
+a3i32 a3animationBenchmarkTwoBone(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3ui32 solveCount, const a3ui32 iterations)
+{
+	if (benchmark_out && poseGroup && poseGroup->hierarchy && solveCount && iterations &&
+		midIndex < poseGroup->hierarchy->numNodes && endIndex < poseGroup->hierarchy->numNodes)
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		a3_HierarchyState state[1] = { 0 };
+		a3_HierarchyStateBatch batch[1] = { 0 };
+		a3_Timer timer[1] = { 0 };
+		const a3real *a, *b, *c, *end;
+		a3real *target, *pole, lab, lcb, reach, length, dir[3];
+		a3ui32 seed = 1, n, k, r;
+		a3f64 diff;
+
+		if (a3hierarchyStateCreate(state, poseGroup) < 0)
+			return -1;
+		if (a3hierarchyStateBatchCreate(batch, poseGroup->hierarchy, solveCount) < 0)
+		{
+			a3hierarchyStateRelease(state);
+			return -1;
+		}
+		target = (a3real *)malloc(sizeof(a3real) * 6 * solveCount);
+		if (!target)
+		{
+			a3hierarchyStateBatchRelease(batch);
+			a3hierarchyStateRelease(state);
+			return -1;
+		}
+		pole = target + 3 * solveCount;
+
+		// base pose; targets scattered around the root within reach, poles 
+		//	ahead of the current bend
+		a3hierarchyPoseCopy(state->localHPose, poseGroup->hpose, nodeCount);
+		a3kinematicsSolveForward(state);
+		a = state->objectHPose->spatialPose[rootIndex].transform.m[3];
+		b = state->objectHPose->spatialPose[midIndex].transform.m[3];
+		c = state->objectHPose->spatialPose[endIndex].transform.m[3];
+		lab = a3sqrt((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+		lcb = a3sqrt((c[0] - b[0]) * (c[0] - b[0]) + (c[1] - b[1]) * (c[1] - b[1]) + (c[2] - b[2]) * (c[2] - b[2]));
+		reach = lab + lcb;
+		for (k = 0; k < solveCount; ++k)
+		{
+			do {
+				for (r = 0; r < 3; ++r)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					dir[r] = (a3real)(seed >> 8) / (a3real)(1u << 24) * a3real_two - a3real_one;
+				}
+				length = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+			} while (length < (a3real)0.01 || length > a3real_one);
+			seed = seed * 1664525u + 1013904223u;
+			length = (a3absolute(lab - lcb) + (reach * (a3real)0.9 - a3absolute(lab - lcb)) * ((a3real)(seed >> 8) / (a3real)(1u << 24) * (a3real)0.8 + (a3real)0.2)) / a3sqrt(length);
+			for (r = 0; r < 3; ++r)
+			{
+				target[k * 3 + r] = a[r] + dir[r] * length;
+				pole[k * 3 + r] = b[r] + (b[r] - (a[r] + c[r]) * a3real_half) * reach;
+			}
+			a3hierarchyStateBatchStoreLocal(batch, k, state->localHPose);
+		}
+		a3kinematicsSolveForwardBatch(batch);
+
+		a3animationBenchmarkReset(benchmark_out, "two-bone IK", solveCount, iterations);
+
+		// single state, refreshing whole hierarchy after each solve
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < solveCount; ++k)
+			{
+				a3kinematicsSolveTwoBone(state, rootIndex, midIndex, endIndex, target + k * 3, pole + k * 3, a3real_zero);
+				a3kinematicsSolveForward(state);
+			}
+		a3animationBenchmarkStop(benchmark_out, timer, "single, full FK refresh");
+
+		// single state, partial refresh of chain subtree only
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < solveCount; ++k)
+				a3kinematicsSolveTwoBone(state, rootIndex, midIndex, endIndex, target + k * 3, pole + k * 3, a3real_zero);
+		a3animationBenchmarkStop(benchmark_out, timer, "single, partial refresh");
+
+		// batch: one instance per solve
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3kinematicsSolveTwoBoneBatch(batch, rootIndex, midIndex, endIndex, target, pole, a3real_zero, poseGroup->scaleMode);
+		a3animationBenchmarkStop(benchmark_out, timer, "batched");
+
+		// every target is reachable: error is distance from end to target
+		end = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, endIndex);
+		for (k = 0; k < solveCount; ++k)
+		{
+			for (r = 0; r < 3; ++r)
+				dir[r] = end[(12 + r) * batch->instanceStride + k] - target[k * 3 + r];
+			diff = (a3f64)a3sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+			benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, diff);
+		}
+
+		free(target);
+		a3hierarchyStateBatchRelease(batch);
+		a3hierarchyStateRelease(state);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time iterative chain IK
+a3i32 a3animationBenchmarkChainIK(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 rootIndex, const a3ui32 endIndex, const a3real tolerance, const a3ui32 iterationMax, const a3ui32 solveCount, const a3ui32 iterations)
+{
+	if (benchmark_out && poseGroup && poseGroup->hierarchy && solveCount && iterations)
+	{
+		const a3byte *variantName[4] = { "FABRIK, cold", "FABRIK, warm", "CCD, cold", "CCD, warm" };
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		a3_HierarchyState state[1] = { 0 };
+		a3_KinematicsChain chain[1] = { 0 };
+		a3_Timer timer[1] = { 0 };
+		const a3real *a, *b;
+		a3real *target, reach = a3real_zero, length, dir[3], angle;
+		a3real errorMax;
+		a3ui32 iterationTotal, n, k, r, v;
+
+		if (a3kinematicsChainCreate(chain, poseGroup->hierarchy, rootIndex, endIndex) < 0)
+			return -1;
+		if (a3hierarchyStateCreate(state, poseGroup) < 0)
+		{
+			a3kinematicsChainRelease(chain);
+			return -1;
+		}
+		target = (a3real *)malloc(sizeof(a3real) * 3 * solveCount);
+		if (!target)
+		{
+			a3hierarchyStateRelease(state);
+			a3kinematicsChainRelease(chain);
+			return -1;
+		}
+
+		// base pose; targets circle the rest direction from the root at 
+		//	half to three quarters of the reach, a little further each solve
+		a3hierarchyPoseCopy(state->localHPose, poseGroup->hpose, nodeCount);
+		a3kinematicsSolveForward(state);
+		for (k = 0; k + 1 < chain->nodeCount; ++k)
+		{
+			a = state->objectHPose->spatialPose[chain->nodeIndex[k]].transform.m[3];
+			b = state->objectHPose->spatialPose[chain->nodeIndex[k + 1]].transform.m[3];
+			reach += a3sqrt((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+		}
+		a = state->objectHPose->spatialPose[rootIndex].transform.m[3];
+		b = state->objectHPose->spatialPose[endIndex].transform.m[3];
+		for (k = 0; k < solveCount; ++k)
+		{
+			angle = (a3real)k * (a3real)0.05;
+			for (r = 0; r < 3; ++r)
+				dir[r] = b[r] - a[r];
+			length = a3sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+			dir[0] += a3sinrv(angle) * length * a3real_half;
+			dir[1] += a3cosrv(angle * (a3real)1.3) * length * a3real_half;
+			dir[2] += a3sinrv(angle * (a3real)0.7) * length * a3real_half;
+			length = reach * ((a3real)0.625 + (a3real)0.125 * a3sinrv(angle * (a3real)0.9)) * a3recipsafe(a3sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]));
+			for (r = 0; r < 3; ++r)
+				target[k * 3 + r] = a[r] + dir[r] * length;
+		}
+
+		a3animationBenchmarkReset(benchmark_out, "chain IK", solveCount, iterations);
+
+		// every solve starts from the base pose, as after sampling the 
+		//	animation each frame (same refresh cost in every variant); cold 
+		//	variants also discard the previous solution
+		for (v = 0, errorMax = a3real_zero; v < 4; ++v)
+		{
+			a3kinematicsChainResetWarmStart(chain);
+			iterationTotal = 0;
+			a3animationBenchmarkStart(timer);
+			for (n = 0; n < iterations; ++n)
+				for (k = 0; k < solveCount; ++k)
+				{
+					a3hierarchyPoseCopy(state->localHPose, poseGroup->hpose, nodeCount);
+					a3kinematicsSolveForward(state);
+					if (!(v & 1))
+						a3kinematicsChainResetWarmStart(chain);
+					if (v < 2)
+						a3kinematicsSolveChainFABRIK(state, chain, target + k * 3, tolerance, iterationMax);
+					else
+						a3kinematicsSolveChainCCD(state, chain, target + k * 3, tolerance, iterationMax);
+					iterationTotal += chain->iterations;
+					errorMax = a3maximum(errorMax, chain->error);
+				}
+			a3animationBenchmarkStop(benchmark_out, timer, variantName[v]);
+			benchmark_out->variantSolverIterations[benchmark_out->variantCount - 1] = (a3f64)iterationTotal / (a3f64)(iterations * solveCount);
+		}
+		benchmark_out->errorMax = (a3f64)errorMax;
+
+		free(target);
+		a3hierarchyStateRelease(state);
+		a3kinematicsChainRelease(chain);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// generic XML reading for comparison: line by line, every attribute of 
+//	every tag tokenized into name/value strings before interpreting
+a3i32 a3animationBenchmarkInternalLoadDeformerWeightGeneric(a3_SkinningWeights *weights_out, const a3_Hierarchy *hierarchy_opt, const a3byte *filePath)
+{
+	FILE *fp = fopen(filePath, "r");
+	a3byte line[512], tag[32], attribName[8][32], attribValue[8][256];
+	const a3byte *ptr, *shapeName, *source, *size, *index, *value, *layer;
+	a3byte listShape[256] = { 0 };
+	a3ui32 attribCount, count = 0, i;
+	a3i32 nodeIndex = -1, length;
+	a3boolean inShape = 0;
+	a3f32 x, y, z;
+
+	if (!fp)
+		return -1;
+	weights_out->pointCount = weights_out->influenceCount = weights_out->droppedCount = 0;
+	while (fgets(line, sizeof(line), fp))
+	{
+		ptr = strchr(line, '<');
+		if (!ptr || sscanf(ptr, "<%31[^ />]%n", tag, &length) != 1)
+			continue;
+		for (ptr += length, attribCount = 0; attribCount < 8 &&
+			sscanf(ptr, " %31[^=]=\"%255[^\"]\"%n", attribName[attribCount], attribValue[attribCount], &length) == 2;
+			ptr += length, ++attribCount);
+
+		shapeName = source = size = index = value = layer = 0;
+		for (i = 0; i < attribCount; ++i)
+		{
+			if (!strcmp(attribName[i], "name") || !strcmp(attribName[i], "shape"))
+				shapeName = attribValue[i];
+			else if (!strcmp(attribName[i], "source"))
+				source = attribValue[i];
+			else if (!strcmp(attribName[i], "size"))
+				size = attribValue[i];
+			else if (!strcmp(attribName[i], "index"))
+				index = attribValue[i];
+			else if (!strcmp(attribName[i], "value"))
+				value = attribValue[i];
+			else if (!strcmp(attribName[i], "layer"))
+				layer = attribValue[i];
+		}
+
+		if (!strcmp(tag, "shape") && size && shapeName)
+		{
+			// single shape only
+			if (weights_out->data)
+				break;
+			count = (a3ui32)atoi(size);
+			strcpy(listShape, shapeName);
+			if (!count || a3skinningWeightsCreate(weights_out, count) < 0)
+				break;
+			inShape = 1;
+		}
+		else if (!strcmp(tag, "weights") && weights_out->data)
+		{
+			inShape = 0;
+			nodeIndex = -1;
+			if (shapeName && strcmp(shapeName, listShape))
+				continue;
+			if (hierarchy_opt && source && strlen(source) < a3node_nameSize)
+				nodeIndex = a3hierarchyGetNodeIndex(hierarchy_opt, source);
+			else if (!hierarchy_opt && layer)
+				nodeIndex = atoi(layer);
+			if (nodeIndex >= 0)
+				++weights_out->influenceCount;
+		}
+		else if (!strcmp(tag, "point") && index && value && weights_out->data && (a3ui32)atoi(index) < count)
+		{
+			i = (a3ui32)atoi(index);
+			if (inShape && sscanf(value, "%f %f %f", &x, &y, &z) == 3)
+			{
+				weights_out->position[i * 3 + 0] = (a3real)x;
+				weights_out->position[i * 3 + 1] = (a3real)y;
+				weights_out->position[i * 3 + 2] = (a3real)z;
+			}
+			else if (!inShape && nodeIndex >= 0)
+				a3skinningWeightsAddInfluence(weights_out, i, nodeIndex, (a3real)atof(value));
+		}
+	}
+	fclose(fp);
+	if (weights_out->data)
+		return a3skinningWeightsNormalize(weights_out);
+	return -1;
+}
+
+// time skin weights loading
+a3i32 a3animationBenchmarkSkinWeightsLoad(a3_AnimationBenchmark *benchmark_out, const a3_Hierarchy *hierarchy_opt, const a3byte *filePath, const a3ui32 iterations)
+{
+	if (benchmark_out && filePath && *filePath && iterations)
+	{
+		a3_SkinningWeights weights[2] = { 0 };
+		a3_Timer timer[1] = { 0 };
+		a3f64 diff;
+		a3ui32 n, i;
+
+		// reference result, also gives point count
+		if (a3animationBenchmarkInternalLoadDeformerWeightGeneric(weights + 0, hierarchy_opt, filePath) < 0)
+			return -1;
+
+		a3animationBenchmarkReset(benchmark_out, "skin weights load", weights[0].pointCount, iterations);
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			a3skinningWeightsRelease(weights + 0);
+			a3animationBenchmarkInternalLoadDeformerWeightGeneric(weights + 0, hierarchy_opt, filePath);
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "generic (fgets + attributes)");
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			a3skinningWeightsRelease(weights + 1);
+			a3skinningWeightsLoadDeformerWeight(weights + 1, hierarchy_opt, filePath);
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "deformerWeight scanner");
+
+		// weights and indices must agree up to number parsing
+		if (weights[0].data && weights[1].data && weights[0].pointCount == weights[1].pointCount)
+			for (i = 0; i < weights[0].pointCount * a3skinning_influenceMax; ++i)
+			{
+				diff = (a3f64)(weights[0].blendWeight[i] - weights[1].blendWeight[i]);
+				diff = diff >= 0.0 ? diff : -diff;
+				if (weights[0].blendIndex[i] != weights[1].blendIndex[i] && weights[0].blendWeight[i] > a3real_zero)
+					diff = 1.0;
+				benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, diff);
+			}
+		else
+			benchmark_out->errorMax = 1.0;
+
+		a3skinningWeightsRelease(weights + 1);
+		a3skinningWeightsRelease(weights + 0);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time whole-pose blending
+a3i32 a3animationBenchmarkBlend(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 blendCount, const a3ui32 iterations)
+{
+	if (benchmark_out && poseGroup && poseGroup->hierarchy && poseGroup->hposeCount > 1 && blendCount && iterations)
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		const a3ui32 poseCount = a3minimum(poseGroup->hposeCount, 64);
+		const a3real u = (a3real)0.375;
+		a3_HierarchyPoseSoA *pose, result[1] = { 0 };
+		a3_SpatialPose *spatialPose;
+		const a3_SpatialPose *spatialPose0, *spatialPose1;
+		a3_Timer timer[1] = { 0 };
+		a3real *mask, q[4], d, u1, lenInv;
+		a3_HierarchyPose hpose[1];
+		a3ui32 n, k, i, j;
+
+		pose = (a3_HierarchyPoseSoA *)malloc(sizeof(a3_HierarchyPoseSoA) * (poseCount + 1) + sizeof(a3_SpatialPose) * nodeCount + sizeof(a3real) * (nodeCount + a3poseSoA_nodeAlign));
+		if (!pose)
+			return -1;
+		memset(pose, 0, sizeof(a3_HierarchyPoseSoA) * (poseCount + 1));
+		spatialPose = (a3_SpatialPose *)(pose + poseCount + 1);
+		mask = (a3real *)(spatialPose + nodeCount);
+		for (k = 0; k <= poseCount; ++k)
+			a3hierarchyPoseSoACreate(pose + k, nodeCount);
+		for (k = 0; k < poseCount; ++k)
+			a3hierarchyPoseSoAStore(pose + k, poseGroup->hpose + k);
+		a3hierarchyPoseSoACreate(result, nodeCount);
+		for (i = 0; i < nodeCount + a3poseSoA_nodeAlign; ++i)
+			mask[i] = a3real_one;
+
+		a3animationBenchmarkReset(benchmark_out, "whole-pose blend (nodes)", nodeCount * blendCount, iterations);
+
+		// node loop over spatial poses: scalar nlerp and channel lerps
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < blendCount; ++k)
+			{
+				spatialPose0 = poseGroup->hpose[k % poseCount].spatialPose;
+				spatialPose1 = poseGroup->hpose[(k + 1) % poseCount].spatialPose;
+				for (i = 0; i < nodeCount; ++i)
+				{
+					d = spatialPose0[i].orientation.x * spatialPose1[i].orientation.x + spatialPose0[i].orientation.y * spatialPose1[i].orientation.y +
+						spatialPose0[i].orientation.z * spatialPose1[i].orientation.z + spatialPose0[i].orientation.w * spatialPose1[i].orientation.w;
+					u1 = d < a3real_zero ? -u : u;
+					for (j = 0, d = a3real_zero; j < 4; ++j)
+					{
+						q[j] = (a3real_one - u) * spatialPose0[i].orientation.v[j] + u1 * spatialPose1[i].orientation.v[j];
+						d += q[j] * q[j];
+					}
+					lenInv = a3recip(a3sqrt(d));
+					for (j = 0; j < 4; ++j)
+						spatialPose[i].orientation.v[j] = q[j] * lenInv;
+					for (j = 0; j < 3; ++j)
+					{
+						spatialPose[i].scale.v[j] = spatialPose0[i].scale.v[j] + u * (spatialPose1[i].scale.v[j] - spatialPose0[i].scale.v[j]);
+						spatialPose[i].translation.v[j] = spatialPose0[i].translation.v[j] + u * (spatialPose1[i].translation.v[j] - spatialPose0[i].translation.v[j]);
+					}
+				}
+			}
+		a3animationBenchmarkStop(benchmark_out, timer, "node loop, spatial poses");
+
+		// structure-of-arrays kernels
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < blendCount; ++k)
+				a3hierarchyPoseSoALerp(result, pose + k % poseCount, pose + (k + 1) % poseCount, u);
+		a3animationBenchmarkStop(benchmark_out, timer, "SoA nlerp");
+
+		// compare last blend of each nlerp variant with node loop
+		hpose->spatialPose = spatialPose;
+		a3hierarchyPoseSoAStore(pose + poseCount, hpose);
+		for (j = 0; j < a3poseSoA_channelCount; ++j)
+			for (i = 0; i < nodeCount; ++i)
+				benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, (a3f64)a3absolute(result->channel[j][i] - pose[poseCount].channel[j][i]));
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < blendCount; ++k)
+				a3hierarchyPoseSoALerpMasked(result, pose + k % poseCount, pose + (k + 1) % poseCount, u, mask);
+		a3animationBenchmarkStop(benchmark_out, timer, "SoA nlerp, node mask");
+		for (j = 0; j < a3poseSoA_channelCount; ++j)
+			for (i = 0; i < nodeCount; ++i)
+				benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, (a3f64)a3absolute(result->channel[j][i] - pose[poseCount].channel[j][i]));
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < blendCount; ++k)
+				a3hierarchyPoseSoASlerp(result, pose + k % poseCount, pose + (k + 1) % poseCount, u, 0);
+		a3animationBenchmarkStop(benchmark_out, timer, "SoA slerp");
+
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < blendCount; ++k)
+				a3hierarchyPoseSoAAddDifference(result, pose + k % poseCount, pose + (k + 1) % poseCount, pose, u, 0);
+		a3animationBenchmarkStop(benchmark_out, timer, "SoA additive");
+
+		a3hierarchyPoseSoARelease(result);
+		for (k = 0; k <= poseCount; ++k)
+			a3hierarchyPoseSoARelease(pose + k);
+		free(pose);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time sprite updates
+a3i32 a3animationBenchmarkSprites(a3_AnimationBenchmark *benchmark_out, const a3_ClipPool *clipPool, const a3_TextureAtlas *atlas, const a3ui32 spriteCount, const a3ui32 iterations)
+{
+	if (benchmark_out && clipPool && clipPool->count && atlas && atlas->cells && spriteCount && iterations)
+	{
+		const a3real dt = (a3real)(1.0 / 64.0);
+		a3_SpriteAnimationBatch batch[1] = { 0 };
+		a3_ClipController *clipCtrl;
+		const a3_TextureAtlasCell *cell;
+		a3_Timer timer[1] = { 0 };
+		a3real *rect;
+		a3ui32 n, k;
+
+		clipCtrl = (a3_ClipController *)malloc((sizeof(a3_ClipController) + sizeof(a3real) * 4) * spriteCount);
+		if (!clipCtrl)
+			return -1;
+		rect = (a3real *)(clipCtrl + spriteCount);
+		if (a3spriteAnimationBatchCreate(batch, clipPool, atlas, spriteCount) < 0)
+		{
+			free(clipCtrl);
+			return -1;
+		}
+		for (k = 0; k < spriteCount; ++k)
+		{
+			memset(clipCtrl + k, 0, sizeof(a3_ClipController));
+			a3clipControllerSetClip(clipCtrl + k, clipPool, k % clipPool->count);
+			clipCtrl[k].playback_direction = 1;
+			if (a3spriteAnimationBatchAdd(batch, k % clipPool->count, a3real_one) < 0)
+			{
+				a3spriteAnimationBatchRelease(batch);
+				free(clipCtrl);
+				return -1;
+			}
+		}
+
+		a3animationBenchmarkReset(benchmark_out, "sprite animation (sprites)", spriteCount, iterations);
+
+		// one controller per sprite, then copy its cell for upload
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			for (k = 0; k < spriteCount; ++k)
+			{
+				a3clipControllerUpdate(clipCtrl + k, dt);
+				cell = atlas->cells + clipPool->clip[clipCtrl[k].clip].keyframe_pool->keyframe[clipCtrl[k].keyframe].data;
+				rect[k * 4 + 0] = cell->relativeOffset[0];
+				rect[k * 4 + 1] = cell->relativeOffset[1];
+				rect[k * 4 + 2] = cell->relativeSize[0];
+				rect[k * 4 + 3] = cell->relativeSize[1];
+			}
+		a3animationBenchmarkStop(benchmark_out, timer, "clip controller per sprite");
+
+		// batched update writes only rects that change
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3spriteAnimationBatchUpdate(batch, dt);
+		a3animationBenchmarkStop(benchmark_out, timer, "sprite batch");
+
+		for (k = 0; k < spriteCount * 4; ++k)
+			benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, (a3f64)a3absolute(rect[k] - batch->instance[k]));
+
+		a3spriteAnimationBatchRelease(batch);
+		free(clipCtrl);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+// time dense versus reduced capture sampling
+a3i32 a3animationBenchmarkKeyframeReduction(a3_AnimationBenchmark *benchmark_out, const a3_KeyframeReduction *reduction, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 sampleCount, const a3ui32 iterations)
+{
+	if (benchmark_out && reduction && reduction->data && poseGroup && poseGroup->hierarchy == reduction->hierarchy &&
+		firstPose + reduction->frameCount <= poseGroup->hposeCount && sampleCount && iterations)
+	{
+		// a little over a third of a frame per sample, so samples land 
+		//	between frames
+		const a3ui32 nodeCount = reduction->nodeCount, lastFrame = reduction->frameCount - 1;
+		const a3real step = reduction->frameDuration * (a3real)0.37;
+		a3_HierarchyPoseSoA pose[2] = { 0 };
+		a3_HierarchyBlendSource source[1];
+		a3_Timer timer[1] = { 0 };
+		a3ui32 *cursor, n, k, f, i, j;
+		a3real t, u;
+
+		cursor = (a3ui32 *)malloc(sizeof(a3ui32) * nodeCount * a3keyframeReduction_trackCount);
+		if (!cursor)
+			return -1;
+		memset(cursor, 0, sizeof(a3ui32) * nodeCount * a3keyframeReduction_trackCount);
+		a3hierarchyPoseSoACreate(pose + 0, nodeCount);
+		a3hierarchyPoseSoACreate(pose + 1, nodeCount);
+		source->poseGroup = poseGroup;
+
+		a3animationBenchmarkReset(benchmark_out, "keyframe reduction (samples)", sampleCount, iterations);
+
+		// dense: lerp between the two frames around each time
+		a3animationBenchmarkStart(timer);
+		for (n = 0, t = a3real_zero; n < iterations; ++n)
+			for (k = 0; k < sampleCount; ++k)
+			{
+				if ((t += step) >= reduction->duration)
+					t -= reduction->duration;
+				u = t / reduction->frameDuration;
+				f = a3minimum((a3ui32)u, lastFrame);
+				source->pose0 = firstPose + f;
+				source->pose1 = firstPose + a3minimum(f + 1, lastFrame);
+				source->param = u - (a3real)f;
+				a3hierarchyBlendSourceSample(pose + 0, source);
+			}
+		a3animationBenchmarkStop(benchmark_out, timer, "dense frames, pose group lerp");
+
+		// reduced: cursors step through each track's keys
+		a3animationBenchmarkStart(timer);
+		for (n = 0, t = a3real_zero; n < iterations; ++n)
+			for (k = 0; k < sampleCount; ++k)
+			{
+				if ((t += step) >= reduction->duration)
+					t -= reduction->duration;
+				a3keyframeReductionSample(pose + 1, cursor, reduction, t);
+			}
+		a3animationBenchmarkStop(benchmark_out, timer, "reduced tracks, cursors");
+
+		for (j = 0; j < a3poseSoA_channelCount; ++j)
+			for (i = 0; i < nodeCount; ++i)
+				benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, (a3f64)a3absolute(pose[0].channel[j][i] - pose[1].channel[j][i]));
+
+		a3hierarchyPoseSoARelease(pose + 0);
+		a3hierarchyPoseSoARelease(pose + 1);
+		free(cursor);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+
+// time live versus baked crowd animation
+a3i32 a3animationBenchmarkBake(a3_AnimationBenchmark *benchmark_out, const a3_AnimationBake *bake, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *clipIndexList_opt, const a3_HierarchyTransform *objectSpaceBindInverse, const a3ui32 instanceCount, const a3ui32 iterations)
+{
+	if (benchmark_out && bake && bake->data && poseGroup && poseGroup->hierarchy == bake->hierarchy && clipPool && 
+		objectSpaceBindInverse && objectSpaceBindInverse->transform && instanceCount && iterations)
+	{
+		// 60 updates per second; instances spread over clips and phases
+		const a3ui32 nodeCount = bake->nodeCount, paletteSize = nodeCount * a3hierarchyPalette_mat3x4;
+		const a3real dt = (a3real)(1.0 / 60.0);
+		const a3_AnimationBakeClip *bakeClip;
+		const a3_Clip *clip;
+		const a3real *baked;
+		a3_HierarchyState state[1] = { 0 };
+		a3_AnimationBakeInstance *instance, *live;
+		a3_Timer timer[1] = { 0 };
+		a3real *palette;
+		a3i32 frame;
+		a3ui32 n, i, j;
+
+		instance = (a3_AnimationBakeInstance *)malloc(sizeof(a3_AnimationBakeInstance) * instanceCount * 2 + sizeof(a3real) * paletteSize);
+		if (!instance)
+			return -1;
+		if (a3hierarchyStateCreate(state, poseGroup) < 0)
+		{
+			free(instance);
+			return -1;
+		}
+		live = instance + instanceCount;
+		palette = (a3real *)(live + instanceCount);
+		for (i = 0; i < instanceCount; ++i)
+		{
+			instance[i].clip = i % bake->clipCount;
+			instance[i].time = bake->clip[instance[i].clip].duration * (a3real)(i % 17) / (a3real)17;
+		}
+		memcpy(live, instance, sizeof(a3_AnimationBakeInstance) * instanceCount);
+
+		a3animationBenchmarkReset(benchmark_out, "baked crowd (instances)", instanceCount, iterations);
+
+		// live: whole palette per instance, which would then be uploaded
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			a3animationBakeUpdateInstances(bake, live, instanceCount, dt);
+			for (i = 0; i < instanceCount; ++i)
+			{
+				clip = clipPool->clip + (clipIndexList_opt ? clipIndexList_opt[live[i].clip] : live[i].clip);
+				a3animationBakeSampleClip(state->samplePoseSoA, poseGroup, clip, live[i].time);
+				a3hierarchyPoseSoALoad(state->localHPose, state->samplePoseSoA);
+				a3hierarchyPoseConvert(state->localHPose, nodeCount);
+				a3kinematicsSolveForward(state);
+				a3hierarchyStateUpdateObjectBindToCurrent(state, objectSpaceBindInverse, palette, a3hierarchyPalette_mat3x4);
+			}
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "live FK + palette");
+
+		// baked lookup: same palettes as live, copied from frame rows, 
+		//	i.e. what the vertex shader's fetches do on the CPU
+		memcpy(live, instance, sizeof(a3_AnimationBakeInstance) * instanceCount);
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+		{
+			a3animationBakeUpdateInstances(bake, live, instanceCount, dt);
+			for (i = 0; i < instanceCount; ++i)
+			{
+				frame = a3animationBakeGetFrame(bake, live[i].clip, live[i].time);
+				memcpy(palette, a3animationBakeGetPalette(bake, frame), sizeof(a3real) * paletteSize);
+			}
+		}
+		a3animationBenchmarkStop(benchmark_out, timer, "baked palette lookup");
+
+		// baked upload: instance entries are all that leaves the CPU; 
+		//	the lookup above moves to the GPU and is not timed here
+		a3animationBenchmarkStart(timer);
+		for (n = 0; n < iterations; ++n)
+			a3animationBakeUpdateInstances(bake, instance, instanceCount, dt);
+		a3animationBenchmarkStop(benchmark_out, timer, "baked (clip, time) only");
+
+		// baked rows against live evaluation at their frame times
+		for (i = 0; i < a3minimum(instanceCount, 64); ++i)
+		{
+			frame = a3animationBakeGetFrame(bake, instance[i].clip, instance[i].time);
+			bakeClip = bake->clip + instance[i].clip;
+			clip = clipPool->clip + (clipIndexList_opt ? clipIndexList_opt[instance[i].clip] : instance[i].clip);
+			a3animationBakeSampleClip(state->samplePoseSoA, poseGroup, clip, (a3real)(frame - (a3i32)bakeClip->frameFirst) / bakeClip->frameRate);
+			a3hierarchyPoseSoALoad(state->localHPose, state->samplePoseSoA);
+			a3hierarchyPoseConvert(state->localHPose, nodeCount);
+			a3kinematicsSolveForward(state);
+			a3hierarchyStateUpdateObjectBindToCurrent(state, objectSpaceBindInverse, palette, a3hierarchyPalette_mat3x4);
+			baked = a3animationBakeGetPalette(bake, frame);
+			for (j = 0; j < paletteSize; ++j)
+				benchmark_out->errorMax = a3maximum(benchmark_out->errorMax, (a3f64)a3absolute(baked[j] - palette[j]));
+		}
+
+		a3hierarchyStateRelease(state);
+		free(instance);
+		return benchmark_out->variantCount;
+	}
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+// print benchmark result to console
+a3i32 a3animationBenchmarkPrint(const a3_AnimationBenchmark *benchmark)
+{
+	a3ui32 i;
+	if (benchmark && benchmark->variantCount)
+	{
+		printf("\n A3 benchmark: %s (%u items, %u iterations)", benchmark->name, benchmark->instanceCount, benchmark->iterations);
+		for (i = 0; i < benchmark->variantCount; ++i)
+			printf("\n    %-32s %10.4lf ms  (%.2lfx)  %.3lf M items/s per thread", benchmark->variantName[i], benchmark->variantTime[i] * 1000.0,
+				benchmark->variantTime[i] > 0.0 ? benchmark->variantTime[0] / benchmark->variantTime[i] : 0.0,
+				benchmark->variantTime[i] > 0.0 ? (a3f64)benchmark->instanceCount / benchmark->variantTime[i] / (a3f64)benchmark->variantThreads[i] * 1.0e-6 : 0.0);
+		for (i = 0; i < benchmark->variantCount; ++i)
+			if (benchmark->variantSolverIterations[i] > 0.0)
+				printf("\n    %-32s %10.2lf iterations per item", benchmark->variantName[i], benchmark->variantSolverIterations[i]);
+		printf("\n    max difference from first variant: %g", benchmark->errorMax);
+		return benchmark->variantCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,289 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationCurve.c
+	Implementation of curve tracks.
+*/
+
+#include "../a3_AnimationCurve.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// find track segment containing time, starting from cursor: holding or 
+//	stepping to the next segment is the common case; otherwise search
+inline a3ui32 a3animationCurveInternalSeek(const a3_AnimationCurveSet *curveSet, const a3_AnimationCurveTrack *track, a3ui32 segment, const a3real time)
+{
+	const a3real *keyTime = curveSet->keyTime + track->keyFirst;
+	const a3ui32 last = track->keyCount - 1;
+	a3ui32 lo, hi, mid;
+	if (segment > last)
+		segment = 0;
+	if (time >= keyTime[segment])
+	{
+		if (segment == last || time < keyTime[segment + 1])
+			return segment;
+		if (++segment == last || time < keyTime[segment + 1])
+			return segment;
+		lo = segment + 1;
+		hi = last;
+	}
+	else if (segment)
+	{
+		lo = 0;
+		hi = segment - 1;
+	}
+	else
+		return 0;
+
+	// last key at or before time
+	while (lo < hi)
+	{
+		mid = (lo + hi + 1) / 2;
+		if (keyTime[mid] <= time)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+// segment parameter, clamped to segment
+inline a3real a3animationCurveInternalParam(const a3_AnimationCurveSet *curveSet, const a3ui32 key, const a3real time)
+{
+	const a3real t = (time - curveSet->keyTime[key]) * curveSet->segmentDurationInv[key];
+	return a3clamp(a3real_zero, a3real_one, t);
+}
+
+// Bezier control values of segment from key k0
+inline void a3animationCurveInternalControl(a3real *control_out, const a3_AnimationCurveSet *curveSet, const a3_AnimationCurveTrack *track, const a3ui32 k0)
+{
+	const a3real *value = curveSet->keyValue;
+	const a3ui32 k1 = k0 + 1, kEnd = track->keyFirst + track->keyCount;
+	const a3real third = a3recip((a3real)3), sixth = a3recip((a3real)6);
+	a3real d;
+
+	control_out[0] = control_out[1] = control_out[2] = control_out[3] = value[k0];
+	if (k1 >= kEnd)
+		return;
+	control_out[3] = value[k1];
+	switch (track->interp)
+	{
+	case a3curveInterp_hermite:
+		d = curveSet->keyTime[k1] - curveSet->keyTime[k0];
+		control_out[1] = value[k0] + curveSet->keyOut[k0] * d * third;
+		control_out[2] = value[k1] - curveSet->keyIn[k1] * d * third;
+		break;
+	case a3curveInterp_bezier:
+		control_out[1] = curveSet->keyOut[k0];
+		control_out[2] = curveSet->keyIn[k1];
+		break;
+	default:
+		control_out[1] = value[k0] + (value[k1] - value[k0 > track->keyFirst ? k0 - 1 : k0]) * sixth;
+		control_out[2] = value[k1] - (value[k1 + 1 < kEnd ? k1 + 1 : k1] - value[k0]) * sixth;
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create curve set
+a3i32 a3animationCurveSetCreate(a3_AnimationCurveSet *curveSet_out, const a3ui32 trackMax, const a3ui32 keyMax)
+{
+	if (curveSet_out && !curveSet_out->data && trackMax && keyMax)
+	{
+		const a3ui32 trackStride = (trackMax + 3) / 4 * 4;
+		const size_t dataSize = sizeof(a3real) * ((keyMax + 1) * 4 + 16) + sizeof(a3real) * (keyMax * 4 + (keyMax + 1)) + sizeof(a3_AnimationCurveTrack) * trackMax;
+
+		curveSet_out->data = malloc(dataSize);
+		if (!curveSet_out->data)
+			return -1;
+		memset(curveSet_out->data, 0, dataSize);
+
+		// aligned control values first
+		curveSet_out->control = (a3real *)(((size_t)curveSet_out->data + 15) & ~(size_t)15);
+		curveSet_out->segmentDurationInv = curveSet_out->control + (keyMax + 1) * 4;
+		curveSet_out->keyTime = curveSet_out->segmentDurationInv + (keyMax + 1);
+		curveSet_out->keyValue = curveSet_out->keyTime + keyMax;
+		curveSet_out->keyIn = curveSet_out->keyValue + keyMax;
+		curveSet_out->keyOut = curveSet_out->keyIn + keyMax;
+		curveSet_out->track = (a3_AnimationCurveTrack *)(curveSet_out->keyOut + keyMax);
+		curveSet_out->trackMax = trackMax;
+		curveSet_out->trackStride = trackStride;
+		curveSet_out->keyMax = keyMax;
+		curveSet_out->trackCount = curveSet_out->keyCount = 0;
+		return trackMax;
+	}
+	return -1;
+}
+
+// release curve set
+a3i32 a3animationCurveSetRelease(a3_AnimationCurveSet *curveSet)
+{
+	if (curveSet && curveSet->data)
+	{
+		free(curveSet->data);
+		memset(curveSet, 0, sizeof(a3_AnimationCurveSet));
+		return 1;
+	}
+	return -1;
+}
+
+// add track
+a3i32 a3animationCurveSetAddTrack(a3_AnimationCurveSet *curveSet, const a3byte name[a3keyframeAnimation_nameLenMax], const a3_AnimationCurveInterp interp, const a3_AnimationCurveKey *key, const a3ui32 keyCount)
+{
+	if (curveSet && curveSet->data && key && keyCount && curveSet->trackCount < curveSet->trackMax && curveSet->keyCount + keyCount <= curveSet->keyMax && interp <= a3curveInterp_catmullRom)
+	{
+		a3_AnimationCurveTrack *track = curveSet->track + curveSet->trackCount;
+		a3ui32 i, k;
+
+		// keys must be in strictly increasing time
+		for (i = 1; i < keyCount; ++i)
+			if (key[i].time <= key[i - 1].time)
+				return -1;
+
+		strncpy(track->name, name ? name : "", a3keyframeAnimation_nameLenMax);
+		track->name[a3keyframeAnimation_nameLenMax - 1] = 0;
+		track->interp = interp;
+		track->keyFirst = curveSet->keyCount;
+		track->keyCount = keyCount;
+		for (i = 0, k = track->keyFirst; i < keyCount; ++i, ++k)
+		{
+			curveSet->keyTime[k] = key[i].time;
+			curveSet->keyValue[k] = key[i].value;
+			curveSet->keyIn[k] = key[i].in;
+			curveSet->keyOut[k] = key[i].out;
+		}
+
+		// segments; the last key holds its value
+		for (i = 0, k = track->keyFirst; i < keyCount; ++i, ++k)
+		{
+			curveSet->segmentDurationInv[k] = (i + 1 < keyCount) ? a3recip(curveSet->keyTime[k + 1] - curveSet->keyTime[k]) : a3real_zero;
+			a3animationCurveInternalControl(curveSet->control + k * 4, curveSet, track, k);
+		}
+		curveSet->keyCount += keyCount;
+		return curveSet->trackCount++;
+	}
+	return -1;
+}
+
+// get track index by name
+a3i32 a3animationCurveSetGetTrackIndex(const a3_AnimationCurveSet *curveSet, const a3byte name[a3keyframeAnimation_nameLenMax])
+{
+	a3ui32 i;
+	if (curveSet && curveSet->data && name)
+	{
+		for (i = 0; i < curveSet->trackCount; ++i)
+			if (!strncmp(curveSet->track[i].name, name, a3keyframeAnimation_nameLenMax))
+				return i;
+	}
+	return -1;
+}
+
+// sample one track with its own kernel
+a3real a3animationCurveSetSampleTrack(const a3_AnimationCurveSet *curveSet, const a3ui32 trackIndex, const a3real time)
+{
+	if (curveSet && curveSet->data && trackIndex < curveSet->trackCount)
+	{
+		const a3_AnimationCurveTrack *track = curveSet->track + trackIndex;
+		const a3real *value = curveSet->keyValue;
+		const a3ui32 k0 = track->keyFirst + a3animationCurveInternalSeek(curveSet, track, 0, time), k1 = k0 + 1;
+		const a3ui32 kEnd = track->keyFirst + track->keyCount;
+		const a3real t = a3animationCurveInternalParam(curveSet, k0, time);
+		a3real d;
+		if (k1 >= kEnd)
+			return value[k0];
+		switch (track->interp)
+		{
+		case a3curveInterp_hermite:
+			d = curveSet->keyTime[k1] - curveSet->keyTime[k0];
+			return a3HermiteTangent(value[k0], value[k1], curveSet->keyOut[k0] * d, curveSet->keyIn[k1] * d, t);
+		case a3curveInterp_bezier:
+			return a3Bezier3(value[k0], curveSet->keyOut[k0], curveSet->keyIn[k1], value[k1], t);
+		default:
+			return a3CatmullRom(value[k0 > track->keyFirst ? k0 - 1 : k0], value[k0], value[k1], value[k1 + 1 < kEnd ? k1 + 1 : k1], t);
+		}
+	}
+	return a3real_zero;
+}
+
+// batched evaluation
+a3i32 a3animationCurveSetEvaluate(a3real *value_out, a3ui32 *cursor, const a3_AnimationCurveSet *curveSet, const a3real *time, const a3ui32 controllerCount)
+{
+	if (value_out && cursor && curveSet && curveSet->data && time)
+	{
+		const a3_AnimationCurveTrack *track;
+		const a3real *control = curveSet->control;
+		a3ui32 segment[4], c, i, j;
+		a3real t[4];
+#ifdef A3_HIERARCHY_SIMD
+		__m128 c0, c1, c2, c3, tv, uv, tt, uu, three = _mm_set1_ps(a3real_three);
+#endif	// A3_HIERARCHY_SIMD
+
+		for (c = 0; c < controllerCount; ++c, ++time, value_out += curveSet->trackStride, cursor += curveSet->trackStride)
+			for (i = 0, track = curveSet->track; i < curveSet->trackCount; i += 4)
+			{
+				// locate segment per track; unused lanes read the zero segment
+				for (j = 0; j < 4; ++j)
+					if (i + j < curveSet->trackCount)
+					{
+						cursor[i + j] = a3animationCurveInternalSeek(curveSet, track, cursor[i + j], *time);
+						segment[j] = track->keyFirst + cursor[i + j];
+						t[j] = a3animationCurveInternalParam(curveSet, segment[j], *time);
+						++track;
+					}
+					else
+					{
+						segment[j] = curveSet->keyMax;
+						t[j] = a3real_zero;
+					}
+
+				// cubic Bezier in Bernstein form, four tracks per step
+#ifdef A3_HIERARCHY_SIMD
+				c0 = _mm_load_ps(control + segment[0] * 4);
+				c1 = _mm_load_ps(control + segment[1] * 4);
+				c2 = _mm_load_ps(control + segment[2] * 4);
+				c3 = _mm_load_ps(control + segment[3] * 4);
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				tv = _mm_loadu_ps(t);
+				uv = _mm_sub_ps(_mm_set1_ps(a3real_one), tv);
+				tt = _mm_mul_ps(tv, tv);
+				uu = _mm_mul_ps(uv, uv);
+				c0 = _mm_mul_ps(c0, _mm_mul_ps(uu, uv));
+				c1 = _mm_mul_ps(c1, _mm_mul_ps(three, _mm_mul_ps(uu, tv)));
+				c2 = _mm_mul_ps(c2, _mm_mul_ps(three, _mm_mul_ps(uv, tt)));
+				c3 = _mm_mul_ps(c3, _mm_mul_ps(tt, tv));
+				_mm_storeu_ps(value_out + i, _mm_add_ps(_mm_add_ps(c0, c1), _mm_add_ps(c2, c3)));
+#else	// !A3_HIERARCHY_SIMD
+				for (j = 0; j < 4; ++j)
+					value_out[i + j] = a3Bezier3(control[segment[j] * 4 + 0], control[segment[j] * 4 + 1], control[segment[j] * 4 + 2], control[segment[j] * 4 + 3], t[j]);
+#endif	// A3_HIERARCHY_SIMD
+			}
+		return curveSet->trackCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
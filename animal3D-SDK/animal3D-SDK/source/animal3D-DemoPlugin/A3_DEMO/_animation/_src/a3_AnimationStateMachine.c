@@ -0,0 +1,412 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationStateMachine.c
+	Implementation of animation state machine.
+*/
+
+#include "../a3_AnimationStateMachine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// condition bytecode: each term is a compare opcode, one operand byte 
+//	(parameter index or state time) and the value; 'or' closes a group 
+//	and 'end' closes the condition
+enum a3_AnimationConditionCode
+{
+	a3animationCode_end = a3animationCompare_or + 1,
+	a3animationCode_or = a3animationCompare_or,
+	a3animationCode_stateTime = 0xff,
+	a3animationCode_termSize = 2 + sizeof(a3real),
+};
+
+
+// crossfade weight for normalized time
+inline a3real a3animationStateMachineInternalCurve(const a3_AnimationTransitionCurve curve, const a3real t)
+{
+	switch (curve)
+	{
+	case a3animationCurve_smooth:
+		return (t * t * (a3real_three - a3real_two * t));
+	case a3animationCurve_easeIn:
+		return (t * t);
+	case a3animationCurve_easeOut:
+		return (t * (a3real_two - t));
+	default:
+		return t;
+	}
+}
+
+// fade weight of a crossfade entry; the bottom entry is always full
+inline a3real a3animationStateMachineInternalWeight(const a3_AnimationCrossfade *crossfade)
+{
+	const a3real t = crossfade->fadeTime * crossfade->fadeDurationInv;
+	return (crossfade->fadeDurationInv > a3real_zero && t < a3real_one) ? a3animationStateMachineInternalCurve(crossfade->curve, t) : a3real_one;
+}
+
+// normalized time in state: progress through clip in its playback 
+//	direction for clips, seconds for trees
+inline a3real a3animationStateMachineInternalStateTime(const a3_AnimationStateMachine *machine, const a3_AnimationCrossfade *crossfade)
+{
+	if (machine->state[crossfade->state].type == a3animationState_clip)
+		return (crossfade->controller.playback_direction < 0 ? a3real_one - crossfade->controller.clip_param : crossfade->controller.clip_param);
+	return crossfade->stateTime;
+}
+
+// push crossfade; when the stack is full the oldest entry is dropped
+inline void a3animationStateMachineInternalPush(a3_AnimationStateMachineInstance *instance, const a3ui32 state, const a3real duration, const a3_AnimationTransitionCurve curve)
+{
+	const a3_AnimationStateMachine *machine = instance->machine;
+	a3_AnimationCrossfade *crossfade;
+	if (instance->crossfadeCount == a3stateMachine_crossfadeMax)
+	{
+		memmove(instance->crossfade, instance->crossfade + 1, sizeof(a3_AnimationCrossfade) * (a3stateMachine_crossfadeMax - 1));
+		--instance->crossfadeCount;
+	}
+	crossfade = instance->crossfade + instance->crossfadeCount++;
+	crossfade->state = state;
+	crossfade->stateTime = a3real_zero;
+	crossfade->fadeTime = a3real_zero;
+	crossfade->fadeDurationInv = (instance->crossfadeCount > 1 && duration > a3real_zero) ? a3recip(duration) : a3real_zero;
+	crossfade->curve = curve;
+	if (machine->state[state].type == a3animationState_clip)
+	{
+		a3clipControllerSetClip(&crossfade->controller, machine->clipPool, machine->state[state].clipIndex);
+		crossfade->controller.playback_direction = 1;
+
+		// negative speed plays in reverse from the end of the last keyframe
+		if (machine->state[state].speed < a3real_zero)
+		{
+			const a3_Clip *clip = machine->clipPool->clip + machine->state[state].clipIndex;
+			crossfade->controller.playback_direction = -1;
+			crossfade->controller.keyframe = clip->last_keyframe;
+			crossfade->controller.keyframe_time = clip->keyframe_pool->keyframe[clip->last_keyframe].duration;
+			crossfade->controller.clip_time = clip->duration;
+			crossfade->controller.keyframe_param = crossfade->controller.clip_param = a3real_one;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create state machine
+a3i32 a3animationStateMachineCreate(a3_AnimationStateMachine *machine_out, const a3_ClipPool *clipPool, const a3ui32 stateMax, const a3ui32 transitionMax, const a3ui32 conditionMax)
+{
+	if (machine_out && !machine_out->data && stateMax)
+	{
+		const a3ui32 codeMax = conditionMax * a3animationCode_termSize + transitionMax;
+		const size_t dataSize = sizeof(a3_AnimationState) * stateMax + sizeof(a3_AnimationTransition) * transitionMax + codeMax;
+
+		machine_out->data = malloc(dataSize);
+		if (!machine_out->data)
+			return -1;
+		memset(machine_out->data, 0, dataSize);
+		machine_out->state = (a3_AnimationState *)machine_out->data;
+		machine_out->transition = (a3_AnimationTransition *)(machine_out->state + stateMax);
+		machine_out->code = (a3ubyte *)(machine_out->transition + transitionMax);
+		machine_out->stateMax = stateMax;
+		machine_out->transitionMax = transitionMax;
+		machine_out->codeMax = codeMax;
+		machine_out->stateCount = machine_out->transitionCount = machine_out->codeSize = machine_out->paramCount = 0;
+		machine_out->clipPool = clipPool;
+		return stateMax;
+	}
+	return -1;
+}
+
+// release state machine
+a3i32 a3animationStateMachineRelease(a3_AnimationStateMachine *machine)
+{
+	if (machine && machine->data)
+	{
+		free(machine->data);
+		machine->data = 0;
+		machine->state = 0;
+		machine->transition = 0;
+		machine->code = 0;
+		machine->stateCount = machine->transitionCount = machine->codeSize = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// add clip state
+a3i32 a3animationStateMachineAddClipState(a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax], const a3ui32 clipIndex, const a3real speed)
+{
+	if (machine && machine->data && machine->clipPool && machine->stateCount < machine->stateMax && clipIndex < machine->clipPool->count)
+	{
+		a3_AnimationState *state = machine->state + machine->stateCount;
+		strncpy(state->name, name ? name : "", a3keyframeAnimation_nameLenMax);
+		state->name[a3keyframeAnimation_nameLenMax - 1] = 0;
+		state->type = a3animationState_clip;
+		state->clipIndex = clipIndex;
+		state->tree = 0;
+		state->speed = speed;
+		return machine->stateCount++;
+	}
+	return -1;
+}
+
+// add blend tree state
+a3i32 a3animationStateMachineAddTreeState(a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax], const a3_HierarchyBlendTree *tree, const a3real speed)
+{
+	if (machine && machine->data && machine->stateCount < machine->stateMax && tree && tree->instruction && speed >= a3real_zero)
+	{
+		a3_AnimationState *state = machine->state + machine->stateCount;
+		strncpy(state->name, name ? name : "", a3keyframeAnimation_nameLenMax);
+		state->name[a3keyframeAnimation_nameLenMax - 1] = 0;
+		state->type = a3animationState_tree;
+		state->clipIndex = 0;
+		state->tree = tree;
+		state->speed = speed;
+		return machine->stateCount++;
+	}
+	return -1;
+}
+
+// add transition
+a3i32 a3animationStateMachineAddTransition(a3_AnimationStateMachine *machine, const a3i32 stateFrom, const a3ui32 stateTo, const a3real duration, const a3_AnimationTransitionCurve curve, const a3_AnimationCondition *condition, const a3ui32 conditionCount)
+{
+	if (machine && machine->data && machine->transitionCount < machine->transitionMax &&
+		stateTo < machine->stateCount && (stateFrom == a3stateMachine_anyState || (stateFrom >= 0 && (a3ui32)stateFrom < machine->stateCount)) &&
+		(condition || !conditionCount) && machine->codeSize + conditionCount * a3animationCode_termSize + 1 <= machine->codeMax)
+	{
+		a3_AnimationTransition *transition = machine->transition + machine->transitionCount;
+		a3ubyte *code = machine->code + machine->codeSize;
+		a3ui32 i;
+
+		// validate terms before emitting anything
+		for (i = 0; i < conditionCount; ++i)
+			if (condition[i].compare > a3animationCompare_or || (condition[i].compare != a3animationCompare_or &&
+				condition[i].paramIndex != a3stateMachine_stateTime && (condition[i].paramIndex < 0 || condition[i].paramIndex >= a3stateMachine_paramMax)))
+				return -1;
+
+		transition->stateFrom = stateFrom;
+		transition->stateTo = stateTo;
+		transition->duration = duration;
+		transition->curve = curve;
+		transition->code = machine->codeSize;
+		for (i = 0; i < conditionCount; ++i)
+		{
+			*(code++) = (a3ubyte)condition[i].compare;
+			if (condition[i].compare == a3animationCompare_or)
+				continue;
+			if (condition[i].paramIndex == a3stateMachine_stateTime)
+				*(code++) = a3animationCode_stateTime;
+			else
+			{
+				*(code++) = (a3ubyte)condition[i].paramIndex;
+				if (machine->paramCount <= (a3ui32)condition[i].paramIndex)
+					machine->paramCount = condition[i].paramIndex + 1;
+			}
+			memcpy(code, &condition[i].value, sizeof(a3real));
+			code += sizeof(a3real);
+		}
+		*(code++) = a3animationCode_end;
+		machine->codeSize = (a3ui32)(code - machine->code);
+		return machine->transitionCount++;
+	}
+	return -1;
+}
+
+// get state index by name
+a3i32 a3animationStateMachineGetStateIndex(const a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax])
+{
+	a3ui32 i;
+	if (machine && machine->data && name)
+	{
+		for (i = 0; i < machine->stateCount; ++i)
+			if (!strncmp(machine->state[i].name, name, a3keyframeAnimation_nameLenMax))
+				return i;
+	}
+	return -1;
+}
+
+// run compiled condition
+a3boolean a3animationStateMachineTestCondition(const a3_AnimationStateMachine *machine, const a3ui32 code, const a3real *param, const a3real stateTime)
+{
+	const a3ubyte *pc = machine->code + code;
+	a3boolean result = a3true;
+	a3real lhs, rhs;
+	a3ubyte op;
+
+	for (op = *(pc++); op != a3animationCode_end; op = *(pc++))
+	{
+		// group done: true if all its terms held, else start next group
+		if (op == a3animationCode_or)
+		{
+			if (result)
+				return a3true;
+			result = a3true;
+			continue;
+		}
+
+		// skip remaining terms of a failed group
+		if (result)
+		{
+			lhs = *pc == a3animationCode_stateTime ? stateTime : param[*pc];
+			memcpy(&rhs, pc + 1, sizeof(a3real));
+			switch (op)
+			{
+			case a3animationCompare_less:
+				result = lhs < rhs;
+				break;
+			case a3animationCompare_lessEqual:
+				result = lhs <= rhs;
+				break;
+			case a3animationCompare_greater:
+				result = lhs > rhs;
+				break;
+			case a3animationCompare_greaterEqual:
+				result = lhs >= rhs;
+				break;
+			case a3animationCompare_equal:
+				result = lhs == rhs;
+				break;
+			default:
+				result = lhs != rhs;
+				break;
+			}
+		}
+		pc += 1 + sizeof(a3real);
+	}
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// start character in state
+a3i32 a3animationStateMachineInstanceInit(a3_AnimationStateMachineInstance *instance_out, const a3_AnimationStateMachine *machine, const a3ui32 state)
+{
+	if (instance_out && machine && machine->data && state < machine->stateCount)
+	{
+		instance_out->machine = machine;
+		instance_out->crossfadeCount = 0;
+		a3animationStateMachineInternalPush(instance_out, state, a3real_zero, a3animationCurve_linear);
+		return 1;
+	}
+	return -1;
+}
+
+// force transition
+a3i32 a3animationStateMachineInstanceSetState(a3_AnimationStateMachineInstance *instance, const a3ui32 state, const a3real duration, const a3_AnimationTransitionCurve curve)
+{
+	if (instance && instance->machine && state < instance->machine->stateCount)
+	{
+		a3animationStateMachineInternalPush(instance, state, duration, curve);
+		return instance->crossfadeCount;
+	}
+	return -1;
+}
+
+// update character
+a3i32 a3animationStateMachineInstanceUpdate(a3_AnimationStateMachineInstance *instance, const a3real *param, const a3real dt)
+{
+	if (instance && instance->machine && instance->crossfadeCount && (param || !instance->machine->paramCount) && dt >= a3real_zero)
+	{
+		const a3_AnimationStateMachine *machine = instance->machine;
+		const a3_AnimationTransition *transition, *transitionEnd;
+		a3_AnimationCrossfade *crossfade, *current;
+		a3real stateDt;
+		a3ui32 i;
+
+		// advance every blending state
+		for (i = 0, crossfade = instance->crossfade; i < instance->crossfadeCount; ++i, ++crossfade)
+		{
+			stateDt = dt * a3absolute(machine->state[crossfade->state].speed);
+			crossfade->stateTime += stateDt;
+			crossfade->fadeTime += dt;
+			if (machine->state[crossfade->state].type == a3animationState_clip && stateDt > a3real_zero)
+				a3clipControllerUpdate(&crossfade->controller, stateDt);
+		}
+
+		// a completed fade hides everything under it
+		for (i = instance->crossfadeCount - 1; i > 0; --i)
+			if (a3animationStateMachineInternalWeight(instance->crossfade + i) >= a3real_one)
+			{
+				memmove(instance->crossfade, instance->crossfade + i, sizeof(a3_AnimationCrossfade) * (instance->crossfadeCount - i));
+				instance->crossfadeCount -= i;
+				instance->crossfade->fadeDurationInv = a3real_zero;
+				break;
+			}
+
+		// first transition out of the current state whose condition holds
+		current = instance->crossfade + instance->crossfadeCount - 1;
+		for (transition = machine->transition, transitionEnd = transition + machine->transitionCount; transition < transitionEnd; ++transition)
+			if ((transition->stateFrom == (a3i32)current->state || (transition->stateFrom == a3stateMachine_anyState && transition->stateTo != current->state)) &&
+				a3animationStateMachineTestCondition(machine, transition->code, param, a3animationStateMachineInternalStateTime(machine, current)))
+			{
+				a3animationStateMachineInternalPush(instance, transition->stateTo, transition->duration, transition->curve);
+				return 1;
+			}
+		return 0;
+	}
+	return -1;
+}
+
+// evaluate character's pose
+a3i32 a3animationStateMachineInstanceEvaluate(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *scratch, const a3_AnimationStateMachineInstance *instance, const a3_HierarchyPoseGroup *poseGroup, const a3_HierarchyBlendStack *stack_opt, const a3_HierarchyBlendSource *treeSource_opt, const a3real *treeParam_opt)
+{
+	if (pose_out && pose_out->data && scratch && scratch->data && pose_out != scratch && instance && instance->machine && instance->crossfadeCount && poseGroup)
+	{
+		const a3_AnimationStateMachine *machine = instance->machine;
+		const a3_AnimationCrossfade *crossfade;
+		const a3_AnimationState *state;
+		const a3_HierarchyPoseSoA *pose;
+		a3_HierarchyBlendSource source[1];
+		a3real w;
+		a3ui32 base, i;
+
+		// newest state whose fade is complete; older ones do not contribute
+		for (base = instance->crossfadeCount - 1; base > 0; --base)
+			if (a3animationStateMachineInternalWeight(instance->crossfade + base) >= a3real_one)
+				break;
+
+		for (i = base, crossfade = instance->crossfade + base; i < instance->crossfadeCount; ++i, ++crossfade)
+		{
+			state = machine->state + crossfade->state;
+			pose = i == base ? pose_out : scratch;
+			if (state->type == a3animationState_clip)
+			{
+				if (a3hierarchyBlendSourceSetClipController(source, poseGroup, &crossfade->controller) < 0 ||
+					a3hierarchyBlendSourceSample(pose, source) < 0)
+					return -1;
+			}
+			else if (a3hierarchyBlendTreeEvaluate(pose, state->tree, stack_opt, treeSource_opt, treeParam_opt) < 0)
+				return -1;
+			if (i > base)
+			{
+				w = a3animationStateMachineInternalWeight(crossfade);
+				a3hierarchyPoseSoALerp(pose_out, pose_out, scratch, w);
+			}
+		}
+		return (instance->crossfadeCount - base);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,462 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyPoseCompression.c
+	Implementation of quantized pose group storage.
+*/
+
+#include "../a3_HierarchyPoseCompression.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// quantization constants
+#define a3poseQuantMax15		32767
+#define a3poseQuantMax16		65535
+
+// smallest-three components lie within +/-sqrt(1/2)
+#define a3poseQuantOrientRange	a3real_sqrthalf
+
+// scale is considered constant within this tolerance (exporters round 
+//	bone scale factors to six decimal places)
+#define a3poseQuantScaleTolerance	((a3real)0.0001)
+
+
+// quantize value in [base, base + step * max]
+inline a3ui16 a3poseInternalQuantizeRange(const a3real value, const a3real base, const a3real step)
+{
+	a3real q;
+	if (step > a3real_zero)
+	{
+		q = (value - base) / step + a3real_half;
+		return (a3ui16)(q < a3real_zero ? 0 : q > (a3real)a3poseQuantMax16 ? a3poseQuantMax16 : q);
+	}
+	return 0;
+}
+
+// quantize smallest-three component with given bit range
+inline a3ui16 a3poseInternalQuantizeOrient(const a3real value, const a3ui32 maxQuant)
+{
+	const a3real q = (value + a3poseQuantOrientRange) * (a3real)maxQuant / (a3poseQuantOrientRange + a3poseQuantOrientRange) + a3real_half;
+	return (a3ui16)(q < a3real_zero ? 0 : q > (a3real)maxQuant ? maxQuant : q);
+}
+
+// encode unit quaternion as smallest-three in three words
+inline void a3poseInternalEncodeOrient(a3ui16 *w0, a3ui16 *w1, a3ui16 *w2, const a3real *q)
+{
+	a3real v[4], s[3], lenSq;
+	a3ui32 k = 0, i, j;
+
+	// normalize and find largest magnitude component
+	lenSq = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+	lenSq = lenSq > a3real_zero ? a3recip(a3sqrt(lenSq)) : a3real_zero;
+	for (i = 0; i < 4; ++i)
+	{
+		v[i] = q[i] * lenSq;
+		if (a3absolute(v[i]) > a3absolute(v[k]))
+			k = i;
+	}
+
+	// q and -q are the same rotation: keep largest positive so it can 
+	//	be reconstructed from the others
+	if (v[k] < a3real_zero)
+		for (i = 0; i < 4; ++i)
+			v[i] = -v[i];
+	for (i = j = 0; i < 4; ++i)
+		if (i != k)
+			s[j++] = v[i];
+
+	*w0 = a3poseInternalQuantizeOrient(s[0], a3poseQuantMax15) | (a3ui16)((k & 1) << 15);
+	*w1 = a3poseInternalQuantizeOrient(s[1], a3poseQuantMax15) | (a3ui16)((k >> 1) << 15);
+	*w2 = a3poseInternalQuantizeOrient(s[2], a3poseQuantMax16);
+}
+
+// decode smallest-three words into quaternion streams (scalar)
+inline void a3poseInternalDecodeOrient(a3real *x, a3real *y, a3real *z, a3real *w, const a3ui16 w0, const a3ui16 w1, const a3ui16 w2)
+{
+	const a3real scale15 = (a3poseQuantOrientRange + a3poseQuantOrientRange) / (a3real)a3poseQuantMax15;
+	const a3real scale16 = (a3poseQuantOrientRange + a3poseQuantOrientRange) / (a3real)a3poseQuantMax16;
+	const a3ui32 k = (w0 >> 15) | ((w1 >> 15) << 1);
+	const a3real a = (a3real)(w0 & 0x7fff) * scale15 - a3poseQuantOrientRange;
+	const a3real b = (a3real)(w1 & 0x7fff) * scale15 - a3poseQuantOrientRange;
+	const a3real c = (a3real)(w2) * scale16 - a3poseQuantOrientRange;
+	a3real l = a3real_one - a * a - b * b - c * c;
+	l = l > a3real_zero ? a3sqrt(l) : a3real_zero;
+	*x = k == 0 ? l : a;
+	*y = k == 0 ? a : k == 1 ? l : b;
+	*z = k <= 1 ? b : k == 2 ? l : c;
+	*w = k == 3 ? l : c;
+}
+
+
+#ifdef A3_HIERARCHY_SIMD
+// load four 16-bit values as 32-bit integers
+#define a3poseLoadU16x4(src, zero)	_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(src)), zero)
+
+// select: mask ? a : b
+#define a3poseSelect(mask, a, b)	_mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+#endif	// A3_HIERARCHY_SIMD
+
+
+//-----------------------------------------------------------------------------
+
+// compress pose group
+a3i32 a3hierarchyPoseGroupCompress(a3_HierarchyPoseGroupCompressed *compressed_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 *rangeFirstPose, const a3ui32 rangeCount)
+{
+	if (compressed_out && !compressed_out->hierarchy && poseGroup && poseGroup->hierarchy && poseGroup->hposeCount &&
+		(!rangeFirstPose || (rangeCount && rangeFirstPose[0] == 0)))
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		const a3ui32 nodeStride = (nodeCount + a3poseSoA_nodeAlign - 1) / a3poseSoA_nodeAlign * a3poseSoA_nodeAlign;
+		const a3ui32 poseCount = poseGroup->hposeCount;
+		const a3ui32 ranges = rangeFirstPose ? rangeCount : 1;
+		const a3ui32 poseStreamSize = poseCount * 3 * nodeStride;
+		const a3ui32 rangeTableSize = ranges * 3 * nodeStride;
+		a3ui32 realCount, u16Count, dataSize;
+		a3boolean scaleElided = 1;
+		const a3_SpatialPose *spatialPose, *spatialPose0;
+		a3real *base, *step, vMin, vMax, value;
+		a3ui16 *q;
+		a3byte *ptr;
+		a3ui32 r, p, p0, p1, i, j;
+
+		// validate ranges
+		for (r = 1; rangeFirstPose && r < ranges; ++r)
+			if (rangeFirstPose[r] <= rangeFirstPose[r - 1] || rangeFirstPose[r] >= poseCount)
+				return -1;
+
+		// scale is elided if every pose matches the first for every node
+		for (p = 1; scaleElided && p < poseCount; ++p)
+			for (i = 0, spatialPose = poseGroup->hpose[p].spatialPose, spatialPose0 = poseGroup->hpose[0].spatialPose; 
+				scaleElided && i < nodeCount; ++i, ++spatialPose, ++spatialPose0)
+				scaleElided = (a3absolute(spatialPose->scale.x - spatialPose0->scale.x) <= a3poseQuantScaleTolerance &&
+					a3absolute(spatialPose->scale.y - spatialPose0->scale.y) <= a3poseQuantScaleTolerance &&
+					a3absolute(spatialPose->scale.z - spatialPose0->scale.z) <= a3poseQuantScaleTolerance);
+
+		// determine memory requirements: real tables first (alignment), 
+		//	then quantized streams, then range indices
+		realCount = rangeTableSize * 2 + (scaleElided ? 3 * nodeStride : rangeTableSize * 2);
+		u16Count = poseStreamSize * (scaleElided ? 2 : 3);
+		dataSize = realCount * sizeof(a3real) + u16Count * sizeof(a3ui16) + poseCount * sizeof(a3ui32);
+
+		// allocate everything (one malloc)
+		compressed_out->data = malloc(dataSize + 16);
+		if (!compressed_out->data)
+			return -1;
+		memset(compressed_out->data, 0, dataSize + 16);
+		ptr = (a3byte *)(((size_t)compressed_out->data + 15) & ~(size_t)15);
+
+		// set pointers
+		compressed_out->translationBase = (a3real *)ptr;
+		compressed_out->translationStep = compressed_out->translationBase + rangeTableSize;
+		if (scaleElided)
+		{
+			compressed_out->scaleConstant = compressed_out->translationStep + rangeTableSize;
+			compressed_out->scaleBase = compressed_out->scaleStep = 0;
+		}
+		else
+		{
+			compressed_out->scaleBase = compressed_out->translationStep + rangeTableSize;
+			compressed_out->scaleStep = compressed_out->scaleBase + rangeTableSize;
+			compressed_out->scaleConstant = 0;
+		}
+		compressed_out->orientation = (a3ui16 *)(ptr + realCount * sizeof(a3real));
+		compressed_out->translation = compressed_out->orientation + poseStreamSize;
+		compressed_out->scale = scaleElided ? 0 : compressed_out->translation + poseStreamSize;
+		compressed_out->poseRange = (a3ui32 *)(compressed_out->orientation + u16Count);
+		compressed_out->hierarchy = poseGroup->hierarchy;
+		compressed_out->hposeCount = poseCount;
+		compressed_out->nodeCount = nodeCount;
+		compressed_out->nodeStride = nodeStride;
+		compressed_out->rangeCount = ranges;
+		compressed_out->scaleElided = scaleElided;
+		compressed_out->dataSize = dataSize;
+
+		// constant scale (padding lanes decode to unit scale)
+		if (scaleElided)
+			for (j = 0; j < 3; ++j)
+				for (i = 0; i < nodeStride; ++i)
+					compressed_out->scaleConstant[j * nodeStride + i] = i < nodeCount ? poseGroup->hpose[0].spatialPose[i].scale.v[j] : a3real_one;
+
+		// per-range tables and quantized streams
+		for (r = 0; r < ranges; ++r)
+		{
+			p0 = rangeFirstPose ? rangeFirstPose[r] : 0;
+			p1 = (rangeFirstPose && r + 1 < ranges) ? rangeFirstPose[r + 1] : poseCount;
+			for (p = p0; p < p1; ++p)
+				compressed_out->poseRange[p] = r;
+
+			for (j = 0; j < 3; ++j)
+			{
+				for (i = 0; i < nodeStride; ++i)
+				{
+					// translation bounds
+					base = compressed_out->translationBase + (r * 3 + j) * nodeStride + i;
+					step = compressed_out->translationStep + (r * 3 + j) * nodeStride + i;
+					if (i < nodeCount)
+					{
+						vMin = vMax = poseGroup->hpose[p0].spatialPose[i].translation.v[j];
+						for (p = p0 + 1; p < p1; ++p)
+						{
+							value = poseGroup->hpose[p].spatialPose[i].translation.v[j];
+							vMin = a3minimum(vMin, value);
+							vMax = a3maximum(vMax, value);
+						}
+						*base = vMin;
+						*step = (vMax - vMin) / (a3real)a3poseQuantMax16;
+						for (p = p0; p < p1; ++p)
+							compressed_out->translation[(p * 3 + j) * nodeStride + i] = a3poseInternalQuantizeRange(poseGroup->hpose[p].spatialPose[i].translation.v[j], *base, *step);
+					}
+
+					// scale bounds
+					if (!scaleElided)
+					{
+						base = compressed_out->scaleBase + (r * 3 + j) * nodeStride + i;
+						step = compressed_out->scaleStep + (r * 3 + j) * nodeStride + i;
+						if (i < nodeCount)
+						{
+							vMin = vMax = poseGroup->hpose[p0].spatialPose[i].scale.v[j];
+							for (p = p0 + 1; p < p1; ++p)
+							{
+								value = poseGroup->hpose[p].spatialPose[i].scale.v[j];
+								vMin = a3minimum(vMin, value);
+								vMax = a3maximum(vMax, value);
+							}
+							*base = vMin;
+							*step = (vMax - vMin) / (a3real)a3poseQuantMax16;
+							for (p = p0; p < p1; ++p)
+								compressed_out->scale[(p * 3 + j) * nodeStride + i] = a3poseInternalQuantizeRange(poseGroup->hpose[p].spatialPose[i].scale.v[j], *base, *step);
+						}
+						else
+							*base = a3real_one;
+					}
+				}
+			}
+		}
+
+		// orientations (padding lanes encode identity)
+		for (p = 0; p < poseCount; ++p)
+		{
+			q = compressed_out->orientation + p * 3 * nodeStride;
+			for (i = 0; i < nodeStride; ++i)
+			{
+				if (i < nodeCount)
+					a3poseInternalEncodeOrient(q + i, q + nodeStride + i, q + nodeStride * 2 + i, poseGroup->hpose[p].spatialPose[i].orientation.v);
+				else
+					a3poseInternalEncodeOrient(q + i, q + nodeStride + i, q + nodeStride * 2 + i, a3vec4_w.v);
+			}
+		}
+
+		// done
+		return poseCount;
+	}
+	return -1;
+}
+
+// release compressed pose group
+a3i32 a3hierarchyPoseGroupCompressedRelease(a3_HierarchyPoseGroupCompressed *compressed)
+{
+	if (compressed && compressed->hierarchy)
+	{
+		free(compressed->data);
+		memset(compressed, 0, sizeof(a3_HierarchyPoseGroupCompressed));
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// decompress single pose directly into structure-of-arrays pose
+a3i32 a3hierarchyPoseGroupCompressedDecode(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseGroupCompressed *compressed, const a3ui32 poseIndex)
+{
+	if (pose_out && pose_out->data && compressed && compressed->hierarchy &&
+		pose_out->nodeStride == compressed->nodeStride && poseIndex < compressed->hposeCount)
+	{
+		const a3ui32 nodeStride = compressed->nodeStride;
+		const a3ui32 range = compressed->poseRange[poseIndex];
+		const a3ui16 *orientation = compressed->orientation + poseIndex * 3 * nodeStride;
+		const a3ui16 *translation = compressed->translation + poseIndex * 3 * nodeStride;
+		const a3ui16 *scale = compressed->scale ? compressed->scale + poseIndex * 3 * nodeStride : 0;
+		const a3real *translationBase = compressed->translationBase + range * 3 * nodeStride;
+		const a3real *translationStep = compressed->translationStep + range * 3 * nodeStride;
+		const a3real *scaleBase = scale ? compressed->scaleBase + range * 3 * nodeStride : 0;
+		const a3real *scaleStep = scale ? compressed->scaleStep + range * 3 * nodeStride : 0;
+		a3ui32 i, j;
+
+#ifdef A3_HIERARCHY_SIMD
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask15 = _mm_set1_epi32(0x7fff);
+		const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2), three = _mm_set1_epi32(3);
+		const __m128 scale15 = _mm_set1_ps((a3poseQuantOrientRange + a3poseQuantOrientRange) / (a3real)a3poseQuantMax15);
+		const __m128 scale16 = _mm_set1_ps((a3poseQuantOrientRange + a3poseQuantOrientRange) / (a3real)a3poseQuantMax16);
+		const __m128 bias = _mm_set1_ps(-a3poseQuantOrientRange);
+		const __m128 unit = _mm_set1_ps(a3real_one);
+		__m128i v0, v1, v2, k;
+		__m128 a, b, c, l, m0, m1, m2, m3;
+
+		// orientation: four nodes per step
+		for (i = 0; i < nodeStride; i += 4)
+		{
+			v0 = a3poseLoadU16x4(orientation + i, zero);
+			v1 = a3poseLoadU16x4(orientation + nodeStride + i, zero);
+			v2 = a3poseLoadU16x4(orientation + nodeStride * 2 + i, zero);
+			k = _mm_or_si128(_mm_srli_epi32(v0, 15), _mm_slli_epi32(_mm_srli_epi32(v1, 15), 1));
+			a = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(v0, mask15)), scale15), bias);
+			b = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(v1, mask15)), scale15), bias);
+			c = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v2), scale16), bias);
+			l = _mm_sub_ps(unit, _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_mul_ps(c, c)));
+			l = _mm_sqrt_ps(_mm_max_ps(l, _mm_setzero_ps()));
+			m0 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, zero));
+			m1 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, one));
+			m2 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, two));
+			m3 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, three));
+			_mm_store_ps(pose_out->orientation[0] + i, a3poseSelect(m0, l, a));
+			_mm_store_ps(pose_out->orientation[1] + i, a3poseSelect(m0, a, a3poseSelect(m1, l, b)));
+			_mm_store_ps(pose_out->orientation[2] + i, a3poseSelect(_mm_or_ps(m0, m1), b, a3poseSelect(m2, l, c)));
+			_mm_store_ps(pose_out->orientation[3] + i, a3poseSelect(m3, l, c));
+		}
+
+		// translation and scale: base + quantized * step
+		for (j = 0; j < 3; ++j)
+		{
+			for (i = 0; i < nodeStride; i += 4)
+			{
+				v0 = a3poseLoadU16x4(translation + j * nodeStride + i, zero);
+				_mm_store_ps(pose_out->translation[j] + i, _mm_add_ps(_mm_load_ps(translationBase + j * nodeStride + i),
+					_mm_mul_ps(_mm_cvtepi32_ps(v0), _mm_load_ps(translationStep + j * nodeStride + i))));
+			}
+			if (scale)
+			{
+				for (i = 0; i < nodeStride; i += 4)
+				{
+					v0 = a3poseLoadU16x4(scale + j * nodeStride + i, zero);
+					_mm_store_ps(pose_out->scale[j] + i, _mm_add_ps(_mm_load_ps(scaleBase + j * nodeStride + i),
+						_mm_mul_ps(_mm_cvtepi32_ps(v0), _mm_load_ps(scaleStep + j * nodeStride + i))));
+				}
+			}
+			else
+				memcpy(pose_out->scale[j], compressed->scaleConstant + j * nodeStride, nodeStride * sizeof(a3real));
+		}
+#else	// !A3_HIERARCHY_SIMD
+		for (i = 0; i < nodeStride; ++i)
+			a3poseInternalDecodeOrient(pose_out->orientation[0] + i, pose_out->orientation[1] + i, pose_out->orientation[2] + i, pose_out->orientation[3] + i,
+				orientation[i], orientation[nodeStride + i], orientation[nodeStride * 2 + i]);
+		for (j = 0; j < 3; ++j)
+		{
+			for (i = 0; i < nodeStride; ++i)
+				pose_out->translation[j][i] = translationBase[j * nodeStride + i] + (a3real)translation[j * nodeStride + i] * translationStep[j * nodeStride + i];
+			if (scale)
+				for (i = 0; i < nodeStride; ++i)
+					pose_out->scale[j][i] = scaleBase[j * nodeStride + i] + (a3real)scale[j * nodeStride + i] * scaleStep[j * nodeStride + i];
+			else
+				memcpy(pose_out->scale[j], compressed->scaleConstant + j * nodeStride, nodeStride * sizeof(a3real));
+		}
+#endif	// A3_HIERARCHY_SIMD
+
+		// done
+		return compressed->nodeCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// decode every pose and compare against source
+a3i32 a3hierarchyPoseGroupCompressedReport(a3_HierarchyPoseCompressionReport *report_out, const a3_HierarchyPoseGroupCompressed *compressed, const a3_HierarchyPoseGroup *poseGroup)
+{
+	if (report_out && compressed && compressed->hierarchy && poseGroup && poseGroup->hierarchy == compressed->hierarchy &&
+		poseGroup->hposeCount == compressed->hposeCount)
+	{
+		a3_HierarchyPoseSoA pose[1] = { 0 };
+		const a3_SpatialPose *spatialPose;
+		a3real d, e, dx, dy, dz;
+		a3ui32 p, i, j;
+
+		if (a3hierarchyPoseSoACreate(pose, compressed->nodeCount) < 0)
+			return -1;
+
+		report_out->sourceSize = compressed->hposeCount * compressed->nodeCount * 10 * sizeof(a3real);
+		report_out->compressedSize = compressed->dataSize;
+		report_out->ratio = (a3real)report_out->sourceSize / (a3real)report_out->compressedSize;
+		report_out->orientationErrorMax = report_out->translationErrorMax = report_out->scaleErrorMax = a3real_zero;
+
+		for (p = 0; p < compressed->hposeCount; ++p)
+		{
+			a3hierarchyPoseGroupCompressedDecode(pose, compressed, p);
+			for (i = 0, spatialPose = poseGroup->hpose[p].spatialPose; i < compressed->nodeCount; ++i, ++spatialPose)
+			{
+				// angle between rotations: 4 asin(|q0 - q1| / 2) with q1 on the 
+				//	same hemisphere; stays precise for tiny angles unlike acos
+				d = spatialPose->orientation.x * pose->orientation[0][i] + spatialPose->orientation.y * pose->orientation[1][i] +
+					spatialPose->orientation.z * pose->orientation[2][i] + spatialPose->orientation.w * pose->orientation[3][i];
+				d = d < a3real_zero ? -a3real_one : a3real_one;
+				for (j = 0, e = a3real_zero; j < 4; ++j)
+				{
+					dx = spatialPose->orientation.v[j] - d * pose->orientation[j][i];
+					e += dx * dx;
+				}
+				e = a3asind(a3minimum(a3sqrt(e) * a3real_half, a3real_one)) * a3real_four;
+				report_out->orientationErrorMax = a3maximum(report_out->orientationErrorMax, e);
+
+				// distance between translations
+				dx = spatialPose->translation.x - pose->translation[0][i];
+				dy = spatialPose->translation.y - pose->translation[1][i];
+				dz = spatialPose->translation.z - pose->translation[2][i];
+				e = a3sqrt(dx * dx + dy * dy + dz * dz);
+				report_out->translationErrorMax = a3maximum(report_out->translationErrorMax, e);
+
+				// largest scale component difference
+				for (j = 0; j < 3; ++j)
+				{
+					e = a3absolute(spatialPose->scale.v[j] - pose->scale[j][i]);
+					report_out->scaleErrorMax = a3maximum(report_out->scaleErrorMax, e);
+				}
+			}
+		}
+
+		a3hierarchyPoseSoARelease(pose);
+		return compressed->hposeCount;
+	}
+	return -1;
+}
+
+// print report to console
+a3i32 a3hierarchyPoseGroupCompressedPrintReport(const a3_HierarchyPoseCompressionReport *report, const a3byte *label)
+{
+	if (report)
+	{
+		printf("\n A3 pose compression (%s): %u -> %u bytes (%.2f:1); max error: %.4f deg, %.4f units, %.6f scale",
+			label ? label : "", report->sourceSize, report->compressedSize, (a3f64)report->ratio,
+			(a3f64)report->orientationErrorMax, (a3f64)report->translationErrorMax, (a3f64)report->scaleErrorMax);
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
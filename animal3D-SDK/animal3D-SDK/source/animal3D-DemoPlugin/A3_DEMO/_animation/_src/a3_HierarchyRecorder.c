@@ -0,0 +1,402 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyRecorder.c
+	Implementation of hierarchy state capture and playback.
+*/
+
+#include "../a3_HierarchyRecorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// platform primitives: ring counters are published with release stores 
+//	and read with acquire loads, so a frame's contents are visible before 
+//	its counter; writer sleeps on an event that each capture signals
+#ifdef _WIN32
+#include <Windows.h>
+#define a3hierarchyRecorderInternalPublish(counter, value)	InterlockedExchange((volatile LONG *)&(counter), (LONG)(value))
+#define a3hierarchyRecorderInternalAcquire(counter)			((a3ui32)InterlockedCompareExchange((volatile LONG *)&(counter), 0, 0))
+inline void *a3hierarchyRecorderInternalWakeCreate()
+{
+	return CreateEventA(0, FALSE, FALSE, 0);
+}
+inline void a3hierarchyRecorderInternalWakeRelease(void *wake)
+{
+	CloseHandle((HANDLE)wake);
+}
+inline void a3hierarchyRecorderInternalWait(void *wake)
+{
+	WaitForSingleObject((HANDLE)wake, INFINITE);
+}
+inline void a3hierarchyRecorderInternalSignal(void *wake)
+{
+	SetEvent((HANDLE)wake);
+}
+#else	// !_WIN32
+#include <semaphore.h>
+#define a3hierarchyRecorderInternalPublish(counter, value)	__atomic_store_n(&(counter), (value), __ATOMIC_RELEASE)
+#define a3hierarchyRecorderInternalAcquire(counter)			__atomic_load_n(&(counter), __ATOMIC_ACQUIRE)
+inline void *a3hierarchyRecorderInternalWakeCreate()
+{
+	sem_t *wake = (sem_t *)malloc(sizeof(sem_t));
+	if (wake && sem_init(wake, 0, 0))
+	{
+		free(wake);
+		wake = 0;
+	}
+	return wake;
+}
+inline void a3hierarchyRecorderInternalWakeRelease(void *wake)
+{
+	sem_destroy((sem_t *)wake);
+	free(wake);
+}
+inline void a3hierarchyRecorderInternalWait(void *wake)
+{
+	while (sem_wait((sem_t *)wake));
+}
+inline void a3hierarchyRecorderInternalSignal(void *wake)
+{
+	sem_post((sem_t *)wake);
+}
+#endif	// _WIN32
+
+
+//-----------------------------------------------------------------------------
+
+// file header: magic, version, node count, words per frame
+// each frame record: frame number, byte count of the rest, 2-bit codes 
+//	(four words per byte), then the low bytes of each changed word
+
+// bytes of codes for word count
+inline a3ui32 a3hierarchyRecordingInternalCodeSize(const a3ui32 wordCount)
+{
+	return ((wordCount + 3) / 4);
+}
+
+// write file header
+a3ret a3hierarchyRecordingInternalWriteHeader(const a3ui32 *header, const a3_FileStream *fileStream)
+{
+	FILE *fp = fileStream->stream;
+	return fp ? (a3ret)fwrite(header, 1, sizeof(a3ui32) * 4, fp) : -1;
+}
+
+// write recorder's encoded frame
+a3ret a3hierarchyRecorderInternalWriteRecord(const a3_HierarchyRecorder *recorder, const a3_FileStream *fileStream)
+{
+	FILE *fp = fileStream->stream;
+	return fp ? (a3ret)fwrite(recorder->record, 1, recorder->recordSize, fp) : -1;
+}
+
+// encode ring slot against previous frame, which it then replaces
+inline void a3hierarchyRecorderInternalEncode(a3_HierarchyRecorder *recorder, const a3ui32 slot)
+{
+	const a3ui32 wordCount = recorder->wordCount, codeSize = a3hierarchyRecordingInternalCodeSize(wordCount);
+	const a3ui32 *word = (const a3ui32 *)(recorder->ring + slot * recorder->hierarchy->numNodes);
+	a3ui32 *previous = recorder->previous;
+	a3ubyte *code = recorder->record + sizeof(a3ui32) * 2, *payload = code + codeSize;
+	a3ui32 i, x, n, b;
+	memset(code, 0, codeSize);
+	for (i = 0; i < wordCount; ++i)
+	{
+		x = word[i] ^ previous[i];
+		previous[i] = word[i];
+		if (x)
+		{
+			n = (x >> 24) ? 4 : (x >> 16) ? 3 : 2;
+			code[i >> 2] |= (a3ubyte)((n - 1) << ((i & 3) * 2));
+			for (b = 0; b < n; ++b)
+				*(payload++) = (a3ubyte)(x >> (b * 8));
+		}
+	}
+	recorder->recordSize = (a3ui32)(payload - recorder->record);
+	((a3ui32 *)recorder->record)[0] = recorder->ringFrame[slot];
+	((a3ui32 *)recorder->record)[1] = recorder->recordSize - sizeof(a3ui32) * 2;
+}
+
+// encode and write every waiting frame
+inline void a3hierarchyRecorderInternalDrain(a3_HierarchyRecorder *recorder)
+{
+	a3ui32 consumed = recorder->consumed;
+	a3i32 bytes;
+	while (consumed != a3hierarchyRecorderInternalAcquire(recorder->produced))
+	{
+		a3hierarchyRecorderInternalEncode(recorder, consumed % recorder->ringCapacity);
+		bytes = a3fileStreamWriteObject(recorder->fileStream, recorder, (a3_FileStreamWriteFunc)a3hierarchyRecorderInternalWriteRecord);
+		if (bytes > 0)
+		{
+			recorder->bytesWritten += bytes;
+			++recorder->framesWritten;
+		}
+		a3hierarchyRecorderInternalPublish(recorder->consumed, ++consumed);
+	}
+}
+
+// writer thread: sleep until signalled, drain; stop is read before 
+//	draining so frames captured before release are written
+a3ret a3hierarchyRecorderInternalWriter(a3_HierarchyRecorder *recorder)
+{
+	a3boolean stop;
+	do
+	{
+		a3hierarchyRecorderInternalWait(recorder->wake);
+		stop = a3hierarchyRecorderInternalAcquire(recorder->stop);
+		a3hierarchyRecorderInternalDrain(recorder);
+	} while (!stop);
+	return recorder->framesWritten;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create recorder
+a3i32 a3hierarchyRecorderCreate(a3_HierarchyRecorder *recorder_out, const a3_Hierarchy *hierarchy, const a3ui32 ringCapacity, const a3byte *filePath)
+{
+	if (recorder_out && !recorder_out->data && hierarchy && hierarchy->nodes && ringCapacity && filePath && *filePath)
+	{
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		const a3ui32 wordCount = nodeCount * sizeof(a3_SpatialPose) / sizeof(a3ui32);
+		a3ui32 header[4];
+		size_t dataSize;
+
+		// ring, ring frame numbers, previous frame, largest record
+		dataSize = sizeof(a3_SpatialPose) * nodeCount * ringCapacity + sizeof(a3ui32) * (ringCapacity + wordCount) +
+			sizeof(a3ui32) * (2 + wordCount) + a3hierarchyRecordingInternalCodeSize(wordCount);
+		recorder_out->data = malloc(dataSize);
+		if (!recorder_out->data)
+			return -1;
+		memset(recorder_out->data, 0, dataSize);
+		memset(recorder_out->fileStream, 0, sizeof(a3_FileStream));
+		if (a3fileStreamOpenWrite(recorder_out->fileStream, filePath) <= 0)
+		{
+			free(recorder_out->data);
+			recorder_out->data = 0;
+			return -1;
+		}
+		recorder_out->ring = (a3_SpatialPose *)recorder_out->data;
+		recorder_out->ringFrame = (a3ui32 *)(recorder_out->ring + nodeCount * ringCapacity);
+		recorder_out->previous = recorder_out->ringFrame + ringCapacity;
+		recorder_out->record = (a3ubyte *)(recorder_out->previous + wordCount);
+		recorder_out->hierarchy = hierarchy;
+		recorder_out->wordCount = wordCount;
+		recorder_out->ringCapacity = ringCapacity;
+		recorder_out->produced = recorder_out->consumed = 0;
+		recorder_out->frameCount = recorder_out->droppedCount = 0;
+		recorder_out->recordSize = recorder_out->bytesWritten = recorder_out->framesWritten = 0;
+		recorder_out->stop = a3false;
+
+		header[0] = a3hierarchyRecording_magic;
+		header[1] = a3hierarchyRecording_version;
+		header[2] = nodeCount;
+		header[3] = wordCount;
+		recorder_out->bytesWritten = a3fileStreamWriteObject(recorder_out->fileStream, header, (a3_FileStreamWriteFunc)a3hierarchyRecordingInternalWriteHeader);
+
+		// without a writer thread, frames are written as they are captured
+		memset(recorder_out->thread, 0, sizeof(a3_Thread));
+		recorder_out->wake = a3hierarchyRecorderInternalWakeCreate();
+		recorder_out->launched = recorder_out->wake &&
+			(a3threadLaunch(recorder_out->thread, (a3_threadfunc)a3hierarchyRecorderInternalWriter, recorder_out, 0) > 0);
+		return ringCapacity;
+	}
+	return -1;
+}
+
+// release recorder
+a3i32 a3hierarchyRecorderRelease(a3_HierarchyRecorder *recorder)
+{
+	if (recorder && recorder->data)
+	{
+		a3hierarchyRecorderInternalPublish(recorder->stop, a3true);
+		if (recorder->launched)
+		{
+			a3hierarchyRecorderInternalSignal(recorder->wake);
+			a3threadWait(recorder->thread);
+		}
+		else
+			a3hierarchyRecorderInternalDrain(recorder);
+		if (recorder->wake)
+			a3hierarchyRecorderInternalWakeRelease(recorder->wake);
+		recorder->wake = 0;
+		recorder->launched = a3false;
+		a3fileStreamClose(recorder->fileStream);
+		free(recorder->data);
+		recorder->data = 0;
+		recorder->ring = 0;
+		recorder->ringFrame = recorder->previous = 0;
+		recorder->record = 0;
+		recorder->hierarchy = 0;
+		return recorder->framesWritten;
+	}
+	return -1;
+}
+
+// capture state
+a3i32 a3hierarchyRecorderCapture(a3_HierarchyRecorder *recorder, const a3_HierarchyState *state)
+{
+	if (recorder && recorder->data && state && state->poseGroup && state->poseGroup->hierarchy == recorder->hierarchy)
+	{
+		const a3ui32 produced = recorder->produced, slot = produced % recorder->ringCapacity;
+		const a3ui32 nodeCount = recorder->hierarchy->numNodes;
+
+		// full: drop rather than stall
+		if (produced - a3hierarchyRecorderInternalAcquire(recorder->consumed) >= recorder->ringCapacity)
+		{
+			++recorder->frameCount;
+			++recorder->droppedCount;
+			return 0;
+		}
+		memcpy(recorder->ring + slot * nodeCount, state->localHPose->spatialPose, sizeof(a3_SpatialPose) * nodeCount);
+		recorder->ringFrame[slot] = recorder->frameCount++;
+		a3hierarchyRecorderInternalPublish(recorder->produced, produced + 1);
+		if (recorder->launched)
+			a3hierarchyRecorderInternalSignal(recorder->wake);
+		else
+			a3hierarchyRecorderInternalDrain(recorder);
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// load capture file
+a3i32 a3hierarchyPlayerLoad(a3_HierarchyPlayer *player_out, const a3_Hierarchy *hierarchy, const a3byte *filePath)
+{
+	if (player_out && !player_out->data && hierarchy && hierarchy->nodes && filePath && *filePath)
+	{
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		const a3ui32 wordCount = nodeCount * sizeof(a3_SpatialPose) / sizeof(a3ui32);
+		const a3ui32 codeSize = a3hierarchyRecordingInternalCodeSize(wordCount);
+		a3_FileStream fileStream[1] = { 0 };
+		FILE *fp;
+		const a3ui32 *previous;
+		a3ui32 *word;
+		a3ubyte *record, *payload;
+		a3ui32 header[4], frameCount, i, n, b, x;
+		long start;
+		size_t dataSize;
+
+		if (a3fileStreamOpenRead(fileStream, filePath) <= 0)
+			return -1;
+		fp = fileStream->stream;
+
+		// validate header, then count frames and check record sizes
+		if (fread(header, sizeof(a3ui32), 4, fp) != 4 || header[0] != a3hierarchyRecording_magic ||
+			header[1] != a3hierarchyRecording_version || header[2] != nodeCount || header[3] != wordCount)
+		{
+			a3fileStreamClose(fileStream);
+			return -1;
+		}
+		start = ftell(fp);
+		for (frameCount = 0; fread(header, sizeof(a3ui32), 2, fp) == 2; ++frameCount)
+			if (header[1] < codeSize || header[1] > codeSize + wordCount * 4 || fseek(fp, header[1], SEEK_CUR))
+			{
+				a3fileStreamClose(fileStream);
+				return -1;
+			}
+
+		// frames, frame numbers, largest record
+		dataSize = sizeof(a3_SpatialPose) * nodeCount * frameCount + sizeof(a3ui32) * frameCount + codeSize + wordCount * 4;
+		player_out->data = malloc(dataSize);
+		if (!player_out->data)
+		{
+			a3fileStreamClose(fileStream);
+			return -1;
+		}
+		player_out->frame = (a3_SpatialPose *)player_out->data;
+		player_out->frameNumber = (a3ui32 *)(player_out->frame + nodeCount * frameCount);
+		record = (a3ubyte *)(player_out->frameNumber + frameCount);
+
+		// decode: each word is the previous frame's word XOR stored bytes
+		fseek(fp, start, SEEK_SET);
+		for (player_out->frameCount = 0; player_out->frameCount < frameCount; ++player_out->frameCount)
+		{
+			if (fread(header, sizeof(a3ui32), 2, fp) != 2 || fread(record, 1, header[1], fp) != header[1])
+				break;
+			word = (a3ui32 *)(player_out->frame + nodeCount * player_out->frameCount);
+			previous = player_out->frameCount ? word - wordCount : 0;
+			player_out->frameNumber[player_out->frameCount] = header[0];
+			for (i = 0, payload = record + codeSize; i < wordCount; ++i)
+			{
+				n = (record[i >> 2] >> ((i & 3) * 2)) & 3;
+				for (b = x = 0, n = n ? n + 1 : 0; b < n; ++b)
+					x |= (a3ui32)(*(payload++)) << (b * 8);
+				word[i] = previous ? previous[i] ^ x : x;
+			}
+		}
+		a3fileStreamClose(fileStream);
+		player_out->hierarchy = hierarchy;
+		return player_out->frameCount;
+	}
+	return -1;
+}
+
+// release player
+a3i32 a3hierarchyPlayerRelease(a3_HierarchyPlayer *player)
+{
+	if (player && player->data)
+	{
+		free(player->data);
+		player->data = 0;
+		player->frame = 0;
+		player->frameNumber = 0;
+		player->frameCount = 0;
+		player->hierarchy = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// compare captures
+a3i32 a3hierarchyPlayerCompare(const a3_HierarchyPlayer *playerA, const a3_HierarchyPlayer *playerB, const a3real tolerance, a3real *maxError_out_opt)
+{
+	if (playerA && playerA->data && playerB && playerB->data && playerA->hierarchy->numNodes == playerB->hierarchy->numNodes)
+	{
+		const a3ui32 realCount = playerA->hierarchy->numNodes * sizeof(a3_SpatialPose) / sizeof(a3real);
+		const a3ui32 frameCount = a3minimum(playerA->frameCount, playerB->frameCount);
+		const a3real *a, *b;
+		a3real error, errorMax = a3real_zero, frameError;
+		a3ui32 f, i;
+		a3i32 differ = 0;
+		for (f = 0; f < frameCount; ++f)
+		{
+			a = (const a3real *)(playerA->frame + f * playerA->hierarchy->numNodes);
+			b = (const a3real *)(playerB->frame + f * playerB->hierarchy->numNodes);
+			for (i = 0, frameError = a3real_zero; i < realCount; ++i)
+			{
+				error = a3absolute(a[i] - b[i]);
+				frameError = a3maximum(frameError, error);
+			}
+			differ += (frameError > tolerance);
+			errorMax = a3maximum(errorMax, frameError);
+		}
+		if (maxError_out_opt)
+			*maxError_out_opt = errorMax;
+		return differ;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -24,42 +24,732 @@
 
 #include "../a3_HierarchyState.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 
+// scale components closer than this are considered equal (exporters 
+//	round scale factors)
+#define a3hierarchyScaleTolerance	((a3real)0.0001)
+
+
 //-----------------------------------------------------------------------------
 
 // initialize pose set given an initialized hierarchy and key pose count
 a3i32 a3hierarchyPoseGroupCreate(a3_HierarchyPoseGroup *poseGroup_out, const a3_Hierarchy *hierarchy, const a3ui32 poseCount)
 {
+	// validate params and initialization states
+	//	(output is not yet initialized, hierarchy is initialized)
+	if (poseGroup_out && hierarchy && !poseGroup_out->hierarchy && hierarchy->nodes && poseCount)
+	{
+		// determine memory requirements: one node pose per node per pose, 
+		//	followed by the hierarchy pose descriptors
+		const a3ui32 spatialPoseCount = hierarchy->numNodes * poseCount;
+		const size_t dataSize = sizeof(a3_SpatialPose) * spatialPoseCount + sizeof(a3_HierarchyPose) * poseCount;
+		a3ui32 i;
+
+		// allocate everything (one malloc)
+		poseGroup_out->spatialPosePool = (a3_SpatialPose *)malloc(dataSize);
+		if (!poseGroup_out->spatialPosePool)
+			return -1;
+
+		// set pointers
+		poseGroup_out->hierarchy = hierarchy;
+		poseGroup_out->hpose = (a3_HierarchyPose *)(poseGroup_out->spatialPosePool + spatialPoseCount);
+		poseGroup_out->hposeCount = poseCount;
+		poseGroup_out->spatialPoseCount = spatialPoseCount;
+		poseGroup_out->scaleMode = a3hierarchyScale_nonuniform;
+
+		// reset all data
+		for (i = 0; i < poseCount; ++i)
+		{
+			poseGroup_out->hpose[i].spatialPose = poseGroup_out->spatialPosePool + i * hierarchy->numNodes;
+			a3hierarchyPoseReset(poseGroup_out->hpose + i, hierarchy->numNodes);
+		}
+
+		// done
+		return poseCount;
+	}
 	return -1;
 }
 
 // release pose set
 a3i32 a3hierarchyPoseGroupRelease(a3_HierarchyPoseGroup *poseGroup)
 {
+	// validate param exists and is initialized
+	if (poseGroup && poseGroup->hierarchy)
+	{
+		// release everything (one free)
+		free(poseGroup->spatialPosePool);
+
+		// reset pointers
+		poseGroup->hierarchy = 0;
+		poseGroup->spatialPosePool = 0;
+		poseGroup->hpose = 0;
+		poseGroup->hposeCount = 0;
+		poseGroup->spatialPoseCount = 0;
+
+		// done
+		return 1;
+	}
+	return -1;
+}
+
+
+// scan all poses to determine scale usage
+a3i32 a3hierarchyPoseGroupUpdateScaleMode(a3_HierarchyPoseGroup *poseGroup)
+{
+	if (poseGroup && poseGroup->hierarchy)
+	{
+		const a3_SpatialPose *spatialPose = poseGroup->spatialPosePool;
+		const a3_SpatialPose *const end = spatialPose + poseGroup->spatialPoseCount;
+		a3_HierarchyScaleMode scaleMode = a3hierarchyScale_none;
+		for (; spatialPose < end && scaleMode != a3hierarchyScale_nonuniform; ++spatialPose)
+		{
+			if (a3absolute(spatialPose->scale.x - spatialPose->scale.y) > a3hierarchyScaleTolerance ||
+				a3absolute(spatialPose->scale.x - spatialPose->scale.z) > a3hierarchyScaleTolerance)
+				scaleMode = a3hierarchyScale_nonuniform;
+			else if (a3absolute(spatialPose->scale.x - a3real_one) > a3hierarchyScaleTolerance)
+				scaleMode = a3hierarchyScale_uniform;
+		}
+		poseGroup->scaleMode = scaleMode;
+		return scaleMode;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// HTR file sections
+enum a3_HierarchyHTRSection
+{
+	a3htr_none,
+	a3htr_header,
+	a3htr_hierarchy,
+	a3htr_basePosition,
+	a3htr_frames,
+	a3htr_end,
+};
+
+// load HTR file, create hierarchy and pose group
+a3i32 a3hierarchyPoseGroupLoadHTR(a3_HierarchyPoseGroup *poseGroup_out, a3_Hierarchy *hierarchy_out, const a3byte *resourceFilePath)
+{
+	if (poseGroup_out && !poseGroup_out->hierarchy && hierarchy_out && !hierarchy_out->nodes && resourceFilePath && *resourceFilePath)
+	{
+		FILE *fp = fopen(resourceFilePath, "r");
+		a3byte line[256], token[a3node_nameSize], parentName[a3node_nameSize];
+		enum a3_HierarchyHTRSection section = a3htr_none;
+		a3_SpatialPoseEulerOrder order = a3poseEulerOrder_zyx;
+		a3ui32 segmentCount = 0, frameCount = 0, nodeIndex = 0, nodeCount = 0, frame = 0;
+		a3i32 parentIndex, segmentIndex = -1;
+		a3real scaleFactor = a3real_one;
+		a3f32 tx, ty, tz, rx, ry, rz, sf;
+		a3_SpatialPose *spatialPose, *basePose;
+		a3_SpatialPose delta[1];
+		a3byte *close;
+		a3ui32 i;
+
+		if (!fp)
+		{
+			printf("\n A3 ERROR: Could not open HTR file \'%s\'.", resourceFilePath);
+			return -1;
+		}
+
+		while (fgets(line, sizeof(line), fp))
+		{
+			// skip comments and empty lines
+			if (*line == '#' || *line == '\n' || *line == '\r' || !*line)
+				continue;
+
+			// section change
+			if (*line == '[')
+			{
+				close = strchr(line, ']');
+				if (close)
+					*close = 0;
+				if (!strcmp(line + 1, "Header"))
+					section = a3htr_header;
+				else if (!strcmp(line + 1, "SegmentNames&Hierarchy"))
+				{
+					// header is complete, allocate everything
+					section = a3htr_hierarchy;
+					if (!segmentCount || !frameCount ||
+						a3hierarchyCreate(hierarchy_out, segmentCount, 0) < 0 ||
+						a3hierarchyPoseGroupCreate(poseGroup_out, hierarchy_out, frameCount + 1) < 0)
+						break;
+				}
+				else if (!strcmp(line + 1, "BasePosition"))
+					section = a3htr_basePosition;
+				else if (!strcmp(line + 1, "EndOfFile"))
+					section = a3htr_end;
+				else if (poseGroup_out->hierarchy)
+				{
+					// segment frame data
+					section = a3htr_frames;
+					segmentIndex = a3hierarchyGetNodeIndex(hierarchy_out, line + 1);
+					frame = 0;
+				}
+				continue;
+			}
+
+			switch (section)
+			{
+			case a3htr_header:
+				if (sscanf(line, "%31s", token) == 1)
+				{
+					if (!strcmp(token, "NumSegments"))
+						sscanf(line + strlen(token), "%u", &segmentCount);
+					else if (!strcmp(token, "NumFrames"))
+						sscanf(line + strlen(token), "%u", &frameCount);
+					else if (!strcmp(token, "EulerRotationOrder"))
+					{
+						sscanf(line + strlen(token), "%31s", token);
+						order = strcmp(token, "XYZ") ? a3poseEulerOrder_zyx : a3poseEulerOrder_xyz;
+					}
+					else if (!strcmp(token, "ScaleFactor"))
+					{
+						sscanf(line + strlen(token), "%f", &sf);
+						scaleFactor = (a3real)sf;
+					}
+				}
+				break;
+			case a3htr_hierarchy:
+				// parent must already exist; index must exceed parent's
+				if (nodeIndex < segmentCount && sscanf(line, "%31s %31s", token, parentName) == 2)
+				{
+					parentIndex = strcmp(parentName, "GLOBAL") ? a3hierarchyGetNodeIndex(hierarchy_out, parentName) : -1;
+					if (strcmp(parentName, "GLOBAL") && parentIndex < 0)
+						printf("\n A3 ERROR: HTR segment \'%s\' listed before its parent \'%s\'.", token, parentName);
+					else if (a3hierarchySetNode(hierarchy_out, nodeIndex, parentIndex, token) >= 0)
+						++nodeCount;
+					++nodeIndex;
+				}
+				break;
+			case a3htr_basePosition:
+				if (sscanf(line, "%31s %f %f %f %f %f %f", token, &tx, &ty, &tz, &rx, &ry, &rz) == 7)
+				{
+					segmentIndex = a3hierarchyGetNodeIndex(hierarchy_out, token);
+					if (segmentIndex >= 0)
+					{
+						spatialPose = poseGroup_out->hpose[0].spatialPose + segmentIndex;
+						a3spatialPoseSetRotation(spatialPose, (a3real)rx, (a3real)ry, (a3real)rz, order);
+						a3spatialPoseSetTranslation(spatialPose, (a3real)tx * scaleFactor, (a3real)ty * scaleFactor, (a3real)tz * scaleFactor);
+					}
+				}
+				break;
+			case a3htr_frames:
+				// frames are stored relative to the base pose; concatenate
+				if (segmentIndex >= 0 && frame < frameCount &&
+					sscanf(line, "%*d %f %f %f %f %f %f %f", &tx, &ty, &tz, &rx, &ry, &rz, &sf) == 7)
+				{
+					basePose = poseGroup_out->hpose[0].spatialPose + segmentIndex;
+					spatialPose = poseGroup_out->hpose[++frame].spatialPose + segmentIndex;
+					a3spatialPoseSetRotation(delta, (a3real)rx, (a3real)ry, (a3real)rz, order);
+					a3quatProduct(spatialPose->orientation.v, basePose->orientation.v, delta->orientation.v);
+					a3spatialPoseSetScale(spatialPose, (a3real)sf, (a3real)sf, (a3real)sf);
+					a3spatialPoseSetTranslation(spatialPose,
+						basePose->translation.x + (a3real)tx * scaleFactor,
+						basePose->translation.y + (a3real)ty * scaleFactor,
+						basePose->translation.z + (a3real)tz * scaleFactor);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		fclose(fp);
+
+		// validate and finish
+		if (poseGroup_out->hierarchy && nodeCount == segmentCount)
+		{
+			for (i = 0; i < poseGroup_out->hposeCount; ++i)
+				a3hierarchyPoseConvert(poseGroup_out->hpose + i, nodeCount);
+			a3hierarchyPoseGroupUpdateScaleMode(poseGroup_out);
+			return poseGroup_out->hposeCount;
+		}
+
+		printf("\n A3 ERROR: Invalid HTR file \'%s\'.", resourceFilePath);
+		a3hierarchyPoseGroupRelease(poseGroup_out);
+		a3hierarchyRelease(hierarchy_out);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// allocate structure-of-arrays pose for node count
+a3i32 a3hierarchyPoseSoACreate(a3_HierarchyPoseSoA *pose_out, const a3ui32 nodeCount)
+{
+	if (pose_out && !pose_out->data && nodeCount)
+	{
+		// stride padded to SIMD width; extra space for 16-byte alignment
+		const a3ui32 nodeStride = (nodeCount + a3poseSoA_nodeAlign - 1) / a3poseSoA_nodeAlign * a3poseSoA_nodeAlign;
+		const size_t dataSize = sizeof(a3real) * nodeStride * a3poseSoA_channelCount + 16;
+		a3real *channel;
+		a3ui32 i, j;
+
+		pose_out->data = malloc(dataSize);
+		if (!pose_out->data)
+			return -1;
+		pose_out->nodeCount = nodeCount;
+		pose_out->nodeStride = nodeStride;
+
+		// align and distribute streams; initialize all lanes to identity 
+		//	so that padding never produces invalid values in kernels
+		channel = (a3real *)(((size_t)pose_out->data + 15) & ~(size_t)15);
+		for (j = 0; j < a3poseSoA_channelCount; ++j, channel += nodeStride)
+		{
+			pose_out->channel[j] = channel;
+			for (i = 0; i < nodeStride; ++i)
+				channel[i] = (j == a3poseSoA_orient_w || (j >= a3poseSoA_scale_x && j <= a3poseSoA_scale_z)) ? a3real_one : a3real_zero;
+		}
+		return nodeStride;
+	}
+	return -1;
+}
+
+// release structure-of-arrays pose
+a3i32 a3hierarchyPoseSoARelease(a3_HierarchyPoseSoA *pose)
+{
+	if (pose && pose->data)
+	{
+		free(pose->data);
+		memset(pose, 0, sizeof(a3_HierarchyPoseSoA));
+		return 1;
+	}
+	return -1;
+}
+
+// scatter hierarchy pose channels into structure-of-arrays pose
+a3i32 a3hierarchyPoseSoAStore(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPose *pose_in)
+{
+	const a3_SpatialPose *spatialPose;
+	a3ui32 i;
+	if (pose_out && pose_out->data && pose_in && pose_in->spatialPose)
+	{
+		for (i = 0, spatialPose = pose_in->spatialPose; i < pose_out->nodeCount; ++i, ++spatialPose)
+		{
+			pose_out->orientation[0][i] = spatialPose->orientation.x;
+			pose_out->orientation[1][i] = spatialPose->orientation.y;
+			pose_out->orientation[2][i] = spatialPose->orientation.z;
+			pose_out->orientation[3][i] = spatialPose->orientation.w;
+			pose_out->scale[0][i] = spatialPose->scale.x;
+			pose_out->scale[1][i] = spatialPose->scale.y;
+			pose_out->scale[2][i] = spatialPose->scale.z;
+			pose_out->translation[0][i] = spatialPose->translation.x;
+			pose_out->translation[1][i] = spatialPose->translation.y;
+			pose_out->translation[2][i] = spatialPose->translation.z;
+		}
+		return i;
+	}
+	return -1;
+}
+
+// gather structure-of-arrays pose channels into hierarchy pose
+a3i32 a3hierarchyPoseSoALoad(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_in)
+{
+	a3_SpatialPose *spatialPose;
+	a3ui32 i;
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->data)
+	{
+		for (i = 0, spatialPose = pose_out->spatialPose; i < pose_in->nodeCount; ++i, ++spatialPose)
+		{
+			a3real4Set(spatialPose->orientation.v, pose_in->orientation[0][i], pose_in->orientation[1][i], pose_in->orientation[2][i], pose_in->orientation[3][i]);
+			a3real4Set(spatialPose->scale.v, pose_in->scale[0][i], pose_in->scale[1][i], pose_in->scale[2][i], a3real_zero);
+			a3real4Set(spatialPose->translation.v, pose_in->translation[0][i], pose_in->translation[1][i], pose_in->translation[2][i], a3real_zero);
+		}
+		return i;
+	}
 	return -1;
 }
 
 
 //-----------------------------------------------------------------------------
 
+// subtree ranges: parents precede children, so walking backwards 
+//	propagates each node's range end up to its parent
+inline void a3hierarchyInternalSetSubtreeEnd(a3ui32 *subtreeEnd, const a3_Hierarchy *hierarchy)
+{
+	a3i32 parentIndex;
+	a3ui32 i;
+	for (i = 0; i < hierarchy->numNodes; ++i)
+		subtreeEnd[i] = i + 1;
+	for (i = hierarchy->numNodes; i > 0; --i)
+	{
+		parentIndex = hierarchy->nodes[i - 1].parentIndex;
+		if (parentIndex >= 0 && subtreeEnd[parentIndex] < subtreeEnd[i - 1])
+			subtreeEnd[parentIndex] = subtreeEnd[i - 1];
+	}
+}
+
+
 // initialize hierarchy state given an initialized hierarchy
 a3i32 a3hierarchyStateCreate(a3_HierarchyState *state_out, const a3_HierarchyPoseGroup *poseGroup)
 {
+	// validate params and initialization states
+	//	(output is not yet initialized, pose group is initialized)
+	if (state_out && poseGroup && !state_out->poseGroup && poseGroup->hierarchy && poseGroup->hierarchy->nodes)
+	{
+		// determine memory requirements: three poses, inverse transforms, 
+		//	subtree ranges and dirty flags
+		const a3_Hierarchy *hierarchy = poseGroup->hierarchy;
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		const size_t dataSize = (sizeof(a3_SpatialPose) * 3 + sizeof(a3mat4) + sizeof(a3ui32) + sizeof(a3ubyte)) * nodeCount;
+		a3ui32 i;
+
+		// allocate everything (one malloc)
+		state_out->sampleHPose->spatialPose = (a3_SpatialPose *)malloc(dataSize);
+		if (!state_out->sampleHPose->spatialPose)
+			return -1;
+
+		// set pointers
+		state_out->poseGroup = poseGroup;
+		state_out->localHPose->spatialPose = state_out->sampleHPose->spatialPose + nodeCount;
+		state_out->objectHPose->spatialPose = state_out->localHPose->spatialPose + nodeCount;
+		state_out->objectSpaceInverse->transform = (a3mat4 *)(state_out->objectHPose->spatialPose + nodeCount);
+		state_out->subtreeEnd = (a3ui32 *)(state_out->objectSpaceInverse->transform + nodeCount);
+		state_out->localDirty = (a3ubyte *)(state_out->subtreeEnd + nodeCount);
+
+		// reset all data
+		for (i = 0; i < 3; ++i)
+			a3hierarchyPoseReset(state_out->hpose + i, nodeCount);
+		for (i = 0; i < nodeCount; ++i)
+			state_out->objectSpaceInverse->transform[i] = a3mat4_identity;
+		state_out->samplePoseSoA->data = 0;
+		a3hierarchyPoseSoACreate(state_out->samplePoseSoA, nodeCount);
+
+		a3hierarchyInternalSetSubtreeEnd(state_out->subtreeEnd, hierarchy);
+		memset(state_out->localDirty, 1, nodeCount);
+		state_out->forwardNodeCount = 0;
+
+		// done
+		return nodeCount;
+	}
+	return -1;
+}
+
+// copy pose into local pose, flagging changed nodes
+a3i32 a3hierarchyStateUpdateLocal(const a3_HierarchyState *state, const a3_HierarchyPose *pose_in)
+{
+	if (state && state->poseGroup && pose_in && pose_in->spatialPose)
+	{
+		const a3ui32 nodeCount = state->poseGroup->hierarchy->numNodes;
+		const a3_SpatialPose *spatialPose_in = pose_in->spatialPose;
+		a3_SpatialPose *spatialPose = state->localHPose->spatialPose;
+		a3ui32 i, changed;
+		for (i = changed = 0; i < nodeCount; ++i, ++spatialPose, ++spatialPose_in)
+		{
+			// compare channels only; matrix is derived from them
+			if (memcmp(spatialPose->orientation.v, spatialPose_in->orientation.v, sizeof(a3vec4) * 3))
+			{
+				spatialPose->orientation = spatialPose_in->orientation;
+				spatialPose->scale = spatialPose_in->scale;
+				spatialPose->translation = spatialPose_in->translation;
+				a3spatialPoseConvert(spatialPose);
+				state->localDirty[i] = 1;
+				++changed;
+			}
+		}
+		return changed;
+	}
 	return -1;
 }
 
 // release hierarchy state
 a3i32 a3hierarchyStateRelease(a3_HierarchyState *state)
 {
+	// validate param exists and is initialized
+	if (state && state->poseGroup)
+	{
+		// release everything (one free)
+		free(state->sampleHPose->spatialPose);
+		a3hierarchyPoseSoARelease(state->samplePoseSoA);
+
+		// reset pointers
+		state->poseGroup = 0;
+		state->sampleHPose->spatialPose = 0;
+		state->localHPose->spatialPose = 0;
+		state->objectHPose->spatialPose = 0;
+		state->objectSpaceInverse->transform = 0;
+		state->subtreeEnd = 0;
+		state->localDirty = 0;
+
+		// done
+		return 1;
+	}
 	return -1;
 }
 
 
 //-----------------------------------------------------------------------------
 
+// initialize batch of states for hierarchy
+a3i32 a3hierarchyStateBatchCreate(a3_HierarchyStateBatch *batch_out, const a3_Hierarchy *hierarchy, const a3ui32 instanceCount)
+{
+	if (batch_out && !batch_out->hierarchy && hierarchy && hierarchy->nodes && instanceCount)
+	{
+		// stride padded to SIMD width; three matrix sets; alignment space
+		const a3ui32 instanceStride = (instanceCount + a3poseSoA_nodeAlign - 1) / a3poseSoA_nodeAlign * a3poseSoA_nodeAlign;
+		const a3ui32 streamCount = hierarchy->numNodes * 16;
+		const size_t dataSize = sizeof(a3real) * instanceStride * streamCount * 3 + sizeof(a3ui32) * hierarchy->numNodes + 16;
+		a3real *stream;
+		a3ui32 i, j;
+
+		batch_out->data = malloc(dataSize);
+		if (!batch_out->data)
+			return -1;
+
+		batch_out->hierarchy = hierarchy;
+		batch_out->instanceCount = instanceCount;
+		batch_out->instanceStride = instanceStride;
+		batch_out->localTransform = (a3real *)(((size_t)batch_out->data + 15) & ~(size_t)15);
+		batch_out->objectTransform = batch_out->localTransform + instanceStride * streamCount;
+		batch_out->objectInverseTransform = batch_out->objectTransform + instanceStride * streamCount;
+		batch_out->subtreeEnd = (a3ui32 *)(batch_out->objectInverseTransform + instanceStride * streamCount);
+		a3hierarchyInternalSetSubtreeEnd(batch_out->subtreeEnd, hierarchy);
+
+		// all matrices start as identity; bottom rows are never rewritten 
+		//	by affine kernels
+		for (j = 0, stream = batch_out->localTransform; j < streamCount * 3; ++j, stream += instanceStride)
+			for (i = 0; i < instanceStride; ++i)
+				stream[i] = (j % 16 % 5 == 0) ? a3real_one : a3real_zero;
+		return instanceCount;
+	}
+	return -1;
+}
+
+// release batch
+a3i32 a3hierarchyStateBatchRelease(a3_HierarchyStateBatch *batch)
+{
+	if (batch && batch->hierarchy)
+	{
+		free(batch->data);
+		memset(batch, 0, sizeof(a3_HierarchyStateBatch));
+		return 1;
+	}
+	return -1;
+}
+
+// scatter hierarchy pose matrices into instance's local streams
+a3i32 a3hierarchyStateBatchStoreLocal(const a3_HierarchyStateBatch *batch, const a3ui32 instanceIndex, const a3_HierarchyPose *pose_in)
+{
+	if (batch && batch->hierarchy && instanceIndex < batch->instanceCount && pose_in && pose_in->spatialPose)
+	{
+		const a3ui32 nodeCount = batch->hierarchy->numNodes;
+		a3real *stream = batch->localTransform + instanceIndex;
+		const a3real *element;
+		a3ui32 i, j;
+		for (i = 0; i < nodeCount; ++i)
+			for (j = 0, element = pose_in->spatialPose[i].transform.mm; j < 16; ++j, stream += batch->instanceStride)
+				*stream = element[j];
+		return nodeCount;
+	}
+	return -1;
+}
+
+// gather instance's object streams into hierarchy pose matrices
+a3i32 a3hierarchyStateBatchLoadObject(const a3_HierarchyPose *pose_out, const a3_HierarchyStateBatch *batch, const a3ui32 instanceIndex)
+{
+	if (pose_out && pose_out->spatialPose && batch && batch->hierarchy && instanceIndex < batch->instanceCount)
+	{
+		const a3ui32 nodeCount = batch->hierarchy->numNodes;
+		const a3real *stream = batch->objectTransform + instanceIndex;
+		a3real *element;
+		a3ui32 i, j;
+		for (i = 0; i < nodeCount; ++i)
+			for (j = 0, element = pose_out->spatialPose[i].transform.mm; j < 16; ++j, stream += batch->instanceStride)
+				element[j] = *stream;
+		return nodeCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// write one palette matrix as rigid dual quaternion: scale is normalized 
+//	out of the basis, real part kept in the w >= 0 hemisphere so blends 
+//	between neighbouring nodes rarely need sign correction
+inline void a3hierarchyInternalStorePaletteDualQuat(a3real *palette_out, const a3real4x4p m)
+{
+	a3mat4 rotation = a3mat4_identity;
+	a3vec3 translation;
+	a3ui32 j;
+	for (j = 0; j < 3; ++j)
+	{
+		rotation.m[j][0] = m[j][0];
+		rotation.m[j][1] = m[j][1];
+		rotation.m[j][2] = m[j][2];
+		a3real3Normalize(rotation.m[j]);
+	}
+	rotation.m[3][0] = m[3][0];
+	rotation.m[3][1] = m[3][1];
+	rotation.m[3][2] = m[3][2];
+	a3quatConvertFromMat4SafeTranslate(palette_out, translation.v, rotation.m);
+	if (palette_out[3] < a3real_zero)
+		for (j = 0; j < 4; ++j)
+			palette_out[j] = -palette_out[j];
+	a3dualquatCalculateDualPart(palette_out + 4, palette_out, translation.v);
+}
+
+// write one palette matrix in layout
+inline void a3hierarchyInternalStorePalette(a3real *palette_out, const a3real4x4p m, const a3_HierarchyPaletteLayout layout)
+{
+	a3ui32 r, j;
+	if (layout == a3hierarchyPalette_mat4)
+		for (j = 0; j < 16; ++j)
+			palette_out[j] = m[j / 4][j % 4];
+	else if (layout == a3hierarchyPalette_mat3x4)
+		for (r = 0; r < 3; ++r)
+			for (j = 0; j < 4; ++j)
+				palette_out[r * 4 + j] = m[j][r];
+	else
+		a3hierarchyInternalStorePaletteDualQuat(palette_out, m);
+}
+
+// update bind-to-current palette
+a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse, a3real *palette_out, const a3_HierarchyPaletteLayout layout)
+{
+	if (state && state->poseGroup && objectSpaceBindInverse && objectSpaceBindInverse->transform && palette_out &&
+		(layout == a3hierarchyPalette_mat4 || layout == a3hierarchyPalette_mat3x4 || layout == a3hierarchyPalette_dualquat))
+	{
+		// product columns are built in registers; rows layout transposes 
+		//	them in place, so nothing is staged outside the palette; dual 
+		//	quaternions are converted from the product
+		const a3ui32 nodeCount = state->poseGroup->hierarchy->numNodes;
+		const a3_SpatialPose *objectPose = state->objectHPose->spatialPose;
+		const a3mat4 *bindInv = objectSpaceBindInverse->transform;
+		a3mat4 bindToCurrent;
+		a3ui32 i;
+#ifdef A3_HIERARCHY_SIMD
+		__m128 l0, l1, l2, l3, c[4];
+		a3ui32 j;
+		for (i = 0; i < nodeCount; ++i, palette_out += layout)
+		{
+			l0 = _mm_loadu_ps(objectPose[i].transform.m[0]);
+			l1 = _mm_loadu_ps(objectPose[i].transform.m[1]);
+			l2 = _mm_loadu_ps(objectPose[i].transform.m[2]);
+			l3 = _mm_loadu_ps(objectPose[i].transform.m[3]);
+			for (j = 0; j < 4; ++j)
+				c[j] = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(l0, _mm_set1_ps(bindInv[i].m[j][0])),
+					_mm_mul_ps(l1, _mm_set1_ps(bindInv[i].m[j][1]))),
+					_mm_mul_ps(l2, _mm_set1_ps(bindInv[i].m[j][2])));
+			c[3] = _mm_add_ps(c[3], l3);
+			if (layout == a3hierarchyPalette_dualquat)
+			{
+				for (j = 0; j < 4; ++j)
+					_mm_storeu_ps(bindToCurrent.m[j], c[j]);
+				a3hierarchyInternalStorePaletteDualQuat(palette_out, bindToCurrent.m);
+				continue;
+			}
+			if (layout == a3hierarchyPalette_mat3x4)
+				_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+			for (j = 0; j < (a3ui32)layout / 4; ++j)
+				_mm_storeu_ps(palette_out + j * 4, c[j]);
+		}
+#else	// !A3_HIERARCHY_SIMD
+		for (i = 0; i < nodeCount; ++i, palette_out += layout)
+		{
+			a3real4x4Product(bindToCurrent.m, objectPose[i].transform.m, bindInv[i].m);
+			a3hierarchyInternalStorePalette(palette_out, bindToCurrent.m, layout);
+		}
+#endif	// A3_HIERARCHY_SIMD
+		return nodeCount;
+	}
+	return -1;
+}
+
+// update bind-to-current palettes for batch
+a3i32 a3hierarchyStateBatchUpdateObjectBindToCurrent(const a3_HierarchyStateBatch *batch, const a3_HierarchyTransform *objectSpaceBindInverse, a3real *palette_out, const a3_HierarchyPaletteLayout layout)
+{
+	if (batch && batch->hierarchy && objectSpaceBindInverse && objectSpaceBindInverse->transform && palette_out &&
+		(layout == a3hierarchyPalette_mat4 || layout == a3hierarchyPalette_mat3x4 || layout == a3hierarchyPalette_dualquat))
+	{
+		// node-major: each bind inverse is loaded once for all instances; 
+		//	four instances per step, transposed from streams to per-instance 
+		//	columns (or rows) on the way out
+		const a3ui32 nodeCount = batch->hierarchy->numNodes, instanceCount = batch->instanceCount;
+		const a3ui32 stride = batch->instanceStride, paletteStride = nodeCount * layout;
+		const a3mat4 *bindInv = objectSpaceBindInverse->transform;
+		const a3real *m;
+		a3real *out;
+		a3ui32 i, k, r, j;
+#ifdef A3_HIERARCHY_SIMD
+		__m128 e[4][4], b[4][3];
+		a3mat4 laneTransform[4];
+		a3ui32 lanes;
+		for (i = 0; i < nodeCount; ++i)
+		{
+			m = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, i);
+			for (j = 0; j < 4; ++j)
+				for (r = 0; r < 3; ++r)
+					b[j][r] = _mm_set1_ps(bindInv[i].m[j][r]);
+			for (k = 0; k < instanceCount; k += 4)
+			{
+				// e[j][r]: element (column j, row r) for four instances
+				for (r = 0; r < 3; ++r)
+				{
+					const __m128 o0 = _mm_load_ps(m + (0 + r) * stride + k), o1 = _mm_load_ps(m + (4 + r) * stride + k), o2 = _mm_load_ps(m + (8 + r) * stride + k);
+					for (j = 0; j < 4; ++j)
+						e[j][r] = _mm_add_ps(_mm_add_ps(
+							_mm_mul_ps(o0, b[j][0]),
+							_mm_mul_ps(o1, b[j][1])),
+							_mm_mul_ps(o2, b[j][2]));
+					e[3][r] = _mm_add_ps(e[3][r], _mm_load_ps(m + (12 + r) * stride + k));
+				}
+				lanes = a3minimum(instanceCount - k, 4);
+				out = palette_out + k * paletteStride + i * layout;
+				if (layout == a3hierarchyPalette_mat3x4)
+				{
+					// row r of each instance: transpose (e[0][r] ... e[3][r])
+					for (r = 0; r < 3; ++r)
+					{
+						_MM_TRANSPOSE4_PS(e[0][r], e[1][r], e[2][r], e[3][r]);
+						for (j = 0; j < lanes; ++j)
+							_mm_storeu_ps(out + j * paletteStride + r * 4, e[j][r]);
+					}
+				}
+				else
+				{
+					// column j of each instance: transpose (e[j][0] ... e[j][3])
+					for (j = 0; j < 4; ++j)
+					{
+						e[j][3] = j < 3 ? _mm_setzero_ps() : _mm_set1_ps(a3real_one);
+						_MM_TRANSPOSE4_PS(e[j][0], e[j][1], e[j][2], e[j][3]);
+						for (r = 0; r < lanes; ++r)
+							if (layout == a3hierarchyPalette_mat4)
+								_mm_storeu_ps(out + r * paletteStride + j * 4, e[j][r]);
+							else
+								_mm_storeu_ps(laneTransform[r].m[j], e[j][r]);
+					}
+					if (layout == a3hierarchyPalette_dualquat)
+						for (r = 0; r < lanes; ++r)
+							a3hierarchyInternalStorePaletteDualQuat(out + r * paletteStride, laneTransform[r].m);
+				}
+			}
+		}
+#else	// !A3_HIERARCHY_SIMD
+		a3mat4 object, bindToCurrent;
+		for (i = 0; i < nodeCount; ++i)
+		{
+			m = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, i);
+			for (k = 0, out = palette_out + i * layout; k < instanceCount; ++k, out += paletteStride)
+			{
+				for (j = 0; j < 16; ++j)
+					object.mm[j] = m[j * stride + k];
+				a3real4x4Product(bindToCurrent.m, object.m, bindInv[i].m);
+				a3hierarchyInternalStorePalette(out, bindToCurrent.m, layout);
+			}
+		}
+#endif	// A3_HIERARCHY_SIMD
+		return instanceCount;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
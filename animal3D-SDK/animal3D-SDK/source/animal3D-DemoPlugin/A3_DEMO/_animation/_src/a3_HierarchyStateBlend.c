@@ -24,9 +24,1165 @@
 
 #include "../a3_HierarchyStateBlend.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// normalize quaternion; degenerate input becomes identity
+inline void a3hierarchyBlendInternalNormalize(a3real *q)
+{
+	a3real lenSq = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+	if (lenSq > a3real_zero)
+	{
+		lenSq = a3recip(a3sqrt(lenSq));
+		q[0] *= lenSq;
+		q[1] *= lenSq;
+		q[2] *= lenSq;
+		q[3] *= lenSq;
+	}
+	else
+	{
+		q[0] = q[1] = q[2] = a3real_zero;
+		q[3] = a3real_one;
+	}
+}
+
+// normalized lerp along the shorter arc
+inline void a3hierarchyBlendInternalNlerp(a3real *q_out, const a3real *q0, const a3real *q1, const a3real u)
+{
+	const a3real d = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+	const a3real u0 = a3real_one - u, u1 = d < a3real_zero ? -u : u;
+	q_out[0] = u0 * q0[0] + u1 * q1[0];
+	q_out[1] = u0 * q0[1] + u1 * q1[1];
+	q_out[2] = u0 * q0[2] + u1 * q1[2];
+	q_out[3] = u0 * q0[3] + u1 * q1[3];
+	a3hierarchyBlendInternalNormalize(q_out);
+}
+
+// orientation of one node
+inline void a3hierarchyBlendInternalGetOrientation(a3real *q_out, const a3_HierarchyPoseSoA *pose, const a3ui32 i)
+{
+	q_out[0] = pose->orientation[0][i];
+	q_out[1] = pose->orientation[1][i];
+	q_out[2] = pose->orientation[2][i];
+	q_out[3] = pose->orientation[3][i];
+}
+
+inline void a3hierarchyBlendInternalSetOrientation(const a3_HierarchyPoseSoA *pose, const a3ui32 i, const a3real *q)
+{
+	pose->orientation[0][i] = q[0];
+	pose->orientation[1][i] = q[1];
+	pose->orientation[2][i] = q[2];
+	pose->orientation[3][i] = q[3];
+}
+
+// scale node of delta pose from identity
+inline void a3hierarchyBlendInternalScaleNode(a3real *q_out, a3real *s_out, a3real *t_out, const a3_HierarchyPoseSoA *pose, const a3ui32 i, const a3real u)
+{
+	const a3real u0 = a3real_one - u, u1 = pose->orientation[3][i] < a3real_zero ? -u : u;
+	a3ui32 j;
+	q_out[0] = u1 * pose->orientation[0][i];
+	q_out[1] = u1 * pose->orientation[1][i];
+	q_out[2] = u1 * pose->orientation[2][i];
+	q_out[3] = u1 * pose->orientation[3][i] + u0;
+	a3hierarchyBlendInternalNormalize(q_out);
+	for (j = 0; j < 3; ++j)
+	{
+		s_out[j] = u0 + u * pose->scale[j][i];
+		t_out[j] = u * pose->translation[j][i];
+	}
+}
+
+// barycentric weight of first pose; evaluation and liveness must agree 
+//	on when it is zero, so both take it from here
+inline a3real a3hierarchyBlendInternalTriangularWeight0(const a3real u1, const a3real u2)
+{
+	return (a3real_one - u1 - u2);
+}
+
+// poses are compatible
+inline a3boolean a3hierarchyBlendInternalMatch(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in)
+{
+	return (pose_out && pose_out->data && pose_in && pose_in->data && pose_out->nodeCount == pose_in->nodeCount);
+}
+
+// single node copy
+inline void a3hierarchyBlendInternalCopyNode(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3ui32 i)
+{
+	a3ui32 j;
+	for (j = 0; j < a3poseSoA_channelCount; ++j)
+		pose_out->channel[j][i] = pose_in->channel[j][i];
+}
+
+// single node nlerp
+inline void a3hierarchyBlendInternalLerpNode(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3ui32 i, const a3real u)
+{
+	a3real q0[4], q1[4];
+	a3ui32 j;
+	a3hierarchyBlendInternalGetOrientation(q0, pose0, i);
+	a3hierarchyBlendInternalGetOrientation(q1, pose1, i);
+	a3hierarchyBlendInternalNlerp(q0, q0, q1, u);
+	a3hierarchyBlendInternalSetOrientation(pose_out, i, q0);
+	for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+		pose_out->channel[j][i] = pose0->channel[j][i] + u * (pose1->channel[j][i] - pose0->channel[j][i]);
+}
+
+// single node additive difference
+inline void a3hierarchyBlendInternalAddDifferenceNode(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3_HierarchyPoseSoA *delta, const a3_HierarchyPoseSoA *reference, const a3ui32 i, const a3real u)
+{
+	a3real q[4], qd[4], qr[4], qw[4];
+	a3ui32 j;
+	a3hierarchyBlendInternalGetOrientation(qd, delta, i);
+	a3hierarchyBlendInternalGetOrientation(qr, reference, i);
+	qr[0] = -qr[0];
+	qr[1] = -qr[1];
+	qr[2] = -qr[2];
+	a3quatProduct(qw, qr, qd);
+	qr[0] = qr[1] = qr[2] = a3real_zero;
+	qr[3] = a3real_one;
+	a3hierarchyBlendInternalNlerp(qw, qr, qw, u);
+	a3hierarchyBlendInternalGetOrientation(qd, pose_in, i);
+	a3quatProduct(q, qd, qw);
+	a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+	for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+		pose_out->channel[j][i] = pose_in->channel[j][i] + u * (delta->channel[j][i] - reference->channel[j][i]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef A3_HIERARCHY_SIMD
+// four quaternions at once: normalize, guarding against zero length
+inline void a3hierarchyBlendInternalNormalize4(__m128 *q)
+{
+	const __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q[0], q[0]), _mm_mul_ps(q[1], q[1])), _mm_add_ps(_mm_mul_ps(q[2], q[2]), _mm_mul_ps(q[3], q[3])));
+	const __m128 lenInv = _mm_div_ps(_mm_set1_ps(a3real_one), _mm_sqrt_ps(_mm_max_ps(lenSq, _mm_set1_ps(1.0e-30f))));
+	q[0] = _mm_mul_ps(q[0], lenInv);
+	q[1] = _mm_mul_ps(q[1], lenInv);
+	q[2] = _mm_mul_ps(q[2], lenInv);
+	q[3] = _mm_mul_ps(q[3], lenInv);
+}
+
+// per-node weights for four nodes
+inline __m128 a3hierarchyBlendInternalWeight4(const __m128 u, const a3real *mask, const a3ui32 i)
+{
+	return (mask ? _mm_mul_ps(u, _mm_loadu_ps(mask + i)) : u);
+}
+#endif	// A3_HIERARCHY_SIMD
+
+// interpolate scale and translation streams
+inline void a3hierarchyBlendInternalLerpStreams(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask)
+{
+	a3ui32 i, j;
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 uu = _mm_set1_ps(u);
+	__m128 w, a;
+	for (i = 0; i < pose_out->nodeStride; i += 4)
+	{
+		w = a3hierarchyBlendInternalWeight4(uu, mask, i);
+		for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+		{
+			a = _mm_load_ps(pose0->channel[j] + i);
+			_mm_store_ps(pose_out->channel[j] + i, _mm_add_ps(a, _mm_mul_ps(w, _mm_sub_ps(_mm_load_ps(pose1->channel[j] + i), a))));
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3real w;
+	for (i = 0; i < pose_out->nodeCount; ++i)
+	{
+		w = mask ? u * mask[i] : u;
+		for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+			pose_out->channel[j][i] = pose0->channel[j][i] + w * (pose1->channel[j][i] - pose0->channel[j][i]);
+	}
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// whole-pose nlerp: orientation, scale and translation in one pass
+inline void a3hierarchyBlendInternalLerpPose(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask)
+{
+	a3ui32 i;
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 uu = _mm_set1_ps(u), one = _mm_set1_ps(a3real_one), sign = _mm_set1_ps(-0.0f), zero = _mm_setzero_ps();
+	__m128 w, w0, w1, d, a, q0[4], q1[4];
+	a3ui32 j;
+	for (i = 0; i < pose_out->nodeStride; i += 4)
+	{
+		w = a3hierarchyBlendInternalWeight4(uu, mask, i);
+		for (j = 0; j < 4; ++j)
+		{
+			q0[j] = _mm_load_ps(pose0->orientation[j] + i);
+			q1[j] = _mm_load_ps(pose1->orientation[j] + i);
+		}
+
+		// flip second weight where the inputs are on opposite hemispheres
+		d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q0[0], q1[0]), _mm_mul_ps(q0[1], q1[1])), _mm_add_ps(_mm_mul_ps(q0[2], q1[2]), _mm_mul_ps(q0[3], q1[3])));
+		w1 = _mm_xor_ps(w, _mm_and_ps(_mm_cmplt_ps(d, zero), sign));
+		w0 = _mm_sub_ps(one, w);
+		for (j = 0; j < 4; ++j)
+			q0[j] = _mm_add_ps(_mm_mul_ps(w0, q0[j]), _mm_mul_ps(w1, q1[j]));
+		a3hierarchyBlendInternalNormalize4(q0);
+		for (j = 0; j < 4; ++j)
+			_mm_store_ps(pose_out->orientation[j] + i, q0[j]);
+
+		for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+		{
+			a = _mm_load_ps(pose0->channel[j] + i);
+			_mm_store_ps(pose_out->channel[j] + i, _mm_add_ps(a, _mm_mul_ps(w, _mm_sub_ps(_mm_load_ps(pose1->channel[j] + i), a))));
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	for (i = 0; i < pose_out->nodeCount; ++i)
+		a3hierarchyBlendInternalLerpNode(pose_out, pose0, pose1, i, mask ? u * mask[i] : u);
+#endif	// A3_HIERARCHY_SIMD
+}
+
 
 //-----------------------------------------------------------------------------
 
+// identity pose
+a3i32 a3hierarchyPoseSoAIdentity(const a3_HierarchyPoseSoA *pose_out)
+{
+	if (pose_out && pose_out->data)
+	{
+		a3ui32 i, j;
+		for (j = 0; j < a3poseSoA_channelCount; ++j)
+			for (i = 0; i < pose_out->nodeCount; ++i)
+				pose_out->channel[j][i] = (j == a3poseSoA_orient_w || (j >= a3poseSoA_scale_x && j <= a3poseSoA_scale_z)) ? a3real_one : a3real_zero;
+		return pose_out->nodeCount;
+	}
+	return -1;
+}
+
+// copy pose
+a3i32 a3hierarchyPoseSoACopy(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose_in))
+	{
+		a3ui32 j;
+		if (pose_out != pose_in)
+			for (j = 0; j < a3poseSoA_channelCount; ++j)
+				memcpy(pose_out->channel[j], pose_in->channel[j], sizeof(a3real) * pose_out->nodeCount);
+		return pose_out->nodeCount;
+	}
+	return -1;
+}
+
+// interpolate poses
+a3i32 a3hierarchyPoseSoALerp(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose0) && a3hierarchyBlendInternalMatch(pose_out, pose1))
+	{
+		a3hierarchyBlendInternalLerpPose(pose_out, pose0, pose1, u, 0);
+		return pose_out->nodeCount;
+	}
+	return -1;
+}
+
+// interpolate poses with per-node weights
+a3i32 a3hierarchyPoseSoALerpMasked(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose0) && a3hierarchyBlendInternalMatch(pose_out, pose1) && mask)
+	{
+		a3hierarchyBlendInternalLerpPose(pose_out, pose0, pose1, u, mask);
+		return pose_out->nodeCount;
+	}
+	return -1;
+}
+
+// spherical interpolation of orientations
+a3i32 a3hierarchyPoseSoASlerp(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask_opt)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose0) && a3hierarchyBlendInternalMatch(pose_out, pose1))
+	{
+		a3real q[4], q0[4], q1[4], w;
+		a3ui32 i, j;
+
+		// slerp has no vector form in the math library; the linear 
+		//	channels still take the vectorized path
+		for (i = 0; i < pose_out->nodeCount; ++i)
+		{
+			w = mask_opt ? u * mask_opt[i] : u;
+			a3hierarchyBlendInternalGetOrientation(q0, pose0, i);
+			a3hierarchyBlendInternalGetOrientation(q1, pose1, i);
+			if (q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3] < a3real_zero)
+				for (j = 0; j < 4; ++j)
+					q1[j] = -q1[j];
+			a3quatSlerp(q, q0, q1, w);
+			a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+		}
+		a3hierarchyBlendInternalLerpStreams(pose_out, pose0, pose1, u, mask_opt);
+		return i;
+	}
+	return -1;
+}
+
+// compose poses
+a3i32 a3hierarchyPoseSoAConcat(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose0) && a3hierarchyBlendInternalMatch(pose_out, pose1))
+	{
+		a3real q0[4], q1[4], q[4];
+		a3ui32 i, j;
+		for (i = 0; i < pose_out->nodeCount; ++i)
+		{
+			a3hierarchyBlendInternalGetOrientation(q0, pose0, i);
+			a3hierarchyBlendInternalGetOrientation(q1, pose1, i);
+			a3quatProduct(q, q0, q1);
+			a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+			for (j = 0; j < 3; ++j)
+			{
+				pose_out->scale[j][i] = pose0->scale[j][i] * pose1->scale[j][i];
+				pose_out->translation[j][i] = pose0->translation[j][i] + pose1->translation[j][i];
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+// scale pose from identity
+a3i32 a3hierarchyPoseSoAScale(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3real u)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose_in))
+	{
+		a3real q[4], s[3], t[3];
+		a3ui32 i, j;
+		for (i = 0; i < pose_out->nodeCount; ++i)
+		{
+			a3hierarchyBlendInternalScaleNode(q, s, t, pose_in, i, u);
+			a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+			for (j = 0; j < 3; ++j)
+			{
+				pose_out->scale[j][i] = s[j];
+				pose_out->translation[j][i] = t[j];
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+// compose pose with scaled delta pose
+a3i32 a3hierarchyPoseSoAAdd(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3_HierarchyPoseSoA *delta, const a3real u)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose_in) && a3hierarchyBlendInternalMatch(pose_out, delta))
+	{
+		a3real q0[4], q1[4], q[4], s[3], t[3];
+		a3ui32 i, j;
+		for (i = 0; i < pose_out->nodeCount; ++i)
+		{
+			a3hierarchyBlendInternalScaleNode(q1, s, t, delta, i, u);
+			a3hierarchyBlendInternalGetOrientation(q0, pose_in, i);
+			a3quatProduct(q, q0, q1);
+			a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+			for (j = 0; j < 3; ++j)
+			{
+				pose_out->scale[j][i] = pose_in->scale[j][i] * s[j];
+				pose_out->translation[j][i] = pose_in->translation[j][i] + t[j];
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+// additive blend of difference between delta and reference poses
+a3i32 a3hierarchyPoseSoAAddDifference(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3_HierarchyPoseSoA *delta, const a3_HierarchyPoseSoA *reference, const a3real u, const a3real *mask_opt)
+{
+	if (a3hierarchyBlendInternalMatch(pose_out, pose_in) && a3hierarchyBlendInternalMatch(pose_out, delta) && a3hierarchyBlendInternalMatch(pose_out, reference))
+	{
+		a3ui32 i;
+#ifdef A3_HIERARCHY_SIMD
+		const __m128 uu = _mm_set1_ps(u), one = _mm_set1_ps(a3real_one), sign = _mm_set1_ps(-0.0f), zero = _mm_setzero_ps();
+		__m128 w, w1, a, q[4], qd[4], qr[4];
+		a3ui32 j;
+		for (i = 0; i < pose_out->nodeStride; i += 4)
+		{
+			w = a3hierarchyBlendInternalWeight4(uu, mask_opt, i);
+
+			// rotation from reference to delta, scaled from identity by 
+			//	weight on the shorter arc, then applied to input
+			for (j = 0; j < 4; ++j)
+			{
+				qd[j] = _mm_load_ps(delta->orientation[j] + i);
+				qr[j] = _mm_load_ps(reference->orientation[j] + i);
+			}
+			qr[0] = _mm_xor_ps(qr[0], sign);
+			qr[1] = _mm_xor_ps(qr[1], sign);
+			qr[2] = _mm_xor_ps(qr[2], sign);
+			a3hierarchyQuatProduct4(qd, qr, qd);
+			w1 = _mm_xor_ps(w, _mm_and_ps(_mm_cmplt_ps(qd[3], zero), sign));
+			qd[0] = _mm_mul_ps(w1, qd[0]);
+			qd[1] = _mm_mul_ps(w1, qd[1]);
+			qd[2] = _mm_mul_ps(w1, qd[2]);
+			qd[3] = _mm_add_ps(_mm_mul_ps(w1, qd[3]), _mm_sub_ps(one, w));
+			a3hierarchyBlendInternalNormalize4(qd);
+			for (j = 0; j < 4; ++j)
+				q[j] = _mm_load_ps(pose_in->orientation[j] + i);
+			a3hierarchyQuatProduct4(q, q, qd);
+			for (j = 0; j < 4; ++j)
+				_mm_store_ps(pose_out->orientation[j] + i, q[j]);
+
+			for (j = a3poseSoA_scale_x; j < a3poseSoA_channelCount; ++j)
+			{
+				a = _mm_sub_ps(_mm_load_ps(delta->channel[j] + i), _mm_load_ps(reference->channel[j] + i));
+				_mm_store_ps(pose_out->channel[j] + i, _mm_add_ps(_mm_load_ps(pose_in->channel[j] + i), _mm_mul_ps(w, a)));
+			}
+		}
+#else	// !A3_HIERARCHY_SIMD
+		for (i = 0; i < pose_out->nodeCount; ++i)
+			a3hierarchyBlendInternalAddDifferenceNode(pose_out, pose_in, delta, reference, i, mask_opt ? u * mask_opt[i] : u);
+#endif	// A3_HIERARCHY_SIMD
+		return pose_out->nodeCount;
+	}
+	return -1;
+}
+
+// barycentric blend
+a3i32 a3hierarchyPoseSoATriangular(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3_HierarchyPoseSoA *pose2, const a3real u1, const a3real u2)
+{
+	const a3_HierarchyPoseSoA *pose[3];
+	a3real u[3];
+	a3ui32 k, n;
+
+	// gather contributing inputs; the others are never touched
+	u[0] = a3hierarchyBlendInternalTriangularWeight0(u1, u2);
+	u[1] = u1;
+	u[2] = u2;
+	pose[0] = pose0;
+	pose[1] = pose1;
+	pose[2] = pose2;
+	for (k = n = 0; k < 3; ++k)
+		if (u[k] != a3real_zero)
+		{
+			if (!a3hierarchyBlendInternalMatch(pose_out, pose[k]))
+				return -1;
+			u[n] = u[k];
+			pose[n++] = pose[k];
+		}
+
+	if (pose_out && pose_out->data && n)
+	{
+		a3real q[4], q0[4], q1[4], w, s[3], t[3];
+		a3ui32 i, j;
+		for (i = 0; i < pose_out->nodeCount; ++i)
+		{
+			// weighted sum with every orientation on the first one's hemisphere
+			a3hierarchyBlendInternalGetOrientation(q0, pose[0], i);
+			for (j = 0; j < 4; ++j)
+				q[j] = u[0] * q0[j];
+			for (j = 0; j < 3; ++j)
+			{
+				s[j] = u[0] * pose[0]->scale[j][i];
+				t[j] = u[0] * pose[0]->translation[j][i];
+			}
+			for (k = 1; k < n; ++k)
+			{
+				a3hierarchyBlendInternalGetOrientation(q1, pose[k], i);
+				w = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3] < a3real_zero ? -u[k] : u[k];
+				for (j = 0; j < 4; ++j)
+					q[j] += w * q1[j];
+				for (j = 0; j < 3; ++j)
+				{
+					s[j] += u[k] * pose[k]->scale[j][i];
+					t[j] += u[k] * pose[k]->translation[j][i];
+				}
+			}
+			a3hierarchyBlendInternalNormalize(q);
+			a3hierarchyBlendInternalSetOrientation(pose_out, i, q);
+			for (j = 0; j < 3; ++j)
+			{
+				pose_out->scale[j][i] = s[j];
+				pose_out->translation[j][i] = t[j];
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// inputs and parameters read by each operation
+inline a3ui32 a3hierarchyBlendInternalInputCount(const a3_HierarchyBlendOp op)
+{
+	switch (op)
+	{
+	case a3blendOp_scale:
+		return 1;
+	case a3blendOp_lerp:
+	case a3blendOp_add:
+	case a3blendOp_concat:
+		return 2;
+	case a3blendOp_triangular:
+		return 3;
+	case a3blendOp_bilerp:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+inline a3ui32 a3hierarchyBlendInternalParamCount(const a3_HierarchyBlendOp op)
+{
+	switch (op)
+	{
+	case a3blendOp_lerp:
+	case a3blendOp_add:
+	case a3blendOp_scale:
+		return 1;
+	case a3blendOp_bilerp:
+	case a3blendOp_triangular:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+// validate subtree and count its instructions; a path longer than the 
+//	description can only come from a cycle
+inline a3i32 a3hierarchyBlendInternalCount(a3ui32 *stackDepth, const a3_HierarchyBlendNode *node, const a3ui32 nodeCount, const a3ui32 index, const a3ui32 slot, const a3ui32 depth)
+{
+	a3ui32 j, inputCount;
+	a3i32 count = 1, inputInstructionCount;
+	if (index >= nodeCount || depth >= nodeCount || (a3ui32)node[index].op >= a3blendOp_count)
+		return -1;
+	if (*stackDepth <= slot)
+		*stackDepth = slot + 1;
+	inputCount = a3hierarchyBlendInternalInputCount(node[index].op);
+	for (j = 0; j < inputCount; ++j)
+	{
+		inputInstructionCount = a3hierarchyBlendInternalCount(stackDepth, node, nodeCount, node[index].input[j], slot + j, depth + 1);
+		if (inputInstructionCount < 0)
+			return -1;
+		count += inputInstructionCount;
+	}
+	return count;
+}
+
+// emit subtree in post-order; input j of an instruction in slot s is 
+//	left in slot s + j, so the result can overwrite its first input
+inline a3ui32 a3hierarchyBlendInternalEmit(a3_HierarchyBlendTree *tree, const a3_HierarchyBlendNode *node, const a3ui32 index, const a3ui32 slot)
+{
+	a3_HierarchyBlendInstruction instruction = { 0 };
+	a3ui32 j, paramCount;
+	instruction.op = node[index].op;
+	instruction.slot = slot;
+	instruction.inputCount = a3hierarchyBlendInternalInputCount(instruction.op);
+	for (j = 0; j < instruction.inputCount; ++j)
+		instruction.input[j] = a3hierarchyBlendInternalEmit(tree, node, node[index].input[j], slot + j);
+	paramCount = a3hierarchyBlendInternalParamCount(instruction.op);
+	for (j = 0; j < paramCount; ++j)
+	{
+		instruction.param[j] = node[index].param[j];
+		if (tree->paramCount <= instruction.param[j])
+			tree->paramCount = instruction.param[j] + 1;
+	}
+	if (instruction.op == a3blendOp_sample)
+	{
+		instruction.source = node[index].source;
+		if (tree->sourceCount <= instruction.source)
+			tree->sourceCount = instruction.source + 1;
+	}
+	tree->instruction[tree->instructionCount] = instruction;
+	return tree->instructionCount++;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// compile blend tree
+a3i32 a3hierarchyBlendTreeCreate(a3_HierarchyBlendTree *tree_out, const a3_HierarchyBlendNode *node, const a3ui32 nodeCount, const a3ui32 rootIndex)
+{
+	if (tree_out && !tree_out->instruction && node && nodeCount)
+	{
+		a3ui32 stackDepth = 0;
+		const a3i32 count = a3hierarchyBlendInternalCount(&stackDepth, node, nodeCount, rootIndex, 0, 0);
+		if (count <= 0)
+			return -1;
+
+		tree_out->instruction = (a3_HierarchyBlendInstruction *)malloc(sizeof(a3_HierarchyBlendInstruction) * count);
+		if (!tree_out->instruction)
+			return -1;
+		tree_out->instructionCount = 0;
+		tree_out->stackDepth = stackDepth;
+		tree_out->sourceCount = tree_out->paramCount = 0;
+		a3hierarchyBlendInternalEmit(tree_out, node, rootIndex, 0);
+
+		// done
+		return count;
+	}
+	return -1;
+}
+
+// release blend tree
+a3i32 a3hierarchyBlendTreeRelease(a3_HierarchyBlendTree *tree)
+{
+	if (tree && tree->instruction)
+	{
+		free(tree->instruction);
+		tree->instruction = 0;
+		tree->instructionCount = tree->stackDepth = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// create scratch stack
+a3i32 a3hierarchyBlendStackCreate(a3_HierarchyBlendStack *stack_out, const a3ui32 nodeCount, const a3ui32 depth, const a3ui32 instructionMax)
+{
+	if (stack_out && !stack_out->data && nodeCount && depth && instructionMax)
+	{
+		const size_t dataSize = sizeof(a3_HierarchyPoseSoA) * depth + instructionMax;
+		a3ui32 i;
+
+		stack_out->data = malloc(dataSize);
+		if (!stack_out->data)
+			return -1;
+		memset(stack_out->data, 0, dataSize);
+		stack_out->pose = (a3_HierarchyPoseSoA *)stack_out->data;
+		stack_out->live = (a3ubyte *)(stack_out->pose + depth);
+		stack_out->depth = depth;
+		stack_out->instructionMax = instructionMax;
+		for (i = 0; i < depth; ++i)
+			if (a3hierarchyPoseSoACreate(stack_out->pose + i, nodeCount) < 0)
+			{
+				a3hierarchyBlendStackRelease(stack_out);
+				return -1;
+			}
+		return depth;
+	}
+	return -1;
+}
+
+// release scratch stack
+a3i32 a3hierarchyBlendStackRelease(a3_HierarchyBlendStack *stack)
+{
+	if (stack && stack->data)
+	{
+		a3ui32 i;
+		for (i = 0; i < stack->depth; ++i)
+			if (stack->pose[i].data)
+				a3hierarchyPoseSoARelease(stack->pose + i);
+		free(stack->data);
+		stack->data = 0;
+		stack->pose = 0;
+		stack->live = 0;
+		stack->depth = stack->instructionMax = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// root first, mark inputs that contribute under the current weights; 
+//	everything below a dead input stays dead
+inline void a3hierarchyBlendInternalMarkLive(a3ubyte *live, const a3_HierarchyBlendTree *tree, const a3real *param)
+{
+	const a3_HierarchyBlendInstruction *instruction;
+	a3real u, v;
+	a3ui32 i;
+
+	memset(live, 0, tree->instructionCount);
+	live[tree->instructionCount - 1] = 1;
+	for (i = tree->instructionCount, instruction = tree->instruction + i - 1; i > 0; --i, --instruction)
+	{
+		if (!live[i - 1])
+			continue;
+		switch (instruction->op)
+		{
+		case a3blendOp_lerp:
+			u = param[instruction->param[0]];
+			live[instruction->input[0]] = u < a3real_one;
+			live[instruction->input[1]] = u > a3real_zero;
+			break;
+		case a3blendOp_add:
+			live[instruction->input[0]] = 1;
+			live[instruction->input[1]] = param[instruction->param[0]] != a3real_zero;
+			break;
+		case a3blendOp_scale:
+			live[instruction->input[0]] = param[instruction->param[0]] != a3real_zero;
+			break;
+		case a3blendOp_concat:
+			live[instruction->input[0]] = live[instruction->input[1]] = 1;
+			break;
+		case a3blendOp_bilerp:
+			u = param[instruction->param[0]];
+			v = param[instruction->param[1]];
+			live[instruction->input[0]] = u < a3real_one && v < a3real_one;
+			live[instruction->input[1]] = u > a3real_zero && v < a3real_one;
+			live[instruction->input[2]] = u < a3real_one && v > a3real_zero;
+			live[instruction->input[3]] = u > a3real_zero && v > a3real_zero;
+			break;
+		case a3blendOp_triangular:
+			u = param[instruction->param[0]];
+			v = param[instruction->param[1]];
+			live[instruction->input[0]] = a3hierarchyBlendInternalTriangularWeight0(u, v) != a3real_zero;
+			live[instruction->input[1]] = u != a3real_zero;
+			live[instruction->input[2]] = v != a3real_zero;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+// interpolate into first pose; endpoints copy or do nothing
+inline void a3hierarchyBlendInternalLerp(const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u)
+{
+	if (u >= a3real_one)
+		a3hierarchyPoseSoACopy(pose0, pose1);
+	else if (u > a3real_zero)
+		a3hierarchyPoseSoALerp(pose0, pose0, pose1, u);
+}
+
+// evaluate blend tree
+a3i32 a3hierarchyBlendTreeEvaluate(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyBlendTree *tree, const a3_HierarchyBlendStack *stack, const a3_HierarchyBlendSource *source, const a3real *param)
+{
+	if (pose_out && pose_out->data && tree && tree->instruction && stack && stack->data && source && (param || !tree->paramCount) &&
+		tree->stackDepth <= stack->depth && tree->instructionCount <= stack->instructionMax && pose_out->nodeCount == stack->pose->nodeCount)
+	{
+		const a3_HierarchyBlendInstruction *instruction;
+		const a3_HierarchyPoseSoA *pose;
+		a3ubyte *live = stack->live;
+		a3real u, v;
+		a3ui32 i;
+		a3i32 sampled = 0;
+
+		a3hierarchyBlendInternalMarkLive(live, tree, param);
+
+		// execute live instructions in order; lerp weights are clamped, 
+		//	which is what makes their endpoints prunable
+		for (i = 0, instruction = tree->instruction; i < tree->instructionCount; ++i, ++instruction)
+		{
+			if (!live[i])
+				continue;
+			pose = stack->pose + instruction->slot;
+			switch (instruction->op)
+			{
+			case a3blendOp_sample:
+				a3hierarchyBlendSourceSample(pose, source + instruction->source);
+				++sampled;
+				break;
+			case a3blendOp_lerp:
+				a3hierarchyBlendInternalLerp(pose, pose + 1, param[instruction->param[0]]);
+				break;
+			case a3blendOp_add:
+				u = param[instruction->param[0]];
+				if (u != a3real_zero)
+					a3hierarchyPoseSoAAdd(pose, pose, pose + 1, u);
+				break;
+			case a3blendOp_scale:
+				u = param[instruction->param[0]];
+				if (u == a3real_zero)
+					a3hierarchyPoseSoAIdentity(pose);
+				else if (u != a3real_one)
+					a3hierarchyPoseSoAScale(pose, pose, u);
+				break;
+			case a3blendOp_concat:
+				a3hierarchyPoseSoAConcat(pose, pose, pose + 1);
+				break;
+			case a3blendOp_bilerp:
+				u = param[instruction->param[0]];
+				v = param[instruction->param[1]];
+				if (v < a3real_one)
+					a3hierarchyBlendInternalLerp(pose, pose + 1, u);
+				if (v > a3real_zero)
+				{
+					a3hierarchyBlendInternalLerp(pose + 2, pose + 3, u);
+					a3hierarchyBlendInternalLerp(pose, pose + 2, v);
+				}
+				break;
+			case a3blendOp_triangular:
+				a3hierarchyPoseSoATriangular(pose, pose, pose + 1, pose + 2, param[instruction->param[0]], param[instruction->param[1]]);
+				break;
+			default:
+				break;
+			}
+		}
+
+		// root result is in the bottom slot
+		a3hierarchyPoseSoACopy(pose_out, stack->pose);
+		return sampled;
+	}
+	return -1;
+}
+
+// interpolate into separate output; endpoints copy
+inline void a3hierarchyBlendInternalLerpTo(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u)
+{
+	if (u <= a3real_zero)
+		a3hierarchyPoseSoACopy(pose_out, pose0);
+	else if (u >= a3real_one)
+		a3hierarchyPoseSoACopy(pose_out, pose1);
+	else
+		a3hierarchyPoseSoALerp(pose_out, pose0, pose1, u);
+}
+
+// cached result still valid: same source or parameters (within 
+//	tolerance) and every live input unchanged since it was computed
+inline a3boolean a3hierarchyBlendInternalCacheHit(const a3_HierarchyBlendCache *cache, const a3_HierarchyBlendInstruction *instruction, const a3_HierarchyBlendCacheEntry *entry, const a3_HierarchyBlendSource *source, const a3real *param)
+{
+	const a3ui32 paramCount = a3hierarchyBlendInternalParamCount(instruction->op);
+	a3ui32 j;
+	if (!entry->generation)
+		return a3false;
+	if (instruction->op == a3blendOp_sample)
+		return (source->poseGroup == entry->poseGroup && source->pose0 == entry->pose0 && source->pose1 == entry->pose1 &&
+			a3absolute(source->param - entry->param[0]) <= cache->tolerance);
+	for (j = 0; j < paramCount; ++j)
+		if (a3absolute(param[instruction->param[j]] - entry->param[j]) > cache->tolerance)
+			return a3false;
+	for (j = 0; j < instruction->inputCount; ++j)
+		if (cache->live[instruction->input[j]] && cache->entry[instruction->input[j]].generation != entry->inputGeneration[j])
+			return a3false;
+	return a3true;
+}
+
+// recompute one result from its inputs' cached results and record key
+inline void a3hierarchyBlendInternalCacheUpdate(const a3_HierarchyBlendCache *cache, const a3_HierarchyBlendInstruction *instruction, a3_HierarchyBlendCacheEntry *entry, const a3_HierarchyBlendSource *source, const a3real *param)
+{
+	const a3_HierarchyPoseSoA *pose = cache->pose + (entry - cache->entry);
+	const a3_HierarchyPoseSoA *input[a3blendTree_inputMax];
+	const a3ui32 paramCount = a3hierarchyBlendInternalParamCount(instruction->op);
+	a3real u = a3real_zero, v = a3real_zero;
+	a3ui32 j;
+
+	for (j = 0; j < instruction->inputCount; ++j)
+	{
+		input[j] = cache->pose + instruction->input[j];
+		entry->inputGeneration[j] = cache->live[instruction->input[j]] ? cache->entry[instruction->input[j]].generation : 0;
+	}
+	for (j = 0; j < paramCount; ++j)
+		entry->param[j] = param[instruction->param[j]];
+	if (paramCount > 0)
+		u = entry->param[0];
+	if (paramCount > 1)
+		v = entry->param[1];
+
+	switch (instruction->op)
+	{
+	case a3blendOp_sample:
+		a3hierarchyBlendSourceSample(pose, source);
+		entry->poseGroup = source->poseGroup;
+		entry->pose0 = source->pose0;
+		entry->pose1 = source->pose1;
+		entry->param[0] = source->param;
+		break;
+	case a3blendOp_lerp:
+		a3hierarchyBlendInternalLerpTo(pose, input[0], input[1], u);
+		break;
+	case a3blendOp_add:
+		if (u != a3real_zero)
+			a3hierarchyPoseSoAAdd(pose, input[0], input[1], u);
+		else
+			a3hierarchyPoseSoACopy(pose, input[0]);
+		break;
+	case a3blendOp_scale:
+		if (u == a3real_zero)
+			a3hierarchyPoseSoAIdentity(pose);
+		else
+			a3hierarchyPoseSoAScale(pose, input[0], u);
+		break;
+	case a3blendOp_concat:
+		a3hierarchyPoseSoAConcat(pose, input[0], input[1]);
+		break;
+	case a3blendOp_bilerp:
+		if (v <= a3real_zero)
+			a3hierarchyBlendInternalLerpTo(pose, input[0], input[1], u);
+		else if (v >= a3real_one)
+			a3hierarchyBlendInternalLerpTo(pose, input[2], input[3], u);
+		else
+		{
+			a3hierarchyBlendInternalLerpTo(pose, input[0], input[1], u);
+			a3hierarchyBlendInternalLerpTo(cache->scratch, input[2], input[3], u);
+			a3hierarchyPoseSoALerp(pose, pose, cache->scratch, v);
+		}
+		break;
+	case a3blendOp_triangular:
+		a3hierarchyPoseSoATriangular(pose, input[0], input[1], input[2], u, v);
+		break;
+	default:
+		break;
+	}
+
+	// zero marks an empty entry
+	if (!++entry->generation)
+		entry->generation = 1;
+}
+
+// create blend cache
+a3i32 a3hierarchyBlendCacheCreate(a3_HierarchyBlendCache *cache_out, const a3_HierarchyBlendTree *tree, const a3ui32 nodeCount, const a3real tolerance)
+{
+	if (cache_out && !cache_out->data && tree && tree->instruction && nodeCount)
+	{
+		const a3ui32 count = tree->instructionCount;
+		const size_t dataSize = sizeof(a3_HierarchyPoseSoA) * (count + 1) + sizeof(a3_HierarchyBlendCacheEntry) * count + count;
+		a3ui32 i;
+
+		cache_out->data = malloc(dataSize);
+		if (!cache_out->data)
+			return -1;
+		memset(cache_out->data, 0, dataSize);
+		cache_out->pose = (a3_HierarchyPoseSoA *)cache_out->data;
+		cache_out->scratch = cache_out->pose + count;
+		cache_out->entry = (a3_HierarchyBlendCacheEntry *)(cache_out->scratch + 1);
+		cache_out->live = (a3ubyte *)(cache_out->entry + count);
+		cache_out->tree = tree;
+		cache_out->instructionCount = count;
+		cache_out->tolerance = tolerance;
+		cache_out->hitCount = cache_out->missCount = 0;
+		for (i = 0; i <= count; ++i)
+			if (a3hierarchyPoseSoACreate(cache_out->pose + i, nodeCount) < 0)
+			{
+				a3hierarchyBlendCacheRelease(cache_out);
+				return -1;
+			}
+		return count;
+	}
+	return -1;
+}
+
+// release blend cache
+a3i32 a3hierarchyBlendCacheRelease(a3_HierarchyBlendCache *cache)
+{
+	if (cache && cache->data)
+	{
+		a3ui32 i;
+		for (i = 0; i <= cache->instructionCount; ++i)
+			if (cache->pose[i].data)
+				a3hierarchyPoseSoARelease(cache->pose + i);
+		free(cache->data);
+		cache->data = 0;
+		cache->pose = cache->scratch = 0;
+		cache->entry = 0;
+		cache->live = 0;
+		cache->tree = 0;
+		cache->instructionCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// discard all cached results
+a3i32 a3hierarchyBlendCacheInvalidate(a3_HierarchyBlendCache *cache)
+{
+	if (cache && cache->data)
+	{
+		a3ui32 i;
+		for (i = 0; i < cache->instructionCount; ++i)
+			cache->entry[i].generation = 0;
+		return i;
+	}
+	return -1;
+}
+
+// evaluate blend tree through cache
+a3i32 a3hierarchyBlendTreeEvaluateCached(const a3_HierarchyPoseSoA *pose_out, a3_HierarchyBlendCache *cache, const a3_HierarchyBlendSource *source, const a3real *param)
+{
+	if (pose_out && pose_out->data && cache && cache->data && source && (param || !cache->tree->paramCount) &&
+		pose_out->nodeCount == cache->pose->nodeCount && cache->tree->instructionCount == cache->instructionCount)
+	{
+		const a3_HierarchyBlendTree *tree = cache->tree;
+		const a3_HierarchyBlendInstruction *instruction;
+		a3_HierarchyBlendCacheEntry *entry;
+		a3ui32 i;
+		a3i32 computed = 0;
+
+		a3hierarchyBlendInternalMarkLive(cache->live, tree, param);
+
+		// post-order: inputs settle their generations before the 
+		//	instructions that read them are checked
+		for (i = 0, instruction = tree->instruction, entry = cache->entry; i < tree->instructionCount; ++i, ++instruction, ++entry)
+		{
+			if (!cache->live[i])
+				continue;
+			if (a3hierarchyBlendInternalCacheHit(cache, instruction, entry, source + instruction->source, param))
+				++cache->hitCount;
+			else
+			{
+				a3hierarchyBlendInternalCacheUpdate(cache, instruction, entry, source + instruction->source, param);
+				++cache->missCount;
+				++computed;
+			}
+		}
+
+		a3hierarchyPoseSoACopy(pose_out, cache->pose + tree->instructionCount - 1);
+		return computed;
+	}
+	return -1;
+}
+
+// sample source into pose
+a3i32 a3hierarchyBlendSourceSample(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyBlendSource *source)
+{
+	if (pose_out && pose_out->data && source && source->poseGroup &&
+		source->pose0 < source->poseGroup->hposeCount && source->pose1 < source->poseGroup->hposeCount &&
+		pose_out->nodeCount == source->poseGroup->hierarchy->numNodes)
+	{
+		const a3_SpatialPose *spatialPose0 = source->poseGroup->hpose[source->pose0].spatialPose;
+		const a3_SpatialPose *spatialPose1 = source->poseGroup->hpose[source->pose1].spatialPose;
+		const a3real u = source->param;
+		a3real q[4];
+		a3ui32 i, j;
+
+		// either key alone is a plain store
+		if (u <= a3real_zero || source->pose0 == source->pose1)
+			return a3hierarchyPoseSoAStore(pose_out, source->poseGroup->hpose + source->pose0);
+		if (u >= a3real_one)
+			return a3hierarchyPoseSoAStore(pose_out, source->poseGroup->hpose + source->pose1);
+
+		for (i = 0; i < pose_out->nodeCount; ++i, ++spatialPose0, ++spatialPose1)
+		{
+			a3hierarchyBlendInternalNlerp(q, spatialPose0->orientation.v, spatialPose1->orientation.v, u);
+			for (j = 0; j < 4; ++j)
+				pose_out->orientation[j][i] = q[j];
+			for (j = 0; j < 3; ++j)
+			{
+				pose_out->scale[j][i] = spatialPose0->scale.v[j] + u * (spatialPose1->scale.v[j] - spatialPose0->scale.v[j]);
+				pose_out->translation[j][i] = spatialPose0->translation.v[j] + u * (spatialPose1->translation.v[j] - spatialPose0->translation.v[j]);
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// rebuild index list of nodes with non-zero weight
+inline a3ui32 a3hierarchyBlendInternalMaskCompile(a3_HierarchyBlendMask *mask)
+{
+	a3ui32 i;
+	for (i = mask->indexCount = 0; i < mask->hierarchy->numNodes; ++i)
+		if (mask->weight[i] != a3real_zero)
+			mask->index[mask->indexCount++] = i;
+	return mask->indexCount;
+}
+
+// create mask
+a3i32 a3hierarchyBlendMaskCreate(a3_HierarchyBlendMask *mask_out, const a3_Hierarchy *hierarchy, const a3byte name[a3node_nameSize])
+{
+	if (mask_out && !mask_out->data && hierarchy && hierarchy->numNodes)
+	{
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		const a3ui32 nodeStride = (nodeCount + a3poseSoA_nodeAlign - 1) / a3poseSoA_nodeAlign * a3poseSoA_nodeAlign;
+		const size_t dataSize = sizeof(a3real) * nodeStride + sizeof(a3ui32) * nodeCount;
+
+		mask_out->data = malloc(dataSize);
+		if (!mask_out->data)
+			return -1;
+		memset(mask_out->data, 0, dataSize);
+		mask_out->weight = (a3real *)mask_out->data;
+		mask_out->index = (a3ui32 *)(mask_out->weight + nodeStride);
+		mask_out->indexCount = 0;
+		mask_out->hierarchy = hierarchy;
+		strncpy(mask_out->name, name ? name : "", a3node_nameSize);
+		mask_out->name[a3node_nameSize - 1] = 0;
+		return nodeCount;
+	}
+	return -1;
+}
+
+// release mask
+a3i32 a3hierarchyBlendMaskRelease(a3_HierarchyBlendMask *mask)
+{
+	if (mask && mask->data)
+	{
+		free(mask->data);
+		mask->data = 0;
+		mask->weight = 0;
+		mask->index = 0;
+		mask->indexCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// set weight of one node
+a3i32 a3hierarchyBlendMaskSetNode(a3_HierarchyBlendMask *mask, const a3ui32 nodeIndex, const a3real weight)
+{
+	if (mask && mask->data && nodeIndex < mask->hierarchy->numNodes)
+	{
+		mask->weight[nodeIndex] = weight;
+		a3hierarchyBlendInternalMaskCompile(mask);
+		return 1;
+	}
+	return -1;
+}
+
+// set weight of subtree
+a3i32 a3hierarchyBlendMaskSetSubtree(a3_HierarchyBlendMask *mask, const a3ui32 rootIndex, const a3real weight)
+{
+	if (mask && mask->data && rootIndex < mask->hierarchy->numNodes)
+	{
+		// parents precede children: a node is in the subtree if its parent 
+		//	is; the index list doubles as membership flags until recompiled
+		const a3_HierarchyNode *node = mask->hierarchy->nodes;
+		a3ui32 *member = mask->index;
+		a3ui32 i, count = 1;
+		a3i32 parentIndex;
+		member[rootIndex] = 1;
+		mask->weight[rootIndex] = weight;
+		for (i = rootIndex + 1; i < mask->hierarchy->numNodes; ++i)
+		{
+			parentIndex = node[i].parentIndex;
+			member[i] = parentIndex >= (a3i32)rootIndex && member[parentIndex];
+			if (member[i])
+			{
+				mask->weight[i] = weight;
+				++count;
+			}
+		}
+		a3hierarchyBlendInternalMaskCompile(mask);
+		return count;
+	}
+	return -1;
+}
+
+// apply layer with mask
+a3i32 a3hierarchyPoseSoALayer(const a3_HierarchyPoseSoA *pose_inout, const a3_HierarchyPoseSoA *layer, const a3_HierarchyPoseSoA *reference_opt, const a3_HierarchyBlendMask *mask, const a3real u, const a3_HierarchyBlendLayerMode mode)
+{
+	if (a3hierarchyBlendInternalMatch(pose_inout, layer) && mask && mask->data && mask->hierarchy->numNodes == pose_inout->nodeCount &&
+		(mode == a3blendLayer_override || a3hierarchyBlendInternalMatch(pose_inout, reference_opt)))
+	{
+		const a3ui32 *index = mask->index, *const indexEnd = index + mask->indexCount;
+		a3real w;
+
+		// nothing to do
+		if (u == a3real_zero || !mask->indexCount)
+			return 0;
+
+		// mask covers every node: dense vector kernels
+		if (mask->indexCount == pose_inout->nodeCount)
+		{
+			if (mode == a3blendLayer_override)
+				a3hierarchyBlendInternalLerpPose(pose_inout, pose_inout, layer, u, mask->weight);
+			else
+				a3hierarchyPoseSoAAddDifference(pose_inout, pose_inout, layer, reference_opt, u, mask->weight);
+			return mask->indexCount;
+		}
+
+		// sparse: visit masked nodes only
+		if (mode == a3blendLayer_override)
+			for (; index < indexEnd; ++index)
+			{
+				w = u * mask->weight[*index];
+				if (w == a3real_one)
+					a3hierarchyBlendInternalCopyNode(pose_inout, layer, *index);
+				else
+					a3hierarchyBlendInternalLerpNode(pose_inout, pose_inout, layer, *index, w);
+			}
+		else
+			for (; index < indexEnd; ++index)
+				a3hierarchyBlendInternalAddDifferenceNode(pose_inout, pose_inout, layer, reference_opt, *index, u * mask->weight[*index]);
+		return mask->indexCount;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -65,7 +65,7 @@ a3i32 a3keyframeInit(a3_Keyframe* keyframe_out, const a3real duration, const a3u
 	if (!keyframe_out || duration <= 0) return -1;
 	// set keyframe values
 	keyframe_out->duration = duration;
-	keyframe_out->duration_inverse = duration / 1.0f;
+	keyframe_out->duration_inverse = 1.0f / duration;
 	keyframe_out->data = value_x;
 
 	return 1;
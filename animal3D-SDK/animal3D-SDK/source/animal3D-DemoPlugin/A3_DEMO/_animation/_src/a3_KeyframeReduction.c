@@ -0,0 +1,494 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_KeyframeReduction.c
+	Implementation of keyframe reduction.
+*/
+
+#include "../a3_KeyframeReduction.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// channel of node in pose
+inline const a3real *a3keyframeReductionInternalChannel(const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex, const a3ui32 nodeIndex, const a3ui32 track)
+{
+	const a3_SpatialPose *spatialPose = poseGroup->hpose[poseIndex].spatialPose + nodeIndex;
+	return (track == a3keyframeReduction_orientation ? spatialPose->orientation.v :
+		track == a3keyframeReduction_scale ? spatialPose->scale.v : spatialPose->translation.v);
+}
+
+// interpolate channel the way the blend kernels do: orientation is 
+//	nlerp along the shorter arc, others are linear
+inline void a3keyframeReductionInternalLerp(a3real *v_out, const a3real *v0, const a3real *v1, const a3real u, const a3ui32 track)
+{
+	a3real d, u0, u1;
+	if (track == a3keyframeReduction_orientation)
+	{
+		d = v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2] + v0[3] * v1[3];
+		u0 = a3real_one - u;
+		u1 = d < a3real_zero ? -u : u;
+		v_out[0] = u0 * v0[0] + u1 * v1[0];
+		v_out[1] = u0 * v0[1] + u1 * v1[1];
+		v_out[2] = u0 * v0[2] + u1 * v1[2];
+		v_out[3] = u0 * v0[3] + u1 * v1[3];
+		d = v_out[0] * v_out[0] + v_out[1] * v_out[1] + v_out[2] * v_out[2] + v_out[3] * v_out[3];
+		if (d > a3real_zero)
+		{
+			d = a3recip(a3sqrt(d));
+			v_out[0] *= d;
+			v_out[1] *= d;
+			v_out[2] *= d;
+			v_out[3] *= d;
+		}
+	}
+	else
+	{
+		v_out[0] = v0[0] + u * (v1[0] - v0[0]);
+		v_out[1] = v0[1] + u * (v1[1] - v0[1]);
+		v_out[2] = v0[2] + u * (v1[2] - v0[2]);
+		v_out[3] = a3real_zero;
+	}
+}
+
+// error of channel value: angle in radians (4 asin(|q0 - q1| / 2) on 
+//	the same hemisphere), largest scale component, translation distance
+inline a3real a3keyframeReductionInternalError(const a3real *v, const a3real *source, const a3ui32 track)
+{
+	a3real d, e, s;
+	a3ui32 j;
+	if (track == a3keyframeReduction_orientation)
+	{
+		d = v[0] * source[0] + v[1] * source[1] + v[2] * source[2] + v[3] * source[3];
+		s = d < a3real_zero ? -a3real_one : a3real_one;
+		for (j = 0, e = a3real_zero; j < 4; ++j)
+		{
+			d = v[j] - s * source[j];
+			e += d * d;
+		}
+		return (a3asind(a3minimum(a3sqrt(e) * a3real_half, a3real_one)) * a3real_four * a3real_deg2rad);
+	}
+	if (track == a3keyframeReduction_scale)
+	{
+		for (j = 0, e = a3real_zero; j < 3; ++j)
+			e = a3maximum(e, a3absolute(v[j] - source[j]));
+		return e;
+	}
+	for (j = 0, e = a3real_zero; j < 3; ++j)
+	{
+		d = v[j] - source[j];
+		e += d * d;
+	}
+	return a3sqrt(e);
+}
+
+// reduce one track: a constant track keeps its first frame only; 
+//	otherwise each key reaches as far forward as every frame in between 
+//	stays within tolerance, and the last frame is always kept
+a3ui32 a3keyframeReductionInternalReduceTrack(a3ui32 *keyFrame_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 frameCount, const a3ui32 nodeIndex, const a3ui32 track, const a3real tolerance)
+{
+	const a3real *v0 = a3keyframeReductionInternalChannel(poseGroup, firstPose, nodeIndex, track), *v1;
+	a3real v[4];
+	a3ui32 keyCount = 1, k = 0, j, m;
+	a3boolean fits;
+
+	keyFrame_out[0] = 0;
+	for (m = 1, fits = a3true; m < frameCount && fits; ++m)
+		fits = (a3keyframeReductionInternalError(v0, a3keyframeReductionInternalChannel(poseGroup, firstPose + m, nodeIndex, track), track) <= tolerance);
+	if (fits)
+		return keyCount;
+
+	for (j = 2; j < frameCount; ++j)
+	{
+		v1 = a3keyframeReductionInternalChannel(poseGroup, firstPose + j, nodeIndex, track);
+		for (m = k + 1, fits = a3true; m < j && fits; ++m)
+		{
+			a3keyframeReductionInternalLerp(v, v0, v1, (a3real)(m - k) / (a3real)(j - k), track);
+			fits = (a3keyframeReductionInternalError(v, a3keyframeReductionInternalChannel(poseGroup, firstPose + m, nodeIndex, track), track) <= tolerance);
+		}
+		if (!fits)
+		{
+			k = j - 1;
+			keyFrame_out[keyCount++] = k;
+			v0 = a3keyframeReductionInternalChannel(poseGroup, firstPose + k, nodeIndex, track);
+		}
+	}
+	keyFrame_out[keyCount++] = frameCount - 1;
+	return keyCount;
+}
+
+// per-node tolerances from object-space budget; tolerance holds 
+//	(orientation, scale, translation) per node
+a3i32 a3keyframeReductionInternalTolerance(a3real *tolerance_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 frameCount, const a3real positionTolerance, const a3real angleTolerance)
+{
+	const a3_Hierarchy *hierarchy = poseGroup->hierarchy;
+	const a3ui32 nodeCount = hierarchy->numNodes;
+	a3_HierarchyState state[1] = { 0 };
+	const a3_SpatialPose *objectPose;
+	a3ui32 *depth, *height;
+	a3real *reach, *parentScale, share, shareAngle, d, dx, dy, dz;
+	a3ui32 f, i, c, j;
+	a3i32 parentIndex;
+
+	depth = (a3ui32 *)malloc((sizeof(a3ui32) * 2 + sizeof(a3real) * 2) * nodeCount);
+	if (!depth)
+		return -1;
+	if (a3hierarchyStateCreate(state, poseGroup) < 0)
+	{
+		free(depth);
+		return -1;
+	}
+	height = depth + nodeCount;
+	reach = (a3real *)(height + nodeCount);
+	parentScale = reach + nodeCount;
+
+	// longest chain through each node: parents precede children, so 
+	//	depth accumulates forward and height backward
+	for (i = 0; i < nodeCount; ++i)
+	{
+		parentIndex = hierarchy->nodes[i].parentIndex;
+		depth[i] = parentIndex >= 0 ? depth[parentIndex] + 1 : 0;
+		height[i] = 0;
+		reach[i] = a3real_zero;
+		parentScale[i] = a3real_one;
+	}
+	for (i = nodeCount; i > 0; --i)
+	{
+		parentIndex = hierarchy->nodes[i - 1].parentIndex;
+		if (parentIndex >= 0)
+			height[parentIndex] = a3maximum(height[parentIndex], height[i - 1] + 1);
+	}
+
+	// over the capture: furthest descendant of each node and largest 
+	//	scale of each node's parent space
+	for (f = 0; f < frameCount; ++f)
+	{
+		a3hierarchyPoseCopy(state->localHPose, poseGroup->hpose + firstPose + f, nodeCount);
+		a3kinematicsSolveForward(state);
+		objectPose = state->objectHPose->spatialPose;
+		for (i = 0; i < nodeCount; ++i)
+		{
+			for (c = i + 1; c < state->subtreeEnd[i]; ++c)
+			{
+				dx = objectPose[c].transform.m[3][0] - objectPose[i].transform.m[3][0];
+				dy = objectPose[c].transform.m[3][1] - objectPose[i].transform.m[3][1];
+				dz = objectPose[c].transform.m[3][2] - objectPose[i].transform.m[3][2];
+				reach[i] = a3maximum(reach[i], a3sqrt(dx * dx + dy * dy + dz * dz));
+			}
+			parentIndex = hierarchy->nodes[i].parentIndex;
+			if (parentIndex >= 0)
+				for (j = 0; j < 3; ++j)
+				{
+					d = a3real3Length(objectPose[parentIndex].transform.m[j]);
+					parentScale[i] = a3maximum(parentScale[i], d);
+				}
+		}
+	}
+
+	// node's share is a third each for orientation, scale and translation 
+	//	of its position budget; orientation is also held to its angle 
+	//	budget, as is scale of a leaf, which moves no other node
+	for (i = 0; i < nodeCount; ++i, tolerance_out += a3keyframeReduction_trackCount)
+	{
+		d = (a3real)(depth[i] + height[i] + 1);
+		share = positionTolerance / d * a3real_third;
+		shareAngle = angleTolerance / d;
+		if (reach[i] > a3real_zero)
+		{
+			tolerance_out[a3keyframeReduction_orientation] = a3minimum(shareAngle, share / reach[i]);
+			tolerance_out[a3keyframeReduction_scale] = share / reach[i];
+		}
+		else
+			tolerance_out[a3keyframeReduction_orientation] = tolerance_out[a3keyframeReduction_scale] = shareAngle;
+		tolerance_out[a3keyframeReduction_translation] = share / parentScale[i];
+	}
+
+	a3hierarchyStateRelease(state);
+	free(depth);
+	return nodeCount;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// reduce capture
+a3i32 a3keyframeReductionCreate(a3_KeyframeReduction *reduction_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 frameCount, const a3real frameDuration, const a3real positionTolerance, const a3real angleTolerance_degrees)
+{
+	if (reduction_out && !reduction_out->data && poseGroup && poseGroup->hierarchy && frameCount &&
+		firstPose + frameCount <= poseGroup->hposeCount && frameDuration > a3real_zero &&
+		positionTolerance >= a3real_zero && angleTolerance_degrees >= a3real_zero)
+	{
+		const a3_Hierarchy *hierarchy = poseGroup->hierarchy;
+		const a3ui32 nodeCount = hierarchy->numNodes, trackCount = nodeCount * a3keyframeReduction_trackCount;
+		a3ui32 *keyFrame, *trackKeyCount, keyCount, t, k, f, key;
+		a3real *tolerance;
+		a3_Keyframe *keyframe;
+		a3_Clip *clip;
+
+		// scratch: kept frames of every track, key count per track, 
+		//	tolerance per track
+		keyFrame = (a3ui32 *)malloc((sizeof(a3ui32) * (frameCount + 1) + sizeof(a3real)) * trackCount);
+		if (!keyFrame)
+			return -1;
+		trackKeyCount = keyFrame + trackCount * frameCount;
+		tolerance = (a3real *)(trackKeyCount + trackCount);
+		if (a3keyframeReductionInternalTolerance(tolerance, poseGroup, firstPose, frameCount, positionTolerance, angleTolerance_degrees * a3real_deg2rad) < 0)
+		{
+			free(keyFrame);
+			return -1;
+		}
+		for (t = keyCount = 0; t < trackCount; ++t)
+		{
+			trackKeyCount[t] = a3keyframeReductionInternalReduceTrack(keyFrame + t * frameCount, poseGroup, firstPose, frameCount,
+				t / a3keyframeReduction_trackCount, t % a3keyframeReduction_trackCount, tolerance[t]);
+			keyCount += trackKeyCount[t];
+		}
+
+		// keys, tracks, values and times
+		memset(reduction_out->keyframePool, 0, sizeof(a3_KeyframePool));
+		memset(reduction_out->trackPool, 0, sizeof(a3_ClipPool));
+		a3keyframePoolCreate(reduction_out->keyframePool, keyCount);
+		a3clipPoolCreate(reduction_out->trackPool, trackCount);
+		reduction_out->data = malloc(sizeof(a3real) * 5 * keyCount);
+		if (!reduction_out->keyframePool->keyframe || !reduction_out->trackPool->clip || !reduction_out->data)
+		{
+			free(reduction_out->keyframePool->keyframe);
+			free(reduction_out->trackPool->clip);
+			free(reduction_out->data);
+			reduction_out->data = 0;
+			free(keyFrame);
+			return -1;
+		}
+		reduction_out->keyValue = (a3real *)reduction_out->data;
+		reduction_out->keyTime = reduction_out->keyValue + keyCount * 4;
+		reduction_out->hierarchy = hierarchy;
+		reduction_out->nodeCount = nodeCount;
+		reduction_out->frameCount = frameCount;
+		reduction_out->keyCount = keyCount;
+		reduction_out->frameDuration = frameDuration;
+		reduction_out->duration = frameDuration * (a3real)frameCount;
+
+		// each key lasts until the next; the last lasts until the end
+		for (t = key = 0, keyframe = reduction_out->keyframePool->keyframe, clip = reduction_out->trackPool->clip; t < trackCount; ++t, ++clip)
+		{
+			for (k = 0; k < trackKeyCount[t]; ++k, ++key, ++keyframe)
+			{
+				f = keyFrame[t * frameCount + k];
+				keyframe->index = key;
+				keyframe->duration = frameDuration * (a3real)((k + 1 < trackKeyCount[t] ? keyFrame[t * frameCount + k + 1] : frameCount) - f);
+				keyframe->duration_inverse = a3recip(keyframe->duration);
+				keyframe->data = key;
+				memcpy(reduction_out->keyValue + key * 4, a3keyframeReductionInternalChannel(poseGroup, firstPose + f, t / a3keyframeReduction_trackCount, t % a3keyframeReduction_trackCount), sizeof(a3real) * 4);
+				reduction_out->keyTime[key] = frameDuration * (a3real)f;
+			}
+			a3clipInit(clip, hierarchy->nodes[t / a3keyframeReduction_trackCount].name, reduction_out->keyframePool, key - trackKeyCount[t], key - 1);
+			clip->index = t;
+			clip->keyframe_count = trackKeyCount[t];
+			clip->duration = reduction_out->duration;
+			clip->duration_inverse = a3recip(clip->duration);
+		}
+
+		free(keyFrame);
+		return keyCount;
+	}
+	return -1;
+}
+
+// release reduced clip
+a3i32 a3keyframeReductionRelease(a3_KeyframeReduction *reduction)
+{
+	if (reduction && reduction->data)
+	{
+		a3keyframePoolRelease(reduction->keyframePool);
+		a3clipPoolRelease(reduction->trackPool);
+		free(reduction->data);
+		reduction->data = 0;
+		reduction->keyValue = reduction->keyTime = 0;
+		reduction->keyframePool->keyframe = 0;
+		reduction->trackPool->clip = 0;
+		reduction->hierarchy = 0;
+		reduction->keyCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// step track's cursor to time and get the keys around it; held keys 
+//	(single-key tracks and the last key) return the same key twice
+inline a3real a3keyframeReductionInternalStep(const a3real **v0_out, const a3real **v1_out, a3ui32 *cursor, const a3_Clip *clip, const a3_KeyframeReduction *reduction, const a3real t)
+{
+	const a3_Keyframe *keyframe = reduction->keyframePool->keyframe;
+	const a3real *keyTime = reduction->keyTime;
+	const a3ui32 first = clip->first_keyframe, last = clip->last_keyframe;
+	a3ui32 c;
+
+	// step from the cursor, or start over if time went back
+	c = (*cursor >= first && *cursor <= last && keyTime[*cursor] <= t) ? *cursor : first;
+	while (c < last && keyTime[c + 1] <= t)
+		++c;
+	*cursor = c;
+
+	*v0_out = reduction->keyValue + keyframe[c].data * 4;
+	if (c == last)
+	{
+		*v1_out = *v0_out;
+		return a3real_zero;
+	}
+	*v1_out = reduction->keyValue + keyframe[c + 1].data * 4;
+	return ((t - keyTime[c]) * keyframe[c].duration_inverse);
+}
+
+// sample every track
+a3i32 a3keyframeReductionSample(const a3_HierarchyPoseSoA *pose_out, a3ui32 *cursor, const a3_KeyframeReduction *reduction, const a3real time)
+{
+	if (pose_out && pose_out->data && cursor && reduction && reduction->data && pose_out->nodeCount == reduction->nodeCount)
+	{
+		const a3real t = a3clamp(a3real_zero, reduction->duration, time);
+		const a3_Clip *clip = reduction->trackPool->clip;
+		const a3real *v0, *v1;
+		a3real q[4], u;
+		a3ui32 i, j;
+
+		for (i = 0; i < reduction->nodeCount; ++i, clip += a3keyframeReduction_trackCount, cursor += a3keyframeReduction_trackCount)
+		{
+			// orientation: held keys are copied, others nlerp
+			u = a3keyframeReductionInternalStep(&v0, &v1, cursor + a3keyframeReduction_orientation, clip + a3keyframeReduction_orientation, reduction, t);
+			if (v0 != v1)
+			{
+				a3keyframeReductionInternalLerp(q, v0, v1, u, a3keyframeReduction_orientation);
+				v0 = q;
+			}
+			for (j = 0; j < 4; ++j)
+				pose_out->orientation[j][i] = v0[j];
+
+			// scale and translation: plain lerp (held keys have u = 0)
+			u = a3keyframeReductionInternalStep(&v0, &v1, cursor + a3keyframeReduction_scale, clip + a3keyframeReduction_scale, reduction, t);
+			for (j = 0; j < 3; ++j)
+				pose_out->scale[j][i] = v0[j] + u * (v1[j] - v0[j]);
+			u = a3keyframeReductionInternalStep(&v0, &v1, cursor + a3keyframeReduction_translation, clip + a3keyframeReduction_translation, reduction, t);
+			for (j = 0; j < 3; ++j)
+				pose_out->translation[j][i] = v0[j] + u * (v1[j] - v0[j]);
+		}
+		return reduction->nodeCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// compare against source in object space
+a3i32 a3keyframeReductionReport(a3_KeyframeReductionReport *report_out, const a3_KeyframeReduction *reduction, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose)
+{
+	if (report_out && reduction && reduction->data && poseGroup && poseGroup->hierarchy == reduction->hierarchy &&
+		firstPose + reduction->frameCount <= poseGroup->hposeCount)
+	{
+		const a3ui32 nodeCount = reduction->nodeCount;
+		a3_HierarchyState state[2] = { 0 };
+		a3_HierarchyPoseSoA pose[1] = { 0 };
+		const a3_SpatialPose *objectPose0, *objectPose1;
+		a3real m[3][3], d, dx, dy, dz, s, c;
+		a3ui32 *cursor, f, i, r, j;
+
+		cursor = (a3ui32 *)malloc(sizeof(a3ui32) * nodeCount * a3keyframeReduction_trackCount);
+		if (!cursor)
+			return -1;
+		memset(cursor, 0, sizeof(a3ui32) * nodeCount * a3keyframeReduction_trackCount);
+		if (a3hierarchyStateCreate(state + 0, poseGroup) < 0 || a3hierarchyStateCreate(state + 1, poseGroup) < 0 ||
+			a3hierarchyPoseSoACreate(pose, nodeCount) < 0)
+		{
+			a3hierarchyStateRelease(state + 0);
+			a3hierarchyStateRelease(state + 1);
+			free(cursor);
+			return -1;
+		}
+
+		report_out->sourceKeyCount = reduction->frameCount * nodeCount * a3keyframeReduction_trackCount;
+		report_out->keyCount = reduction->keyCount;
+		report_out->sourceSize = reduction->frameCount * nodeCount * 10 * sizeof(a3real);
+		report_out->reducedSize = reduction->keyCount * (sizeof(a3_Keyframe) + 5 * sizeof(a3real)) + nodeCount * a3keyframeReduction_trackCount * sizeof(a3_Clip);
+		report_out->keyRatio = (a3real)report_out->sourceKeyCount / (a3real)report_out->keyCount;
+		report_out->sizeRatio = (a3real)report_out->sourceSize / (a3real)report_out->reducedSize;
+		report_out->positionErrorMax = report_out->orientationErrorMax = a3real_zero;
+
+		for (f = 0; f < reduction->frameCount; ++f)
+		{
+			a3hierarchyPoseCopy(state[0].localHPose, poseGroup->hpose + firstPose + f, nodeCount);
+			a3kinematicsSolveForward(state + 0);
+			a3keyframeReductionSamplePose(state[1].localHPose, pose, cursor, reduction, reduction->frameDuration * (a3real)f);
+			a3hierarchyPoseConvert(state[1].localHPose, nodeCount);
+			a3kinematicsSolveForward(state + 1);
+
+			for (i = 0, objectPose0 = state[0].objectHPose->spatialPose, objectPose1 = state[1].objectHPose->spatialPose;
+				i < nodeCount; ++i, ++objectPose0, ++objectPose1)
+			{
+				dx = objectPose0->transform.m[3][0] - objectPose1->transform.m[3][0];
+				dy = objectPose0->transform.m[3][1] - objectPose1->transform.m[3][1];
+				dz = objectPose0->transform.m[3][2] - objectPose1->transform.m[3][2];
+				report_out->positionErrorMax = a3maximum(report_out->positionErrorMax, a3sqrt(dx * dx + dy * dy + dz * dz));
+
+				// relative rotation between scale-free bases: angle from 
+				//	its skew part and trace, precise for tiny angles
+				for (r = 0; r < 3; ++r)
+					for (j = 0; j < 3; ++j)
+						m[r][j] = a3real3Dot(objectPose0->transform.m[r], objectPose1->transform.m[j]) *
+							a3recipsafe(a3real3Length(objectPose0->transform.m[r]) * a3real3Length(objectPose1->transform.m[j]));
+				dx = m[1][2] - m[2][1];
+				dy = m[2][0] - m[0][2];
+				dz = m[0][1] - m[1][0];
+				s = a3sqrt(dx * dx + dy * dy + dz * dz) * a3real_half;
+				c = (m[0][0] + m[1][1] + m[2][2] - a3real_one) * a3real_half;
+				d = a3atan2d(s, c);
+				report_out->orientationErrorMax = a3maximum(report_out->orientationErrorMax, d);
+			}
+		}
+
+		a3hierarchyPoseSoARelease(pose);
+		a3hierarchyStateRelease(state + 0);
+		a3hierarchyStateRelease(state + 1);
+		free(cursor);
+		return reduction->frameCount;
+	}
+	return -1;
+}
+
+// print report to console
+a3i32 a3keyframeReductionPrintReport(const a3_KeyframeReductionReport *report, const a3byte *label)
+{
+	if (report)
+	{
+		printf("\n A3 keyframe reduction (%s): %u -> %u keys (%.2f:1), %u -> %u bytes (%.2f:1); max object-space error: %.4f units, %.4f deg",
+			label ? label : "", report->sourceKeyCount, report->keyCount, (a3f64)report->keyRatio,
+			report->sourceSize, report->reducedSize, (a3f64)report->sizeRatio,
+			(a3f64)report->positionErrorMax, (a3f64)report->orientationErrorMax);
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
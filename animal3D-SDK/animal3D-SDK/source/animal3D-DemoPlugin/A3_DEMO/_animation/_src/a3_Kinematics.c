@@ -24,21 +24,200 @@
 
 #include "../a3_Kinematics.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+
+// platform primitives: full memory barrier between writing results and 
+//	publishing progress (a compiler barrier alone lets a store move past a 
+//	later load); yield while waiting at a level barrier, so oversubscribed 
+//	cores do not spin until preempted; semaphore a worker parks on between 
+//	solves (one per worker, so a worker that finishes early cannot take 
+//	another's wake-up)
+#ifdef _WIN32
+#include <Windows.h>
+#define a3kinematicsInternalBarrier()	MemoryBarrier()
+#define a3kinematicsInternalYield()		SwitchToThread()
+inline void *a3kinematicsInternalParkCreate()
+{
+	return CreateSemaphoreA(0, 0, 1, 0);
+}
+inline void a3kinematicsInternalParkRelease(void *park)
+{
+	CloseHandle((HANDLE)park);
+}
+inline void a3kinematicsInternalPark(void *park)
+{
+	WaitForSingleObject((HANDLE)park, INFINITE);
+}
+inline void a3kinematicsInternalUnpark(void *park)
+{
+	ReleaseSemaphore((HANDLE)park, 1, 0);
+}
+#else	// !_WIN32
+#include <sched.h>
+#include <semaphore.h>
+#define a3kinematicsInternalBarrier()	__sync_synchronize()
+#define a3kinematicsInternalYield()		sched_yield()
+inline void *a3kinematicsInternalParkCreate()
+{
+	sem_t *park = (sem_t *)malloc(sizeof(sem_t));
+	if (park && sem_init(park, 0, 0))
+	{
+		free(park);
+		park = 0;
+	}
+	return park;
+}
+inline void a3kinematicsInternalParkRelease(void *park)
+{
+	sem_destroy((sem_t *)park);
+	free(park);
+}
+inline void a3kinematicsInternalPark(void *park)
+{
+	while (sem_wait((sem_t *)park));
+}
+inline void a3kinematicsInternalUnpark(void *park)
+{
+	sem_post((sem_t *)park);
+}
+#endif	// _WIN32
+
+// spins at a barrier before yielding
+#define a3kinematicsInternalSpinMax		1024
+
 
 //-----------------------------------------------------------------------------
 
+// affine matrix product: bottom rows of both inputs are assumed to be 
+//	(0, 0, 0, 1), which saves a multiply-add per column
+inline void a3kinematicsInternalAffineProduct(a3real4x4p m_out, const a3real4x4p mL, const a3real4x4p mR)
+{
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 l0 = _mm_loadu_ps(mL[0]), l1 = _mm_loadu_ps(mL[1]), l2 = _mm_loadu_ps(mL[2]), l3 = _mm_loadu_ps(mL[3]);
+	a3ui32 j;
+	for (j = 0; j < 3; ++j)
+		_mm_storeu_ps(m_out[j], _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(l0, _mm_set1_ps(mR[j][0])),
+			_mm_mul_ps(l1, _mm_set1_ps(mR[j][1]))),
+			_mm_mul_ps(l2, _mm_set1_ps(mR[j][2]))));
+	_mm_storeu_ps(m_out[3], _mm_add_ps(_mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(l0, _mm_set1_ps(mR[3][0])),
+		_mm_mul_ps(l1, _mm_set1_ps(mR[3][1]))),
+		_mm_mul_ps(l2, _mm_set1_ps(mR[3][2]))), l3));
+#else	// !A3_HIERARCHY_SIMD
+	a3real4x4Product(m_out, mL, mR);
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// solve single node: object = parent object * local
+inline void a3kinematicsInternalSolveForwardNode(const a3_HierarchyState *hierarchyState, const a3_HierarchyNode *node)
+{
+	a3_SpatialPose *objectPose = hierarchyState->objectHPose->spatialPose;
+	const a3_SpatialPose *localPose = hierarchyState->localHPose->spatialPose + node->index;
+	if (node->parentIndex >= 0)
+		a3kinematicsInternalAffineProduct(objectPose[node->index].transform.m, objectPose[node->parentIndex].transform.m, localPose->transform.m);
+	else
+		objectPose[node->index].transform = localPose->transform;
+	hierarchyState->localDirty[node->index] = 0;
+}
+
+// affine matrix product across instances: element (column j, row r) of 
+//	each product; bottom row stays (0, 0, 0, 1)
+inline void a3kinematicsInternalAffineProductBatch(a3real *m_out, const a3real *mL, const a3real *mR, const a3ui32 stride)
+{
+	a3ui32 i, r, j;
+#ifdef A3_HIERARCHY_SIMD
+	__m128 r0, r1, r2, o;
+	for (i = 0; i < stride; i += 4)
+	{
+		for (j = 0; j < 4; ++j)
+		{
+			r0 = _mm_load_ps(mR + (j * 4 + 0) * stride + i);
+			r1 = _mm_load_ps(mR + (j * 4 + 1) * stride + i);
+			r2 = _mm_load_ps(mR + (j * 4 + 2) * stride + i);
+			for (r = 0; r < 3; ++r)
+			{
+				o = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_load_ps(mL + (0 + r) * stride + i), r0),
+					_mm_mul_ps(_mm_load_ps(mL + (4 + r) * stride + i), r1)),
+					_mm_mul_ps(_mm_load_ps(mL + (8 + r) * stride + i), r2));
+				if (j == 3)
+					o = _mm_add_ps(o, _mm_load_ps(mL + (12 + r) * stride + i));
+				_mm_store_ps(m_out + (j * 4 + r) * stride + i, o);
+			}
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	for (i = 0; i < stride; ++i)
+		for (j = 0; j < 4; ++j)
+			for (r = 0; r < 3; ++r)
+				m_out[(j * 4 + r) * stride + i] =
+					mL[(0 + r) * stride + i] * mR[(j * 4 + 0) * stride + i] +
+					mL[(4 + r) * stride + i] * mR[(j * 4 + 1) * stride + i] +
+					mL[(8 + r) * stride + i] * mR[(j * 4 + 2) * stride + i] +
+					(j == 3 ? mL[(12 + r) * stride + i] : a3real_zero);
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// solve single node across all instances in batch
+inline void a3kinematicsInternalSolveForwardNodeBatch(const a3_HierarchyStateBatch *batch, const a3_HierarchyNode *node)
+{
+	const a3ui32 stride = batch->instanceStride;
+	const a3real *mR = a3hierarchyStateBatchGetNodeTransform(batch->localTransform, batch, node->index);
+	a3real *m_out = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, node->index);
+	if (node->parentIndex >= 0)
+		a3kinematicsInternalAffineProductBatch(m_out, a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, node->parentIndex), mR, stride);
+	else
+		memcpy(m_out, mR, sizeof(a3real) * 16 * stride);
+}
+
+
 // partial FK solver
 a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount)
 {
 	if (hierarchyState && hierarchyState->poseGroup && 
 		firstIndex < hierarchyState->poseGroup->hierarchy->numNodes && nodeCount)
 	{
-		// ****TO-DO: implement forward kinematics algorithm
-		//	- for all nodes starting at first index
-		//		- if node is not root (has parent node)
-		//			- object matrix = parent object matrix * local matrix
-		//		- else
-		//			- copy local matrix to object matrix
+		// parents always precede children, so solving in index order 
+		//	guarantees each parent is current before its children
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->numNodes);
+		a3ui32 i;
+		for (i = firstIndex; i < lastIndex; ++i)
+			a3kinematicsInternalSolveForwardNode(hierarchyState, hierarchy->nodes + i);
+		return (lastIndex - firstIndex);
+	}
+	return -1;
+}
+
+// incremental FK solver
+a3i32 a3kinematicsSolveForwardDirty(a3_HierarchyState *hierarchyState)
+{
+	if (hierarchyState && hierarchyState->poseGroup)
+	{
+		// find the first dirty node, solve its whole subtree range and 
+		//	resume after it; clean subtrees are skipped entirely
+		// non-descendants interleaved in the range are solved redundantly 
+		//	but correctly; depth-first ordered rigs have none
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		a3ui32 i, j, end, count;
+		for (i = count = 0; i < nodeCount; )
+		{
+			if (hierarchyState->localDirty[i])
+			{
+				for (j = i, end = hierarchyState->subtreeEnd[i]; j < end; ++j)
+					a3kinematicsInternalSolveForwardNode(hierarchyState, hierarchy->nodes + j);
+				count += end - i;
+				i = end;
+			}
+			else
+				++i;
+		}
+		hierarchyState->forwardNodeCount = count;
+		return count;
 	}
 	return -1;
 }
@@ -46,18 +225,938 @@ a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, c
 
 //-----------------------------------------------------------------------------
 
+// solve one participant's share of a level; small levels use fewer 
+//	participants so each gets at least the minimum node count
+inline void a3kinematicsInternalSolveLevelChunk(const a3_KinematicsWorkerPool *pool, const a3ui32 level, const a3ui32 participant, const a3ui32 participantCount)
+{
+	const a3ui32 first = pool->levelStart[level], count = pool->levelStart[level + 1] - first;
+	const a3ui32 active = a3minimum(participantCount, a3maximum(count / pool->levelNodeMin, 1));
+	const a3_HierarchyNode *nodes = pool->hierarchy->nodes;
+	a3ui32 i, end;
+	if (participant < active)
+		for (i = first + count * participant / active, end = first + count * (participant + 1) / active; i < end; ++i)
+			a3kinematicsInternalSolveForwardNode(pool->state, nodes + pool->levelNode[i]);
+}
+
+// wait until every participant has finished the given number of levels
+inline void a3kinematicsInternalWaitLevels(const a3_KinematicsWorkerPool *pool, const a3ui32 participantCount, const a3i32 levelsDone)
+{
+	a3ui32 p, spin;
+	for (p = 0; p < participantCount; ++p)
+		for (spin = 0; pool->progress[p].levelsDone < levelsDone; ++spin)
+			if (spin >= a3kinematicsInternalSpinMax)
+				a3kinematicsInternalYield();
+	a3kinematicsInternalBarrier();
+}
+
+// worker thread: park between solves, then solve own share of every level
+a3ret a3kinematicsInternalWorker(a3_KinematicsWorker *worker)
+{
+	a3_KinematicsWorkerPool *pool = worker->pool;
+	const a3ui32 participant = worker->participant;
+	const a3ui32 participantCount = pool->workerCount + 1;
+	a3ui32 level;
+	for (;;)
+	{
+		a3kinematicsInternalPark(worker->park);
+		a3kinematicsInternalBarrier();
+		if (pool->stop)
+			break;
+		for (level = 0; level < pool->levelCount; ++level)
+		{
+			a3kinematicsInternalWaitLevels(pool, participantCount, level);
+			a3kinematicsInternalSolveLevelChunk(pool, level, participant, participantCount);
+			a3kinematicsInternalBarrier();
+			pool->progress[participant].levelsDone = level + 1;
+		}
+	}
+	return participant;
+}
+
+// initialize worker pool for hierarchy
+a3i32 a3kinematicsWorkerPoolCreate(a3_KinematicsWorkerPool *pool_out, const a3_Hierarchy *hierarchy, const a3ui32 workerCount, const a3ui32 serialNodeMin, const a3ui32 levelNodeMin)
+{
+	if (pool_out && !pool_out->hierarchy && hierarchy && hierarchy->nodes && workerCount <= a3kinematics_workerMax)
+	{
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		a3ui32 *depth;
+		a3i32 parentIndex;
+		a3ui32 i, levelCount;
+
+		// layout: sorted node list, level starts (+1), depth scratch
+		pool_out->data = malloc(sizeof(a3ui32) * (nodeCount * 3 + 1));
+		if (!pool_out->data)
+			return -1;
+		pool_out->levelNode = (a3ui32 *)pool_out->data;
+		pool_out->levelStart = pool_out->levelNode + nodeCount;
+		depth = pool_out->levelStart + nodeCount + 1;
+
+		// depth of each node: parents precede children
+		for (i = levelCount = 0; i < nodeCount; ++i)
+		{
+			parentIndex = hierarchy->nodes[i].parentIndex;
+			depth[i] = parentIndex >= 0 ? depth[parentIndex] + 1 : 0;
+			levelCount = a3maximum(levelCount, depth[i] + 1);
+		}
+
+		// counting sort by depth; stable, so each level stays in index order
+		memset(pool_out->levelStart, 0, sizeof(a3ui32) * (levelCount + 1));
+		for (i = 0; i < nodeCount; ++i)
+			++pool_out->levelStart[depth[i] + 1];
+		for (i = 0; i < levelCount; ++i)
+			pool_out->levelStart[i + 1] += pool_out->levelStart[i];
+		for (i = 0; i < nodeCount; ++i)
+			pool_out->levelNode[pool_out->levelStart[depth[i]]++] = i;
+		for (i = levelCount; i > 0; --i)
+			pool_out->levelStart[i] = pool_out->levelStart[i - 1];
+		pool_out->levelStart[0] = 0;
+
+		pool_out->hierarchy = hierarchy;
+		pool_out->levelCount = levelCount;
+		pool_out->workerCount = workerCount;
+		pool_out->serialNodeMin = serialNodeMin ? serialNodeMin : a3kinematics_serialNodeMin;
+		pool_out->levelNodeMin = levelNodeMin ? levelNodeMin : a3kinematics_levelNodeMin;
+		pool_out->state = 0;
+		pool_out->stop = a3false;
+		for (i = 0; i < a3kinematics_workerMax; ++i)
+		{
+			memset(pool_out->worker[i].thread, 0, sizeof(a3_Thread));
+			pool_out->worker[i].pool = pool_out;
+			pool_out->worker[i].participant = i + 1;
+			pool_out->worker[i].park = 0;
+			pool_out->worker[i].launched = a3false;
+		}
+
+		// launch workers once; they park until the first solve
+		for (i = 0; i < workerCount; ++i)
+		{
+			pool_out->worker[i].park = a3kinematicsInternalParkCreate();
+			if (pool_out->worker[i].park)
+				pool_out->worker[i].launched = (a3threadLaunch(pool_out->worker[i].thread, (a3_threadfunc)a3kinematicsInternalWorker, pool_out->worker + i, 0) > 0);
+		}
+		return levelCount;
+	}
+	return -1;
+}
+
+// release worker pool
+a3i32 a3kinematicsWorkerPoolRelease(a3_KinematicsWorkerPool *pool)
+{
+	if (pool && pool->hierarchy)
+	{
+		a3_KinematicsWorker *worker;
+		a3ui32 p;
+
+		// wake workers one last time to exit, then join
+		pool->stop = a3true;
+		a3kinematicsInternalBarrier();
+		for (p = 0; p < pool->workerCount; ++p)
+			if (pool->worker[p].launched)
+				a3kinematicsInternalUnpark(pool->worker[p].park);
+		for (p = 0; p < pool->workerCount; ++p)
+		{
+			worker = pool->worker + p;
+			if (worker->launched)
+			{
+				a3threadWait(worker->thread);
+				worker->launched = a3false;
+			}
+			if (worker->park)
+			{
+				a3kinematicsInternalParkRelease(worker->park);
+				worker->park = 0;
+			}
+		}
+
+		free(pool->data);
+		pool->data = 0;
+		pool->levelNode = pool->levelStart = 0;
+		pool->levelCount = 0;
+		pool->hierarchy = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// level-parallel FK solver
+a3i32 a3kinematicsSolveForwardParallel(a3_KinematicsWorkerPool *pool, const a3_HierarchyState *hierarchyState)
+{
+	if (pool && pool->hierarchy && hierarchyState && hierarchyState->poseGroup &&
+		hierarchyState->poseGroup->hierarchy == pool->hierarchy)
+	{
+		const a3ui32 participantCount = pool->workerCount + 1;
+		a3ui32 p, level;
+
+		// small rigs: waking workers costs more than it saves
+		if (!pool->workerCount || pool->hierarchy->numNodes < pool->serialNodeMin)
+			return a3kinematicsSolveForward(hierarchyState);
+
+		// reset progress and wake parked workers; previous solve's workers 
+		//	have all finished, so nothing reads progress meanwhile
+		pool->state = hierarchyState;
+		for (p = 0; p < participantCount; ++p)
+			pool->progress[p].levelsDone = 0;
+		a3kinematicsInternalBarrier();
+		for (p = 0; p < pool->workerCount; ++p)
+			if (pool->worker[p].launched)
+				a3kinematicsInternalUnpark(pool->worker[p].park);
+
+		// caller is participant 0 and also covers any worker that failed 
+		//	to launch, so every barrier completes
+		for (level = 0; level < pool->levelCount; ++level)
+		{
+			a3kinematicsInternalWaitLevels(pool, participantCount, level);
+			a3kinematicsInternalSolveLevelChunk(pool, level, 0, participantCount);
+			for (p = 0; p < pool->workerCount; ++p)
+				if (!pool->worker[p].launched)
+					a3kinematicsInternalSolveLevelChunk(pool, level, p + 1, participantCount);
+			a3kinematicsInternalBarrier();
+			pool->progress[0].levelsDone = level + 1;
+			for (p = 0; p < pool->workerCount; ++p)
+				if (!pool->worker[p].launched)
+					pool->progress[p + 1].levelsDone = level + 1;
+		}
+
+		// workers park again once past the last level
+		a3kinematicsInternalWaitLevels(pool, participantCount, pool->levelCount);
+		pool->state = 0;
+		return pool->hierarchy->numNodes;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// partial batched FK solver
+a3i32 a3kinematicsSolveForwardBatchPartial(const a3_HierarchyStateBatch *batch, const a3ui32 firstIndex, const a3ui32 nodeCount)
+{
+	if (batch && batch->hierarchy &&
+		firstIndex < batch->hierarchy->numNodes && nodeCount)
+	{
+		// node-major: parent lookup happens once per node, not per instance
+		const a3_Hierarchy *hierarchy = batch->hierarchy;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->numNodes);
+		a3ui32 i;
+		for (i = firstIndex; i < lastIndex; ++i)
+			a3kinematicsInternalSolveForwardNodeBatch(batch, hierarchy->nodes + i);
+		return (lastIndex - firstIndex);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// cheapest transform inverse valid for scale mode
+inline void a3kinematicsInternalTransformInverse(a3real4x4p m_out, const a3real4x4p m, const a3_HierarchyScaleMode scaleMode)
+{
+	switch (scaleMode)
+	{
+	case a3hierarchyScale_none:
+		a3real4x4TransformInverseIgnoreScale(m_out, m);
+		break;
+	case a3hierarchyScale_uniform:
+		a3real4x4TransformInverseUniformScale(m_out, m);
+		break;
+	default:
+		a3real4x4TransformInverse(m_out, m);
+		break;
+	}
+}
+
+// transform inverse for scale mode
+a3i32 a3kinematicsTransformInverse(a3mat4 *m_out, const a3mat4 *m, const a3_HierarchyScaleMode scaleMode)
+{
+	if (m_out && m)
+	{
+		a3kinematicsInternalTransformInverse(m_out->m, m->m, scaleMode);
+		return 1;
+	}
+	return -1;
+}
+
+// affine inverse across instances: rows of the inverse 3x3 are 
+//	(c1 x c2, c2 x c0, c0 x c1) / det for columns c; with no scale this 
+//	reduces to the transpose, with uniform scale the transpose over |c0|^2
+// translation is -(inverse 3x3 * t); bottom row stays (0, 0, 0, 1)
+inline void a3kinematicsInternalTransformInverseBatch(a3real *m_out, const a3real *m, const a3ui32 stride, const a3_HierarchyScaleMode scaleMode)
+{
+	a3ui32 i, r, j;
+#ifdef A3_HIERARCHY_SIMD
+	__m128 c[4][3], row[3][3], s;
+	for (i = 0; i < stride; i += 4)
+	{
+		for (j = 0; j < 4; ++j)
+			for (r = 0; r < 3; ++r)
+				c[j][r] = _mm_load_ps(m + (j * 4 + r) * stride + i);
+		if (scaleMode == a3hierarchyScale_nonuniform)
+		{
+			for (r = 0; r < 3; ++r)
+				for (j = 0; j < 3; ++j)
+					row[r][j] = _mm_sub_ps(
+						_mm_mul_ps(c[(r + 1) % 3][(j + 1) % 3], c[(r + 2) % 3][(j + 2) % 3]),
+						_mm_mul_ps(c[(r + 1) % 3][(j + 2) % 3], c[(r + 2) % 3][(j + 1) % 3]));
+			s = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(c[0][0], row[0][0]),
+				_mm_mul_ps(c[0][1], row[0][1])),
+				_mm_mul_ps(c[0][2], row[0][2]));
+		}
+		else
+		{
+			for (r = 0; r < 3; ++r)
+				for (j = 0; j < 3; ++j)
+					row[r][j] = c[r][j];
+			s = (scaleMode == a3hierarchyScale_uniform) ? _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(c[0][0], c[0][0]),
+				_mm_mul_ps(c[0][1], c[0][1])),
+				_mm_mul_ps(c[0][2], c[0][2])) : _mm_set1_ps(a3real_one);
+		}
+		s = _mm_div_ps(_mm_set1_ps(a3real_one), s);
+		for (r = 0; r < 3; ++r)
+		{
+			for (j = 0; j < 3; ++j)
+			{
+				row[r][j] = _mm_mul_ps(row[r][j], s);
+				_mm_store_ps(m_out + (j * 4 + r) * stride + i, row[r][j]);
+			}
+			_mm_store_ps(m_out + (12 + r) * stride + i, _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(row[r][0], c[3][0]),
+				_mm_mul_ps(row[r][1], c[3][1])),
+				_mm_mul_ps(row[r][2], c[3][2]))));
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3mat4 lane, laneInv;
+	for (i = 0; i < stride; ++i)
+	{
+		for (j = 0; j < 16; ++j)
+			lane.mm[j] = m[j * stride + i];
+		a3kinematicsInternalTransformInverse(laneInv.m, lane.m, scaleMode);
+		for (j = 0; j < 4; ++j)
+			for (r = 0; r < 3; ++r)
+				m_out[(j * 4 + r) * stride + i] = laneInv.m[j][r];
+	}
+#endif	// A3_HIERARCHY_SIMD
+}
+
+
 // partial IK solver
 a3i32 a3kinematicsSolveInversePartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount)
 {
 	if (hierarchyState && hierarchyState->poseGroup &&
 		firstIndex < hierarchyState->poseGroup->hierarchy->numNodes && nodeCount)
 	{
-		// ****TO-DO: implement inverse kinematics algorithm
-		//	- for all nodes starting at first index
-		//		- if node is not root (has parent node)
-		//			- local matrix = inverse parent object matrix * object matrix
-		//		- else
-		//			- copy object matrix to local matrix
+		// each parent is inverted once, when visited, before any child 
+		//	(parents precede children); inverses land in the state's 
+		//	object-space inverse set
+		// parents before the range are inverted on demand, once per run 
+		//	of siblings
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3_HierarchyScaleMode scaleMode = hierarchyState->poseGroup->scaleMode;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->numNodes);
+		const a3_SpatialPose *objectPose = hierarchyState->objectHPose->spatialPose;
+		a3_SpatialPose *localPose = hierarchyState->localHPose->spatialPose;
+		a3mat4 *objectInv = hierarchyState->objectSpaceInverse->transform;
+		a3i32 parentIndex, outsideIndex = -1;
+		a3ui32 i;
+		for (i = firstIndex; i < lastIndex; ++i)
+		{
+			if (hierarchyState->subtreeEnd[i] > i + 1)
+				a3kinematicsInternalTransformInverse(objectInv[i].m, objectPose[i].transform.m, scaleMode);
+			parentIndex = hierarchy->nodes[i].parentIndex;
+			if (parentIndex >= 0)
+			{
+				if ((a3ui32)parentIndex < firstIndex && parentIndex != outsideIndex)
+				{
+					a3kinematicsInternalTransformInverse(objectInv[parentIndex].m, objectPose[parentIndex].transform.m, scaleMode);
+					outsideIndex = parentIndex;
+				}
+				a3kinematicsInternalAffineProduct(localPose[i].transform.m, objectInv[parentIndex].m, objectPose[i].transform.m);
+			}
+			else
+				localPose[i].transform = objectPose[i].transform;
+		}
+		return (lastIndex - firstIndex);
+	}
+	return -1;
+}
+
+// partial batched IK solver
+a3i32 a3kinematicsSolveInverseBatchPartial(const a3_HierarchyStateBatch *batch, const a3ui32 firstIndex, const a3ui32 nodeCount, const a3_HierarchyScaleMode scaleMode)
+{
+	if (batch && batch->hierarchy &&
+		firstIndex < batch->hierarchy->numNodes && nodeCount)
+	{
+		// same scheme as single state: parents inverted once for all 
+		//	instances, children use the stored inverse
+		const a3_Hierarchy *hierarchy = batch->hierarchy;
+		const a3ui32 stride = batch->instanceStride;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->numNodes);
+		a3i32 parentIndex, outsideIndex = -1;
+		a3ui32 i;
+		for (i = firstIndex; i < lastIndex; ++i)
+		{
+			if (batch->subtreeEnd[i] > i + 1)
+				a3kinematicsInternalTransformInverseBatch(
+					a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, i),
+					a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, i), stride, scaleMode);
+			parentIndex = hierarchy->nodes[i].parentIndex;
+			if (parentIndex >= 0)
+			{
+				if ((a3ui32)parentIndex < firstIndex && parentIndex != outsideIndex)
+				{
+					a3kinematicsInternalTransformInverseBatch(
+						a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, parentIndex),
+						a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, parentIndex), stride, scaleMode);
+					outsideIndex = parentIndex;
+				}
+				a3kinematicsInternalAffineProductBatch(
+					a3hierarchyStateBatchGetNodeTransform(batch->localTransform, batch, i),
+					a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, parentIndex),
+					a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, i), stride);
+			}
+			else
+				memcpy(a3hierarchyStateBatchGetNodeTransform(batch->localTransform, batch, i),
+					a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, i), sizeof(a3real) * 16 * stride);
+		}
+		return (lastIndex - firstIndex);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// rotation about unit axis given cosine and sine of angle (Rodrigues); 
+//	affine with zero translation
+inline void a3kinematicsInternalSetRotation(a3real4x4p m_out, const a3real3p axis, const a3real c, const a3real s)
+{
+	const a3real t = a3real_one - c, x = axis[0], y = axis[1], z = axis[2];
+	m_out[0][0] = c + t * x * x;		m_out[0][1] = t * x * y + s * z;	m_out[0][2] = t * x * z - s * y;	m_out[0][3] = a3real_zero;
+	m_out[1][0] = t * x * y - s * z;	m_out[1][1] = c + t * y * y;		m_out[1][2] = t * y * z + s * x;	m_out[1][3] = a3real_zero;
+	m_out[2][0] = t * x * z + s * y;	m_out[2][1] = t * y * z - s * x;	m_out[2][2] = c + t * z * z;		m_out[2][3] = a3real_zero;
+	m_out[3][0] = m_out[3][1] = m_out[3][2] = a3real_zero;				m_out[3][3] = a3real_one;
+}
+
+// make rotation act about pivot: translation = pivot - R pivot
+inline void a3kinematicsInternalSetPivot(a3real4x4p m_inout, const a3real3p pivot)
+{
+	a3ui32 r;
+	for (r = 0; r < 3; ++r)
+		m_inout[3][r] = pivot[r] - (m_inout[0][r] * pivot[0] + m_inout[1][r] * pivot[1] + m_inout[2][r] * pivot[2]);
+}
+
+// cosine and sine of difference of two angles in [0, pi] given cosines
+inline void a3kinematicsInternalAngleDelta(a3real *c_out, a3real *s_out, const a3real cosFrom, const a3real cosTo)
+{
+	const a3real sinFrom = a3sqrt(a3maximum(a3real_one - cosFrom * cosFrom, a3real_zero));
+	const a3real sinTo = a3sqrt(a3maximum(a3real_one - cosTo * cosTo, a3real_zero));
+	*c_out = cosTo * cosFrom + sinTo * sinFrom;
+	*s_out = sinTo * cosFrom - cosTo * sinFrom;
+}
+
+// two-bone solve: object-space rotations about root (a) and mid (b) so 
+//	that end (c) reaches target; no trigonometric functions, angles are 
+//	carried as cosine/sine pairs
+inline a3boolean a3kinematicsInternalSolveTwoBone(a3real4x4p rootDelta_out, a3real4x4p midDelta_out, const a3real3p a, const a3real3p b, const a3real3p c, const a3real3p target, const a3real3p pole_opt, const a3real softLimit)
+{
+	const a3real epsilon = (a3real)1.0e-5;
+	a3real3 ab, cb, ac, at, ap, axis, u, v;
+	a3real4x4 R;
+	a3real lab, lcb, lac, lat, latReach, reach, soft, x, cosFrom, cosTo, cosD, sinD, lu, lv;
+	a3boolean reached;
+
+	a3real3Diff(ab, b, a);
+	a3real3Diff(cb, c, b);
+	a3real3Diff(ac, c, a);
+	a3real3Diff(at, target, a);
+	lab = a3real3Length(ab);
+	lcb = a3real3Length(cb);
+	lac = a3real3Length(ac);
+	lat = a3real3Length(at);
+	a3kinematicsInternalSetRotation(rootDelta_out, a3vec3_z.v, a3real_one, a3real_zero);
+	a3kinematicsInternalSetRotation(midDelta_out, a3vec3_z.v, a3real_one, a3real_zero);
+	if (lab <= epsilon || lcb <= epsilon || lac <= epsilon)
+		return 0;
+
+	// distance to reach: soft limit eases in toward full extension 
+	//	(rational ease: slope 1 where it starts, approaches full reach)
+	reach = lab + lcb;
+	reached = (lat <= reach && lat >= a3absolute(lab - lcb));
+	latReach = lat;
+	if (softLimit > a3real_zero && lat > reach * (a3real_one - softLimit))
+	{
+		soft = reach * softLimit;
+		x = (lat - reach + soft) / soft;
+		latReach = reach - soft + soft * x / (a3real_one + x);
+	}
+	latReach = a3clamp(a3absolute(lab - lcb) + epsilon * reach, reach * (a3real_one - epsilon), latReach);
+
+	// bend plane: current bend, else toward pole, else any perpendicular
+	a3real3Cross(axis, ac, ab);
+	if (a3real3LengthSquared(axis) <= epsilon * epsilon * lac * lab)
+	{
+		if (pole_opt)
+		{
+			a3real3Diff(ap, pole_opt, a);
+			a3real3Cross(axis, ac, ap);
+		}
+		if (a3real3LengthSquared(axis) <= epsilon * epsilon * lac * lab)
+			a3real3Cross(axis, ac, a3absolute(ac[0]) < a3absolute(ac[1]) ? a3vec3_x.v : a3vec3_y.v);
+	}
+	a3real3Normalize(axis);
+
+	// root: angle between ac and ab becomes the target triangle's angle
+	cosFrom = a3real3Dot(ac, ab) / (lac * lab);
+	cosTo = (lab * lab + latReach * latReach - lcb * lcb) / (a3real_two * lab * latReach);
+	a3kinematicsInternalAngleDelta(&cosD, &sinD, a3clamp(-a3real_one, a3real_one, cosFrom), a3clamp(-a3real_one, a3real_one, cosTo));
+	a3kinematicsInternalSetRotation(rootDelta_out, axis, cosD, sinD);
+
+	// mid: angle between ba and bc becomes the target triangle's angle
+	cosFrom = -a3real3Dot(ab, cb) / (lab * lcb);
+	cosTo = (lab * lab + lcb * lcb - latReach * latReach) / (a3real_two * lab * lcb);
+	a3kinematicsInternalAngleDelta(&cosD, &sinD, a3clamp(-a3real_one, a3real_one, cosFrom), a3clamp(-a3real_one, a3real_one, cosTo));
+	a3kinematicsInternalSetRotation(midDelta_out, axis, cosD, sinD);
+	a3kinematicsInternalSetPivot(midDelta_out, b);
+
+	// aim: both rotations are in the bend plane and keep ac's direction; 
+	//	rotate it onto at (half turn about bend axis if opposite)
+	if (lat > epsilon)
+	{
+		a3real3Cross(u, ac, at);
+		lu = a3real3Length(u);
+		cosD = a3real3Dot(ac, at) / (lac * lat);
+		if (lu > epsilon * lac * lat)
+		{
+			a3real3MulS(u, a3recip(lu));
+			a3kinematicsInternalSetRotation(R, u, cosD, lu / (lac * lat));
+			a3real4x4Product(rootDelta_out, R, rootDelta_out);
+		}
+		else if (cosD < a3real_zero)
+		{
+			a3kinematicsInternalSetRotation(R, axis, -a3real_one, a3real_zero);
+			a3real4x4Product(rootDelta_out, R, rootDelta_out);
+		}
+
+		// twist about aim so mid lies in the plane of the pole
+		if (pole_opt)
+		{
+			a3real3Diff(ap, pole_opt, a);
+			a3real3MulS(at, a3recip(lat));
+			u[0] = rootDelta_out[0][0] * ab[0] + rootDelta_out[1][0] * ab[1] + rootDelta_out[2][0] * ab[2];
+			u[1] = rootDelta_out[0][1] * ab[0] + rootDelta_out[1][1] * ab[1] + rootDelta_out[2][1] * ab[2];
+			u[2] = rootDelta_out[0][2] * ab[0] + rootDelta_out[1][2] * ab[1] + rootDelta_out[2][2] * ab[2];
+			x = a3real3Dot(u, at);
+			u[0] -= at[0] * x;
+			u[1] -= at[1] * x;
+			u[2] -= at[2] * x;
+			x = a3real3Dot(ap, at);
+			ap[0] -= at[0] * x;
+			ap[1] -= at[1] * x;
+			ap[2] -= at[2] * x;
+			lu = a3real3Length(u);
+			lv = a3real3Length(ap);
+			if (lu > epsilon * lab && lv > epsilon)
+			{
+				a3real3Cross(v, u, ap);
+				x = a3recip(lu * lv);
+				a3kinematicsInternalSetRotation(R, at, a3real3Dot(u, ap) * x, a3real3Dot(v, at) * x);
+				a3real4x4Product(rootDelta_out, R, rootDelta_out);
+			}
+		}
+	}
+	a3kinematicsInternalSetPivot(rootDelta_out, a);
+	return reached;
+}
+
+// new local transform of chain node: the node's parent moves rigidly with 
+//	anything above it, so local = inverse original parent * delta * original
+inline void a3kinematicsInternalTwoBoneLocal(a3real4x4p local_out, const a3real4x4p delta, const a3real4x4p object, const a3real4x4p parentInv_opt)
+{
+	a3real4x4 m;
+	if (parentInv_opt)
+	{
+		a3kinematicsInternalAffineProduct(m, delta, object);
+		a3kinematicsInternalAffineProduct(local_out, parentInv_opt, m);
+	}
+	else
+		a3kinematicsInternalAffineProduct(local_out, delta, object);
+}
+
+// validate two-bone chain
+inline a3boolean a3kinematicsInternalIsTwoBoneChain(const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex)
+{
+	return (rootIndex < midIndex && midIndex < endIndex && endIndex < hierarchy->numNodes &&
+		a3hierarchyIsAncestorNode(hierarchy, rootIndex, midIndex) > 0 &&
+		a3hierarchyIsAncestorNode(hierarchy, midIndex, endIndex) > 0);
+}
+
+
+// two-bone IK solver
+a3i32 a3kinematicsSolveTwoBone(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real *target, const a3real *pole_opt, const a3real softLimit)
+{
+	if (hierarchyState && hierarchyState->poseGroup && target && softLimit >= a3real_zero && softLimit < a3real_one &&
+		a3kinematicsInternalIsTwoBoneChain(hierarchyState->poseGroup->hierarchy, rootIndex, midIndex, endIndex))
+	{
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3_HierarchyScaleMode scaleMode = hierarchyState->poseGroup->scaleMode;
+		const a3_SpatialPose *objectPose = hierarchyState->objectHPose->spatialPose;
+		a3_SpatialPose *localPose = hierarchyState->localHPose->spatialPose;
+		const a3i32 rootParent = hierarchy->nodes[rootIndex].parentIndex, midParent = hierarchy->nodes[midIndex].parentIndex;
+		a3real4x4 rootDelta, midDelta, parentInv;
+		a3boolean reached;
+
+		reached = a3kinematicsInternalSolveTwoBone(rootDelta, midDelta,
+			objectPose[rootIndex].transform.m[3], objectPose[midIndex].transform.m[3], objectPose[endIndex].transform.m[3],
+			target, pole_opt, softLimit);
+
+		// new locals from original object-space pose, then refresh subtree
+		if (rootParent >= 0)
+			a3kinematicsInternalTransformInverse(parentInv, objectPose[rootParent].transform.m, scaleMode);
+		a3kinematicsInternalTwoBoneLocal(localPose[rootIndex].transform.m, rootDelta, objectPose[rootIndex].transform.m, rootParent >= 0 ? parentInv : 0);
+		a3kinematicsInternalTransformInverse(parentInv, objectPose[midParent].transform.m, scaleMode);
+		a3kinematicsInternalTwoBoneLocal(localPose[midIndex].transform.m, midDelta, objectPose[midIndex].transform.m, parentInv);
+		a3kinematicsSolveForwardPartial(hierarchyState, rootIndex, hierarchyState->subtreeEnd[rootIndex] - rootIndex);
+		return reached;
+	}
+	return -1;
+}
+
+// scatter one instance's affine matrix into batch streams (bottom row kept)
+inline void a3kinematicsInternalStoreInstance(a3real *m_out, const a3real4x4p m, const a3ui32 stride, const a3ui32 instanceIndex)
+{
+	a3ui32 j, r;
+	for (j = 0, m_out += instanceIndex; j < 4; ++j, m_out += stride)
+		for (r = 0; r < 3; ++r, m_out += stride)
+			*m_out = m[j][r];
+}
+
+// batched two-bone IK solver
+a3i32 a3kinematicsSolveTwoBoneBatch(const a3_HierarchyStateBatch *batch, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real *target, const a3real *pole_opt, const a3real softLimit, const a3_HierarchyScaleMode scaleMode)
+{
+	if (batch && batch->hierarchy && target && softLimit >= a3real_zero && softLimit < a3real_one &&
+		a3kinematicsInternalIsTwoBoneChain(batch->hierarchy, rootIndex, midIndex, endIndex))
+	{
+		// only the solve itself is per instance: positions are gathered and 
+		//	deltas scattered into the local streams of root and mid (about 
+		//	to be replaced); parent inverses, new locals and the subtree 
+		//	refresh run across all instances, with the mid node's inverse 
+		//	streams as scratch (stale after the pose changes anyway)
+		const a3_Hierarchy *hierarchy = batch->hierarchy;
+		const a3ui32 stride = batch->instanceStride;
+		const a3i32 rootParent = hierarchy->nodes[rootIndex].parentIndex, midParent = hierarchy->nodes[midIndex].parentIndex;
+		const a3real *rootObject = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, rootIndex);
+		const a3real *midObject = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, midIndex);
+		const a3real *endObject = a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, endIndex);
+		a3real *rootLocal = a3hierarchyStateBatchGetNodeTransform(batch->localTransform, batch, rootIndex);
+		a3real *midLocal = a3hierarchyStateBatchGetNodeTransform(batch->localTransform, batch, midIndex);
+		a3real *scratch = a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, midIndex);
+		a3real *rootParentInv = rootParent >= 0 ? a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, rootParent) : 0;
+		a3real *midParentInv = a3hierarchyStateBatchGetNodeTransform(batch->objectInverseTransform, batch, midParent);
+		a3real4x4 rootDelta, midDelta;
+		a3real3 a, b, c;
+		a3ui32 k, r, reached = 0;
+
+		for (k = 0; k < batch->instanceCount; ++k)
+		{
+			for (r = 0; r < 3; ++r)
+			{
+				a[r] = rootObject[(12 + r) * stride + k];
+				b[r] = midObject[(12 + r) * stride + k];
+				c[r] = endObject[(12 + r) * stride + k];
+			}
+			reached += a3kinematicsInternalSolveTwoBone(rootDelta, midDelta, a, b, c,
+				target + k * 3, pole_opt ? pole_opt + k * 3 : 0, softLimit);
+			a3kinematicsInternalStoreInstance(rootLocal, rootDelta, stride, k);
+			a3kinematicsInternalStoreInstance(midLocal, midDelta, stride, k);
+		}
+
+		// original parent inverses
+		a3kinematicsInternalTransformInverseBatch(midParentInv,
+			a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, midParent), stride, scaleMode);
+		if (rootParentInv)
+			a3kinematicsInternalTransformInverseBatch(rootParentInv,
+				a3hierarchyStateBatchGetNodeTransform(batch->objectTransform, batch, rootParent), stride, scaleMode);
+
+		// local = inverse original parent * delta * original object
+		a3kinematicsInternalAffineProductBatch(scratch, midLocal, midObject, stride);
+		a3kinematicsInternalAffineProductBatch(midLocal, midParentInv, scratch, stride);
+		a3kinematicsInternalAffineProductBatch(scratch, rootLocal, rootObject, stride);
+		if (rootParentInv)
+			a3kinematicsInternalAffineProductBatch(rootLocal, rootParentInv, scratch, stride);
+		else
+			memcpy(rootLocal, scratch, sizeof(a3real) * 16 * stride);
+
+		// refresh root subtree, all instances
+		a3kinematicsSolveForwardBatchPartial(batch, rootIndex, batch->subtreeEnd[rootIndex] - rootIndex);
+		return reached;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// initialize chain
+a3i32 a3kinematicsChainCreate(a3_KinematicsChain *chain_out, const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3ui32 endIndex)
+{
+	if (chain_out && !chain_out->hierarchy && hierarchy && hierarchy->nodes &&
+		rootIndex < endIndex && a3hierarchyIsAncestorNode(hierarchy, rootIndex, endIndex) > 0)
+	{
+		a3ui32 nodeCount, i;
+		a3i32 j;
+
+		// walk up from end to root
+		for (nodeCount = 1, i = endIndex; i != rootIndex; i = hierarchy->nodes[i].parentIndex)
+			++nodeCount;
+
+		// indices, then positions, warm positions and lengths
+		chain_out->data = malloc(sizeof(a3ui32) * nodeCount + sizeof(a3real) * nodeCount * 7);
+		if (!chain_out->data)
+			return -1;
+		chain_out->nodeIndex = (a3ui32 *)chain_out->data;
+		chain_out->position = (a3real *)(chain_out->nodeIndex + nodeCount);
+		chain_out->warmPosition = chain_out->position + nodeCount * 3;
+		chain_out->length = chain_out->warmPosition + nodeCount * 3;
+		for (j = nodeCount - 1, i = endIndex; j >= 0; --j, i = hierarchy->nodes[i].parentIndex)
+			chain_out->nodeIndex[j] = i;
+
+		chain_out->hierarchy = hierarchy;
+		chain_out->nodeCount = nodeCount;
+		chain_out->warm = 0;
+		chain_out->iterations = 0;
+		chain_out->error = a3real_zero;
+		return nodeCount;
+	}
+	return -1;
+}
+
+// release chain
+a3i32 a3kinematicsChainRelease(a3_KinematicsChain *chain)
+{
+	if (chain && chain->hierarchy)
+	{
+		free(chain->data);
+		chain->data = 0;
+		chain->nodeIndex = 0;
+		chain->position = chain->warmPosition = chain->length = 0;
+		chain->hierarchy = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+// place point at distance from origin, in direction of other point
+inline void a3kinematicsInternalPlace(a3real3p p_out, const a3real3p origin, const a3real3p toward, const a3real length)
+{
+	a3real3 d;
+	a3real3Diff(d, toward, origin);
+	a3real3ProductS(p_out, d, length * a3recipsafe(a3real3Length(d)));
+	a3real3Add(p_out, origin);
+}
+
+// rotation taking direction u onto direction v (shortest arc); false if 
+//	either is degenerate or they are already aligned
+inline a3boolean a3kinematicsInternalSetRotationAlign(a3real4x4p m_out, const a3real3p u, const a3real3p v)
+{
+	const a3real epsilon = (a3real)1.0e-6;
+	const a3real lengths = a3real3Length(u) * a3real3Length(v);
+	a3real3 axis;
+	a3real s;
+	a3real3Cross(axis, u, v);
+	s = a3real3Length(axis);
+	if (lengths > epsilon && s > lengths * epsilon)
+	{
+		a3real3MulS(axis, a3recip(s));
+		a3kinematicsInternalSetRotation(m_out, axis, a3real3Dot(u, v) / lengths, s / lengths);
+		return 1;
+	}
+	return 0;
+}
+
+// swing node toward position
+a3i32 a3kinematicsSwingNode(const a3_HierarchyState *hierarchyState, const a3ui32 nodeIndex, const a3ui32 childIndex, const a3real *position)
+{
+	if (hierarchyState && hierarchyState->poseGroup && position &&
+		childIndex < hierarchyState->poseGroup->hierarchy->numNodes &&
+		hierarchyState->poseGroup->hierarchy->nodes[childIndex].parentIndex == (a3i32)nodeIndex)
+	{
+		const a3i32 parentIndex = hierarchyState->poseGroup->hierarchy->nodes[nodeIndex].parentIndex;
+		a3_SpatialPose *objectPose = hierarchyState->objectHPose->spatialPose;
+		a3_SpatialPose *localPose = hierarchyState->localHPose->spatialPose;
+		a3real4x4r object = objectPose[nodeIndex].transform.m;
+		a3real4x4 R, m, parentInv;
+		a3real3 offset, child, v;
+
+		// where the child is now versus where it should be
+		a3real3SetReal3(offset, localPose[childIndex].transform.m[3]);
+		child[0] = object[0][0] * offset[0] + object[1][0] * offset[1] + object[2][0] * offset[2];
+		child[1] = object[0][1] * offset[0] + object[1][1] * offset[1] + object[2][1] * offset[2];
+		child[2] = object[0][2] * offset[0] + object[1][2] * offset[1] + object[2][2] * offset[2];
+		a3real3Diff(v, position, object[3]);
+		if (!a3kinematicsInternalSetRotationAlign(R, child, v))
+			return 0;
+
+		// swing about node, then express relative to parent
+		a3kinematicsInternalSetPivot(R, object[3]);
+		a3kinematicsInternalAffineProduct(m, R, object);
+		a3real4x4SetReal4x4(object, m);
+		if (parentIndex >= 0)
+		{
+			a3kinematicsInternalTransformInverse(parentInv, objectPose[parentIndex].transform.m, hierarchyState->poseGroup->scaleMode);
+			a3kinematicsInternalAffineProduct(localPose[nodeIndex].transform.m, parentInv, m);
+		}
+		else
+			a3real4x4SetReal4x4(localPose[nodeIndex].transform.m, m);
+		return 1;
+	}
+	return -1;
+}
+
+// load chain positions and lengths from object-space pose; warm start 
+//	keeps previous directions, re-anchored at the root with current lengths
+inline a3real a3kinematicsInternalChainLoad(a3_KinematicsChain *chain, const a3_SpatialPose *objectPose, const a3real3p target)
+{
+	a3real *position = chain->position, *warm = chain->warmPosition;
+	a3real3 d;
+	a3ui32 i;
+	for (i = 0; i < chain->nodeCount; ++i)
+	{
+		position[i * 3 + 0] = objectPose[chain->nodeIndex[i]].transform.m[3][0];
+		position[i * 3 + 1] = objectPose[chain->nodeIndex[i]].transform.m[3][1];
+		position[i * 3 + 2] = objectPose[chain->nodeIndex[i]].transform.m[3][2];
+		if (i)
+			chain->length[i - 1] = a3real3Length(a3real3Diff(d, position + i * 3, position + i * 3 - 3));
+	}
+	if (chain->warm)
+		for (i = 1; i < chain->nodeCount; ++i)
+		{
+			a3real3Diff(d, warm + i * 3, warm + i * 3 - 3);
+			a3real3ProductS(position + i * 3, d, chain->length[i - 1] * a3recipsafe(a3real3Length(d)));
+			a3real3Add(position + i * 3, position + i * 3 - 3);
+		}
+	a3real3Diff(d, position + (chain->nodeCount - 1) * 3, target);
+	return a3real3Length(d);
+}
+
+// rotate chain nodes onto solved positions, root first: each node swings 
+//	about itself so its child lands on the solved child position; new 
+//	local = inverse parent (already updated) * swung object; then refresh
+inline void a3kinematicsInternalChainStore(a3_KinematicsChain *chain, const a3_HierarchyState *hierarchyState)
+{
+	const a3_Hierarchy *hierarchy = chain->hierarchy;
+	a3_SpatialPose *objectPose = hierarchyState->objectHPose->spatialPose;
+	a3_SpatialPose *localPose = hierarchyState->localHPose->spatialPose;
+	a3ui32 i, node;
+	a3i32 parentIndex;
+
+	for (i = 0; i + 1 < chain->nodeCount; ++i)
+	{
+		node = chain->nodeIndex[i];
+		parentIndex = hierarchy->nodes[node].parentIndex;
+
+		// node's object transform given its (updated) parent
+		if (i && parentIndex >= 0)
+			a3kinematicsInternalAffineProduct(objectPose[node].transform.m, objectPose[parentIndex].transform.m, localPose[node].transform.m);
+		a3kinematicsSwingNode(hierarchyState, node, chain->nodeIndex[i + 1], chain->position + i * 3 + 3);
+	}
+
+	// keep solution for next solve, refresh everything below the root
+	memcpy(chain->warmPosition, chain->position, sizeof(a3real) * 3 * chain->nodeCount);
+	chain->warm = 1;
+	a3kinematicsSolveForwardPartial(hierarchyState, chain->nodeIndex[0], hierarchyState->subtreeEnd[chain->nodeIndex[0]] - chain->nodeIndex[0]);
+}
+
+
+// FABRIK chain solver
+a3i32 a3kinematicsSolveChainFABRIK(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real *target, const a3real tolerance, const a3ui32 iterationMax)
+{
+	if (hierarchyState && hierarchyState->poseGroup && chain && chain->hierarchy == hierarchyState->poseGroup->hierarchy && target && tolerance >= a3real_zero)
+	{
+		const a3ui32 last = chain->nodeCount - 1;
+		a3real *position = chain->position;
+		a3real3 root, d;
+		a3real reach = a3real_zero, error;
+		a3ui32 n = 0;
+		a3i32 i;
+
+		error = a3kinematicsInternalChainLoad(chain, hierarchyState->objectHPose->spatialPose, target);
+		a3real3SetReal3(root, position);
+		for (i = 0; i < (a3i32)last; ++i)
+			reach += chain->length[i];
+
+		// out of reach: straight line toward target
+		if (a3real3Length(a3real3Diff(d, target, root)) >= reach)
+		{
+			for (i = 0; i < (a3i32)last; ++i)
+				a3kinematicsInternalPlace(position + i * 3 + 3, position + i * 3, target, chain->length[i]);
+			error = a3real3Length(a3real3Diff(d, position + last * 3, target));
+			n = 1;
+		}
+		else
+			for (; n < iterationMax && error > tolerance; ++n)
+			{
+				// backward: end on target, parents follow
+				a3real3SetReal3(position + last * 3, target);
+				for (i = last - 1; i >= 0; --i)
+					a3kinematicsInternalPlace(position + i * 3, position + i * 3 + 3, position + i * 3, chain->length[i]);
+
+				// forward: root back on origin, children follow
+				a3real3SetReal3(position, root);
+				for (i = 0; i < (a3i32)last; ++i)
+					a3kinematicsInternalPlace(position + i * 3 + 3, position + i * 3, position + i * 3 + 3, chain->length[i]);
+				error = a3real3Length(a3real3Diff(d, position + last * 3, target));
+			}
+
+		a3kinematicsInternalChainStore(chain, hierarchyState);
+		chain->iterations = n;
+		chain->error = error;
+		return n;
+	}
+	return -1;
+}
+
+// CCD chain solver
+a3i32 a3kinematicsSolveChainCCD(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real *target, const a3real tolerance, const a3ui32 iterationMax)
+{
+	if (hierarchyState && hierarchyState->poseGroup && chain && chain->hierarchy == hierarchyState->poseGroup->hierarchy && target && tolerance >= a3real_zero)
+	{
+		const a3ui32 last = chain->nodeCount - 1;
+		a3real *position = chain->position;
+		a3real4x4 R;
+		a3real3 u, v, d;
+		a3real error;
+		a3ui32 n = 0, j;
+		a3i32 i;
+
+		error = a3kinematicsInternalChainLoad(chain, hierarchyState->objectHPose->spatialPose, target);
+		for (; n < iterationMax && error > tolerance; ++n)
+		{
+			// end's parent back to root: swing rest of chain about node
+			for (i = last - 1; i >= 0; --i)
+			{
+				a3real3Diff(u, position + last * 3, position + i * 3);
+				a3real3Diff(v, target, position + i * 3);
+				if (!a3kinematicsInternalSetRotationAlign(R, u, v))
+					continue;
+				for (j = i + 1; j <= last; ++j)
+				{
+					a3real3Diff(d, position + j * 3, position + i * 3);
+					u[0] = R[0][0] * d[0] + R[1][0] * d[1] + R[2][0] * d[2];
+					u[1] = R[0][1] * d[0] + R[1][1] * d[1] + R[2][1] * d[2];
+					u[2] = R[0][2] * d[0] + R[1][2] * d[1] + R[2][2] * d[2];
+					a3real3Sum(position + j * 3, position + i * 3, u);
+				}
+			}
+			error = a3real3Length(a3real3Diff(d, position + last * 3, target));
+		}
+
+		a3kinematicsInternalChainStore(chain, hierarchyState);
+		chain->iterations = n;
+		chain->error = error;
+		return n;
 	}
 	return -1;
 }
@@ -0,0 +1,270 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MorphTarget.c
+	Implementation of sparse morph target evaluation.
+*/
+
+#include "../a3_MorphTarget.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// difference of a target vertex from the base in the stream layout; 
+//	returns largest absolute component
+inline a3real a3morphInternalDelta(a3real *delta_out, const a3real *basePosition, const a3real *baseNormal, const a3real *baseTangent, const a3_GeometryData *target, const a3ui32 vertexIndex)
+{
+	const a3real *position = (const a3real *)target->attribData[a3attrib_geomPosition] + vertexIndex * 3;
+	const a3real *normal = (const a3real *)target->attribData[a3attrib_geomNormal];
+	const a3real *tangent = (const a3real *)target->attribData[a3attrib_geomTangent];
+	a3real deltaMax = a3real_zero;
+	a3ui32 i;
+	memset(delta_out, 0, sizeof(a3real) * a3morph_vertexStride);
+	for (i = 0; i < 3; ++i)
+	{
+		delta_out[i] = position[i] - basePosition[i];
+		if (baseNormal && normal)
+			delta_out[4 + i] = normal[vertexIndex * 3 + i] - baseNormal[i];
+		if (baseTangent && tangent)
+			delta_out[8 + i] = tangent[vertexIndex * 3 + i] - baseTangent[i];
+	}
+	for (i = 0; i < a3morph_vertexStride; ++i)
+		deltaMax = a3maximum(deltaMax, a3absolute(delta_out[i]));
+	return deltaMax;
+}
+
+
+#ifdef A3_HIERARCHY_SIMD
+// renormalize vec4 direction with w = 0 (zero stays zero)
+inline void a3morphInternalNormalize(a3real *v)
+{
+	__m128 d = _mm_load_ps(v), len = _mm_mul_ps(d, d);
+	len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(2, 3, 0, 1)));
+	len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(1, 0, 3, 2)));
+	_mm_store_ps(v, _mm_div_ps(d, _mm_sqrt_ps(_mm_max_ps(len, _mm_set1_ps(1.0e-24f)))));
+}
+#else	// !A3_HIERARCHY_SIMD
+// renormalize vec4 direction with w = 0 (zero stays zero)
+inline void a3morphInternalNormalize(a3real *v)
+{
+	const a3real lengthInv = a3recipsafe(a3sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]));
+	v[0] *= lengthInv;
+	v[1] *= lengthInv;
+	v[2] *= lengthInv;
+}
+#endif	// A3_HIERARCHY_SIMD
+
+
+//-----------------------------------------------------------------------------
+
+// create morph engine
+a3i32 a3morphEngineCreate(a3_MorphEngine *engine_out, const a3_GeometryData *base, const a3_GeometryData *targetList, const a3ui32 targetCount, const a3real tolerance)
+{
+	if (engine_out && !engine_out->data && base && base->numVertices && base->attribData[a3attrib_geomPosition] &&
+		targetCount <= a3morph_targetMax && (targetList || !targetCount))
+	{
+		const a3ui32 vertexCount = base->numVertices;
+		const a3real *position = (const a3real *)base->attribData[a3attrib_geomPosition];
+		const a3real *normal = (const a3real *)base->attribData[a3attrib_geomNormal];
+		const a3real *tangent = (const a3real *)base->attribData[a3attrib_geomTangent];
+		a3real delta[a3morph_vertexStride], *vertex;
+		a3ui32 t, v, e, entryCount;
+		size_t dataSize;
+
+		// targets must match the base vertex for vertex
+		for (t = 0; t < targetCount; ++t)
+			if (targetList[t].numVertices != vertexCount || !targetList[t].attribData[a3attrib_geomPosition])
+				return -1;
+
+		// count moving vertices, then allocate once: base and evaluated 
+		//	streams, entry deltas, entry indices
+		for (t = entryCount = 0; t < targetCount; ++t)
+			for (v = 0; v < vertexCount; ++v)
+				entryCount += (a3morphInternalDelta(delta, position + v * 3, normal ? normal + v * 3 : 0, tangent ? tangent + v * 3 : 0, targetList + t, v) > tolerance);
+		dataSize = sizeof(a3real) * a3morph_vertexStride * (vertexCount * 2 + entryCount) + sizeof(a3ui32) * entryCount + 15;
+		engine_out->data = malloc(dataSize);
+		if (!engine_out->data)
+			return -1;
+		engine_out->base = (a3real *)(((size_t)engine_out->data + 15) & ~(size_t)15);
+		engine_out->stream = engine_out->base + vertexCount * a3morph_vertexStride;
+		engine_out->entryDelta = engine_out->stream + vertexCount * a3morph_vertexStride;
+		engine_out->entryIndex = (a3ui32 *)(engine_out->entryDelta + entryCount * a3morph_vertexStride);
+
+		// interleave base
+		for (v = 0, vertex = engine_out->base; v < vertexCount; ++v, vertex += a3morph_vertexStride)
+		{
+			memset(vertex, 0, sizeof(a3real) * a3morph_vertexStride);
+			memcpy(vertex, position + v * 3, sizeof(a3real) * 3);
+			vertex[3] = a3real_one;
+			if (normal)
+				memcpy(vertex + 4, normal + v * 3, sizeof(a3real) * 3);
+			if (tangent)
+				memcpy(vertex + 8, tangent + v * 3, sizeof(a3real) * 3);
+		}
+		memcpy(engine_out->stream, engine_out->base, sizeof(a3real) * a3morph_vertexStride * vertexCount);
+
+		// store entries and each target's range
+		for (t = e = 0; t < targetCount; ++t)
+		{
+			engine_out->targetEntry[t] = e;
+			engine_out->targetFirstVertex[t] = vertexCount;
+			engine_out->targetLastVertex[t] = 0;
+			for (v = 0; v < vertexCount; ++v)
+				if (a3morphInternalDelta(engine_out->entryDelta + e * a3morph_vertexStride, position + v * 3, normal ? normal + v * 3 : 0, tangent ? tangent + v * 3 : 0, targetList + t, v) > tolerance)
+				{
+					engine_out->entryIndex[e++] = v;
+					engine_out->targetFirstVertex[t] = a3minimum(engine_out->targetFirstVertex[t], v);
+					engine_out->targetLastVertex[t] = v;
+				}
+			engine_out->weight[t] = a3real_zero;
+		}
+		engine_out->targetEntry[targetCount] = e;
+
+		engine_out->activeCount = 0;
+		engine_out->dirtyFirst = vertexCount;
+		engine_out->dirtyLast = 0;
+		engine_out->vertexCount = vertexCount;
+		engine_out->targetCount = targetCount;
+		engine_out->entryCount = entryCount;
+		engine_out->normals = (normal != 0);
+		engine_out->tangents = (tangent != 0);
+		return entryCount;
+	}
+	return -1;
+}
+
+// release morph engine
+a3i32 a3morphEngineRelease(a3_MorphEngine *engine)
+{
+	if (engine && engine->data)
+	{
+		free(engine->data);
+		engine->data = 0;
+		engine->base = engine->stream = engine->entryDelta = 0;
+		engine->entryIndex = 0;
+		engine->vertexCount = engine->targetCount = engine->entryCount = engine->activeCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// evaluate stream
+a3i32 a3morphEngineEvaluate(a3_MorphEngine *engine)
+{
+	if (engine && engine->data)
+	{
+		const a3real *delta;
+		a3real *vertex;
+		a3ui32 a, t, e, eEnd, dirtyFirst = engine->vertexCount, dirtyLast = 0;
+#ifdef A3_HIERARCHY_SIMD
+		__m128 w;
+#else	// !A3_HIERARCHY_SIMD
+		a3real w;
+		a3ui32 i;
+#endif	// A3_HIERARCHY_SIMD
+
+		// restore vertices touched last time
+		for (a = 0; a < engine->activeCount; ++a)
+		{
+			t = engine->active[a];
+			for (e = engine->targetEntry[t], eEnd = engine->targetEntry[t + 1]; e < eEnd; ++e)
+				memcpy(engine->stream + engine->entryIndex[e] * a3morph_vertexStride, engine->base + engine->entryIndex[e] * a3morph_vertexStride, a3morph_vertexSize);
+			dirtyFirst = a3minimum(dirtyFirst, engine->targetFirstVertex[t]);
+			dirtyLast = a3maximum(dirtyLast, engine->targetLastVertex[t]);
+		}
+
+		// accumulate targets with weight
+		for (t = engine->activeCount = 0; t < engine->targetCount; ++t)
+		{
+			e = engine->targetEntry[t];
+			eEnd = engine->targetEntry[t + 1];
+			if (engine->weight[t] == a3real_zero || e == eEnd)
+				continue;
+			engine->active[engine->activeCount++] = t;
+			dirtyFirst = a3minimum(dirtyFirst, engine->targetFirstVertex[t]);
+			dirtyLast = a3maximum(dirtyLast, engine->targetLastVertex[t]);
+			delta = engine->entryDelta + e * a3morph_vertexStride;
+#ifdef A3_HIERARCHY_SIMD
+			w = _mm_set1_ps(engine->weight[t]);
+			for (; e < eEnd; ++e, delta += a3morph_vertexStride)
+			{
+				vertex = engine->stream + engine->entryIndex[e] * a3morph_vertexStride;
+				_mm_store_ps(vertex + 0, _mm_add_ps(_mm_load_ps(vertex + 0), _mm_mul_ps(_mm_load_ps(delta + 0), w)));
+				_mm_store_ps(vertex + 4, _mm_add_ps(_mm_load_ps(vertex + 4), _mm_mul_ps(_mm_load_ps(delta + 4), w)));
+				_mm_store_ps(vertex + 8, _mm_add_ps(_mm_load_ps(vertex + 8), _mm_mul_ps(_mm_load_ps(delta + 8), w)));
+			}
+#else	// !A3_HIERARCHY_SIMD
+			w = engine->weight[t];
+			for (; e < eEnd; ++e, delta += a3morph_vertexStride)
+			{
+				vertex = engine->stream + engine->entryIndex[e] * a3morph_vertexStride;
+				for (i = 0; i < a3morph_vertexStride; ++i)
+					vertex[i] += delta[i] * w;
+			}
+#endif	// A3_HIERARCHY_SIMD
+		}
+
+		// renormalize touched directions; a vertex shared by several 
+		//	targets is normalized more than once, which changes nothing
+		if (engine->normals || engine->tangents)
+			for (a = 0; a < engine->activeCount; ++a)
+			{
+				t = engine->active[a];
+				for (e = engine->targetEntry[t], eEnd = engine->targetEntry[t + 1]; e < eEnd; ++e)
+				{
+					vertex = engine->stream + engine->entryIndex[e] * a3morph_vertexStride;
+					if (engine->normals)
+						a3morphInternalNormalize(vertex + 4);
+					if (engine->tangents)
+						a3morphInternalNormalize(vertex + 8);
+				}
+			}
+
+		engine->dirtyFirst = dirtyFirst;
+		engine->dirtyLast = dirtyLast;
+		return engine->activeCount;
+	}
+	return -1;
+}
+
+// upload changed vertices
+a3i32 a3morphEngineUpload(const a3_MorphEngine *engine, a3_VertexBuffer *buffer, const a3ui32 offset)
+{
+	if (engine && engine->data && buffer)
+	{
+		const a3ui32 first = engine->dirtyFirst, last = engine->dirtyLast;
+		a3ui32 size;
+		if (first > last)
+			return 0;
+		size = (last - first + 1) * a3morph_vertexSize;
+		if (a3bufferRefillOffset(buffer, 0, offset + first * a3morph_vertexSize, size, engine->stream + first * a3morph_vertexStride) > 0)
+			return size;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
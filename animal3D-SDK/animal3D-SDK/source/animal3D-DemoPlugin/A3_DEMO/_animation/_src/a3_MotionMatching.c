@@ -0,0 +1,436 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MotionMatching.c
+	Implementation of motion matching database and search.
+*/
+
+#include "../a3_MotionMatching.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// solve object-space pose for pose index
+inline void a3motionMatchingInternalSolve(const a3_HierarchyState *state, const a3ui32 poseIndex)
+{
+	a3hierarchyStateUpdateLocal(state, state->poseGroup->hpose + poseIndex);
+	a3kinematicsSolveForward(state);
+}
+
+// transform point by affine matrix
+inline void a3motionMatchingInternalTransform(a3real *p_out, const a3real4x4p m, const a3real *p)
+{
+	p_out[0] = m[0][0] * p[0] + m[1][0] * p[1] + m[2][0] * p[2] + m[3][0];
+	p_out[1] = m[0][1] * p[0] + m[1][1] * p[1] + m[2][1] * p[2] + m[3][1];
+	p_out[2] = m[0][2] * p[0] + m[1][2] * p[1] + m[2][2] * p[2] + m[3][2];
+}
+
+// keyframe some distance ahead, looping within clip or held at its end
+inline a3ui32 a3motionMatchingInternalAdvance(const a3_Clip *clip, const a3ui32 keyframe, const a3ui32 offset, const a3boolean loop)
+{
+	const a3ui32 count = clip->last_keyframe - clip->first_keyframe + 1;
+	if (loop)
+		return (clip->first_keyframe + (keyframe - clip->first_keyframe + offset) % count);
+	return a3minimum(keyframe + offset, clip->last_keyframe);
+}
+
+// raw features of one entry
+inline void a3motionMatchingInternalExtract(a3real *feature_out, const a3_MotionMatchingDatabase *database, const a3_HierarchyState *state, const a3_MotionMatchingEntry *entry, const a3boolean loop)
+{
+	const a3_Clip *clip = database->clipPool->clip + entry->clip;
+	const a3_Keyframe *keyframe = clip->keyframe_pool->keyframe;
+	const a3_SpatialPose *objectPose = state->objectHPose->spatialPose;
+	const a3real dtInv = a3recipsafe(keyframe[entry->keyframe].duration);
+	a3mat4 rootInv;
+	a3real next[3];
+	a3ui32 i;
+
+	// positions in root space of current frame
+	a3motionMatchingInternalSolve(state, entry->pose);
+	a3real4x4TransformInverse(rootInv.m, objectPose->transform.m);
+	for (i = 0; i < database->featureNodeCount; ++i)
+		a3motionMatchingInternalTransform(feature_out + i * 6, rootInv.m, objectPose[database->featureNode[i]].transform.v3.v);
+
+	// velocities from next frame, same space
+	a3motionMatchingInternalSolve(state, keyframe[a3motionMatchingInternalAdvance(clip, entry->keyframe, 1, loop)].data);
+	for (i = 0; i < database->featureNodeCount; ++i)
+	{
+		a3motionMatchingInternalTransform(next, rootInv.m, objectPose[database->featureNode[i]].transform.v3.v);
+		feature_out[i * 6 + 3] = (next[0] - feature_out[i * 6 + 0]) * dtInv;
+		feature_out[i * 6 + 4] = (next[1] - feature_out[i * 6 + 1]) * dtInv;
+		feature_out[i * 6 + 5] = (next[2] - feature_out[i * 6 + 2]) * dtInv;
+	}
+
+	// future root positions
+	feature_out += database->featureNodeCount * 6;
+	for (i = 0; i < database->trajectoryCount; ++i, feature_out += 3)
+	{
+		a3motionMatchingInternalSolve(state, keyframe[a3motionMatchingInternalAdvance(clip, entry->keyframe, database->trajectoryOffset[i], loop)].data);
+		a3motionMatchingInternalTransform(feature_out, rootInv.m, objectPose->transform.v3.v);
+	}
+}
+
+// squared distance between padded rows; stops early once past bound
+inline a3real a3motionMatchingInternalDistance(const a3real *row, const a3real *query, const a3ui32 dimStride, const a3real bound)
+{
+	a3real d = a3real_zero;
+	a3ui32 j;
+#ifdef A3_HIERARCHY_SIMD
+	__m128 sum = _mm_setzero_ps(), v;
+	for (j = 0; j < dimStride; j += 4)
+	{
+		v = _mm_sub_ps(_mm_load_ps(row + j), _mm_load_ps(query + j));
+		sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+
+		// check every eight dimensions and at the end
+		if ((j & 4) || j + 4 >= dimStride)
+		{
+			v = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			d = _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+			if (d >= bound)
+				break;
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3real v;
+	for (j = 0; j < dimStride; ++j)
+	{
+		v = row[j] - query[j];
+		d += v * v;
+		if ((j & 7) == 7 && d >= bound)
+			break;
+	}
+#endif	// A3_HIERARCHY_SIMD
+	return d;
+}
+
+// swap two feature rows and their entries
+inline void a3motionMatchingInternalSwap(a3_MotionMatchingDatabase *database, const a3ui32 i0, const a3ui32 i1)
+{
+	a3real tmp[a3motionMatching_dimMax];
+	a3_MotionMatchingEntry entry;
+	a3real *row0 = database->feature + i0 * database->dimStride, *row1 = database->feature + i1 * database->dimStride;
+	if (i0 != i1)
+	{
+		memcpy(tmp, row0, sizeof(a3real) * database->dimStride);
+		memcpy(row0, row1, sizeof(a3real) * database->dimStride);
+		memcpy(row1, tmp, sizeof(a3real) * database->dimStride);
+		entry = database->entry[i0];
+		database->entry[i0] = database->entry[i1];
+		database->entry[i1] = entry;
+	}
+}
+
+// partition rows so that the row at 'k' holds the median along axis
+inline void a3motionMatchingInternalSelect(a3_MotionMatchingDatabase *database, a3ui32 lo, a3ui32 hi, const a3ui32 k, const a3ui32 axis)
+{
+	const a3real *key = database->feature + axis;
+	const a3ui32 stride = database->dimStride;
+	a3real pivot;
+	a3ui32 i, store;
+	while (lo < hi)
+	{
+		a3motionMatchingInternalSwap(database, (lo + hi) / 2, hi);
+		pivot = key[hi * stride];
+		for (i = store = lo; i < hi; ++i)
+			if (key[i * stride] < pivot)
+				a3motionMatchingInternalSwap(database, i, store++);
+		a3motionMatchingInternalSwap(database, store, hi);
+		if (store == k)
+			return;
+		else if (k < store)
+			hi = store - 1;
+		else
+			lo = store + 1;
+	}
+}
+
+// build tree breadth-first: split each node on its widest dimension at 
+//	the median until leaves are small
+inline void a3motionMatchingInternalBuild(a3_MotionMatchingDatabase *database)
+{
+	a3_MotionMatchingTreeNode *node;
+	a3real lo[a3motionMatching_dimMax], hi[a3motionMatching_dimMax], spread, v;
+	const a3real *row;
+	a3ui32 i, r, j, mid;
+
+	node = database->node;
+	node->first = 0;
+	node->count = database->entryCount;
+	node->child = node->axis = 0;
+	node->split = a3real_zero;
+	database->nodeCount = 1;
+	for (i = 0; i < database->nodeCount; ++i)
+	{
+		node = database->node + i;
+		if (node->count <= a3motionMatching_leafSize)
+			continue;
+
+		// widest dimension
+		row = database->feature + node->first * database->dimStride;
+		for (j = 0; j < database->dim; ++j)
+			lo[j] = hi[j] = row[j];
+		for (r = 1, row += database->dimStride; r < node->count; ++r, row += database->dimStride)
+			for (j = 0; j < database->dim; ++j)
+			{
+				lo[j] = a3minimum(lo[j], row[j]);
+				hi[j] = a3maximum(hi[j], row[j]);
+			}
+		for (j = 1, node->axis = 0, spread = hi[0] - lo[0]; j < database->dim; ++j)
+			if ((v = hi[j] - lo[j]) > spread)
+			{
+				spread = v;
+				node->axis = j;
+			}
+		if (spread <= a3real_zero)
+			continue;
+
+		// split at median; children are adjacent
+		mid = node->first + node->count / 2;
+		a3motionMatchingInternalSelect(database, node->first, node->first + node->count - 1, mid, node->axis);
+		node->split = database->feature[mid * database->dimStride + node->axis];
+		node->child = database->nodeCount;
+		database->nodeCount += 2;
+		database->node[node->child].first = node->first;
+		database->node[node->child].count = mid - node->first;
+		database->node[node->child + 1].first = mid;
+		database->node[node->child + 1].count = node->first + node->count - mid;
+		for (j = 0; j < 2; ++j)
+		{
+			database->node[node->child + j].child = database->node[node->child + j].axis = 0;
+			database->node[node->child + j].split = a3real_zero;
+		}
+	}
+}
+
+// copy query into aligned, padded buffer
+inline a3real *a3motionMatchingInternalQuery(a3real *buffer, const a3_MotionMatchingDatabase *database, const a3real *query)
+{
+	a3real *const q = (a3real *)(((size_t)buffer + 15) & ~(size_t)15);
+	memcpy(q, query, sizeof(a3real) * database->dim);
+	memset(q + database->dim, 0, sizeof(a3real) * (database->dimStride - database->dim));
+	return q;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create database
+a3i32 a3motionMatchingDatabaseCreate(a3_MotionMatchingDatabase *database_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *featureNode, const a3ui32 featureNodeCount, const a3ui32 *trajectoryOffset, const a3ui32 trajectoryCount, const a3boolean *clipLoop_opt)
+{
+	if (database_out && !database_out->data && poseGroup && poseGroup->hierarchy && clipPool && clipPool->clip &&
+		(featureNode || !featureNodeCount) && (trajectoryOffset || !trajectoryCount) &&
+		featureNodeCount <= a3motionMatching_featureNodeMax && trajectoryCount <= a3motionMatching_trajectoryMax && featureNodeCount + trajectoryCount)
+	{
+		a3_HierarchyState state[1] = { 0 };
+		a3_MotionMatchingEntry *entry;
+		const a3_Clip *clip;
+		a3real *row, var;
+		size_t dataSize;
+		a3ui32 entryCount, nodeMax, dim, dimStride, c, k, i, j;
+
+		// validate layout and count frames
+		for (i = 0; i < featureNodeCount; ++i)
+			if (featureNode[i] >= poseGroup->hierarchy->numNodes)
+				return -1;
+		for (c = entryCount = 0, clip = clipPool->clip; c < clipPool->count; ++c, ++clip)
+		{
+			if (!clip->keyframe_pool || clip->first_keyframe > clip->last_keyframe || clip->last_keyframe >= clip->keyframe_pool->count)
+				return -1;
+			for (k = clip->first_keyframe; k <= clip->last_keyframe; ++k)
+				if (clip->keyframe_pool->keyframe[k].data >= poseGroup->hposeCount)
+					return -1;
+			entryCount += clip->last_keyframe - clip->first_keyframe + 1;
+		}
+		if (!entryCount)
+			return -1;
+
+		// allocate; leaves hold at least half the leaf size
+		dim = featureNodeCount * 6 + trajectoryCount * 3;
+		dimStride = (dim + 3) / 4 * 4;
+		nodeMax = (entryCount / (a3motionMatching_leafSize / 2) + 1) * 2;
+		dataSize = sizeof(a3real) * dimStride * (entryCount + 2) + 16 + sizeof(a3_MotionMatchingEntry) * entryCount + sizeof(a3_MotionMatchingTreeNode) * nodeMax;
+		database_out->data = malloc(dataSize);
+		if (!database_out->data)
+			return -1;
+		if (a3hierarchyStateCreate(state, poseGroup) < 0)
+		{
+			free(database_out->data);
+			database_out->data = 0;
+			return -1;
+		}
+		memset(database_out->data, 0, dataSize);
+		database_out->feature = (a3real *)(((size_t)database_out->data + 15) & ~(size_t)15);
+		database_out->mean = database_out->feature + dimStride * entryCount;
+		database_out->scale = database_out->mean + dimStride;
+		database_out->entry = (a3_MotionMatchingEntry *)(database_out->scale + dimStride);
+		database_out->node = (a3_MotionMatchingTreeNode *)(database_out->entry + entryCount);
+		database_out->poseGroup = poseGroup;
+		database_out->clipPool = clipPool;
+		database_out->featureNodeCount = featureNodeCount;
+		database_out->trajectoryCount = trajectoryCount;
+		for (i = 0; i < featureNodeCount; ++i)
+			database_out->featureNode[i] = featureNode[i];
+		for (i = 0; i < trajectoryCount; ++i)
+			database_out->trajectoryOffset[i] = trajectoryOffset[i];
+		database_out->dim = dim;
+		database_out->dimStride = dimStride;
+		database_out->entryCount = entryCount;
+
+		// extract raw features
+		for (c = 0, entry = database_out->entry, row = database_out->feature, clip = clipPool->clip; c < clipPool->count; ++c, ++clip)
+			for (k = clip->first_keyframe; k <= clip->last_keyframe; ++k, ++entry, row += dimStride)
+			{
+				entry->clip = c;
+				entry->keyframe = k;
+				entry->pose = clip->keyframe_pool->keyframe[k].data;
+				a3motionMatchingInternalExtract(row, database_out, state, entry, clipLoop_opt && clipLoop_opt[c]);
+			}
+		a3hierarchyStateRelease(state);
+
+		// normalize each 3-vector by its mean and average spread
+		for (i = 0, row = database_out->feature; i < entryCount; ++i, row += dimStride)
+			for (j = 0; j < dim; ++j)
+				database_out->mean[j] += row[j];
+		for (j = 0; j < dim; ++j)
+			database_out->mean[j] /= (a3real)entryCount;
+		for (i = 0, row = database_out->feature; i < entryCount; ++i, row += dimStride)
+			for (j = 0; j < dim; ++j)
+				database_out->scale[j] += (row[j] - database_out->mean[j]) * (row[j] - database_out->mean[j]);
+		for (j = 0; j < dim; j += 3)
+		{
+			var = (database_out->scale[j] + database_out->scale[j + 1] + database_out->scale[j + 2]) / (a3real)(entryCount * 3);
+			database_out->scale[j] = database_out->scale[j + 1] = database_out->scale[j + 2] = a3recipsafe(a3sqrt(var));
+		}
+		for (i = 0, row = database_out->feature; i < entryCount; ++i, row += dimStride)
+			a3motionMatchingDatabaseNormalize(database_out, row, row);
+
+		// index
+		a3motionMatchingInternalBuild(database_out);
+		return entryCount;
+	}
+	return -1;
+}
+
+// release database
+a3i32 a3motionMatchingDatabaseRelease(a3_MotionMatchingDatabase *database)
+{
+	if (database && database->data)
+	{
+		free(database->data);
+		memset(database, 0, sizeof(a3_MotionMatchingDatabase));
+		return 1;
+	}
+	return -1;
+}
+
+// find entry for clip keyframe
+a3i32 a3motionMatchingDatabaseGetEntryIndex(const a3_MotionMatchingDatabase *database, const a3ui32 clip, const a3ui32 keyframe)
+{
+	a3ui32 i;
+	if (database && database->data)
+	{
+		for (i = 0; i < database->entryCount; ++i)
+			if (database->entry[i].clip == clip && database->entry[i].keyframe == keyframe)
+				return i;
+	}
+	return -1;
+}
+
+// tree search
+a3i32 a3motionMatchingQuery(const a3_MotionMatchingDatabase *database, const a3real *query, a3real *distanceSq_out_opt)
+{
+	if (database && database->data && query)
+	{
+		a3real buffer[a3motionMatching_dimMax + 4];
+		a3ui32 stackNode[a3motionMatching_searchDepthMax];
+		a3real stackBound[a3motionMatching_searchDepthMax];
+		const a3real *const q = a3motionMatchingInternalQuery(buffer, database, query);
+		const a3_MotionMatchingTreeNode *node;
+		const a3real *row;
+		a3real best = (a3real)1.0e30f, d, bound;
+		a3i32 bestIndex = -1;
+		a3ui32 top = 1, r;
+
+		// depth-first from root, skipping subtrees that cannot beat best
+		stackNode[0] = 0;
+		stackBound[0] = a3real_zero;
+		while (top)
+		{
+			--top;
+			if (stackBound[top] >= best)
+				continue;
+			node = database->node + stackNode[top];
+			if (!node->child)
+			{
+				for (r = node->first, row = database->feature + r * database->dimStride; r < node->first + node->count; ++r, row += database->dimStride)
+					if ((d = a3motionMatchingInternalDistance(row, q, database->dimStride, best)) < best)
+					{
+						best = d;
+						bestIndex = r;
+					}
+			}
+			else
+			{
+				// far side first so near side is searched next
+				d = q[node->axis] - node->split;
+				bound = stackBound[top];
+				stackNode[top] = node->child + (d < a3real_zero);
+				stackBound[top++] = a3maximum(bound, d * d);
+				stackNode[top] = node->child + (d >= a3real_zero);
+				stackBound[top++] = bound;
+			}
+		}
+		if (distanceSq_out_opt)
+			*distanceSq_out_opt = best;
+		return bestIndex;
+	}
+	return -1;
+}
+
+// exhaustive search
+a3i32 a3motionMatchingQueryBruteForce(const a3_MotionMatchingDatabase *database, const a3real *query, a3real *distanceSq_out_opt)
+{
+	if (database && database->data && query)
+	{
+		a3real buffer[a3motionMatching_dimMax + 4];
+		const a3real *const q = a3motionMatchingInternalQuery(buffer, database, query);
+		const a3real *row;
+		a3real best = (a3real)1.0e30f, d;
+		a3i32 bestIndex = -1;
+		a3ui32 r;
+		for (r = 0, row = database->feature; r < database->entryCount; ++r, row += database->dimStride)
+			if ((d = a3motionMatchingInternalDistance(row, q, database->dimStride, best)) < best)
+			{
+				best = d;
+				bestIndex = r;
+			}
+		if (distanceSq_out_opt)
+			*distanceSq_out_opt = best;
+		return bestIndex;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
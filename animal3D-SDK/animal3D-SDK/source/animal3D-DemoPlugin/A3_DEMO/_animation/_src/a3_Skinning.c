@@ -0,0 +1,826 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_Skinning.c
+	Implementation of CPU skinning kernels.
+*/
+
+#include "../a3_Skinning.h"
+
+// A3 file streaming
+#include "animal3D/a3utility/a3_Stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// platform primitives: full memory barrier between writing vertices and 
+//	publishing completion; yield while waiting for workers; semaphore a 
+//	worker parks on between deforms (one per worker, so a worker that 
+//	finishes early cannot take another's wake-up)
+#ifdef _WIN32
+#include <Windows.h>
+#define a3skinningInternalBarrier()		MemoryBarrier()
+#define a3skinningInternalYield()		SwitchToThread()
+inline void *a3skinningInternalParkCreate()
+{
+	return CreateSemaphoreA(0, 0, 1, 0);
+}
+inline void a3skinningInternalParkRelease(void *park)
+{
+	CloseHandle((HANDLE)park);
+}
+inline void a3skinningInternalPark(void *park)
+{
+	WaitForSingleObject((HANDLE)park, INFINITE);
+}
+inline void a3skinningInternalUnpark(void *park)
+{
+	ReleaseSemaphore((HANDLE)park, 1, 0);
+}
+#else	// !_WIN32
+#include <sched.h>
+#include <semaphore.h>
+#define a3skinningInternalBarrier()		__sync_synchronize()
+#define a3skinningInternalYield()		sched_yield()
+inline void *a3skinningInternalParkCreate()
+{
+	sem_t *park = (sem_t *)malloc(sizeof(sem_t));
+	if (park && sem_init(park, 0, 0))
+	{
+		free(park);
+		park = 0;
+	}
+	return park;
+}
+inline void a3skinningInternalParkRelease(void *park)
+{
+	sem_destroy((sem_t *)park);
+	free(park);
+}
+inline void a3skinningInternalPark(void *park)
+{
+	while (sem_wait((sem_t *)park));
+}
+inline void a3skinningInternalUnpark(void *park)
+{
+	sem_post((sem_t *)park);
+}
+#endif	// _WIN32
+
+// spins while waiting for workers before yielding
+#define a3skinningInternalSpinMax		1024
+
+
+//-----------------------------------------------------------------------------
+
+// rotate vector by unit quaternion (x, y, z, w): 
+//	v' = v + 2 r x (r x v + w v)
+inline void a3skinningInternalRotate(a3real *v_out, const a3real *q, const a3real *v)
+{
+	const a3real tx = q[1] * v[2] - q[2] * v[1] + q[3] * v[0];
+	const a3real ty = q[2] * v[0] - q[0] * v[2] + q[3] * v[1];
+	const a3real tz = q[0] * v[1] - q[1] * v[0] + q[3] * v[2];
+	v_out[0] = v[0] + (q[1] * tz - q[2] * ty) * a3real_two;
+	v_out[1] = v[1] + (q[2] * tx - q[0] * tz) * a3real_two;
+	v_out[2] = v[2] + (q[0] * ty - q[1] * tx) * a3real_two;
+}
+
+
+// dual quaternion skinning
+a3i32 a3skinningDeformDualQuat(a3real *position_out, a3real *normal_out_opt, const a3real *position, const a3real *normal_opt, const a3real *blendWeight, const a3i32 *blendIndex, const a3ui32 vertexCount, const a3real *palette)
+{
+	if (position_out && position && blendWeight && blendIndex && palette)
+	{
+		// normals are only rotated; translation of the blended transform 
+		//	is 2 (w d - d.w r + r x d) for real part (r, w), dual part d
+		const a3boolean usingNormals = (normal_out_opt && normal_opt);
+		a3real Q[8];
+		a3ui32 i;
+#ifdef A3_HIERARCHY_SIMD
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		__m128 r, d, r0, w, dot, len;
+		const a3real *Qi;
+		a3ui32 j;
+#endif	// A3_HIERARCHY_SIMD
+		for (i = 0; i < vertexCount; ++i, position += 3, position_out += 3, blendWeight += 4, blendIndex += 4)
+		{
+#ifdef A3_HIERARCHY_SIMD
+			// blend in two registers; sign correction flips the weight's 
+			//	sign bit by the sign of the dot product with the first entry
+			r0 = _mm_loadu_ps(palette + blendIndex[0] * a3hierarchyPalette_dualquat);
+			r = d = _mm_setzero_ps();
+			for (j = 0; j < a3skinning_influenceMax; ++j)
+			{
+				Qi = palette + blendIndex[j] * a3hierarchyPalette_dualquat;
+				w = _mm_load1_ps(blendWeight + j);
+				dot = _mm_mul_ps(_mm_loadu_ps(Qi), r0);
+				dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+				dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+				w = _mm_xor_ps(w, _mm_and_ps(dot, signMask));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(Qi), w));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(Qi + 4), w));
+			}
+			len = _mm_mul_ps(r, r);
+			len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(2, 3, 0, 1)));
+			len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(1, 0, 3, 2)));
+			len = _mm_sqrt_ps(len);
+			_mm_storeu_ps(Q, _mm_div_ps(r, len));
+			_mm_storeu_ps(Q + 4, _mm_div_ps(d, len));
+#else	// !A3_HIERARCHY_SIMD
+			a3skinningBlendDualQuat(Q, palette, blendWeight, blendIndex);
+#endif	// A3_HIERARCHY_SIMD
+
+			a3skinningInternalRotate(position_out, Q, position);
+			position_out[0] += (Q[3] * Q[4] - Q[7] * Q[0] + Q[1] * Q[6] - Q[2] * Q[5]) * a3real_two;
+			position_out[1] += (Q[3] * Q[5] - Q[7] * Q[1] + Q[2] * Q[4] - Q[0] * Q[6]) * a3real_two;
+			position_out[2] += (Q[3] * Q[6] - Q[7] * Q[2] + Q[0] * Q[5] - Q[1] * Q[4]) * a3real_two;
+			if (usingNormals)
+			{
+				a3skinningInternalRotate(normal_out_opt, Q, normal_opt);
+				normal_out_opt += 3;
+				normal_opt += 3;
+			}
+		}
+		return vertexCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef A3_HIERARCHY_SIMD
+// store xyz of register without touching the next vertex
+inline void a3skinningInternalStore3(a3real *v_out, const __m128 v)
+{
+	_mm_storel_pi((__m64 *)v_out, v);
+	_mm_store_ss(v_out + 2, _mm_movehl_ps(v, v));
+}
+
+// transform direction by blended columns and renormalize
+inline void a3skinningInternalTransformDirection(a3real *v_out, const a3real *v, const __m128 c0, const __m128 c1, const __m128 c2)
+{
+	__m128 d = _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(c0, _mm_set1_ps(v[0])),
+		_mm_mul_ps(c1, _mm_set1_ps(v[1]))),
+		_mm_mul_ps(c2, _mm_set1_ps(v[2])));
+	__m128 len = _mm_mul_ps(d, d);
+	len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(2, 3, 0, 1)));
+	len = _mm_add_ps(len, _mm_shuffle_ps(len, len, _MM_SHUFFLE(1, 0, 3, 2)));
+	a3skinningInternalStore3(v_out, _mm_div_ps(d, _mm_sqrt_ps(len)));
+}
+#else	// !A3_HIERARCHY_SIMD
+// transform direction by blended matrix and renormalize
+inline void a3skinningInternalTransformDirection(a3real *v_out, const a3real *v, const a3real m[4][3])
+{
+	a3real d[3], lengthInv;
+	a3ui32 r;
+	for (r = 0; r < 3; ++r)
+		d[r] = m[0][r] * v[0] + m[1][r] * v[1] + m[2][r] * v[2];
+	lengthInv = a3recipsafe(a3sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+	for (r = 0; r < 3; ++r)
+		v_out[r] = d[r] * lengthInv;
+}
+#endif	// A3_HIERARCHY_SIMD
+
+
+// linear blend skinning of vertex range
+a3i32 a3skinningEngineDeformRange(const a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout, const a3ui32 firstVertex, const a3ui32 vertexCount)
+{
+	if (engine && engine->geom && palette &&
+		(layout == a3hierarchyPalette_mat4 || layout == a3hierarchyPalette_mat3x4) &&
+		firstVertex <= engine->vertexCount)
+	{
+		// blend the influences' matrices once per vertex, then transform 
+		//	every attribute with the blended matrix
+		const a3ui32 lastVertex = a3minimum(firstVertex + vertexCount, engine->vertexCount);
+		const a3real *blendWeight = engine->blendWeight + firstVertex * 4, *P;
+		const a3i32 *blendIndex = engine->blendIndex + firstVertex * 4;
+		a3ui32 i, j, v;
+#ifdef A3_HIERARCHY_SIMD
+		// mat3x4 rows are blended and transposed to columns; the implied 
+		//	bottom row (0, 0, 0, 1) becomes the fourth row
+		__m128 c[4], w;
+		for (i = firstVertex; i < lastVertex; ++i, blendWeight += 4, blendIndex += 4)
+		{
+			c[0] = c[1] = c[2] = c[3] = _mm_setzero_ps();
+			for (j = 0; j < a3skinning_influenceMax; ++j)
+			{
+				P = palette + blendIndex[j] * layout;
+				w = _mm_set1_ps(blendWeight[j]);
+				c[0] = _mm_add_ps(c[0], _mm_mul_ps(_mm_loadu_ps(P + 0), w));
+				c[1] = _mm_add_ps(c[1], _mm_mul_ps(_mm_loadu_ps(P + 4), w));
+				c[2] = _mm_add_ps(c[2], _mm_mul_ps(_mm_loadu_ps(P + 8), w));
+				if (layout == a3hierarchyPalette_mat4)
+					c[3] = _mm_add_ps(c[3], _mm_mul_ps(_mm_loadu_ps(P + 12), w));
+			}
+			if (layout == a3hierarchyPalette_mat3x4)
+			{
+				c[3] = _mm_set_ps(a3real_one, a3real_zero, a3real_zero, a3real_zero);
+				_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+			}
+
+			v = i * 3;
+			a3skinningInternalStore3(engine->positionOut + v, _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(c[0], _mm_set1_ps(engine->position[v + 0])),
+				_mm_mul_ps(c[1], _mm_set1_ps(engine->position[v + 1]))),
+				_mm_mul_ps(c[2], _mm_set1_ps(engine->position[v + 2]))), c[3]));
+			if (engine->normal)
+				a3skinningInternalTransformDirection(engine->normalOut + v, engine->normal + v, c[0], c[1], c[2]);
+			if (engine->tangent)
+				a3skinningInternalTransformDirection(engine->tangentOut + v, engine->tangent + v, c[0], c[1], c[2]);
+			if (engine->bitangent)
+				a3skinningInternalTransformDirection(engine->bitangentOut + v, engine->bitangent + v, c[0], c[1], c[2]);
+		}
+#else	// !A3_HIERARCHY_SIMD
+		// m[j][r]: column j, row r of blended matrix
+		a3real m[4][3];
+		a3ui32 r;
+		for (i = firstVertex; i < lastVertex; ++i, blendWeight += 4, blendIndex += 4)
+		{
+			for (j = 0; j < 4; ++j)
+				for (r = 0; r < 3; ++r)
+					m[j][r] = a3real_zero;
+			for (v = 0; v < a3skinning_influenceMax; ++v)
+			{
+				P = palette + blendIndex[v] * layout;
+				for (j = 0; j < 4; ++j)
+					for (r = 0; r < 3; ++r)
+						m[j][r] += blendWeight[v] * (layout == a3hierarchyPalette_mat4 ? P[j * 4 + r] : P[r * 4 + j]);
+			}
+
+			v = i * 3;
+			for (r = 0; r < 3; ++r)
+				engine->positionOut[v + r] = m[0][r] * engine->position[v + 0] + m[1][r] * engine->position[v + 1] + m[2][r] * engine->position[v + 2] + m[3][r];
+			if (engine->normal)
+				a3skinningInternalTransformDirection(engine->normalOut + v, engine->normal + v, m);
+			if (engine->tangent)
+				a3skinningInternalTransformDirection(engine->tangentOut + v, engine->tangent + v, m);
+			if (engine->bitangent)
+				a3skinningInternalTransformDirection(engine->bitangentOut + v, engine->bitangent + v, m);
+		}
+#endif	// A3_HIERARCHY_SIMD
+		return (lastVertex - firstVertex);
+	}
+	return -1;
+}
+
+
+// worker thread: park between deforms, then skin own vertex range
+a3ret a3skinningInternalWorker(a3_SkinningWorker *worker)
+{
+	a3_SkinningEngine *engine = worker->engine;
+	for (;;)
+	{
+		a3skinningInternalPark(worker->park);
+		a3skinningInternalBarrier();
+		if (engine->stop)
+			break;
+		a3skinningEngineDeformRange(engine, engine->palette, engine->layout, worker->first, worker->count);
+		a3skinningInternalBarrier();
+		worker->deformsDone = engine->deformCount;
+	}
+	return worker->count;
+}
+
+// initialize skinning engine
+a3i32 a3skinningEngineCreate(a3_SkinningEngine *engine_out, const a3_GeometryData *geom, const a3ui32 workerCount)
+{
+	if (engine_out && !engine_out->geom && geom && geom->numVertices && workerCount <= a3skinning_workerMax &&
+		geom->attribData[a3attrib_geomPosition] && geom->attribData[a3attrib_geomBlending])
+	{
+		const a3ui32 vertexCount = geom->numVertices;
+		const void *blendIndex = 0, *bitangent = 0;
+		a3ui32 i, attribCount;
+		a3real *out;
+
+		if (a3geometryGetAddressBlendingInd(&blendIndex, geom) <= 0 || !blendIndex)
+			return -1;
+		if (geom->attribData[a3attrib_geomTangent])
+			a3geometryGetAddressBitangent(&bitangent, geom);
+
+		engine_out->position = (const a3real *)geom->attribData[a3attrib_geomPosition];
+		engine_out->normal = (const a3real *)geom->attribData[a3attrib_geomNormal];
+		engine_out->tangent = (const a3real *)geom->attribData[a3attrib_geomTangent];
+		engine_out->bitangent = (const a3real *)bitangent;
+		engine_out->blendWeight = (const a3real *)geom->attribData[a3attrib_geomBlending];
+		engine_out->blendIndex = (const a3i32 *)blendIndex;
+
+		// one output array per source attribute (one malloc)
+		attribCount = 1 + !!engine_out->normal + !!engine_out->tangent + !!engine_out->bitangent;
+		engine_out->data = malloc(sizeof(a3real) * 3 * vertexCount * attribCount);
+		if (!engine_out->data)
+			return -1;
+		out = (a3real *)engine_out->data;
+		engine_out->positionOut = out;
+		engine_out->normalOut = engine_out->normal ? (out += 3 * vertexCount) : 0;
+		engine_out->tangentOut = engine_out->tangent ? (out += 3 * vertexCount) : 0;
+		engine_out->bitangentOut = engine_out->bitangent ? (out += 3 * vertexCount) : 0;
+
+		engine_out->geom = geom;
+		engine_out->vertexCount = vertexCount;
+		engine_out->workerCount = workerCount;
+		engine_out->palette = 0;
+		engine_out->layout = a3hierarchyPalette_mat4;
+		engine_out->deformCount = 0;
+		engine_out->stop = a3false;
+
+		// caller is participant 0; worker i skins participant i + 1's range
+		for (i = 0; i < a3skinning_workerMax; ++i)
+		{
+			memset(engine_out->worker[i].thread, 0, sizeof(a3_Thread));
+			engine_out->worker[i].engine = engine_out;
+			engine_out->worker[i].first = engine_out->worker[i].count = 0;
+			engine_out->worker[i].park = 0;
+			engine_out->worker[i].deformsDone = 0;
+			engine_out->worker[i].launched = a3false;
+		}
+		for (i = 0; i < workerCount; ++i)
+		{
+			engine_out->worker[i].first = vertexCount * (i + 1) / (workerCount + 1);
+			engine_out->worker[i].count = vertexCount * (i + 2) / (workerCount + 1) - engine_out->worker[i].first;
+		}
+
+		// launch workers once; they park until the first deform
+		for (i = 0; i < workerCount; ++i)
+		{
+			engine_out->worker[i].park = a3skinningInternalParkCreate();
+			if (engine_out->worker[i].park)
+				engine_out->worker[i].launched = (a3threadLaunch(engine_out->worker[i].thread, (a3_threadfunc)a3skinningInternalWorker, engine_out->worker + i, 0) > 0);
+		}
+		return vertexCount;
+	}
+	return -1;
+}
+
+// release skinning engine
+a3i32 a3skinningEngineRelease(a3_SkinningEngine *engine)
+{
+	if (engine && engine->geom)
+	{
+		a3_SkinningWorker *worker;
+		a3ui32 p;
+
+		// wake workers one last time to exit, then join
+		engine->stop = a3true;
+		a3skinningInternalBarrier();
+		for (p = 0; p < engine->workerCount; ++p)
+			if (engine->worker[p].launched)
+				a3skinningInternalUnpark(engine->worker[p].park);
+		for (p = 0; p < engine->workerCount; ++p)
+		{
+			worker = engine->worker + p;
+			if (worker->launched)
+			{
+				a3threadWait(worker->thread);
+				worker->launched = a3false;
+			}
+			if (worker->park)
+			{
+				a3skinningInternalParkRelease(worker->park);
+				worker->park = 0;
+			}
+		}
+
+		free(engine->data);
+		engine->data = 0;
+		engine->positionOut = engine->normalOut = engine->tangentOut = engine->bitangentOut = 0;
+		engine->geom = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+// linear blend skinning of all vertices
+a3i32 a3skinningEngineDeform(a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout)
+{
+	if (engine && engine->geom && palette &&
+		(layout == a3hierarchyPalette_mat4 || layout == a3hierarchyPalette_mat3x4))
+	{
+		// caller is participant 0 and covers any worker that failed to 
+		//	launch; workers finish before returning, so the output is 
+		//	complete and the palette may change afterwards
+		const a3ui32 participantCount = engine->workerCount + 1, vertexCount = engine->vertexCount;
+		a3_SkinningWorker *worker;
+		a3ui32 p, spin;
+
+		// publish palette and wake parked workers
+		engine->palette = palette;
+		engine->layout = layout;
+		++engine->deformCount;
+		a3skinningInternalBarrier();
+		for (p = 0; p < engine->workerCount; ++p)
+			if (engine->worker[p].launched)
+				a3skinningInternalUnpark(engine->worker[p].park);
+
+		a3skinningEngineDeformRange(engine, palette, layout, 0, vertexCount / participantCount);
+		for (p = 0; p < engine->workerCount; ++p)
+		{
+			worker = engine->worker + p;
+			if (!worker->launched)
+				a3skinningEngineDeformRange(engine, palette, layout, worker->first, worker->count);
+		}
+
+		// workers park again once done
+		for (p = 0; p < engine->workerCount; ++p)
+			for (spin = 0, worker = engine->worker + p; worker->launched && worker->deformsDone != engine->deformCount; ++spin)
+				if (spin >= a3skinningInternalSpinMax)
+					a3skinningInternalYield();
+		a3skinningInternalBarrier();
+		return vertexCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// resize weights storage, keeping existing points; new points are unbound
+a3i32 a3skinningInternalWeightsResize(a3_SkinningWeights *weights, const a3ui32 pointCount)
+{
+	const a3ui32 keep = a3minimum(weights->pointCount, pointCount);
+	const a3ui32 n = a3skinning_influenceMax;
+	a3real *blendWeight;
+	a3i32 *blendIndex;
+	a3real *position;
+	void *data = malloc((sizeof(a3real) * n + sizeof(a3i32) * n + sizeof(a3real) * 3) * pointCount);
+	if (!data)
+		return -1;
+
+	// weights, then indices, then positions
+	blendWeight = (a3real *)data;
+	blendIndex = (a3i32 *)(blendWeight + n * pointCount);
+	position = (a3real *)(blendIndex + n * pointCount);
+	memset(data, 0, (sizeof(a3real) * n + sizeof(a3i32) * n + sizeof(a3real) * 3) * pointCount);
+	if (weights->data)
+	{
+		memcpy(blendWeight, weights->blendWeight, sizeof(a3real) * n * keep);
+		memcpy(blendIndex, weights->blendIndex, sizeof(a3i32) * n * keep);
+		memcpy(position, weights->position, sizeof(a3real) * 3 * keep);
+		free(weights->data);
+	}
+	weights->blendWeight = blendWeight;
+	weights->blendIndex = blendIndex;
+	weights->position = position;
+	weights->pointCount = pointCount;
+	weights->data = data;
+	return pointCount;
+}
+
+// create empty skin weights
+a3i32 a3skinningWeightsCreate(a3_SkinningWeights *weights_out, const a3ui32 pointCount)
+{
+	if (weights_out && !weights_out->data && pointCount)
+	{
+		weights_out->pointCount = weights_out->influenceCount = weights_out->droppedCount = 0;
+		return a3skinningInternalWeightsResize(weights_out, pointCount);
+	}
+	return -1;
+}
+
+// release skin weights
+a3i32 a3skinningWeightsRelease(a3_SkinningWeights *weights)
+{
+	if (weights && weights->data)
+	{
+		free(weights->data);
+		weights->data = 0;
+		weights->blendWeight = weights->position = 0;
+		weights->blendIndex = 0;
+		weights->pointCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// renormalize influences
+a3i32 a3skinningWeightsNormalize(a3_SkinningWeights *weights)
+{
+	if (weights && weights->data)
+	{
+		a3real *blendWeight = weights->blendWeight;
+		a3i32 *blendIndex = weights->blendIndex;
+		a3real sum;
+		a3ui32 i, j;
+		for (i = 0; i < weights->pointCount; ++i, blendWeight += a3skinning_influenceMax, blendIndex += a3skinning_influenceMax)
+		{
+			for (j = 0, sum = a3real_zero; j < a3skinning_influenceMax; ++j)
+				sum += blendWeight[j];
+			if (sum > a3real_zero)
+			{
+				sum = a3recip(sum);
+				for (j = 0; j < a3skinning_influenceMax; ++j)
+					blendWeight[j] *= sum;
+			}
+			else
+			{
+				blendWeight[0] = a3real_one;
+				blendIndex[0] = 0;
+			}
+		}
+		return weights->pointCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// deformerWeight shape: name in file contents and first point
+typedef struct a3_SkinningInternalShape
+{
+	const a3byte *name;
+	a3ui32 nameLength, first, count;
+} a3_SkinningInternalShape;
+
+// find attribute value in current tag: returns first character after 
+//	opening quote, or null if tag ends first
+inline const a3byte *a3skinningInternalFindAttribute(const a3byte *ptr, const a3byte *end, const a3byte *name, const a3ui32 nameLength)
+{
+	for (; ptr + nameLength + 2 < end && *ptr != '>'; ++ptr)
+		if (*ptr == ' ' && ptr[nameLength + 1] == '=' && !memcmp(ptr + 1, name, nameLength))
+			return (ptr + nameLength + 3);
+	return 0;
+}
+
+// length of quoted attribute value
+inline a3ui32 a3skinningInternalAttributeLength(const a3byte *value, const a3byte *end)
+{
+	const a3byte *ptr = value;
+	while (ptr < end && *ptr != '\"')
+		++ptr;
+	return (a3ui32)(ptr - value);
+}
+
+// parse unsigned integer
+inline a3ui32 a3skinningInternalParseIndex(const a3byte *ptr, const a3byte *end)
+{
+	a3ui32 value = 0;
+	for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr)
+		value = value * 10 + (a3ui32)(*ptr - '0');
+	return value;
+}
+
+// parse real ([-]digits[.digits][e[-]digits]), advance pointer
+inline a3real a3skinningInternalParseReal(const a3byte **ptr_inout, const a3byte *end)
+{
+	const a3byte *ptr = *ptr_inout;
+	a3f64 value = 0.0, scale = 1.0;
+	a3i32 exponent = 0, exponentSign = 1;
+	a3boolean negative = 0;
+
+	while (ptr < end && *ptr == ' ')
+		++ptr;
+	if (ptr < end && (*ptr == '-' || *ptr == '+'))
+		negative = (*(ptr++) == '-');
+	for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr)
+		value = value * 10.0 + (a3f64)(*ptr - '0');
+	if (ptr < end && *ptr == '.')
+		for (++ptr; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr)
+			value += (a3f64)(*ptr - '0') * (scale *= 0.1);
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+	{
+		if (++ptr < end && (*ptr == '-' || *ptr == '+'))
+			exponentSign = (*(ptr++) == '-') ? -1 : 1;
+		for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr)
+			exponent = exponent * 10 + (*ptr - '0');
+		for (; exponent > 0; --exponent)
+			value = exponentSign > 0 ? value * 10.0 : value * 0.1;
+	}
+	*ptr_inout = ptr;
+	return (a3real)(negative ? -value : value);
+}
+
+// load Maya deformerWeight XML
+a3i32 a3skinningWeightsLoadDeformerWeight(a3_SkinningWeights *weights_out, const a3_Hierarchy *hierarchy_opt, const a3byte *filePath)
+{
+	if (weights_out && !weights_out->data && filePath && *filePath)
+	{
+		a3_Stream stream[1] = { 0 };
+		a3_SkinningInternalShape shape[a3skinning_shapeMax], *listShape = 0;
+		a3byte name[a3node_nameSize];
+		const a3byte *ptr, *end, *value;
+		a3ui32 shapeCount = 0, pointCount = 0, length, pointIndex, i;
+		a3i32 nodeIndex = -1;
+		a3boolean inShape = 0;
+		a3real weight;
+
+		// whole file in memory; everything below is one forward scan
+		if (a3streamLoadContents(stream, filePath) <= 0)
+		{
+			printf("\n A3 ERROR: Could not open deformerWeight file \'%s\'.", filePath);
+			return -1;
+		}
+		weights_out->pointCount = weights_out->influenceCount = weights_out->droppedCount = 0;
+		ptr = stream->contents;
+		end = ptr + stream->length;
+
+		while (ptr < end && (ptr = (const a3byte *)memchr(ptr, '<', end - ptr)) && ++ptr < end)
+		{
+			// most frequent tag first
+			if (*ptr == 'p' && !memcmp(ptr, "point ", 6))
+			{
+				ptr += 6;
+				value = a3skinningInternalFindAttribute(ptr - 1, end, "index", 5);
+				if (!value || !listShape)
+					continue;
+				pointIndex = a3skinningInternalParseIndex(value, end);
+				if (pointIndex >= listShape->count)
+					continue;
+				pointIndex += listShape->first;
+				value = a3skinningInternalFindAttribute(value, end, "value", 5);
+				if (!value)
+					continue;
+				if (inShape)
+				{
+					// bind shape position
+					weights_out->position[pointIndex * 3 + 0] = a3skinningInternalParseReal(&value, end);
+					weights_out->position[pointIndex * 3 + 1] = a3skinningInternalParseReal(&value, end);
+					weights_out->position[pointIndex * 3 + 2] = a3skinningInternalParseReal(&value, end);
+				}
+				else if (nodeIndex >= 0)
+				{
+					weight = a3skinningInternalParseReal(&value, end);
+					a3skinningWeightsAddInfluence(weights_out, pointIndex, nodeIndex, weight);
+				}
+				ptr = value;
+			}
+			else if (*ptr == 'w' && !memcmp(ptr, "weights ", 8))
+			{
+				// influence list: find its shape and node
+				inShape = 0;
+				listShape = 0;
+				nodeIndex = -1;
+				value = a3skinningInternalFindAttribute(ptr + 7, end, "shape", 5);
+				if (value)
+				{
+					length = a3skinningInternalAttributeLength(value, end);
+					for (i = 0; i < shapeCount && !listShape; ++i)
+						if (shape[i].nameLength == length && !memcmp(shape[i].name, value, length))
+							listShape = shape + i;
+				}
+				else if (shapeCount)
+					listShape = shape;
+				if (!listShape || !weights_out->data)
+					continue;
+				if (hierarchy_opt)
+				{
+					value = a3skinningInternalFindAttribute(ptr + 7, end, "source", 6);
+					if (value && (length = a3skinningInternalAttributeLength(value, end)) < a3node_nameSize)
+					{
+						memcpy(name, value, length);
+						name[length] = 0;
+						nodeIndex = a3hierarchyGetNodeIndex(hierarchy_opt, name);
+					}
+				}
+				else
+				{
+					value = a3skinningInternalFindAttribute(ptr + 7, end, "layer", 5);
+					if (value)
+						nodeIndex = (a3i32)a3skinningInternalParseIndex(value, end);
+				}
+				if (nodeIndex >= 0)
+					++weights_out->influenceCount;
+				ptr += 8;
+			}
+			else if (*ptr == 's' && !memcmp(ptr, "shape ", 6))
+			{
+				// shape: points are appended after previous shapes
+				inShape = 0;
+				listShape = 0;
+				value = a3skinningInternalFindAttribute(ptr + 5, end, "size", 4);
+				if (!value || shapeCount >= a3skinning_shapeMax)
+					continue;
+				listShape = shape + shapeCount++;
+				listShape->first = pointCount;
+				listShape->count = a3skinningInternalParseIndex(value, end);
+				value = a3skinningInternalFindAttribute(ptr + 5, end, "name", 4);
+				listShape->name = value;
+				listShape->nameLength = value ? a3skinningInternalAttributeLength(value, end) : 0;
+				pointCount += listShape->count;
+				if (listShape->count && a3skinningInternalWeightsResize(weights_out, pointCount) < 0)
+					break;
+				inShape = 1;
+				ptr += 6;
+			}
+		}
+		a3streamReleaseContents(stream);
+
+		if (weights_out->data && weights_out->pointCount == pointCount)
+			return a3skinningWeightsNormalize(weights_out);
+		a3skinningWeightsRelease(weights_out);
+	}
+	return -1;
+}
+
+
+// sort key for matching: point's transformed position
+typedef struct a3_SkinningInternalMatchKey
+{
+	a3real x, y, z;
+	a3ui32 index;
+} a3_SkinningInternalMatchKey;
+
+// compare match keys by x
+a3i32 a3skinningInternalMatchKeyCompare(const void *a, const void *b)
+{
+	const a3real xa = ((const a3_SkinningInternalMatchKey *)a)->x, xb = ((const a3_SkinningInternalMatchKey *)b)->x;
+	return (xa > xb) - (xa < xb);
+}
+
+// store weights by matching positions
+a3i32 a3skinningWeightsStoreMatched(a3real *blendWeight_out, a3i32 *blendIndex_out, const a3_SkinningWeights *weights, const a3real *position, const a3ui32 vertexCount, const a3real *transform_opt, const a3real tolerance)
+{
+	if (blendWeight_out && blendIndex_out && weights && weights->data && position && tolerance >= a3real_zero)
+	{
+		const a3ui32 n = a3skinning_influenceMax, pointCount = weights->pointCount;
+		a3_SkinningInternalMatchKey *key = (a3_SkinningInternalMatchKey *)malloc(sizeof(a3_SkinningInternalMatchKey) * pointCount);
+		const a3_SkinningInternalMatchKey *k;
+		const a3real *p, *m = transform_opt;
+		a3ui32 i, j, lo, hi, mid, matched = 0;
+		a3i32 found;
+		if (!key)
+			return -1;
+
+		// points in vertex space, sorted along x
+		for (i = 0; i < pointCount; ++i)
+		{
+			p = weights->position + i * 3;
+			if (m)
+			{
+				key[i].x = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+				key[i].y = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+				key[i].z = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+			}
+			else
+			{
+				key[i].x = p[0];
+				key[i].y = p[1];
+				key[i].z = p[2];
+			}
+			key[i].index = i;
+		}
+		qsort(key, pointCount, sizeof(a3_SkinningInternalMatchKey), a3skinningInternalMatchKeyCompare);
+
+		for (i = 0; i < vertexCount; ++i, position += 3, blendWeight_out += n, blendIndex_out += n)
+		{
+			// first key within tolerance along x, then scan the window
+			for (lo = 0, hi = pointCount; lo < hi; )
+			{
+				mid = (lo + hi) / 2;
+				if (key[mid].x < position[0] - tolerance)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			for (found = -1, k = key + lo; lo < pointCount && k->x <= position[0] + tolerance; ++lo, ++k)
+				if (a3absolute(k->y - position[1]) <= tolerance && a3absolute(k->z - position[2]) <= tolerance)
+				{
+					found = (a3i32)k->index;
+					break;
+				}
+			if (found >= 0)
+			{
+				memcpy(blendWeight_out, weights->blendWeight + found * n, sizeof(a3real) * n);
+				memcpy(blendIndex_out, weights->blendIndex + found * n, sizeof(a3i32) * n);
+				++matched;
+			}
+			else
+			{
+				for (j = 0; j < n; ++j)
+				{
+					blendWeight_out[j] = a3real_zero;
+					blendIndex_out[j] = 0;
+				}
+				blendWeight_out[0] = a3real_one;
+			}
+		}
+		free(key);
+		return matched;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,422 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpringBone.c
+	Implementation of Verlet spring bones.
+*/
+
+#include "../a3_SpringBone.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// nodes below chain root
+inline a3ui32 a3springBoneInternalChainDepth(const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3ui32 endIndex)
+{
+	a3ui32 depth, i;
+	for (depth = 0, i = endIndex; i != rootIndex; i = hierarchy->nodes[i].parentIndex)
+		++depth;
+	return depth;
+}
+
+// node at depth below chain root
+inline a3ui32 a3springBoneInternalChainNode(const a3_Hierarchy *hierarchy, const a3ui32 endIndex, const a3ui32 chainDepth, const a3ui32 depth)
+{
+	a3ui32 n, i;
+	for (n = chainDepth, i = endIndex; n > depth; --n)
+		i = hierarchy->nodes[i].parentIndex;
+	return i;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// read animated tip and parent positions and rest lengths from states
+inline void a3springBoneInternalLoad(a3_SpringBoneSystem *system, const a3_HierarchyState *stateArray)
+{
+	const a3ui32 stride = system->springStride;
+	const a3_SpatialPose *objectPose;
+	const a3real *t, *b;
+	a3real *swap;
+	a3ui32 level, i, end;
+
+	// last update's positions become previous
+	swap = system->tipPrev;
+	system->tipPrev = system->tip;
+	system->tip = swap;
+	swap = system->basePrev;
+	system->basePrev = system->base;
+	system->base = swap;
+
+	for (level = 0; level < system->levels; ++level)
+		for (i = system->levelStart[level], end = i + system->levelCount[level]; i < end; ++i)
+		{
+			objectPose = stateArray[system->instance[i]].objectHPose->spatialPose;
+			t = objectPose[system->node[i]].transform.m[3];
+			b = objectPose[system->hierarchy->nodes[system->node[i]].parentIndex].transform.m[3];
+			system->tip[i] = t[0];
+			system->tip[i + stride] = t[1];
+			system->tip[i + stride * 2] = t[2];
+			system->base[i] = b[0];
+			system->base[i + stride] = b[1];
+			system->base[i + stride * 2] = b[2];
+			system->length[i] = a3sqrt((t[0] - b[0]) * (t[0] - b[0]) + (t[1] - b[1]) * (t[1] - b[1]) + (t[2] - b[2]) * (t[2] - b[2]));
+		}
+
+	// first update: start at rest on the animated pose
+	if (!system->initialized)
+	{
+		memcpy(system->position, system->tip, sizeof(a3real) * stride * 3);
+		memcpy(system->previous, system->tip, sizeof(a3real) * stride * 3);
+		memcpy(system->tipPrev, system->tip, sizeof(a3real) * stride * 3);
+		memcpy(system->basePrev, system->base, sizeof(a3real) * stride * 3);
+		system->initialized = a3true;
+	}
+}
+
+// gather parent positions of springs in range: parent particle, or 
+//	animated chain root interpolated to substep
+inline void a3springBoneInternalGather(a3_SpringBoneSystem *system, const a3ui32 first, const a3ui32 count, const a3real u)
+{
+	const a3ui32 stride = system->springStride;
+	a3ui32 i, j, end;
+	a3i32 p;
+	for (i = first, end = first + count; i < end; ++i)
+		if ((p = system->parent[i]) >= 0)
+			for (j = 0; j < stride * 3; j += stride)
+				system->anchor[i + j] = system->position[p + j];
+		else
+			for (j = 0; j < stride * 3; j += stride)
+				system->anchor[i + j] = system->basePrev[i + j] + (system->base[i + j] - system->basePrev[i + j]) * u;
+}
+
+// Verlet step of springs in range (padded to SIMD width): goal is the 
+//	gathered parent plus the animated parent-to-tip offset at substep
+inline void a3springBoneInternalIntegrate(a3_SpringBoneSystem *system, const a3ui32 first, const a3ui32 count, const a3real u, const a3real h)
+{
+	const a3ui32 stride = system->springStride, end = first + count;
+	const a3real h2 = h * h;
+	const a3real *g = system->gravity.v;
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 uu = _mm_set1_ps(u), hh = _mm_set1_ps(h), hh2 = _mm_set1_ps(h2), one = _mm_set1_ps(a3real_one);
+	__m128 k, d, goal, p, v;
+	a3ui32 i, j, a;
+	for (i = first; i < end; i += 4)
+	{
+		k = _mm_min_ps(_mm_mul_ps(_mm_load_ps(system->stiffness + i), hh2), one);
+		d = _mm_sub_ps(one, _mm_min_ps(_mm_mul_ps(_mm_load_ps(system->damping + i), hh), one));
+		for (a = 0, j = i; a < 3; ++a, j += stride)
+		{
+			goal = _mm_add_ps(_mm_load_ps(system->anchor + j), _mm_sub_ps(
+				_mm_add_ps(_mm_load_ps(system->tipPrev + j), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(system->tip + j), _mm_load_ps(system->tipPrev + j)), uu)),
+				_mm_add_ps(_mm_load_ps(system->basePrev + j), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(system->base + j), _mm_load_ps(system->basePrev + j)), uu))));
+			p = _mm_load_ps(system->position + j);
+			v = _mm_mul_ps(_mm_sub_ps(p, _mm_load_ps(system->previous + j)), d);
+			_mm_store_ps(system->previous + j, p);
+			p = _mm_add_ps(_mm_add_ps(p, v), _mm_add_ps(_mm_mul_ps(_mm_sub_ps(goal, p), k), _mm_set1_ps(g[a] * h2)));
+			_mm_store_ps(system->position + j, p);
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3real k, d, goal, p, v;
+	a3ui32 i, j, a;
+	for (i = first; i < end; ++i)
+	{
+		k = a3minimum(system->stiffness[i] * h2, a3real_one);
+		d = a3real_one - a3minimum(system->damping[i] * h, a3real_one);
+		for (a = 0, j = i; a < 3; ++a, j += stride)
+		{
+			goal = system->anchor[j] + (system->tipPrev[j] + (system->tip[j] - system->tipPrev[j]) * u) - (system->basePrev[j] + (system->base[j] - system->basePrev[j]) * u);
+			p = system->position[j];
+			v = (p - system->previous[j]) * d;
+			system->previous[j] = p;
+			system->position[j] = p + v + (goal - p) * k + g[a] * h2;
+		}
+	}
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// put springs in range (padded to SIMD width) back at rest length from 
+//	their gathered parents; degenerate springs take the animated offset
+inline void a3springBoneInternalConstrain(a3_SpringBoneSystem *system, const a3ui32 first, const a3ui32 count, const a3real u)
+{
+	const a3ui32 stride = system->springStride, end = first + count;
+	const a3real epsilon = (a3real)1.0e-10;
+	a3real *px = system->position, *py = px + stride, *pz = py + stride;
+	const a3real *ax = system->anchor, *ay = ax + stride, *az = ay + stride;
+	const a3real *t = system->tip, *tp = system->tipPrev, *b = system->base, *bp = system->basePrev;
+	a3ui32 i, j, a;
+#ifdef A3_HIERARCHY_SIMD
+	const __m128 uu = _mm_set1_ps(u), eps = _mm_set1_ps(epsilon);
+	__m128 d[3], l2, s, m, f;
+	for (i = first; i < end; i += 4)
+	{
+		d[0] = _mm_sub_ps(_mm_load_ps(px + i), _mm_load_ps(ax + i));
+		d[1] = _mm_sub_ps(_mm_load_ps(py + i), _mm_load_ps(ay + i));
+		d[2] = _mm_sub_ps(_mm_load_ps(pz + i), _mm_load_ps(az + i));
+		l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], d[0]), _mm_mul_ps(d[1], d[1])), _mm_mul_ps(d[2], d[2]));
+		m = _mm_cmpgt_ps(l2, eps);
+		s = _mm_div_ps(_mm_load_ps(system->length + i), _mm_sqrt_ps(_mm_max_ps(l2, eps)));
+		for (a = 0, j = i; a < 3; ++a, j += stride)
+		{
+			f = _mm_sub_ps(
+				_mm_add_ps(_mm_load_ps(tp + j), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t + j), _mm_load_ps(tp + j)), uu)),
+				_mm_add_ps(_mm_load_ps(bp + j), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b + j), _mm_load_ps(bp + j)), uu)));
+			f = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(d[a], s)), _mm_andnot_ps(m, f));
+			_mm_store_ps(px + j, _mm_add_ps(_mm_load_ps(ax + j), f));
+		}
+	}
+#else	// !A3_HIERARCHY_SIMD
+	a3real d[3], l2, s;
+	for (i = first; i < end; ++i)
+	{
+		d[0] = px[i] - ax[i];
+		d[1] = py[i] - ay[i];
+		d[2] = pz[i] - az[i];
+		l2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+		s = l2 > epsilon ? system->length[i] * a3recip(a3sqrt(l2)) : a3real_zero;
+		for (a = 0, j = i; a < 3; ++a, j += stride)
+			px[j] = ax[j] + (l2 > epsilon ? d[a] * s : (tp[j] + (t[j] - tp[j]) * u) - (bp[j] + (b[j] - bp[j]) * u));
+	}
+#endif	// A3_HIERARCHY_SIMD
+}
+
+// swing chain nodes onto particles, root first; then refresh subtrees
+inline void a3springBoneInternalStore(const a3_SpringBoneSystem *system, const a3_HierarchyState *stateArray)
+{
+	const a3_Hierarchy *hierarchy = system->hierarchy;
+	const a3ui32 stride = system->springStride;
+	const a3_HierarchyState *state;
+	a3_SpatialPose *objectPose, *localPose;
+	a3real3 p;
+	a3ui32 level, i, end, k, c, tipNode, node;
+
+	for (level = 0; level < system->levels; ++level)
+		for (i = system->levelStart[level], end = i + system->levelCount[level]; i < end; ++i)
+		{
+			state = stateArray + system->instance[i];
+			objectPose = state->objectHPose->spatialPose;
+			localPose = state->localHPose->spatialPose;
+			tipNode = system->node[i];
+			node = hierarchy->nodes[tipNode].parentIndex;
+
+			// below chain root the node follows its (swung) parent
+			if (system->parent[i] >= 0)
+				a3real4x4Product(objectPose[node].transform.m, objectPose[hierarchy->nodes[node].parentIndex].transform.m, localPose[node].transform.m);
+
+			// swing so the tip points at its particle
+			p[0] = system->position[i];
+			p[1] = system->position[i + stride];
+			p[2] = system->position[i + stride * 2];
+			a3kinematicsSwingNode(state, node, tipNode, p);
+		}
+
+	// refresh everything below each chain root
+	for (k = 0; k < system->instanceCount; ++k)
+		for (c = 0; c < system->chainCount; ++c)
+		{
+			node = system->chainRoot[c];
+			a3kinematicsSolveForwardPartial(stateArray + k, node, stateArray[k].subtreeEnd[node] - node);
+		}
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create system
+a3i32 a3springBoneSystemCreate(a3_SpringBoneSystem *system_out, const a3_Hierarchy *hierarchy, const a3ui32 *chainRoot, const a3ui32 *chainEnd, const a3ui32 chainCount, const a3ui32 instanceCount, const a3ui32 substepCount)
+{
+	if (system_out && !system_out->data && hierarchy && hierarchy->nodes && chainRoot && chainEnd && chainCount && instanceCount &&
+		substepCount && substepCount <= a3springBone_substepMax)
+	{
+		a3ui32 *depth, *last;
+		a3ui32 levels, stride, count, level, k, c, i;
+		size_t dataSize;
+
+		// validate chains: distinct roots, none inside another's subtree
+		for (c = levels = 0; c < chainCount; ++c)
+		{
+			if (chainRoot[c] >= chainEnd[c] || chainEnd[c] >= hierarchy->numNodes || a3hierarchyIsAncestorNode(hierarchy, chainRoot[c], chainEnd[c]) <= 0)
+				return -1;
+			for (i = 0; i < c; ++i)
+				if (chainRoot[i] == chainRoot[c] || a3hierarchyIsAncestorNode(hierarchy, chainRoot[i], chainRoot[c]) > 0 || a3hierarchyIsAncestorNode(hierarchy, chainRoot[c], chainRoot[i]) > 0)
+					return -1;
+			levels = a3maximum(levels, a3springBoneInternalChainDepth(hierarchy, chainRoot[c], chainEnd[c]));
+		}
+		if (levels > a3springBone_levelMax)
+			return -1;
+
+		// scratch: depth per chain, last spring per chain instance
+		depth = (a3ui32 *)malloc(sizeof(a3ui32) * chainCount * (instanceCount + 1));
+		if (!depth)
+			return -1;
+		last = depth + chainCount;
+		for (c = 0; c < chainCount; ++c)
+			depth[c] = a3springBoneInternalChainDepth(hierarchy, chainRoot[c], chainEnd[c]);
+
+		// levels: every instance of every chain at least that deep, padded
+		for (level = stride = 0; level < levels; ++level)
+		{
+			for (c = count = 0; c < chainCount; ++c)
+				count += (depth[c] > level);
+			system_out->levelStart[level] = stride;
+			system_out->levelCount[level] = count * instanceCount;
+			stride += (count * instanceCount + 3) / 4 * 4;
+		}
+		system_out->levelStart[levels] = stride;
+
+		// streams (aligned) then chains and spring indices
+		dataSize = sizeof(a3real) * stride * 24 + 16 + sizeof(a3ui32) * (chainCount * 2 + stride * 4);
+		system_out->data = malloc(dataSize);
+		if (!system_out->data)
+		{
+			free(depth);
+			return -1;
+		}
+		memset(system_out->data, 0, dataSize);
+		system_out->position = (a3real *)(((size_t)system_out->data + 15) & ~(size_t)15);
+		system_out->previous = system_out->position + stride * 3;
+		system_out->tip = system_out->previous + stride * 3;
+		system_out->tipPrev = system_out->tip + stride * 3;
+		system_out->base = system_out->tipPrev + stride * 3;
+		system_out->basePrev = system_out->base + stride * 3;
+		system_out->anchor = system_out->basePrev + stride * 3;
+		system_out->stiffness = system_out->anchor + stride * 3;
+		system_out->damping = system_out->stiffness + stride;
+		system_out->length = system_out->damping + stride;
+		system_out->chainRoot = (a3ui32 *)(system_out->length + stride);
+		system_out->chainEnd = system_out->chainRoot + chainCount;
+		system_out->node = system_out->chainEnd + chainCount;
+		system_out->instance = system_out->node + stride;
+		system_out->chain = system_out->instance + stride;
+		system_out->parent = (a3i32 *)(system_out->chain + stride);
+		memcpy(system_out->chainRoot, chainRoot, sizeof(a3ui32) * chainCount);
+		memcpy(system_out->chainEnd, chainEnd, sizeof(a3ui32) * chainCount);
+
+		// springs: level-major, then instance, then chain; padding 
+		//	springs stay at the origin with zero length
+		for (i = 0; i < stride; ++i)
+			system_out->parent[i] = -1;
+		for (level = 0; level < levels; ++level)
+			for (k = 0, i = system_out->levelStart[level]; k < instanceCount; ++k)
+				for (c = 0; c < chainCount; ++c)
+					if (depth[c] > level)
+					{
+						system_out->node[i] = a3springBoneInternalChainNode(hierarchy, chainEnd[c], depth[c], level + 1);
+						system_out->instance[i] = k;
+						system_out->chain[i] = c;
+						system_out->parent[i] = level ? (a3i32)last[k * chainCount + c] : -1;
+						last[k * chainCount + c] = i++;
+					}
+		free(depth);
+
+		system_out->hierarchy = hierarchy;
+		system_out->chainCount = chainCount;
+		system_out->instanceCount = instanceCount;
+		system_out->levels = levels;
+		system_out->springStride = stride;
+		for (level = system_out->springCount = 0; level < levels; ++level)
+			system_out->springCount += system_out->levelCount[level];
+		system_out->gravity = a3vec3_zero;
+		system_out->substepCount = substepCount;
+		system_out->initialized = a3false;
+
+		// defaults: moderately stiff, settles within about a second
+		for (c = 0; c < chainCount; ++c)
+			a3springBoneSystemSetChain(system_out, c, (a3real)100.0, (a3real)4.0);
+		return system_out->springCount;
+	}
+	return -1;
+}
+
+// release system
+a3i32 a3springBoneSystemRelease(a3_SpringBoneSystem *system)
+{
+	if (system && system->data)
+	{
+		free(system->data);
+		system->data = 0;
+		system->chainRoot = system->chainEnd = 0;
+		system->node = system->instance = system->chain = 0;
+		system->parent = 0;
+		system->position = system->previous = system->tip = system->tipPrev = system->base = system->basePrev = system->anchor = 0;
+		system->stiffness = system->damping = system->length = 0;
+		system->hierarchy = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// set chain stiffness and damping
+a3i32 a3springBoneSystemSetChain(a3_SpringBoneSystem *system, const a3ui32 chainIndex, const a3real stiffness, const a3real damping)
+{
+	if (system && system->data && chainIndex < system->chainCount && stiffness >= a3real_zero && damping >= a3real_zero)
+	{
+		a3ui32 level, i, end;
+		for (level = 0; level < system->levels; ++level)
+			for (i = system->levelStart[level], end = i + system->levelCount[level]; i < end; ++i)
+				if (system->chain[i] == chainIndex)
+				{
+					system->stiffness[i] = stiffness;
+					system->damping[i] = damping;
+				}
+		return 1;
+	}
+	return -1;
+}
+
+// simulate and write back
+a3i32 a3springBoneSystemUpdate(a3_SpringBoneSystem *system, const a3_HierarchyState *stateArray, const a3real dt)
+{
+	if (system && system->data && stateArray && dt >= a3real_zero)
+	{
+		const a3real h = dt / (a3real)system->substepCount;
+		a3real u;
+		a3ui32 k, n, level, first, count;
+
+		for (k = 0; k < system->instanceCount; ++k)
+			if (!stateArray[k].poseGroup || stateArray[k].poseGroup->hierarchy != system->hierarchy)
+				return -1;
+
+		a3springBoneInternalLoad(system, stateArray);
+		for (n = 1; n <= system->substepCount; ++n)
+		{
+			// levels in order, so each follows its parents' new positions
+			u = (a3real)n / (a3real)system->substepCount;
+			for (level = 0; level < system->levels; ++level)
+			{
+				first = system->levelStart[level];
+				count = system->levelStart[level + 1] - first;
+				a3springBoneInternalGather(system, first, system->levelCount[level], u);
+				a3springBoneInternalIntegrate(system, first, count, u, h);
+				a3springBoneInternalConstrain(system, first, count, u);
+			}
+		}
+		a3springBoneInternalStore(system, stateArray);
+		return system->springCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,189 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpriteAnimation.c
+	Implementation of batched sprite animation.
+*/
+
+#include "../a3_SpriteAnimation.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// copy cell rect of sprite's keyframe into its instance
+inline void a3spriteAnimationInternalWriteRect(a3real *instance_out, const a3_TextureAtlasCell *cell)
+{
+	instance_out[0] = cell->relativeOffset[0];
+	instance_out[1] = cell->relativeOffset[1];
+	instance_out[2] = cell->relativeSize[0];
+	instance_out[3] = cell->relativeSize[1];
+}
+
+// validate clip against atlas
+inline a3boolean a3spriteAnimationInternalValidClip(const a3_SpriteAnimationBatch *batch, const a3ui32 clipIndex)
+{
+	const a3_Clip *clip = batch->clipPool->clip + clipIndex;
+	a3ui32 k;
+	if (clipIndex >= batch->clipPool->count || !clip->keyframe_pool || clip->first_keyframe > clip->last_keyframe || clip->last_keyframe >= clip->keyframe_pool->count)
+		return a3false;
+	for (k = clip->first_keyframe; k <= clip->last_keyframe; ++k)
+		if (clip->keyframe_pool->keyframe[k].data >= batch->atlas->numCells || clip->keyframe_pool->keyframe[k].duration <= a3real_zero)
+			return a3false;
+	return a3true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create sprite batch
+a3i32 a3spriteAnimationBatchCreate(a3_SpriteAnimationBatch *batch_out, const a3_ClipPool *clipPool, const a3_TextureAtlas *atlas, const a3ui32 spriteMax)
+{
+	if (batch_out && !batch_out->data && clipPool && clipPool->clip && atlas && atlas->cells && spriteMax)
+	{
+		const size_t dataSize = (sizeof(a3real) * 4 + sizeof(a3ui32) * 2 + sizeof(a3real) * 2) * spriteMax + 16;
+
+		batch_out->data = malloc(dataSize);
+		if (!batch_out->data)
+			return -1;
+
+		// aligned instances first so blocks upload straight from here
+		batch_out->instance = (a3real *)(((size_t)batch_out->data + 15) & ~(size_t)15);
+		batch_out->keyframeTime = batch_out->instance + spriteMax * 4;
+		batch_out->rate = batch_out->keyframeTime + spriteMax;
+		batch_out->clip = (a3ui32 *)(batch_out->rate + spriteMax);
+		batch_out->keyframe = batch_out->clip + spriteMax;
+		batch_out->clipPool = clipPool;
+		batch_out->atlas = atlas;
+		batch_out->spriteCount = 0;
+		batch_out->spriteMax = spriteMax;
+		return spriteMax;
+	}
+	return -1;
+}
+
+// release sprite batch
+a3i32 a3spriteAnimationBatchRelease(a3_SpriteAnimationBatch *batch)
+{
+	if (batch && batch->data)
+	{
+		free(batch->data);
+		memset(batch, 0, sizeof(a3_SpriteAnimationBatch));
+		return 1;
+	}
+	return -1;
+}
+
+// add sprite
+a3i32 a3spriteAnimationBatchAdd(a3_SpriteAnimationBatch *batch, const a3ui32 clipIndex, const a3real rate)
+{
+	if (batch && batch->data && batch->spriteCount < batch->spriteMax && a3spriteAnimationInternalValidClip(batch, clipIndex))
+	{
+		const a3ui32 i = batch->spriteCount++;
+		batch->rate[i] = rate;
+		a3spriteAnimationBatchSetClip(batch, i, clipIndex);
+		return i;
+	}
+	return -1;
+}
+
+// set sprite's clip
+a3i32 a3spriteAnimationBatchSetClip(a3_SpriteAnimationBatch *batch, const a3ui32 spriteIndex, const a3ui32 clipIndex)
+{
+	if (batch && batch->data && spriteIndex < batch->spriteCount && a3spriteAnimationInternalValidClip(batch, clipIndex))
+	{
+		const a3_Clip *clip = batch->clipPool->clip + clipIndex;
+		const a3ui32 k = batch->rate[spriteIndex] < a3real_zero ? clip->last_keyframe : clip->first_keyframe;
+		batch->clip[spriteIndex] = clipIndex;
+		batch->keyframe[spriteIndex] = k;
+		batch->keyframeTime[spriteIndex] = batch->rate[spriteIndex] < a3real_zero ? clip->keyframe_pool->keyframe[k].duration : a3real_zero;
+		a3spriteAnimationInternalWriteRect(batch->instance + spriteIndex * 4, batch->atlas->cells + clip->keyframe_pool->keyframe[k].data);
+		return 1;
+	}
+	return -1;
+}
+
+// advance all sprites
+a3i32 a3spriteAnimationBatchUpdate(a3_SpriteAnimationBatch *batch, const a3real dt)
+{
+	if (batch && batch->data && dt >= a3real_zero)
+	{
+		const a3_Clip *clip;
+		const a3_Keyframe *keyframe;
+		const a3_TextureAtlasCell *cells = batch->atlas->cells;
+		a3real t;
+		a3ui32 i, k, k0, changed;
+
+		for (i = changed = 0; i < batch->spriteCount; ++i)
+		{
+			clip = batch->clipPool->clip + batch->clip[i];
+			keyframe = clip->keyframe_pool->keyframe;
+			k = k0 = batch->keyframe[i];
+			t = batch->keyframeTime[i] + dt * batch->rate[i];
+
+			// step through keyframes, looping at either terminus
+			while (t >= keyframe[k].duration)
+			{
+				t -= keyframe[k].duration;
+				k = (k < clip->last_keyframe) ? k + 1 : clip->first_keyframe;
+			}
+			while (t < a3real_zero)
+			{
+				k = (k > clip->first_keyframe) ? k - 1 : clip->last_keyframe;
+				t += keyframe[k].duration;
+			}
+			batch->keyframeTime[i] = t;
+			if (k != k0)
+			{
+				batch->keyframe[i] = k;
+				a3spriteAnimationInternalWriteRect(batch->instance + i * 4, cells + keyframe[k].data);
+				++changed;
+			}
+		}
+		return changed;
+	}
+	return -1;
+}
+
+// draw all sprites
+a3i32 a3spriteAnimationBatchRender(const a3_SpriteAnimationBatch *batch, a3_UniformBuffer *instanceBuffer, const a3ui32 unifBlockBinding, const a3ui32 blockSize, const a3i32 unifFirstLocation)
+{
+	if (batch && batch->data && instanceBuffer && blockSize && blockSize <= a3sprite_instanceBlockMax)
+	{
+		a3ui32 first, count, draws;
+		for (first = draws = 0; first < batch->spriteCount; first += count, ++draws)
+		{
+			count = a3minimum(blockSize, batch->spriteCount - first);
+			if (a3bufferRefill(instanceBuffer, 0, count * a3sprite_instanceSize, batch->instance + first * 4) <= 0)
+				return -1;
+			a3shaderUniformBufferActivate(instanceBuffer, unifBlockBinding);
+			if (unifFirstLocation >= 0)
+				a3shaderUniformSendInt(a3unif_single, unifFirstLocation, 1, (a3i32 *)&first);
+			a3vertexDrawableRenderActiveInstanced(count);
+		}
+		return draws;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,159 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AimConstraint.h
+	Look-at and aim constraints solved in batches.
+*/
+
+#ifndef __ANIMAL3D_AIMCONSTRAINT_H
+#define __ANIMAL3D_AIMCONSTRAINT_H
+
+
+#include "a3_Kinematics.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_AimConstraint			a3_AimConstraint;
+typedef struct a3_AimConstraintBatch	a3_AimConstraintBatch;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// aim constraint limits
+enum a3_AimConstraintLimits
+{
+	a3aimConstraint_constraintMax = 64,	// constraints per instance
+	a3aimConstraint_stageMax = 8,		// deepest nesting of constrained nodes
+};
+
+
+// aim constraint: node turns about itself so its aim axis points at a 
+//	target, then twists about the aim so its up axis leans toward an 
+//	object-space up direction
+struct a3_AimConstraint
+{
+	// constrained node
+	a3ui32 node;
+
+	// unit axes in node's local frame
+	a3vec3 aimAxis, upAxis;
+
+	// object-space up direction (zero: no twist)
+	a3vec3 up;
+
+	// largest swing away from the animated aim (degrees; 180 for none) 
+	//	and default weight
+	a3real angleLimit, weight;
+};
+
+
+// batch of aim constraints for every instance of a hierarchy
+// constraints are grouped in stages by how many constrained ancestors 
+//	they have (e.g. neck, then head, then eyes); a stage is solved for 
+//	every instance at once, several constraints per step, and padded to 
+//	the SIMD width; slots are stage-major, then instance, then constraint
+// vector streams are structure-of-arrays: x, y and z (and w) each span 
+//	the padded slot count
+struct a3_AimConstraintBatch
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// constraint descriptions
+	a3_AimConstraint *constraint;
+	a3ui32 constraintCount, instanceCount;
+
+	// stage i spans [stageStart[i], stageStart[i] + stageCount[i]); each 
+	//	start is a multiple of the SIMD width
+	a3ui32 stageStart[a3aimConstraint_stageMax + 1], stageCount[a3aimConstraint_stageMax];
+	a3ui32 stages, slotCount, slotStride;
+
+	// per slot: instance and constraint; slot of each instance constraint
+	a3ui32 *instance, *index, *slot;
+
+	// per slot: object-space target point (set by user)
+	a3real *target;
+
+	// per slot, gathered: object-space aim axis, up axis, direction to 
+	//	target and up direction
+	a3real *aim, *upAxis, *direction, *up;
+
+	// per slot: cosine and sine of half the angle limit, weight
+	a3real *limitCos, *limitSin, *weight;
+
+	// per slot result: object-space rotation about node (quaternion)
+	a3real *rotation;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// aim constraints: 
+// for every slot of a stage, the node's current object-space aim and up 
+//	axes and the direction to its target are gathered, then rotations 
+//	are built several slots per step: 
+//		swing = delta quaternion from aim axis to target direction, 
+//			clamped to the angle limit as a slerp from identity
+//		twist = delta quaternion about the new aim, from the swung up 
+//			axis to the up direction (both projected off the aim)
+//		rotation = nlerp(identity, twist * swing, weight)
+// each node is then rotated about itself in object space, its local 
+//	transform is recovered from its parent and only its subtree is 
+//	refreshed with partial forward kinematics, so later stages see it
+
+// create batch of constraints (distinct nodes) on every instance of 
+//	hierarchy; targets start at the origin
+a3i32 a3aimConstraintBatchCreate(a3_AimConstraintBatch *batch_out, const a3_Hierarchy *hierarchy, const a3_AimConstraint *constraint, const a3ui32 constraintCount, const a3ui32 instanceCount);
+
+// release batch
+a3i32 a3aimConstraintBatchRelease(a3_AimConstraintBatch *batch);
+
+// set object-space target of an instance's constraint
+a3i32 a3aimConstraintBatchSetTarget(a3_AimConstraintBatch *batch, const a3ui32 instanceIndex, const a3ui32 constraintIndex, const a3real *target);
+
+// set weight of an instance's constraint
+a3i32 a3aimConstraintBatchSetWeight(a3_AimConstraintBatch *batch, const a3ui32 instanceIndex, const a3ui32 constraintIndex, const a3real weight);
+
+// solve every constraint on one state per instance (object-space poses 
+//	up to date); returns number of constraints solved
+a3i32 a3aimConstraintBatchSolve(a3_AimConstraintBatch *batch, const a3_HierarchyState *stateArray);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_AimConstraint.inl"
+
+
+#endif	// !__ANIMAL3D_AIMCONSTRAINT_H
\ No newline at end of file
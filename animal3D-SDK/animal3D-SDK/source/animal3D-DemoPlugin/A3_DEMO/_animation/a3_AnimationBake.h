@@ -0,0 +1,171 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBake.h
+	Clips baked into skinning palettes for GPU-instanced crowds.
+*/
+
+#ifndef __ANIMAL3D_ANIMATIONBAKE_H
+#define __ANIMAL3D_ANIMATIONBAKE_H
+
+
+#include "a3_Kinematics.h"
+#include "a3_HierarchyStateBlend.h"
+#include "a3_KeyframeAnimation.h"
+
+// A3 graphics
+#include "animal3D-A3DG/a3graphics/a3_Texture.h"
+#include "animal3D-A3DG/a3graphics/a3_UniformBuffer.h"
+#include "animal3D-A3DG/a3graphics/a3_VertexDrawable.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_AnimationBakeClip		a3_AnimationBakeClip;
+typedef struct a3_AnimationBakeInstance	a3_AnimationBakeInstance;
+typedef struct a3_AnimationBake			a3_AnimationBake;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// baked animation limits
+enum a3_AnimationBakeLimits
+{
+	a3animationBake_clipSize = 16,				// bytes per clip table entry: one uvec4
+	a3animationBake_clipMax = 4096,				// clip table entries (64 KiB uniform block)
+	a3animationBake_instanceSize = 8,			// bytes per instance: clip and time
+	a3animationBake_instanceBlockMax = 8192,	// instances per draw (64 KiB uniform block)
+};
+
+
+// clip table entry: run of baked frames; frames evenly span the clip, 
+//	so frame f of the clip is its pose at time f / frameRate
+// std140 layout: 'uvec4 uBakeClip[N]' with xy = first, count and 
+//	zw = float bits of rate and duration
+struct a3_AnimationBakeClip
+{
+	a3ui32 frameFirst, frameCount;
+	a3real frameRate, duration;
+};
+
+
+// instance entry: clip table index and time in clip (wrapped on use)
+// std140 arrays pad to vec4, so two instances share one element: 
+//	'uvec4 uBakeInstance[N / 2]', instance i in xy (even) or zw (odd)
+struct a3_AnimationBakeInstance
+{
+	a3ui32 clip;
+	a3real time;
+};
+
+
+// baked palettes of selected clips: every frame of every clip is run 
+//	through forward kinematics and bind-to-current once, and stored as 
+//	rows of mat3x4 palettes (a3hierarchyPalette_mat3x4 layout), so 
+//	frame f is row f and node n occupies texels 3n to 3n+2 of the row
+// instances then carry only (clip, time); a vertex shader finds its 
+//	palette with the clip table and an RGBA32F texture of the palettes 
+//	(see passNormal_skinBaked_transform_instanced_vs4x.glsl):
+//		uvec2 inst = (gl_InstanceID & 1) != 0 ? uBakeInstance[gl_InstanceID >> 1].zw : uBakeInstance[gl_InstanceID >> 1].xy;
+//		uvec4 clip = uBakeClip[inst.x];
+//		float t = mod(uintBitsToFloat(inst.y), uintBitsToFloat(clip.w));
+//		int frame = int(clip.x + min(uint(t * uintBitsToFloat(clip.z)), clip.y - 1u));
+//		mat4x3 m = transpose(mat3x4(texelFetch(uBakePalette, ivec2(3 * n, frame), 0), ...));
+// texture width is 3 * node count and height is total frames; both 
+//	must stay within the context's maximum texture size
+struct a3_AnimationBake
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// palettes, frame-major (aligned; 12 reals per node per frame)
+	a3real *palette;
+
+	// clip table
+	a3_AnimationBakeClip *clip;
+
+	// counts
+	a3ui32 nodeCount, frameCount, clipCount;
+
+	// palette texture dimensions (texels)
+	a3ui32 textureWidth, textureHeight;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// bake clips of a clip pool whose keyframe data are pose indices in the 
+//	pose group: clipIndexList_opt selects clipCount clips (null takes 
+//	the first clipCount); each clip gets max(1, round(duration * rate)) 
+//	frames; objectSpaceBindInverse is the skin's inverse bind pose
+a3i32 a3animationBakeCreate(a3_AnimationBake *bake_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *clipIndexList_opt, const a3ui32 clipCount, const a3real frameRate, const a3_HierarchyTransform *objectSpaceBindInverse);
+
+// release baked animation
+a3i32 a3animationBakeRelease(a3_AnimationBake *bake);
+
+// sample pose clip at time (wrapped) into structure-of-arrays pose: 
+//	keyframe durations are walked directly and the last keyframe blends 
+//	back to the first, as a looping clip controller would
+a3i32 a3animationBakeSampleClip(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseGroup *poseGroup, const a3_Clip *clip, const a3real time);
+
+// get frame row of clip table entry at time; matches the shader lookup
+a3i32 a3animationBakeGetFrame(const a3_AnimationBake *bake, const a3ui32 clipIndex, const a3real time);
+
+// get palette of frame row
+const a3real *a3animationBakeGetPalette(const a3_AnimationBake *bake, const a3ui32 frame);
+
+// create RGBA32F texture holding the palettes
+a3i32 a3animationBakeCreateTexture(const a3_AnimationBake *bake, a3_Texture *texture_out, const a3byte name_opt[32]);
+
+// upload clip table to uniform buffer; returns bytes uploaded
+a3i32 a3animationBakeUploadClipTable(const a3_AnimationBake *bake, a3_UniformBuffer *clipBuffer);
+
+// advance instance times by dt and wrap them into their clips
+a3i32 a3animationBakeUpdateInstances(const a3_AnimationBake *bake, a3_AnimationBakeInstance *instance, const a3ui32 instanceCount, const a3real dt);
+
+// draw instances with the active program and drawable: instances are 
+//	uploaded to the uniform buffer a block at a time and each block is 
+//	one instanced draw; blockSize is instances per block, no more than 
+//	a3animationBake_instanceBlockMax and the buffer size; the index of 
+//	each block's first instance is sent to unifFirstLocation (-1 to 
+//	skip); returns draws
+a3i32 a3animationBakeRender(const a3_AnimationBake *bake, const a3_AnimationBakeInstance *instance, const a3ui32 instanceCount, a3_UniformBuffer *instanceBuffer, const a3ui32 unifBlockBinding, const a3ui32 blockSize, const a3i32 unifFirstLocation);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_AnimationBake.inl"
+
+
+#endif	// !__ANIMAL3D_ANIMATIONBAKE_H
\ No newline at end of file
@@ -0,0 +1,170 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationBenchmark.h
+	Timing comparisons for animation kernels.
+*/
+
+#ifndef __ANIMAL3D_ANIMATIONBENCHMARK_H
+#define __ANIMAL3D_ANIMATIONBENCHMARK_H
+
+
+#include "a3_Kinematics.h"
+#include "a3_Skinning.h"
+#include "a3_HierarchyStateBlend.h"
+#include "a3_SpriteAnimation.h"
+#include "a3_KeyframeReduction.h"
+#include "a3_AnimationBake.h"
+
+// A3 timer
+#include "animal3D/a3utility/a3_Timer.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_AnimationBenchmark	a3_AnimationBenchmark;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// maximum variants compared in one benchmark
+enum a3_AnimationBenchmarkLimits
+{
+	a3benchmark_variantMax = 6,
+};
+
+
+// benchmark result: average time per iteration for each variant
+struct a3_AnimationBenchmark
+{
+	// name of benchmark and each variant
+	const a3byte *name;
+	const a3byte *variantName[a3benchmark_variantMax];
+
+	// average seconds per iteration
+	a3f64 variantTime[a3benchmark_variantMax];
+
+	// threads used by each variant (for per-thread throughput)
+	a3ui32 variantThreads[a3benchmark_variantMax];
+
+	// average solver iterations per item for iterative variants (else 0)
+	a3f64 variantSolverIterations[a3benchmark_variantMax];
+
+	// variants run, instances (or elements) per iteration, iterations
+	a3ui32 variantCount, instanceCount, iterations;
+
+	// largest difference between any variant's output and the first's
+	a3f64 errorMax;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// reset benchmark result
+a3i32 a3animationBenchmarkReset(a3_AnimationBenchmark *benchmark_out, const a3byte *name, const a3ui32 instanceCount, const a3ui32 iterations);
+
+// begin timing a variant
+a3i32 a3animationBenchmarkStart(a3_Timer *timer);
+
+// finish timing a variant; stores average time per iteration
+a3i32 a3animationBenchmarkStop(a3_AnimationBenchmark *benchmark, a3_Timer *timer, const a3byte *variantName);
+
+
+//-----------------------------------------------------------------------------
+
+// time forward kinematics for instances of a pose group: naive per-instance 
+//	matrix products versus SIMD batch solver
+a3i32 a3animationBenchmarkForwardKinematics(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 instanceCount, const a3ui32 iterations);
+
+// time serial versus level-parallel forward kinematics for a pose group 
+//	(pose 0); error is the number of nodes whose local or object poses are 
+//	not bit-identical, returns -1 if there are any
+a3i32 a3animationBenchmarkForwardKinematicsParallel(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, a3_KinematicsWorkerPool *pool, const a3ui32 iterations);
+
+// time CPU linear blend skinning of engine's geometry with a palette: 
+//	scalar reference, SIMD on one thread, SIMD across engine's workers; 
+//	error is the largest position difference from the reference
+a3i32 a3animationBenchmarkSkinning(a3_AnimationBenchmark *benchmark_out, a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout, const a3ui32 iterations);
+
+// time analytic two-bone IK for a chain (pose 0): solves on one state 
+//	with full forward kinematics refresh, with partial refresh, and one 
+//	batched solve over an instance per target; targets are reachable, 
+//	error is the largest distance from end node to target
+a3i32 a3animationBenchmarkTwoBone(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3ui32 solveCount, const a3ui32 iterations);
+
+// time iterative chain IK for a chain (pose 0) tracking a target along a 
+//	smooth path within reach: FABRIK and CCD, each with the warm start 
+//	reset before every solve and kept; reports average iterations per 
+//	solve; error is the largest distance from end node to target
+a3i32 a3animationBenchmarkChainIK(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 rootIndex, const a3ui32 endIndex, const a3real tolerance, const a3ui32 iterationMax, const a3ui32 solveCount, const a3ui32 iterations);
+
+// time loading skin weights from Maya deformerWeight XML: generic 
+//	line/attribute parse versus single-pass scanner of file contents; 
+//	error is the largest weight difference (1 if influences differ)
+a3i32 a3animationBenchmarkSkinWeightsLoad(a3_AnimationBenchmark *benchmark_out, const a3_Hierarchy *hierarchy_opt, const a3byte *filePath, const a3ui32 iterations);
+
+// time whole-pose blending over pairs of poses: node loop over spatial 
+//	poses, then SoA nlerp, masked nlerp, slerp and additive kernels; 
+//	items are nodes, so throughput reads as nodes per microsecond; error 
+//	compares the nlerp variants with the node loop
+a3i32 a3animationBenchmarkBlend(a3_AnimationBenchmark *benchmark_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 blendCount, const a3ui32 iterations);
+
+// time advancing sprites and producing their atlas rects: one clip 
+//	controller per sprite with a cell copy, versus the batched sprite 
+//	update; sprites cycle through the pool's clips at 64 updates per 
+//	second; error is the largest rect difference
+a3i32 a3animationBenchmarkSprites(a3_AnimationBenchmark *benchmark_out, const a3_ClipPool *clipPool, const a3_TextureAtlas *atlas, const a3ui32 spriteCount, const a3ui32 iterations);
+
+// time sampling a capture at a steady playback rate: pose group lerp 
+//	between dense frames versus per-channel reduced tracks with cursors; 
+//	error is the largest channel difference at the last sample, which 
+//	stays within the reduction tolerance rather than zero
+a3i32 a3animationBenchmarkKeyframeReduction(a3_AnimationBenchmark *benchmark_out, const a3_KeyframeReduction *reduction, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 sampleCount, const a3ui32 iterations);
+
+// time per-instance animation of a crowd cycling through baked clips: 
+//	live clip sample, forward kinematics and palette per instance, versus 
+//	the same palettes looked up from baked rows, versus advancing only the 
+//	baked (clip, time) entries (GPU does the lookup); clipPool and the 
+//	index list must be those the bake was made from; error is the largest 
+//	palette difference between baked rows and live evaluation at frame times
+a3i32 a3animationBenchmarkBake(a3_AnimationBenchmark *benchmark_out, const a3_AnimationBake *bake, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *clipIndexList_opt, const a3_HierarchyTransform *objectSpaceBindInverse, const a3ui32 instanceCount, const a3ui32 iterations);
+
+// print benchmark result to console
+a3i32 a3animationBenchmarkPrint(const a3_AnimationBenchmark *benchmark);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_AnimationBenchmark.inl"
+
+
+#endif	// !__ANIMAL3D_ANIMATIONBENCHMARK_H
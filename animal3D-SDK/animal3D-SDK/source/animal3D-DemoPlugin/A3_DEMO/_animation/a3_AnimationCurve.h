@@ -0,0 +1,136 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationCurve.h
+	Scalar curve tracks sampled in batches alongside clips.
+*/
+
+#ifndef __ANIMAL3D_ANIMATIONCURVE_H
+#define __ANIMAL3D_ANIMATIONCURVE_H
+
+
+#include "a3_HierarchyState.h"
+#include "a3_KeyframeAnimationController.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef enum a3_AnimationCurveInterp	a3_AnimationCurveInterp;
+typedef struct a3_AnimationCurveKey		a3_AnimationCurveKey;
+typedef struct a3_AnimationCurveTrack	a3_AnimationCurveTrack;
+typedef struct a3_AnimationCurveSet		a3_AnimationCurveSet;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// interpolation between keys of a track
+enum a3_AnimationCurveInterp
+{
+	a3curveInterp_hermite,		// key tangents, in value per second
+	a3curveInterp_bezier,		// key handles, as values before and after key
+	a3curveInterp_catmullRom,	// neighbouring key values; tangents unused
+};
+
+
+// curve key as supplied to track creation
+struct a3_AnimationCurveKey
+{
+	a3real time, value;
+	a3real in, out;
+};
+
+
+// track description: a run of keys and segments in the set
+struct a3_AnimationCurveTrack
+{
+	a3byte name[a3keyframeAnimation_nameLenMax];
+	a3_AnimationCurveInterp interp;
+	a3ui32 keyFirst, keyCount;
+};
+
+
+// set of curve tracks belonging to one clip
+// keys are stored as structure-of-arrays; each segment is also stored 
+//	as four aligned cubic Bezier control values, so every interpolation 
+//	type is sampled by one kernel, four tracks per step
+struct a3_AnimationCurveSet
+{
+	// tracks
+	a3_AnimationCurveTrack *track;
+	a3ui32 trackCount, trackMax, trackStride;
+
+	// keys
+	a3real *keyTime, *keyValue, *keyIn, *keyOut;
+	a3ui32 keyCount, keyMax;
+
+	// segment i of a track spans key i to key i+1: reciprocal duration 
+	//	and Bezier control values; the extra segment at keyMax is zero
+	a3real *segmentDurationInv, *control;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create curve set with capacity for tracks and keys (over all tracks)
+a3i32 a3animationCurveSetCreate(a3_AnimationCurveSet *curveSet_out, const a3ui32 trackMax, const a3ui32 keyMax);
+
+// release curve set
+a3i32 a3animationCurveSetRelease(a3_AnimationCurveSet *curveSet);
+
+// add track from keys sorted by time; returns track index
+a3i32 a3animationCurveSetAddTrack(a3_AnimationCurveSet *curveSet, const a3byte name[a3keyframeAnimation_nameLenMax], const a3_AnimationCurveInterp interp, const a3_AnimationCurveKey *key, const a3ui32 keyCount);
+
+// get track index by name
+a3i32 a3animationCurveSetGetTrackIndex(const a3_AnimationCurveSet *curveSet, const a3byte name[a3keyframeAnimation_nameLenMax]);
+
+// sample one track by searching its keys and calling its interpolation 
+//	kernel directly; reference for batched evaluation
+a3real a3animationCurveSetSampleTrack(const a3_AnimationCurveSet *curveSet, const a3ui32 trackIndex, const a3real time);
+
+// evaluate every track for each controller: time holds one time per 
+//	controller; cursor and value_out hold trackStride entries per 
+//	controller; cursors start at zero and hold each track's last segment 
+//	so that sequential playback steps instead of searching
+a3i32 a3animationCurveSetEvaluate(a3real *value_out, a3ui32 *cursor, const a3_AnimationCurveSet *curveSet, const a3real *time, const a3ui32 controllerCount);
+
+// evaluate every track for each clip controller, at its clip time
+a3i32 a3animationCurveSetEvaluateClipControllers(a3real *value_out, a3ui32 *cursor, const a3_AnimationCurveSet *curveSet, const a3_ClipController *clipCtrl, const a3ui32 controllerCount);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_AnimationCurve.inl"
+
+
+#endif	// !__ANIMAL3D_ANIMATIONCURVE_H
\ No newline at end of file
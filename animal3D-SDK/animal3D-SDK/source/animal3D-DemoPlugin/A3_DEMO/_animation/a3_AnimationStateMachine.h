@@ -0,0 +1,231 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_AnimationStateMachine.h
+	Animation state machine with crossfade transitions.
+*/
+
+#ifndef __ANIMAL3D_ANIMATIONSTATEMACHINE_H
+#define __ANIMAL3D_ANIMATIONSTATEMACHINE_H
+
+
+#include "a3_HierarchyStateBlend.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef enum a3_AnimationStateType				a3_AnimationStateType;
+typedef enum a3_AnimationTransitionCurve		a3_AnimationTransitionCurve;
+typedef enum a3_AnimationConditionCompare		a3_AnimationConditionCompare;
+typedef struct a3_AnimationCondition			a3_AnimationCondition;
+typedef struct a3_AnimationState				a3_AnimationState;
+typedef struct a3_AnimationTransition			a3_AnimationTransition;
+typedef struct a3_AnimationStateMachine			a3_AnimationStateMachine;
+typedef struct a3_AnimationCrossfade			a3_AnimationCrossfade;
+typedef struct a3_AnimationStateMachineInstance	a3_AnimationStateMachineInstance;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// state machine limits
+enum a3_AnimationStateMachineLimits
+{
+	a3stateMachine_crossfadeMax = 4,	// states blending at once per character; oldest collapses
+	a3stateMachine_paramMax = 255,		// parameters addressable by conditions
+	a3stateMachine_anyState = -1,		// transition source matching every state
+	a3stateMachine_stateTime = -1,		// condition operand: normalized time in current state
+};
+
+
+// what a state plays
+enum a3_AnimationStateType
+{
+	a3animationState_clip,		// clip from the machine's clip pool
+	a3animationState_tree,		// blend tree (sources and weights supplied per character)
+};
+
+
+// crossfade weight over normalized transition time
+enum a3_AnimationTransitionCurve
+{
+	a3animationCurve_linear,
+	a3animationCurve_smooth,	// smoothstep
+	a3animationCurve_easeIn,	// quadratic
+	a3animationCurve_easeOut,	// quadratic
+};
+
+
+// condition comparisons; 'or' ends the current group of terms
+enum a3_AnimationConditionCompare
+{
+	a3animationCompare_less,
+	a3animationCompare_lessEqual,
+	a3animationCompare_greater,
+	a3animationCompare_greaterEqual,
+	a3animationCompare_equal,
+	a3animationCompare_notEqual,
+	a3animationCompare_or,
+};
+
+
+// transition condition term: parameter (or state time) compared with 
+//	a value; consecutive terms are and-ed, 'or' terms separate groups
+struct a3_AnimationCondition
+{
+	a3i32 paramIndex;
+	a3_AnimationConditionCompare compare;
+	a3real value;
+};
+
+
+// state description
+struct a3_AnimationState
+{
+	a3byte name[a3keyframeAnimation_nameLenMax];
+	a3_AnimationStateType type;
+	a3ui32 clipIndex;
+	const a3_HierarchyBlendTree *tree;
+	a3real speed;
+};
+
+
+// transition description; condition is compiled bytecode at 'code'
+struct a3_AnimationTransition
+{
+	a3i32 stateFrom;
+	a3ui32 stateTo;
+	a3real duration;
+	a3_AnimationTransitionCurve curve;
+	a3ui32 code;
+};
+
+
+// state machine asset, shared by all characters using it
+// transitions are checked in the order they were added
+struct a3_AnimationStateMachine
+{
+	// clips played by clip states
+	const a3_ClipPool *clipPool;
+
+	// states and transitions
+	a3_AnimationState *state;
+	a3_AnimationTransition *transition;
+	a3ui32 stateCount, stateMax, transitionCount, transitionMax;
+
+	// condition bytecode for all transitions
+	a3ubyte *code;
+	a3ui32 codeSize, codeMax;
+
+	// parameter block length required by conditions
+	a3ui32 paramCount;
+
+	// raw allocation
+	void *data;
+};
+
+
+// one blending state: playhead, time in state and fade-in progress
+struct a3_AnimationCrossfade
+{
+	a3_ClipController controller;
+	a3ui32 state;
+	a3real stateTime;
+	a3real fadeTime, fadeDurationInv;
+	a3_AnimationTransitionCurve curve;
+};
+
+
+// per-character state: fixed stack of crossfades, current state on top
+struct a3_AnimationStateMachineInstance
+{
+	const a3_AnimationStateMachine *machine;
+	a3_AnimationCrossfade crossfade[a3stateMachine_crossfadeMax];
+	a3ui32 crossfadeCount;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create state machine with capacity for states, transitions and 
+//	condition terms (total over all transitions)
+a3i32 a3animationStateMachineCreate(a3_AnimationStateMachine *machine_out, const a3_ClipPool *clipPool, const a3ui32 stateMax, const a3ui32 transitionMax, const a3ui32 conditionMax);
+
+// release state machine
+a3i32 a3animationStateMachineRelease(a3_AnimationStateMachine *machine);
+
+// add state playing a clip; speed scales time, negative plays the clip 
+//	in reverse from its end (state time still counts up from zero); 
+//	returns state index
+a3i32 a3animationStateMachineAddClipState(a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax], const a3ui32 clipIndex, const a3real speed);
+
+// add state evaluating a blend tree; speed scales state time and must 
+//	not be negative; returns state index
+a3i32 a3animationStateMachineAddTreeState(a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax], const a3_HierarchyBlendTree *tree, const a3real speed);
+
+// add transition and compile its condition; no terms means always; 
+//	returns transition index
+a3i32 a3animationStateMachineAddTransition(a3_AnimationStateMachine *machine, const a3i32 stateFrom, const a3ui32 stateTo, const a3real duration, const a3_AnimationTransitionCurve curve, const a3_AnimationCondition *condition, const a3ui32 conditionCount);
+
+// get state index by name
+a3i32 a3animationStateMachineGetStateIndex(const a3_AnimationStateMachine *machine, const a3byte name[a3keyframeAnimation_nameLenMax]);
+
+// run compiled condition
+a3boolean a3animationStateMachineTestCondition(const a3_AnimationStateMachine *machine, const a3ui32 code, const a3real *param, const a3real stateTime);
+
+
+//-----------------------------------------------------------------------------
+
+// start character in state
+a3i32 a3animationStateMachineInstanceInit(a3_AnimationStateMachineInstance *instance_out, const a3_AnimationStateMachine *machine, const a3ui32 state);
+
+// force transition to state, as if a transition fired
+a3i32 a3animationStateMachineInstanceSetState(a3_AnimationStateMachineInstance *instance, const a3ui32 state, const a3real duration, const a3_AnimationTransitionCurve curve);
+
+// advance time, retire finished crossfades and fire at most one 
+//	transition from the current state; returns transitions fired
+a3i32 a3animationStateMachineInstanceUpdate(a3_AnimationStateMachineInstance *instance, const a3real *param, const a3real dt);
+
+// get current (most recent) state
+a3i32 a3animationStateMachineInstanceGetState(const a3_AnimationStateMachineInstance *instance);
+
+// evaluate character's pose: states are blended oldest to newest by 
+//	their fade weights, skipping states hidden by a completed fade; 
+//	scratch must differ from output; tree states use the blend stack and 
+//	the character's sources and weights; returns states evaluated
+a3i32 a3animationStateMachineInstanceEvaluate(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *scratch, const a3_AnimationStateMachineInstance *instance, const a3_HierarchyPoseGroup *poseGroup, const a3_HierarchyBlendStack *stack_opt, const a3_HierarchyBlendSource *treeSource_opt, const a3real *treeParam_opt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_AnimationStateMachine.inl"
+
+
+#endif	// !__ANIMAL3D_ANIMATIONSTATEMACHINE_H
\ No newline at end of file
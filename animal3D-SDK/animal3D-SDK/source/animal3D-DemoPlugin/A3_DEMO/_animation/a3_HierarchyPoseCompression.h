@@ -0,0 +1,134 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyPoseCompression.h
+	Quantized storage for hierarchy pose groups.
+*/
+
+#ifndef __ANIMAL3D_HIERARCHYPOSECOMPRESSION_H
+#define __ANIMAL3D_HIERARCHYPOSECOMPRESSION_H
+
+
+#include "a3_HierarchyState.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_HierarchyPoseGroupCompressed	a3_HierarchyPoseGroupCompressed;
+typedef struct a3_HierarchyPoseCompressionReport	a3_HierarchyPoseCompressionReport;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// quantized pose group
+//	orientation: smallest-three in 48 bits per node; three 16-bit words, 
+//		largest component index in the top bits of words 0 and 1, 
+//		remaining components in 15, 15 and 16 bits over +/-sqrt(1/2)
+//	translation: 16 bits per component over the bounding range of the 
+//		node's channel within the clip (range) containing the pose
+//	scale: elided entirely if constant for every node in the group, 
+//		otherwise quantized the same way as translation
+// all streams are structure-of-arrays per pose, padded to node stride
+struct a3_HierarchyPoseGroupCompressed
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// quantized streams: [pose][component][node]
+	a3ui16 *orientation, *translation, *scale;
+
+	// dequantization tables: [range][component][node]
+	//	value = base + quantized * step
+	a3real *translationBase, *translationStep;
+	a3real *scaleBase, *scaleStep;
+
+	// constant scale when elided: [component][node]
+	a3real *scaleConstant;
+
+	// range (clip) index of each pose
+	a3ui32 *poseRange;
+
+	// counts
+	a3ui32 hposeCount, nodeCount, nodeStride, rangeCount;
+
+	// scale stream elided
+	a3boolean scaleElided;
+
+	// storage size in bytes and raw allocation
+	a3ui32 dataSize;
+	void *data;
+};
+
+
+// compression summary
+struct a3_HierarchyPoseCompressionReport
+{
+	// bytes used by source channels (orientation, scale, translation 
+	//	as floats) and by compressed streams and tables
+	a3ui32 sourceSize, compressedSize;
+
+	// source size / compressed size
+	a3real ratio;
+
+	// maximum angular error (degrees) and positional errors (units)
+	a3real orientationErrorMax, translationErrorMax, scaleErrorMax;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// compress pose group; poses are split into ranges (clips) beginning at 
+//	each entry of the sorted first-pose list (null for a single range)
+a3i32 a3hierarchyPoseGroupCompress(a3_HierarchyPoseGroupCompressed *compressed_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 *rangeFirstPose, const a3ui32 rangeCount);
+
+// release compressed pose group
+a3i32 a3hierarchyPoseGroupCompressedRelease(a3_HierarchyPoseGroupCompressed *compressed);
+
+// decompress single pose directly into structure-of-arrays pose
+a3i32 a3hierarchyPoseGroupCompressedDecode(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseGroupCompressed *compressed, const a3ui32 poseIndex);
+
+// decompress single pose into hierarchy pose via structure-of-arrays pose
+a3i32 a3hierarchyPoseGroupCompressedDecodePose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_tmp, const a3_HierarchyPoseGroupCompressed *compressed, const a3ui32 poseIndex);
+
+// decode every pose and compare against source to measure error and size
+a3i32 a3hierarchyPoseGroupCompressedReport(a3_HierarchyPoseCompressionReport *report_out, const a3_HierarchyPoseGroupCompressed *compressed, const a3_HierarchyPoseGroup *poseGroup);
+
+// print report to console
+a3i32 a3hierarchyPoseGroupCompressedPrintReport(const a3_HierarchyPoseCompressionReport *report, const a3byte *label);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_HierarchyPoseCompression.inl"
+
+
+#endif	// !__ANIMAL3D_HIERARCHYPOSECOMPRESSION_H
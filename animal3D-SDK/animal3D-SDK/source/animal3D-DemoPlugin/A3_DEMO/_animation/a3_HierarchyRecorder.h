@@ -0,0 +1,164 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_HierarchyRecorder.h
+	Hierarchy state capture to delta-compressed files, and playback.
+*/
+
+#ifndef __ANIMAL3D_HIERARCHYRECORDER_H
+#define __ANIMAL3D_HIERARCHYRECORDER_H
+
+
+#include "a3_HierarchyState.h"
+
+// A3 threads and file streams
+#include "animal3D/a3utility/a3_Thread.h"
+#include "animal3D/a3utility/a3_Stream.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_HierarchyRecorder	a3_HierarchyRecorder;
+typedef struct a3_HierarchyPlayer	a3_HierarchyPlayer;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// capture file constants
+enum a3_HierarchyRecordingFormat
+{
+	a3hierarchyRecording_magic = 0x52483341,	// 'A3HR'
+	a3hierarchyRecording_version = 1,
+};
+
+
+// hierarchy state recorder
+// each capture copies the state's local pose into a ring of raw frames 
+//	and returns; a writer thread, woken by each capture, encodes waiting 
+//	frames against the one before and streams them to file
+// encoding is lossless: every 32-bit word of the pose is XOR'd with the 
+//	same word of the previous frame, stored as a 2-bit code (unchanged, 
+//	or 2, 3 or 4 low bytes) followed by the low bytes themselves; static 
+//	nodes cost a few bytes, animated floats usually drop their exponent
+// if the ring is full the frame is dropped (counted) rather than 
+//	stalling the caller; frame numbers in the file show the gap
+struct a3_HierarchyRecorder
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// 32-bit words per frame
+	a3ui32 wordCount;
+
+	// ring of raw frames and their frame numbers; frames 
+	//	[consumed, produced) wait for the writer
+	a3_SpatialPose *ring;
+	a3ui32 *ringFrame, ringCapacity;
+	volatile a3ui32 produced, consumed;
+
+	// frames captured (including dropped) and dropped
+	a3ui32 frameCount, droppedCount;
+
+	// writer: previous frame, encoded record and its size
+	a3ui32 *previous;
+	a3ubyte *record;
+	a3ui32 recordSize;
+
+	// writer: bytes and frames written
+	a3ui32 bytesWritten, framesWritten;
+
+	// output file, writer thread and the event that wakes it
+	a3_FileStream fileStream[1];
+	a3_Thread thread[1];
+	void *wake;
+	a3boolean launched;
+	volatile a3boolean stop;
+
+	// raw allocation
+	void *data;
+};
+
+
+// hierarchy capture player: every frame of a file, decoded up front so 
+//	any frame can be applied or compared directly
+struct a3_HierarchyPlayer
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// decoded frames (node poses, frame-major) and their frame numbers
+	a3_SpatialPose *frame;
+	a3ui32 *frameNumber;
+	a3ui32 frameCount;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create recorder writing to file, with ring of frames; starts writer
+a3i32 a3hierarchyRecorderCreate(a3_HierarchyRecorder *recorder_out, const a3_Hierarchy *hierarchy, const a3ui32 ringCapacity, const a3byte *filePath);
+
+// finish writing waiting frames, stop writer, close file and release; 
+//	returns number of frames written
+a3i32 a3hierarchyRecorderRelease(a3_HierarchyRecorder *recorder);
+
+// capture state's local pose; returns 1 if queued, 0 if ring was full
+a3i32 a3hierarchyRecorderCapture(a3_HierarchyRecorder *recorder, const a3_HierarchyState *state);
+
+
+// load every frame of a capture file recorded for hierarchy; returns 
+//	number of frames
+a3i32 a3hierarchyPlayerLoad(a3_HierarchyPlayer *player_out, const a3_Hierarchy *hierarchy, const a3byte *filePath);
+
+// release player
+a3i32 a3hierarchyPlayerRelease(a3_HierarchyPlayer *player);
+
+// get node poses of frame
+const a3_SpatialPose *a3hierarchyPlayerGetFrame(const a3_HierarchyPlayer *player, const a3ui32 frameIndex);
+
+// copy frame (channels and matrices) into state's local pose and flag 
+//	every node changed; kinematics still to be done
+a3i32 a3hierarchyPlayerApply(const a3_HierarchyPlayer *player, const a3_HierarchyState *state, const a3ui32 frameIndex);
+
+// compare two captures frame by frame (up to the shorter); returns number 
+//	of frames where any pose element differs by more than tolerance
+a3i32 a3hierarchyPlayerCompare(const a3_HierarchyPlayer *playerA, const a3_HierarchyPlayer *playerB, const a3real tolerance, a3real *maxError_out_opt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_HierarchyRecorder.inl"
+
+
+#endif	// !__ANIMAL3D_HIERARCHYRECORDER_H
\ No newline at end of file
@@ -33,21 +33,60 @@
 #include "a3_SpatialPose.h"
 
 
+// SIMD batch kernels: SSE2 when reals are single-precision and the target 
+//	guarantees it (always on x64); scalar fallback otherwise
+#if (!defined A3_REAL_F64 && !defined A3_REAL_F128 && (defined _M_X64 || defined __SSE2__ || (defined _M_IX86_FP && _M_IX86_FP >= 2)))
+#define A3_HIERARCHY_SIMD
+#include <emmintrin.h>
+#endif	// SSE2
+
+
 //-----------------------------------------------------------------------------
 
 #ifdef __cplusplus
 extern "C"
 {
 #else	// !__cplusplus
+typedef enum a3_HierarchyScaleMode		a3_HierarchyScaleMode;
+typedef enum a3_HierarchyPaletteLayout	a3_HierarchyPaletteLayout;
 typedef struct a3_HierarchyPose			a3_HierarchyPose;
 typedef struct a3_HierarchyTransform	a3_HierarchyTransform;
+typedef struct a3_HierarchyPoseSoA		a3_HierarchyPoseSoA;
 typedef struct a3_HierarchyPoseGroup	a3_HierarchyPoseGroup;
 typedef struct a3_HierarchyState		a3_HierarchyState;
+typedef struct a3_HierarchyStateBatch	a3_HierarchyStateBatch;
 #endif	// __cplusplus
 	
 
 //-----------------------------------------------------------------------------
 
+// scale usage across all poses of a rig; selects the cheapest valid 
+//	transform inverse
+enum a3_HierarchyScaleMode
+{
+	a3hierarchyScale_none,			// unit scale: rigid inverse
+	a3hierarchyScale_uniform,		// equal scale on all axes per node
+	a3hierarchyScale_nonuniform,	// arbitrary scale: general affine inverse
+};
+
+
+// skinning palette layouts; value is reals per node, all are std140 
+//	arrays with no padding (requires single-precision reals): 
+//		mat4: 'mat4 palette[N]', column-major
+//		mat3x4: 'vec4 palette[3 * N]', three rows per node; in shader: 
+//			mat4x3 m = transpose(mat3x4(palette[3*i], palette[3*i+1], palette[3*i+2]))
+//		dualquat: 'vec4 palette[2 * N]', unit real part (w >= 0) then dual 
+//			part; rigid only, scale is removed
+// batched palettes are instance-major, so an instanced shader reads node i 
+//	of instance k at (k * N + i) * (layout / 4)
+enum a3_HierarchyPaletteLayout
+{
+	a3hierarchyPalette_dualquat = 8,
+	a3hierarchyPalette_mat3x4 = 12,
+	a3hierarchyPalette_mat4 = 16,
+};
+
+
 // single pose for a collection of nodes
 // makes algorithms easier to keep this as a separate data type
 struct a3_HierarchyPose
@@ -63,11 +102,65 @@ struct a3_HierarchyTransform
 };
 
 
+// channel streams in structure-of-arrays pose
+enum a3_HierarchyPoseSoAChannel
+{
+	a3poseSoA_orient_x,
+	a3poseSoA_orient_y,
+	a3poseSoA_orient_z,
+	a3poseSoA_orient_w,
+	a3poseSoA_scale_x,
+	a3poseSoA_scale_y,
+	a3poseSoA_scale_z,
+	a3poseSoA_translate_x,
+	a3poseSoA_translate_y,
+	a3poseSoA_translate_z,
+
+	a3poseSoA_channelCount,
+	a3poseSoA_nodeAlign = 4,	// nodes per SIMD step; stride is a multiple
+};
+
+
+// structure-of-arrays pose for a collection of nodes
+// each channel component is its own 16-byte aligned stream, padded to the 
+//	stride so batch kernels can process several nodes per step
+struct a3_HierarchyPoseSoA
+{
+	// channel streams, indexed by node
+	union {
+		a3real *channel[a3poseSoA_channelCount];
+		struct {
+			a3real *orientation[4];
+			a3real *scale[3];
+			a3real *translation[3];
+		};
+	};
+
+	// number of nodes in use and padded stream length
+	a3ui32 nodeCount, nodeStride;
+
+	// raw allocation (channels point into this)
+	void *data;
+};
+
+
 // pose group
 struct a3_HierarchyPoseGroup
 {
 	// pointer to hierarchy
 	const a3_Hierarchy *hierarchy;
+
+	// contiguous pool of node poses; hierarchy poses index into this
+	a3_SpatialPose *spatialPosePool;
+
+	// hierarchy poses, each referencing one node pose per node
+	a3_HierarchyPose *hpose;
+
+	// number of hierarchy poses and total node poses
+	a3ui32 hposeCount, spatialPoseCount;
+
+	// scale usage of all poses
+	a3_HierarchyScaleMode scaleMode;
 };
 
 
@@ -77,6 +170,52 @@ struct a3_HierarchyState
 {
 	// pointer to pose set that the poses come from
 	const a3_HierarchyPoseGroup *poseGroup;
+
+	// working poses: sampled from group, local-space and object-space
+	union {
+		a3_HierarchyPose hpose[3];
+		struct {
+			a3_HierarchyPose sampleHPose[1], localHPose[1], objectHPose[1];
+		};
+	};
+
+	// inverse object-space transforms
+	a3_HierarchyTransform objectSpaceInverse[1];
+
+	// structure-of-arrays sampling buffer
+	a3_HierarchyPoseSoA samplePoseSoA[1];
+
+	// subtree range per node: descendants of node i lie in (i, subtreeEnd[i])
+	a3ui32 *subtreeEnd;
+
+	// per-node flag raised when local pose changes; cleared by kinematics
+	a3ubyte *localDirty;
+
+	// nodes recomputed by most recent incremental forward kinematics
+	a3ui32 forwardNodeCount;
+};
+
+
+// batch of states for one hierarchy, solved together
+// matrices are node-major, instance-minor: each element of a node's 
+//	matrix is a stream across instances, padded to the SIMD width, so 
+//	kernels process several instances of the same node per step
+struct a3_HierarchyStateBatch
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// matrix streams: [node][element][instance], elements column-major
+	a3real *localTransform, *objectTransform, *objectInverseTransform;
+
+	// one past last node in each node's subtree
+	a3ui32 *subtreeEnd;
+
+	// number of instances and padded stream length
+	a3ui32 instanceCount, instanceStride;
+
+	// raw allocation (streams point into this)
+	void *data;
 };
 	
 
@@ -94,6 +233,40 @@ a3i32 a3hierarchyPoseGroupGetPoseOffsetIndex(const a3_HierarchyPoseGroup *poseGr
 // get offset to single node pose in contiguous set
 a3i32 a3hierarchyPoseGroupGetNodePoseOffsetIndex(const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex, const a3ui32 nodeIndex);
 
+// scan all poses to determine scale usage; updates and returns mode
+a3i32 a3hierarchyPoseGroupUpdateScaleMode(a3_HierarchyPoseGroup *poseGroup);
+
+// load HTR file, create hierarchy and pose group; pose 0 is the base pose, 
+//	frames follow as absolute local poses (base pose concatenated with frame)
+a3i32 a3hierarchyPoseGroupLoadHTR(a3_HierarchyPoseGroup *poseGroup_out, a3_Hierarchy *hierarchy_out, const a3byte *resourceFilePath);
+
+
+//-----------------------------------------------------------------------------
+
+// reset hierarchy pose to identity
+a3i32 a3hierarchyPoseReset(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount);
+
+// copy hierarchy pose
+a3i32 a3hierarchyPoseCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// convert channels to matrices for all nodes in hierarchy pose
+a3i32 a3hierarchyPoseConvert(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount);
+
+
+//-----------------------------------------------------------------------------
+
+// allocate structure-of-arrays pose for node count
+a3i32 a3hierarchyPoseSoACreate(a3_HierarchyPoseSoA *pose_out, const a3ui32 nodeCount);
+
+// release structure-of-arrays pose
+a3i32 a3hierarchyPoseSoARelease(a3_HierarchyPoseSoA *pose);
+
+// scatter hierarchy pose channels into structure-of-arrays pose
+a3i32 a3hierarchyPoseSoAStore(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPose *pose_in);
+
+// gather structure-of-arrays pose channels into hierarchy pose
+a3i32 a3hierarchyPoseSoALoad(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_in);
+
 
 //-----------------------------------------------------------------------------
 
@@ -103,15 +276,60 @@ a3i32 a3hierarchyStateCreate(a3_HierarchyState *state_out, const a3_HierarchyPos
 // release hierarchy state
 a3i32 a3hierarchyStateRelease(a3_HierarchyState *state);
 
+// flag node's local pose as changed so its subtree is recomputed
+a3i32 a3hierarchyStateSetNodeDirty(const a3_HierarchyState *state, const a3ui32 nodeIndex);
+
+// flag all nodes as changed
+a3i32 a3hierarchyStateSetAllDirty(const a3_HierarchyState *state);
+
+// copy pose into local pose; only nodes whose channels differ are copied, 
+//	converted and flagged; returns number of nodes changed
+a3i32 a3hierarchyStateUpdateLocal(const a3_HierarchyState *state, const a3_HierarchyPose *pose_in);
+
 // update inverse object-space matrices
 a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state, const a3boolean usingScale);
 
-// update bind-to-current given bind-pose object-space transforms
-a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse);
+// update bind-to-current (object * bind inverse) given inverse bind-pose 
+//	object-space transforms; written straight into caller's palette in the 
+//	given layout (e.g. mapped or staged uniform buffer contents)
+// palette holds node count * layout reals; returns node count
+a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse, a3real *palette_out, const a3_HierarchyPaletteLayout layout);
+
+
+//-----------------------------------------------------------------------------
+
+// initialize batch of states for hierarchy
+a3i32 a3hierarchyStateBatchCreate(a3_HierarchyStateBatch *batch_out, const a3_Hierarchy *hierarchy, const a3ui32 instanceCount);
+
+// release batch
+a3i32 a3hierarchyStateBatchRelease(a3_HierarchyStateBatch *batch);
+
+// get first element of node's matrix streams
+a3real *a3hierarchyStateBatchGetNodeTransform(const a3real *transform, const a3_HierarchyStateBatch *batch, const a3ui32 nodeIndex);
+
+// scatter hierarchy pose matrices into instance's local streams
+a3i32 a3hierarchyStateBatchStoreLocal(const a3_HierarchyStateBatch *batch, const a3ui32 instanceIndex, const a3_HierarchyPose *pose_in);
+
+// gather instance's object streams into hierarchy pose matrices
+a3i32 a3hierarchyStateBatchLoadObject(const a3_HierarchyPose *pose_out, const a3_HierarchyStateBatch *batch, const a3ui32 instanceIndex);
+
+// get number of instance palettes that fit in a uniform block of given size 
+//	in bytes (e.g. a3shaderUniformBlockMaxSize)
+a3i32 a3hierarchyPaletteGetInstanceCapacity(const a3_HierarchyPaletteLayout layout, const a3ui32 nodeCount, const a3ui32 blockSize);
+
+// update bind-to-current for every instance in one pass over the object 
+//	streams; instance palettes are consecutive in output (instance k starts 
+//	at node count * layout * k); returns instance count
+a3i32 a3hierarchyStateBatchUpdateObjectBindToCurrent(const a3_HierarchyStateBatch *batch, const a3_HierarchyTransform *objectSpaceBindInverse, a3real *palette_out, const a3_HierarchyPaletteLayout layout);
 
 
 //-----------------------------------------------------------------------------
 
+#ifdef A3_HIERARCHY_SIMD
+// four quaternion products at once, one component per register (x, y, z, w); 
+//	same convention as a3quatProduct
+void a3hierarchyQuatProduct4(__m128 *q_out, const __m128 *qL, const __m128 *qR);
+#endif	// A3_HIERARCHY_SIMD
 
 
 //-----------------------------------------------------------------------------
@@ -28,6 +28,8 @@
 
 #include "a3_HierarchyState.h"
 
+#include "a3_KeyframeAnimationController.h"
+
 
 //-----------------------------------------------------------------------------
 
@@ -35,12 +37,302 @@
 extern "C"
 {
 #else	// !__cplusplus
-
+typedef enum a3_HierarchyBlendOp				a3_HierarchyBlendOp;
+typedef struct a3_HierarchyBlendNode			a3_HierarchyBlendNode;
+typedef struct a3_HierarchyBlendInstruction		a3_HierarchyBlendInstruction;
+typedef struct a3_HierarchyBlendTree			a3_HierarchyBlendTree;
+typedef struct a3_HierarchyBlendSource			a3_HierarchyBlendSource;
+typedef struct a3_HierarchyBlendStack			a3_HierarchyBlendStack;
+typedef enum a3_HierarchyBlendLayerMode			a3_HierarchyBlendLayerMode;
+typedef struct a3_HierarchyBlendMask			a3_HierarchyBlendMask;
+typedef struct a3_HierarchyBlendCacheEntry		a3_HierarchyBlendCacheEntry;
+typedef struct a3_HierarchyBlendCache			a3_HierarchyBlendCache;
 #endif	// __cplusplus
 	
 
 //-----------------------------------------------------------------------------
 
+// blend tree operations; 'in' are inputs, 'param' are weights read from 
+//	the character's parameter block
+enum a3_HierarchyBlendOp
+{
+	a3blendOp_sample,		// leaf: sample source
+	a3blendOp_lerp,			// in0 to in1 by param0
+	a3blendOp_add,			// in0 plus delta pose in1 scaled by param0
+	a3blendOp_scale,		// identity to in0 by param0
+	a3blendOp_concat,		// in0 composed with in1
+	a3blendOp_bilerp,		// in0 to in1 and in2 to in3 by param0, then rows by param1
+	a3blendOp_triangular,	// barycentric: in1 by param0, in2 by param1, in0 by remainder
+
+	a3blendOp_count,
+	a3blendTree_inputMax = 4,
+	a3blendTree_paramMax = 2,
+};
+
+
+// blend tree description node; inputs are indices of other nodes in the 
+//	description, params index the parameter block, source indexes the 
+//	sample sources (leaves only); unused fields are ignored
+struct a3_HierarchyBlendNode
+{
+	a3_HierarchyBlendOp op;
+	a3ui32 input[a3blendTree_inputMax];
+	a3ui32 param[a3blendTree_paramMax];
+	a3ui32 source;
+};
+
+
+// compiled instruction: inputs are indices of earlier instructions; 
+//	result goes to stack slot 'slot', input j lives in 'slot + j'
+struct a3_HierarchyBlendInstruction
+{
+	a3_HierarchyBlendOp op;
+	a3ui32 input[a3blendTree_inputMax];
+	a3ui32 param[a3blendTree_paramMax];
+	a3ui32 source;
+	a3ui32 slot;
+	a3ui32 inputCount;
+};
+
+
+// compiled blend tree: flat post-order instruction list, root last
+// shared by all characters using the same graph
+struct a3_HierarchyBlendTree
+{
+	// instructions
+	a3_HierarchyBlendInstruction *instruction;
+	a3ui32 instructionCount;
+
+	// scratch poses needed to execute
+	a3ui32 stackDepth;
+
+	// minimum length of per-character source and parameter arrays
+	a3ui32 sourceCount, paramCount;
+};
+
+
+// per-character sample source for a leaf: two poses of a group and 
+//	the interpolation parameter between them (e.g. from a clip controller)
+struct a3_HierarchyBlendSource
+{
+	const a3_HierarchyPoseGroup *poseGroup;
+	a3ui32 pose0, pose1;
+	a3real param;
+};
+
+
+// scratch stack for executing blend trees; one per thread, sized for 
+//	the largest tree it will run
+struct a3_HierarchyBlendStack
+{
+	// scratch poses
+	a3_HierarchyPoseSoA *pose;
+	a3ui32 depth;
+
+	// per-instruction live flags for current evaluation
+	a3ubyte *live;
+	a3ui32 instructionMax;
+
+	// raw allocation
+	void *data;
+};
+
+
+// cache record for one instruction's result: the key it was computed 
+//	from and generation counters
+struct a3_HierarchyBlendCacheEntry
+{
+	// leaf key: source poses and parameter
+	const a3_HierarchyPoseGroup *poseGroup;
+	a3ui32 pose0, pose1;
+
+	// weights used (leaf: source parameter)
+	a3real param[a3blendTree_paramMax];
+
+	// generations of live inputs when computed (zero for dead inputs)
+	a3ui32 inputGeneration[a3blendTree_inputMax];
+
+	// bumped each time the result is recomputed; zero means empty
+	a3ui32 generation;
+};
+
+
+// per-character cache of blend tree results; an instruction whose key 
+//	and inputs are unchanged keeps its previous result, so an idle 
+//	character costs a key comparison per instruction
+struct a3_HierarchyBlendCache
+{
+	// tree the cache belongs to
+	const a3_HierarchyBlendTree *tree;
+
+	// instruction count the cache was sized for
+	a3ui32 instructionCount;
+
+	// result per instruction, plus scratch
+	a3_HierarchyPoseSoA *pose, *scratch;
+
+	// keys per instruction
+	a3_HierarchyBlendCacheEntry *entry;
+
+	// per-instruction live flags for current evaluation
+	a3ubyte *live;
+
+	// largest weight change still considered equal
+	a3real tolerance;
+
+	// statistics: live instructions reused and recomputed
+	a3ui32 hitCount, missCount;
+
+	// raw allocation
+	void *data;
+};
+
+
+// layer blend modes
+enum a3_HierarchyBlendLayerMode
+{
+	a3blendLayer_override,	// base to layer by weight
+	a3blendLayer_additive,	// base plus weighted difference of layer from reference
+};
+
+
+// named per-node weight mask for layering (e.g. upper body); nodes with 
+//	non-zero weight are kept in a compiled index list so layers visit 
+//	only those nodes
+struct a3_HierarchyBlendMask
+{
+	// mask name
+	a3byte name[a3node_nameSize];
+
+	// hierarchy the mask applies to
+	const a3_Hierarchy *hierarchy;
+
+	// per-node weight, padded to the SoA pose stride with zeros
+	a3real *weight;
+
+	// ascending indices of nodes with non-zero weight
+	a3ui32 *index;
+	a3ui32 indexCount;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// compile blend tree from description rooted at 'rootIndex'; nodes may 
+//	be shared (evaluated once per use); fails on cycles or bad indices
+a3i32 a3hierarchyBlendTreeCreate(a3_HierarchyBlendTree *tree_out, const a3_HierarchyBlendNode *node, const a3ui32 nodeCount, const a3ui32 rootIndex);
+
+// release blend tree
+a3i32 a3hierarchyBlendTreeRelease(a3_HierarchyBlendTree *tree);
+
+// create scratch stack for trees up to the given depth and length
+a3i32 a3hierarchyBlendStackCreate(a3_HierarchyBlendStack *stack_out, const a3ui32 nodeCount, const a3ui32 depth, const a3ui32 instructionMax);
+
+// release scratch stack
+a3i32 a3hierarchyBlendStackRelease(a3_HierarchyBlendStack *stack);
+
+// evaluate blend tree for one character in a single pass; branches whose 
+//	weight is zero are skipped along with all leaves below them
+// returns number of sources sampled
+a3i32 a3hierarchyBlendTreeEvaluate(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyBlendTree *tree, const a3_HierarchyBlendStack *stack, const a3_HierarchyBlendSource *source, const a3real *param);
+
+// create result cache for one character using tree
+a3i32 a3hierarchyBlendCacheCreate(a3_HierarchyBlendCache *cache_out, const a3_HierarchyBlendTree *tree, const a3ui32 nodeCount, const a3real tolerance);
+
+// release result cache
+a3i32 a3hierarchyBlendCacheRelease(a3_HierarchyBlendCache *cache);
+
+// discard all cached results (e.g. after pose group changes)
+a3i32 a3hierarchyBlendCacheInvalidate(a3_HierarchyBlendCache *cache);
+
+// reset hit and miss counts
+a3i32 a3hierarchyBlendCacheResetStats(a3_HierarchyBlendCache *cache);
+
+// fraction of live instructions reused since last reset
+a3real a3hierarchyBlendCacheHitRate(const a3_HierarchyBlendCache *cache);
+
+// evaluate blend tree through cache: same result as uncached evaluation 
+//	within tolerance; fails if the tree no longer has the instruction 
+//	count the cache was created for; returns number of instructions 
+//	recomputed
+a3i32 a3hierarchyBlendTreeEvaluateCached(const a3_HierarchyPoseSoA *pose_out, a3_HierarchyBlendCache *cache, const a3_HierarchyBlendSource *source, const a3real *param);
+
+// set sample source
+a3i32 a3hierarchyBlendSourceSet(a3_HierarchyBlendSource *source_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 pose0, const a3ui32 pose1, const a3real param);
+
+// set sample source from clip controller: current keyframe to next, 
+//	keyframe data is pose index
+a3i32 a3hierarchyBlendSourceSetClipController(a3_HierarchyBlendSource *source_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipController *clipCtrl);
+
+// sample source into pose
+a3i32 a3hierarchyBlendSourceSample(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyBlendSource *source);
+
+
+//-----------------------------------------------------------------------------
+
+// create mask with all weights zero
+a3i32 a3hierarchyBlendMaskCreate(a3_HierarchyBlendMask *mask_out, const a3_Hierarchy *hierarchy, const a3byte name[a3node_nameSize]);
+
+// release mask
+a3i32 a3hierarchyBlendMaskRelease(a3_HierarchyBlendMask *mask);
+
+// set weight of one node
+a3i32 a3hierarchyBlendMaskSetNode(a3_HierarchyBlendMask *mask, const a3ui32 nodeIndex, const a3real weight);
+
+// set weight of node and all of its descendants; returns nodes set
+a3i32 a3hierarchyBlendMaskSetSubtree(a3_HierarchyBlendMask *mask, const a3ui32 rootIndex, const a3real weight);
+
+// set weight of named node and all of its descendants
+a3i32 a3hierarchyBlendMaskSetSubtreeName(a3_HierarchyBlendMask *mask, const a3byte rootName[a3node_nameSize], const a3real weight);
+
+// apply layer to pose in place with per-node weight u * mask weight; 
+//	nodes outside the mask are not touched; reference is required for 
+//	additive layers
+a3i32 a3hierarchyPoseSoALayer(const a3_HierarchyPoseSoA *pose_inout, const a3_HierarchyPoseSoA *layer, const a3_HierarchyPoseSoA *reference_opt, const a3_HierarchyBlendMask *mask, const a3real u, const a3_HierarchyBlendLayerMode mode);
+
+
+//-----------------------------------------------------------------------------
+
+// whole-pose operations on structure-of-arrays poses; outputs may alias 
+//	inputs; orientations interpolate along the shorter arc and are 
+//	renormalized; lerp and additive kernels are vectorized over channel 
+//	streams (four nodes per step)
+
+// identity pose
+a3i32 a3hierarchyPoseSoAIdentity(const a3_HierarchyPoseSoA *pose_out);
+
+// copy pose
+a3i32 a3hierarchyPoseSoACopy(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in);
+
+// interpolate poses
+a3i32 a3hierarchyPoseSoALerp(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u);
+
+// interpolate poses with per-node weights (weight is u * mask[i]); mask 
+//	is padded to the pose stride
+a3i32 a3hierarchyPoseSoALerpMasked(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask);
+
+// interpolate poses with true spherical interpolation of orientations
+a3i32 a3hierarchyPoseSoASlerp(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3real u, const a3real *mask_opt);
+
+// compose poses: rotations multiply, scales multiply, translations add
+a3i32 a3hierarchyPoseSoAConcat(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1);
+
+// scale pose from identity
+a3i32 a3hierarchyPoseSoAScale(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3real u);
+
+// compose pose with scaled delta pose
+a3i32 a3hierarchyPoseSoAAdd(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3_HierarchyPoseSoA *delta, const a3real u);
+
+// additive layer: pose + u * (delta - reference); translation and scale 
+//	add the weighted difference, orientation applies the rotation from 
+//	reference to delta scaled by the weight
+a3i32 a3hierarchyPoseSoAAddDifference(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose_in, const a3_HierarchyPoseSoA *delta, const a3_HierarchyPoseSoA *reference, const a3real u, const a3real *mask_opt);
+
+// barycentric blend; inputs with zero weight are not read
+a3i32 a3hierarchyPoseSoATriangular(const a3_HierarchyPoseSoA *pose_out, const a3_HierarchyPoseSoA *pose0, const a3_HierarchyPoseSoA *pose1, const a3_HierarchyPoseSoA *pose2, const a3real u1, const a3real u2);
 
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_KeyframeReduction.h
+	Keyframe reduction of dense captures into per-channel keyframe tracks.
+*/
+
+#ifndef __ANIMAL3D_KEYFRAMEREDUCTION_H
+#define __ANIMAL3D_KEYFRAMEREDUCTION_H
+
+
+#include "a3_Kinematics.h"
+#include "a3_KeyframeAnimation.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef enum a3_KeyframeReductionTrack		a3_KeyframeReductionTrack;
+typedef struct a3_KeyframeReduction			a3_KeyframeReduction;
+typedef struct a3_KeyframeReductionReport	a3_KeyframeReductionReport;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// tracks of each node; track k of node i is clip (i * count + k)
+enum a3_KeyframeReductionTrack
+{
+	a3keyframeReduction_orientation,
+	a3keyframeReduction_scale,
+	a3keyframeReduction_translation,
+
+	a3keyframeReduction_trackCount,
+};
+
+
+// reduced clip: every node channel keeps only the keys needed to stay 
+//	within tolerance of the capture under linear interpolation (nlerp 
+//	for orientation, as in the pose blend kernels)
+// keys live in an ordinary keyframe pool and each track is a clip over 
+//	its run of keys, so clip controllers can play tracks directly: a 
+//	key's duration spans to the next key (variable rate; the last key 
+//	lasts one frame) and its data indexes the key's value (4 reals)
+struct a3_KeyframeReduction
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// keys of all tracks and one clip per track
+	a3_KeyframePool keyframePool[1];
+	a3_ClipPool trackPool[1];
+
+	// key values (orientation xyzw, scale or translation xyz) and start times
+	a3real *keyValue, *keyTime;
+
+	// counts
+	a3ui32 nodeCount, frameCount, keyCount;
+
+	// capture frame duration and clip duration
+	a3real frameDuration, duration;
+
+	// raw allocation (values and times point into this)
+	void *data;
+};
+
+
+// reduction summary
+struct a3_KeyframeReductionReport
+{
+	// channel samples in capture and keys kept
+	a3ui32 sourceKeyCount, keyCount;
+
+	// bytes used by capture channels (orientation, scale, translation as 
+	//	floats) and by keyframes, values and times
+	a3ui32 sourceSize, reducedSize;
+
+	// source keys / kept keys and source size / reduced size
+	a3real keyRatio, sizeRatio;
+
+	// largest object-space errors over all frames and nodes: position 
+	//	(units) and orientation (degrees)
+	a3real positionErrorMax, orientationErrorMax;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// reduce frameCount consecutive poses of a pose group starting at 
+//	firstPose; errors are budgeted in object space: each node gets a 
+//	share of the position and angle tolerances no larger than the 
+//	tolerance over the length of the longest chain through it, so the 
+//	sum down any chain stays within tolerance; orientation and scale 
+//	shares account for the furthest descendant the node moves
+a3i32 a3keyframeReductionCreate(a3_KeyframeReduction *reduction_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose, const a3ui32 frameCount, const a3real frameDuration, const a3real positionTolerance, const a3real angleTolerance_degrees);
+
+// release reduced clip
+a3i32 a3keyframeReductionRelease(a3_KeyframeReduction *reduction);
+
+// get clip of node's track
+const a3_Clip *a3keyframeReductionGetTrack(const a3_KeyframeReduction *reduction, const a3ui32 nodeIndex, const a3_KeyframeReductionTrack track);
+
+// sample every track at time into structure-of-arrays pose; cursor 
+//	holds one key index per track (node count * track count), starts at 
+//	zero and keeps each track's current key so playback steps instead 
+//	of searching; time is clamped to the clip
+a3i32 a3keyframeReductionSample(const a3_HierarchyPoseSoA *pose_out, a3ui32 *cursor, const a3_KeyframeReduction *reduction, const a3real time);
+
+// sample every track into hierarchy pose via structure-of-arrays pose
+a3i32 a3keyframeReductionSamplePose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseSoA *pose_tmp, a3ui32 *cursor, const a3_KeyframeReduction *reduction, const a3real time);
+
+// sample each capture frame and compare against source in object space
+a3i32 a3keyframeReductionReport(a3_KeyframeReductionReport *report_out, const a3_KeyframeReduction *reduction, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 firstPose);
+
+// print report to console
+a3i32 a3keyframeReductionPrintReport(const a3_KeyframeReductionReport *report, const a3byte *label);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_KeyframeReduction.inl"
+
+
+#endif	// !__ANIMAL3D_KEYFRAMEREDUCTION_H
\ No newline at end of file
@@ -28,6 +28,9 @@
 
 #include "a3_HierarchyState.h"
 
+// A3 threads
+#include "animal3D/a3utility/a3_Thread.h"
+
 
 //-----------------------------------------------------------------------------
 
@@ -35,10 +38,109 @@
 extern "C"
 {
 #else	// !__cplusplus
-
+typedef struct a3_KinematicsWorker		a3_KinematicsWorker;
+typedef struct a3_KinematicsWorkerPool	a3_KinematicsWorkerPool;
+typedef struct a3_KinematicsChain		a3_KinematicsChain;
 #endif	// __cplusplus
 
 
+//-----------------------------------------------------------------------------
+
+// worker pool limits
+enum a3_KinematicsWorkerPoolLimits
+{
+	a3kinematics_workerMax = 15,		// worker threads (excluding caller)
+	a3kinematics_serialNodeMin = 4096,	// default: smaller rigs solve serially
+	a3kinematics_levelNodeMin = 64,		// default: fewest nodes per participant in a level
+};
+
+
+// worker thread and its launch arguments
+struct a3_KinematicsWorker
+{
+	// thread descriptor
+	a3_Thread thread[1];
+
+	// owning pool and participant index (caller is participant 0)
+	a3_KinematicsWorkerPool *pool;
+	a3ui32 participant;
+
+	// semaphore this worker parks on between solves
+	void *park;
+
+	// thread running (launched with pool, joined on release)
+	a3boolean launched;
+};
+
+
+// worker pool for level-parallel forward kinematics
+// nodes are grouped by depth; each level's nodes only depend on the 
+//	previous level, so a level is split across the caller and workers, 
+//	with a barrier between levels
+// workers are launched with the pool and each parks on its own 
+//	semaphore between solves; within a solve they synchronize on per-participant progress 
+//	counters; pool must not move while its workers run
+struct a3_KinematicsWorkerPool
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// node indices sorted by depth; level i spans [levelStart[i], levelStart[i+1])
+	a3ui32 *levelNode, *levelStart;
+	a3ui32 levelCount;
+
+	// worker count, serial threshold (total nodes), minimum nodes per 
+	//	participant in a level
+	a3ui32 workerCount, serialNodeMin, levelNodeMin;
+
+	// state being solved
+	const a3_HierarchyState *state;
+
+	// raised on release so woken workers exit
+	volatile a3boolean stop;
+
+	// workers
+	a3_KinematicsWorker worker[a3kinematics_workerMax];
+
+	// levels completed by each participant (caller is 0); one per cache line
+	struct {
+		volatile a3i32 levelsDone;
+		a3byte pad[60];
+	} progress[a3kinematics_workerMax + 1];
+
+	// raw allocation
+	void *data;
+};
+
+
+// chain of nodes from a root to an end effector (each node the parent of 
+//	the next) for iterative IK; keeps the previous solution so the next 
+//	solve can start from it
+struct a3_KinematicsChain
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// node indices, root first
+	a3ui32 *nodeIndex;
+	a3ui32 nodeCount;
+
+	// working object-space positions and segment lengths
+	a3real *position, *length;
+
+	// previous solution (object-space positions) and whether it is valid
+	a3real *warmPosition;
+	a3boolean warm;
+
+	// iterations used and distance from end to target after last solve
+	a3ui32 iterations;
+	a3real error;
+
+	// raw allocation
+	void *data;
+};
+
+
 //-----------------------------------------------------------------------------
 
 // general forward kinematics: 
@@ -54,6 +156,29 @@ a3i32 a3kinematicsSolveForward(const a3_HierarchyState *hierarchyState);
 // forward kinematics solver starting at a specified joint
 a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount);
 
+// incremental forward kinematics solver: only the subtrees of nodes whose 
+//	local pose is flagged dirty are recomputed; flags are cleared
+// returns (and stores in state) the number of nodes recomputed
+a3i32 a3kinematicsSolveForwardDirty(a3_HierarchyState *hierarchyState);
+
+// initialize worker pool for hierarchy and launch its workers, which park 
+//	between solves; thresholds of zero use defaults
+a3i32 a3kinematicsWorkerPoolCreate(a3_KinematicsWorkerPool *pool_out, const a3_Hierarchy *hierarchy, const a3ui32 workerCount, const a3ui32 serialNodeMin, const a3ui32 levelNodeMin);
+
+// release worker pool; joins workers
+a3i32 a3kinematicsWorkerPoolRelease(a3_KinematicsWorkerPool *pool);
+
+// level-parallel forward kinematics solver; output is identical to the 
+//	serial solver; hierarchies below the serial threshold solve serially
+a3i32 a3kinematicsSolveForwardParallel(a3_KinematicsWorkerPool *pool, const a3_HierarchyState *hierarchyState);
+
+// batched forward kinematics solver: solves every instance in batch, 
+//	several instances per node step
+a3i32 a3kinematicsSolveForwardBatch(const a3_HierarchyStateBatch *batch);
+
+// batched forward kinematics solver starting at a specified joint
+a3i32 a3kinematicsSolveForwardBatchPartial(const a3_HierarchyStateBatch *batch, const a3ui32 firstIndex, const a3ui32 nodeCount);
+
 
 //-----------------------------------------------------------------------------
 
@@ -67,9 +192,89 @@ a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, c
 // inverse kinematics solver given an initialized hierarchy state
 a3i32 a3kinematicsSolveInverse(const a3_HierarchyState *hierarchyState);
 
-// inverse kinematics solver starting at a specified joint
+// inverse kinematics solver starting at a specified joint; each parent's 
+//	object-space inverse is computed once (stored in state) using the 
+//	cheapest inverse valid for the pose group's scale mode
 a3i32 a3kinematicsSolveInversePartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount);
 
+// batched inverse kinematics solver: solves every instance in batch; 
+//	scale mode selects the inverse
+a3i32 a3kinematicsSolveInverseBatch(const a3_HierarchyStateBatch *batch, const a3_HierarchyScaleMode scaleMode);
+
+// batched inverse kinematics solver starting at a specified joint
+a3i32 a3kinematicsSolveInverseBatchPartial(const a3_HierarchyStateBatch *batch, const a3ui32 firstIndex, const a3ui32 nodeCount, const a3_HierarchyScaleMode scaleMode);
+
+
+//-----------------------------------------------------------------------------
+
+// single-node edits shared by solvers that move nodes one at a time: 
+
+// inverse of an object-space transform, using the cheapest inverse valid 
+//	for the scale mode (as the inverse solvers do)
+a3i32 a3kinematicsTransformInverse(a3mat4 *m_out, const a3mat4 *m, const a3_HierarchyScaleMode scaleMode);
+
+// swing node about its own origin (shortest arc) so that a direct child 
+//	points at an object-space position, then update the node's local 
+//	transform from its parent's object transform; the node's object 
+//	transform must be current and its subtree is not refreshed
+// returns 1 if swung, 0 if degenerate or already aligned (unchanged)
+a3i32 a3kinematicsSwingNode(const a3_HierarchyState *hierarchyState, const a3ui32 nodeIndex, const a3ui32 childIndex, const a3real *position);
+
+
+//-----------------------------------------------------------------------------
+
+// analytic two-bone inverse kinematics: 
+// given object-space root (e.g. hip), mid (knee) and end (ankle) nodes, 
+//	rotate root and mid so that end reaches an object-space target: 
+//		mid angle from the law of cosines for the target distance, 
+//		root angle so the chain stays in its bend plane, then aim the 
+//		chain at the target and twist it about the aim so the mid node 
+//		points toward the pole (optional)
+// soft limit is the fraction of full reach over which the chain slows 
+//	down before straightening (0 clamps hard; avoids knee pop)
+// only root and mid local transforms change; the root's subtree is then 
+//	refreshed with partial forward kinematics
+// returns 1 if target is within reach, 0 if chain was stretched toward it
+
+// two-bone IK solver given an initialized hierarchy state with 
+//	up-to-date object-space pose; mid must descend from root, end from mid
+a3i32 a3kinematicsSolveTwoBone(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real *target, const a3real *pole_opt, const a3real softLimit);
+
+// batched two-bone IK solver: one target (and pole) per instance, packed 
+//	vec3; parent inverses are computed for all instances at once and the 
+//	root subtree is refreshed with batched forward kinematics
+// returns number of instances whose target was within reach
+a3i32 a3kinematicsSolveTwoBoneBatch(const a3_HierarchyStateBatch *batch, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real *target, const a3real *pole_opt, const a3real softLimit, const a3_HierarchyScaleMode scaleMode);
+
+
+//-----------------------------------------------------------------------------
+
+// iterative chain inverse kinematics: 
+// chain positions are solved so the end reaches the target, then each 
+//	chain node is rotated (swing only) onto its solved child direction; 
+//	only chain locals change and the root's subtree is refreshed
+// each solve starts from the previous solution (its shape re-anchored at 
+//	the current root with current lengths) unless the warm start is reset; 
+//	iterations stop once the end is within tolerance of the target
+// returns iterations used (also stored in chain with remaining error)
+
+// initialize chain from root to end node (end must descend from root)
+a3i32 a3kinematicsChainCreate(a3_KinematicsChain *chain_out, const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3ui32 endIndex);
+
+// release chain
+a3i32 a3kinematicsChainRelease(a3_KinematicsChain *chain);
+
+// discard previous solution (e.g. after a teleport or animation cut)
+a3i32 a3kinematicsChainResetWarmStart(a3_KinematicsChain *chain);
+
+// FABRIK: alternate passes placing the end at the target and the root 
+//	back at its origin, restoring segment lengths each pass
+a3i32 a3kinematicsSolveChainFABRIK(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real *target, const a3real tolerance, const a3ui32 iterationMax);
+
+// CCD: from the end's parent back to the root, rotate each node so the 
+//	end points at the target
+a3i32 a3kinematicsSolveChainCCD(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real *target, const a3real tolerance, const a3ui32 iterationMax);
+
 
 //-----------------------------------------------------------------------------
 
@@ -0,0 +1,141 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MorphTarget.h
+	Sparse morph target (blend shape) evaluation.
+*/
+
+#ifndef __ANIMAL3D_MORPHTARGET_H
+#define __ANIMAL3D_MORPHTARGET_H
+
+
+// SIMD flag
+#include "a3_HierarchyState.h"
+
+// A3 geometry and buffers
+#include "animal3D/a3geometry/a3_GeometryData.h"
+#include "animal3D-A3DG/a3graphics/a3_VertexBuffer.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_MorphEngine			a3_MorphEngine;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// morph limits and stream layout
+enum a3_MorphLimits
+{
+	a3morph_targetMax = 64,			// targets per engine
+	a3morph_vertexStride = 12,		// reals per vertex: position, normal, tangent as vec4
+	a3morph_vertexSize = 48,		// bytes per vertex
+};
+
+
+// morph engine: base shape plus sparse targets, evaluated into one 
+//	interleaved vertex stream allocated once
+// the stream holds position (w = 1), normal and tangent (w = 0) as vec4 
+//	per vertex, ready to upload as a vertex buffer with three attributes 
+//	at offsets 0, 16 and 32 and stride a3morph_vertexSize
+// each target stores only vertices that move: an index and a delta in 
+//	the stream layout; entries of all targets are stored back to back
+// evaluation restores the vertices touched last time from the base, 
+//	then adds the deltas of targets with non-zero weight, so cost 
+//	follows the active entries, not the vertex count
+struct a3_MorphEngine
+{
+	// base and evaluated streams (16-byte aligned)
+	a3real *base, *stream;
+
+	// entries: vertex index and delta
+	a3ui32 *entryIndex;
+	a3real *entryDelta;
+
+	// first entry of each target (entry count at end)
+	a3ui32 targetEntry[a3morph_targetMax + 1];
+
+	// lowest and highest vertex each target touches
+	a3ui32 targetFirstVertex[a3morph_targetMax], targetLastVertex[a3morph_targetMax];
+
+	// weight per target
+	a3real weight[a3morph_targetMax];
+
+	// targets applied by last evaluation
+	a3ui32 active[a3morph_targetMax];
+	a3ui32 activeCount;
+
+	// vertex range changed by last evaluation (empty if first > last)
+	a3ui32 dirtyFirst, dirtyLast;
+
+	// counts
+	a3ui32 vertexCount, targetCount, entryCount;
+
+	// normals and tangents present in base
+	a3boolean normals, tangents;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create morph engine from base geometry and targets with the same 
+//	vertex order; position is required, normals and tangents are morphed 
+//	if the base has them (a target without one contributes no delta); 
+//	vertices whose deltas are all within tolerance are left out
+a3i32 a3morphEngineCreate(a3_MorphEngine *engine_out, const a3_GeometryData *base, const a3_GeometryData *targetList, const a3ui32 targetCount, const a3real tolerance);
+
+// release morph engine
+a3i32 a3morphEngineRelease(a3_MorphEngine *engine);
+
+// set target's weight (zero disables it)
+a3i32 a3morphEngineSetWeight(a3_MorphEngine *engine, const a3ui32 targetIndex, const a3real weight);
+
+// set all weights from array of targetCount
+a3i32 a3morphEngineSetWeights(a3_MorphEngine *engine, const a3real *weightList);
+
+// evaluate stream from weights; normals and tangents of touched vertices 
+//	are renormalized; returns number of targets applied
+a3i32 a3morphEngineEvaluate(a3_MorphEngine *engine);
+
+// upload the vertices changed by the last evaluation into a buffer 
+//	holding the stream at offset; returns bytes uploaded
+a3i32 a3morphEngineUpload(const a3_MorphEngine *engine, a3_VertexBuffer *buffer, const a3ui32 offset);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_MorphTarget.inl"
+
+
+#endif	// !__ANIMAL3D_MORPHTARGET_H
\ No newline at end of file
@@ -0,0 +1,147 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_MotionMatching.h
+	Motion matching feature database and pose search.
+*/
+
+#ifndef __ANIMAL3D_MOTIONMATCHING_H
+#define __ANIMAL3D_MOTIONMATCHING_H
+
+
+#include "a3_Kinematics.h"
+#include "a3_KeyframeAnimation.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_MotionMatchingEntry		a3_MotionMatchingEntry;
+typedef struct a3_MotionMatchingTreeNode	a3_MotionMatchingTreeNode;
+typedef struct a3_MotionMatchingDatabase	a3_MotionMatchingDatabase;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// motion matching limits
+enum a3_MotionMatchingLimits
+{
+	a3motionMatching_featureNodeMax = 4,	// tracked nodes (e.g. feet)
+	a3motionMatching_trajectoryMax = 4,		// future root samples
+	a3motionMatching_dimMax = a3motionMatching_featureNodeMax * 6 + a3motionMatching_trajectoryMax * 3,
+	a3motionMatching_leafSize = 8,			// most feature rows per tree leaf
+	a3motionMatching_searchDepthMax = 64,	// tree traversal stack
+};
+
+
+// database frame: keyframe of a clip and the pose it samples
+struct a3_MotionMatchingEntry
+{
+	a3ui32 clip, keyframe, pose;
+};
+
+
+// feature tree node: inner nodes split on one dimension with children 
+//	stored next to each other; leaves own a range of feature rows
+struct a3_MotionMatchingTreeNode
+{
+	a3real split;
+	a3ui32 axis, child;
+	a3ui32 first, count;
+};
+
+
+// motion matching database
+// features per frame, in root space: position and velocity of each 
+//	feature node, then root position at each trajectory offset; each 
+//	3-vector is normalized by its mean and spread over the database
+// rows are stored in tree order, padded to the SIMD width
+struct a3_MotionMatchingDatabase
+{
+	// source data
+	const a3_HierarchyPoseGroup *poseGroup;
+	const a3_ClipPool *clipPool;
+
+	// feature layout: tracked nodes and trajectory offsets in keyframes
+	a3ui32 featureNode[a3motionMatching_featureNodeMax], featureNodeCount;
+	a3ui32 trajectoryOffset[a3motionMatching_trajectoryMax], trajectoryCount;
+	a3ui32 dim, dimStride;
+
+	// normalization: normalized = (raw - mean) * scale
+	a3real *mean, *scale;
+
+	// frames and their normalized features
+	a3_MotionMatchingEntry *entry;
+	a3real *feature;
+	a3ui32 entryCount;
+
+	// search tree
+	a3_MotionMatchingTreeNode *node;
+	a3ui32 nodeCount;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create database from every keyframe of every clip; velocity and 
+//	trajectory samples past the end of a clip wrap to its start if its 
+//	loop flag is set, otherwise hold its last keyframe (no flags: no clip 
+//	loops)
+a3i32 a3motionMatchingDatabaseCreate(a3_MotionMatchingDatabase *database_out, const a3_HierarchyPoseGroup *poseGroup, const a3_ClipPool *clipPool, const a3ui32 *featureNode, const a3ui32 featureNodeCount, const a3ui32 *trajectoryOffset, const a3ui32 trajectoryCount, const a3boolean *clipLoop_opt);
+
+// release database
+a3i32 a3motionMatchingDatabaseRelease(a3_MotionMatchingDatabase *database);
+
+// find entry for clip keyframe (linear; cache the result)
+a3i32 a3motionMatchingDatabaseGetEntryIndex(const a3_MotionMatchingDatabase *database, const a3ui32 clip, const a3ui32 keyframe);
+
+// get normalized feature row of entry
+const a3real *a3motionMatchingDatabaseGetFeature(const a3_MotionMatchingDatabase *database, const a3ui32 entryIndex);
+
+// normalize raw feature vector (may be the same array)
+a3i32 a3motionMatchingDatabaseNormalize(const a3_MotionMatchingDatabase *database, a3real *feature_out, const a3real *feature_in);
+
+// find entry nearest normalized query using the tree; returns entry index
+a3i32 a3motionMatchingQuery(const a3_MotionMatchingDatabase *database, const a3real *query, a3real *distanceSq_out_opt);
+
+// find entry nearest normalized query by testing every row; returns 
+//	entry index, for verification of tree search
+a3i32 a3motionMatchingQueryBruteForce(const a3_MotionMatchingDatabase *database, const a3real *query, a3real *distanceSq_out_opt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_MotionMatching.inl"
+
+
+#endif	// !__ANIMAL3D_MOTIONMATCHING_H
\ No newline at end of file
@@ -0,0 +1,213 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_Skinning.h
+	CPU skinning kernels.
+*/
+
+#ifndef __ANIMAL3D_SKINNING_H
+#define __ANIMAL3D_SKINNING_H
+
+
+#include "a3_HierarchyState.h"
+
+// A3 geometry and threads
+#include "animal3D/a3geometry/a3_GeometryData.h"
+#include "animal3D/a3utility/a3_Thread.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_SkinningWorker		a3_SkinningWorker;
+typedef struct a3_SkinningEngine		a3_SkinningEngine;
+typedef struct a3_SkinningWeights		a3_SkinningWeights;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// skinning limits
+enum a3_SkinningLimits
+{
+	a3skinning_influenceMax = 4,	// influences per vertex (vec4 weights, ivec4 indices)
+	a3skinning_workerMax = 15,		// worker threads (excluding caller)
+	a3skinning_shapeMax = 32,		// shapes merged by weights loader
+};
+
+
+// worker thread and its vertex range
+struct a3_SkinningWorker
+{
+	// thread descriptor
+	a3_Thread thread[1];
+
+	// owning engine and vertex range
+	a3_SkinningEngine *engine;
+	a3ui32 first, count;
+
+	// semaphore this worker parks on between deforms
+	void *park;
+
+	// deforms this worker has finished (matches engine's when idle)
+	volatile a3ui32 deformsDone;
+
+	// thread running (launched with engine, joined on release)
+	a3boolean launched;
+};
+
+
+// CPU linear blend skinning engine: deforms one geometry into output 
+//	arrays allocated once, splitting vertices evenly between caller and 
+//	workers (no dependencies between vertices)
+// workers are launched with the engine and each parks on its own 
+//	semaphore between deforms; engine must not move while its workers run
+struct a3_SkinningEngine
+{
+	// source geometry and its attributes (optional ones may be null)
+	const a3_GeometryData *geom;
+	const a3real *position, *normal, *tangent, *bitangent, *blendWeight;
+	const a3i32 *blendIndex;
+
+	// skinned attributes, same packing as source (null if source is null)
+	a3real *positionOut, *normalOut, *tangentOut, *bitangentOut;
+
+	// vertex and worker counts
+	a3ui32 vertexCount, workerCount;
+
+	// palette being applied
+	const a3real *palette;
+	a3_HierarchyPaletteLayout layout;
+
+	// deforms started
+	a3ui32 deformCount;
+
+	// raised on release so woken workers exit
+	volatile a3boolean stop;
+
+	// workers
+	a3_SkinningWorker worker[a3skinning_workerMax];
+
+	// raw allocation (outputs point into this)
+	void *data;
+};
+
+
+// per-point skin weights loaded from file: strongest influences of each 
+//	point; weights and indices are stored back to back in the 
+//	a3_GeometryData blending layout (vec4 weights for all points, then 
+//	ivec4 indices), so both can be copied into a geometry in one go
+struct a3_SkinningWeights
+{
+	// blend weights and indices
+	a3real *blendWeight;
+	a3i32 *blendIndex;
+
+	// bind shape point positions (packed vec3), used to match vertices
+	a3real *position;
+
+	// points (all shapes), influence lists read, influences dropped
+	a3ui32 pointCount, influenceCount, droppedCount;
+
+	// raw allocation (arrays point into this)
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// vertex data follows the a3_GeometryData blending layout: positions and 
+//	normals are packed vec3, weights vec4 and indices ivec4 per vertex; 
+//	unused influences have zero weight
+
+// blend dual quaternion palette entries for one vertex (DLB): sum of 
+//	weighted entries, each sign-corrected to the first, then normalized
+a3i32 a3skinningBlendDualQuat(a3real *Q_out, const a3real *palette, const a3real *blendWeight, const a3i32 *blendIndex);
+
+// dual quaternion skinning: blend each vertex's palette entries and apply 
+//	rigid transform to position and (optional) normal; palette is in the 
+//	dual quaternion layout (a3hierarchyPalette_dualquat)
+a3i32 a3skinningDeformDualQuat(a3real *position_out, a3real *normal_out_opt, const a3real *position, const a3real *normal_opt, const a3real *blendWeight, const a3i32 *blendIndex, const a3ui32 vertexCount, const a3real *palette);
+
+
+//-----------------------------------------------------------------------------
+
+// initialize skinning engine for geometry with blending attributes; 
+//	positions, normals, tangents and bitangents present are skinned; 
+//	workers are launched here and wait for the first deform
+a3i32 a3skinningEngineCreate(a3_SkinningEngine *engine_out, const a3_GeometryData *geom, const a3ui32 workerCount);
+
+// release skinning engine; joins workers
+a3i32 a3skinningEngineRelease(a3_SkinningEngine *engine);
+
+// linear blend skinning of a vertex range on the calling thread; palette 
+//	in mat4 or mat3x4 layout; normals and tangents are renormalized
+a3i32 a3skinningEngineDeformRange(const a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout, const a3ui32 firstVertex, const a3ui32 vertexCount);
+
+// linear blend skinning of all vertices, split across caller and workers
+a3i32 a3skinningEngineDeform(a3_SkinningEngine *engine, const a3real *palette, const a3_HierarchyPaletteLayout layout);
+
+
+//-----------------------------------------------------------------------------
+
+// create empty skin weights for points (all influences on node 0)
+a3i32 a3skinningWeightsCreate(a3_SkinningWeights *weights_out, const a3ui32 pointCount);
+
+// release skin weights
+a3i32 a3skinningWeightsRelease(a3_SkinningWeights *weights);
+
+// merge influence into point's list: adds to an existing entry for node, 
+//	otherwise keeps the strongest a3skinning_influenceMax, sorted
+a3i32 a3skinningWeightsAddInfluence(a3_SkinningWeights *weights, const a3ui32 pointIndex, const a3i32 nodeIndex, const a3real weight);
+
+// renormalize each point's influences to sum to one; points without 
+//	influences are bound fully to node 0
+a3i32 a3skinningWeightsNormalize(a3_SkinningWeights *weights);
+
+// load Maya deformerWeight XML (skinCluster export) in one pass over the 
+//	file contents; shapes are concatenated in file order and each weights 
+//	list is merged into its shape's points; influence 'source' names are 
+//	matched to hierarchy nodes (unknown names skipped), or the 'layer' 
+//	index is used if no hierarchy is given; weights are renormalized
+a3i32 a3skinningWeightsLoadDeformerWeight(a3_SkinningWeights *weights_out, const a3_Hierarchy *hierarchy_opt, const a3byte *filePath);
+
+// store weights for vertices in another order (e.g. geometry with split 
+//	vertices) by matching positions to bind shape points, optionally 
+//	transformed first (same transform as the model loader); unmatched 
+//	vertices are bound fully to node 0; returns number matched
+a3i32 a3skinningWeightsStoreMatched(a3real *blendWeight_out, a3i32 *blendIndex_out, const a3_SkinningWeights *weights, const a3real *position, const a3ui32 vertexCount, const a3real *transform_opt, const a3real tolerance);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_Skinning.inl"
+
+
+#endif	// !__ANIMAL3D_SKINNING_H
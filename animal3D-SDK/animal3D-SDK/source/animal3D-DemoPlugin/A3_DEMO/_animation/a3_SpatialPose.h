@@ -37,6 +37,7 @@ extern "C"
 {
 #else	// !__cplusplus
 typedef enum a3_SpatialPoseChannel		a3_SpatialPoseChannel;
+typedef enum a3_SpatialPoseEulerOrder	a3_SpatialPoseEulerOrder;
 typedef struct a3_SpatialPose			a3_SpatialPose;
 #endif	// __cplusplus
 	
@@ -49,20 +50,76 @@ enum a3_SpatialPoseChannel
 {
 	// identity
 	a3poseChannel_none,					// no channels
+
+	// orientation
+	a3poseChannel_orient_x = 0x0001,	// rotation about x axis
+	a3poseChannel_orient_y = 0x0002,	// rotation about y axis
+	a3poseChannel_orient_z = 0x0004,	// rotation about z axis
+	a3poseChannel_orient_xyz = 0x0007,	// rotation about all axes
+
+	// scale
+	a3poseChannel_scale_x = 0x0010,		// scale along x axis
+	a3poseChannel_scale_y = 0x0020,		// scale along y axis
+	a3poseChannel_scale_z = 0x0040,		// scale along z axis
+	a3poseChannel_scale_xyz = 0x0070,	// scale along all axes
+
+	// translation
+	a3poseChannel_translate_x = 0x0100,		// translation along x axis
+	a3poseChannel_translate_y = 0x0200,		// translation along y axis
+	a3poseChannel_translate_z = 0x0400,		// translation along z axis
+	a3poseChannel_translate_xyz = 0x0700,	// translation along all axes
+};
+
+
+// order in which Euler angles are concatenated
+enum a3_SpatialPoseEulerOrder
+{
+	a3poseEulerOrder_xyz,				// rotate about x, then y, then z
+	a3poseEulerOrder_zyx,				// rotate about z, then y, then x
 };
 
 	
 //-----------------------------------------------------------------------------
 
 // single pose for a single node
+//	transform is the matrix form of the channels below; convert after 
+//	changing channels, restore after changing the matrix
 struct a3_SpatialPose
 {
+	// matrix form of pose
 	a3mat4 transform;
+
+	// orientation as unit quaternion (xyz imaginary, w real)
+	a3vec4 orientation;
+
+	// scale (xyz); w unused
+	a3vec4 scale;
+
+	// translation (xyz); w unused
+	a3vec4 translation;
 };
 
 
 //-----------------------------------------------------------------------------
 
+// reset single node pose to identity
+a3i32 a3spatialPoseReset(a3_SpatialPose *spatialPose);
+
+// set rotation of pose from Euler angles in degrees
+a3i32 a3spatialPoseSetRotation(a3_SpatialPose *spatialPose, const a3real rx_degrees, const a3real ry_degrees, const a3real rz_degrees, const a3_SpatialPoseEulerOrder order);
+
+// set scale of pose
+a3i32 a3spatialPoseSetScale(a3_SpatialPose *spatialPose, const a3real sx, const a3real sy, const a3real sz);
+
+// set translation of pose
+a3i32 a3spatialPoseSetTranslation(a3_SpatialPose *spatialPose, const a3real tx, const a3real ty, const a3real tz);
+
+// copy single node pose
+a3i32 a3spatialPoseCopy(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_in);
+
+// convert single node pose channels to matrix: transform = T * R * S
+a3i32 a3spatialPoseConvert(a3_SpatialPose *spatialPose);
+
 
 
 //-----------------------------------------------------------------------------
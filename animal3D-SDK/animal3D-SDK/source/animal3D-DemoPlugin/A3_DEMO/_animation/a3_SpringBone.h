@@ -0,0 +1,156 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpringBone.h
+	Verlet spring bones for procedural secondary motion.
+*/
+
+#ifndef __ANIMAL3D_SPRINGBONE_H
+#define __ANIMAL3D_SPRINGBONE_H
+
+
+#include "a3_Kinematics.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_SpringBoneSystem	a3_SpringBoneSystem;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// spring bone limits
+enum a3_SpringBoneLimits
+{
+	a3springBone_substepMax = 16,	// most integration substeps per update
+	a3springBone_levelMax = 64,		// longest chain (nodes below root)
+};
+
+
+// spring bone system: every chain of every instance, simulated together
+// each chain runs from a root (animated, rotated but not moved) to an end; 
+//	every node below the root is a particle simulated in object space 
+//	and pulled toward where the animation puts it relative to its parent
+// particles are grouped by depth below their chain root; a level only 
+//	depends on the previous one (its parents), so levels are padded to 
+//	the SIMD width and integrated several springs per step
+// streams are structure-of-arrays: x, y and z each span the padded count
+struct a3_SpringBoneSystem
+{
+	// pointer to hierarchy
+	const a3_Hierarchy *hierarchy;
+
+	// chain root and end nodes
+	a3ui32 *chainRoot, *chainEnd;
+	a3ui32 chainCount, instanceCount;
+
+	// level i spans [levelStart[i], levelStart[i] + levelCount[i]); 
+	//	each start is a multiple of the SIMD width
+	a3ui32 levelStart[a3springBone_levelMax + 1], levelCount[a3springBone_levelMax];
+	a3ui32 levels, springCount, springStride;
+
+	// per spring: tip node, owning instance and chain, parent spring 
+	//	(negative if parent is the chain root)
+	a3ui32 *node, *instance, *chain;
+	a3i32 *parent;
+
+	// simulated tip position and its previous position
+	a3real *position, *previous;
+
+	// animated tip and parent positions, this update and last
+	a3real *tip, *tipPrev, *base, *basePrev;
+
+	// parent position at current substep (gathered)
+	a3real *anchor;
+
+	// per spring: stiffness (1/s^2), damping (per second), rest length
+	a3real *stiffness, *damping, *length;
+
+	// object-space gravity
+	a3vec3 gravity;
+
+	// fixed substeps per update; state valid (false after reset)
+	a3ui32 substepCount;
+	a3boolean initialized;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// Verlet spring bones: 
+// each update reads animated object-space positions from every 
+//	instance's state (forward kinematics must be done), then integrates 
+//	all particles, level by level, for a fixed number of substeps: 
+//		velocity = (position - previous) * (1 - damping * h)
+//		position += velocity + (stiffness * (goal - position) + gravity) * h^2
+//	where goal is the parent particle plus the animated parent-to-tip 
+//	offset; animated positions are interpolated across substeps
+// after each step a particle is put back at its rest (animated) length 
+//	from its parent
+// results are written back with partial IK: root first, each chain node 
+//	swings about itself so its child lands on the particle; new local = 
+//	inverse parent * swung object; then each chain root's subtree is 
+//	refreshed with partial forward kinematics
+// stiffness and damping steps are clamped to 1 so large time steps stay 
+//	stable; cost is bounded by spring count times substep count
+
+// create system for chains (root to end, end must descend from root) on 
+//	every instance of hierarchy; no chain root may be an ancestor of 
+//	another chain root
+a3i32 a3springBoneSystemCreate(a3_SpringBoneSystem *system_out, const a3_Hierarchy *hierarchy, const a3ui32 *chainRoot, const a3ui32 *chainEnd, const a3ui32 chainCount, const a3ui32 instanceCount, const a3ui32 substepCount);
+
+// release system
+a3i32 a3springBoneSystemRelease(a3_SpringBoneSystem *system);
+
+// set stiffness and damping of chain on every instance
+a3i32 a3springBoneSystemSetChain(a3_SpringBoneSystem *system, const a3ui32 chainIndex, const a3real stiffness, const a3real damping);
+
+// set object-space gravity
+a3i32 a3springBoneSystemSetGravity(a3_SpringBoneSystem *system, const a3real *gravity);
+
+// discard simulation state; next update starts at the animated pose 
+//	(e.g. after a teleport or animation cut)
+a3i32 a3springBoneSystemReset(a3_SpringBoneSystem *system);
+
+// simulate and write back to one state per instance (object-space poses 
+//	up to date); returns number of springs simulated
+a3i32 a3springBoneSystemUpdate(a3_SpringBoneSystem *system, const a3_HierarchyState *stateArray, const a3real dt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_SpringBone.inl"
+
+
+#endif	// !__ANIMAL3D_SPRINGBONE_H
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+	Copyright 2011-2020 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_SpriteAnimation.h
+	Batched sprite-sheet animation driving texture atlas cells.
+*/
+
+#ifndef __ANIMAL3D_SPRITEANIMATION_H
+#define __ANIMAL3D_SPRITEANIMATION_H
+
+
+#include "a3_KeyframeAnimationController.h"
+
+// A3 graphics
+#include "animal3D-A3DG/a3graphics/a3_TextureAtlas.h"
+#include "animal3D-A3DG/a3graphics/a3_UniformBuffer.h"
+#include "animal3D-A3DG/a3graphics/a3_VertexDrawable.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+typedef struct a3_SpriteAnimationBatch	a3_SpriteAnimationBatch;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+// sprite animation limits
+enum a3_SpriteAnimationLimits
+{
+	a3sprite_instanceSize = 16,			// bytes per instance: one vec4
+	a3sprite_instanceBlockMax = 4096,	// instances per draw (64 KiB uniform block)
+};
+
+
+// batch of sprite controllers sharing a clip pool and texture atlas
+// clips are sequences of keyframes whose data is an atlas cell index; 
+//	playback loops, and a negative rate plays in reverse
+// controllers are stored as structure-of-arrays; each sprite's atlas 
+//	rect is kept in an instance buffer laid out for a std140 block: 
+//		uniform ubSprite { vec4 uSpriteRect[N]; };
+//	with xy = cell relative offset and zw = cell relative size, indexed 
+//	by gl_InstanceID (see passTexcoord_transform_instanced_vs4x.glsl)
+struct a3_SpriteAnimationBatch
+{
+	// clips and the cells they show
+	const a3_ClipPool *clipPool;
+	const a3_TextureAtlas *atlas;
+
+	// controllers: clip, current keyframe, time in keyframe, rate
+	a3ui32 *clip, *keyframe;
+	a3real *keyframeTime, *rate;
+
+	// atlas rect per sprite
+	a3real *instance;
+
+	// sprites in use and capacity
+	a3ui32 spriteCount, spriteMax;
+
+	// raw allocation
+	void *data;
+};
+
+
+//-----------------------------------------------------------------------------
+
+// create sprite batch
+a3i32 a3spriteAnimationBatchCreate(a3_SpriteAnimationBatch *batch_out, const a3_ClipPool *clipPool, const a3_TextureAtlas *atlas, const a3ui32 spriteMax);
+
+// release sprite batch
+a3i32 a3spriteAnimationBatchRelease(a3_SpriteAnimationBatch *batch);
+
+// add sprite playing clip from the start; returns sprite index
+a3i32 a3spriteAnimationBatchAdd(a3_SpriteAnimationBatch *batch, const a3ui32 clipIndex, const a3real rate);
+
+// set sprite's clip, playing from the start
+a3i32 a3spriteAnimationBatchSetClip(a3_SpriteAnimationBatch *batch, const a3ui32 spriteIndex, const a3ui32 clipIndex);
+
+// set sprite's playback rate (1 is forward, -1 reverse, 0 paused)
+a3i32 a3spriteAnimationBatchSetRate(a3_SpriteAnimationBatch *batch, const a3ui32 spriteIndex, const a3real rate);
+
+// advance every sprite and refresh the rects of those whose cell 
+//	changed; returns number of sprites that changed cell
+a3i32 a3spriteAnimationBatchUpdate(a3_SpriteAnimationBatch *batch, const a3real dt);
+
+// draw all sprites with the active program and drawable: instances are 
+//	uploaded to the uniform buffer a block at a time and each block is 
+//	one instanced draw; blockSize is instances per block, no more than 
+//	a3sprite_instanceBlockMax and the buffer size; the batch index of 
+//	each block's first sprite is sent to unifFirstLocation (-1 to skip); 
+//	returns draws issued
+a3i32 a3spriteAnimationBatchRender(const a3_SpriteAnimationBatch *batch, a3_UniformBuffer *instanceBuffer, const a3ui32 unifBlockBinding, const a3ui32 blockSize, const a3i32 unifFirstLocation);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#include "_inl/a3_SpriteAnimation.inl"
+
+
+#endif	// !__ANIMAL3D_SPRITEANIMATION_H
\ No newline at end of file
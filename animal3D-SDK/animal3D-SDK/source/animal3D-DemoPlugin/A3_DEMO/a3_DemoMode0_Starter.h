@@ -36,6 +36,8 @@
 
 #include "A3_DEMO/_animation/a3_KeyframeAnimation.h"
 #include "A3_DEMO/_animation/a3_KeyframeAnimationController.h"
+#include "A3_DEMO/_animation/a3_SpriteAnimation.h"
+#include "A3_DEMO/_animation/a3_AnimationBake.h"
 
 
 //-----------------------------------------------------------------------------
@@ -63,6 +65,11 @@ typedef enum a3_DemoMode0_Starter_TargetName				a3_DemoMode0_Starter_TargetName;
 		starterMaxCount_cameraObject = 1,
 		starterMaxCount_projector = 1,
 		starterMaxCount_clipController = 3,
+		starterMaxCount_sprite = 64,
+		starterMaxCount_spriteClip = 4,
+		starterMaxCount_bakeInstance = 64,
+		starterMaxCount_bakeClip = 3,
+		starterMaxCount_bakeNode = 128,
 	};
 
 	// scene object rendering program names
@@ -70,6 +77,8 @@ typedef enum a3_DemoMode0_Starter_TargetName				a3_DemoMode0_Starter_TargetName;
 	{
 		starter_renderSolid,			// solid color
 		starter_renderTexture,			// textured
+		starter_renderSprites,			// animated sprite batch
+		starter_renderBakedCrowd,		// skinned crowd from baked palettes
 
 		starter_render_max
 	};
@@ -162,6 +171,29 @@ typedef enum a3_DemoMode0_Starter_TargetName				a3_DemoMode0_Starter_TargetName;
 			};
 		};
 
+		// sprite animation: sheet cells, clips of cells and the batch 
+		//	playing them, drawn through the sprite uniform buffer
+		a3_TextureAtlas atlas_sprite[1];
+		a3_KeyframePool keyframePool_sprite[1];
+		a3_ClipPool clipPool_sprite[1];
+		a3_SpriteAnimationBatch spriteBatch[1];
+		a3_UniformBuffer ubo_sprite[1];
+
+		// baked crowd: character clips baked to palettes once, instances 
+		//	advancing only (clip, time), skinned by the program from the 
+		//	palette texture and clip table
+		a3_Hierarchy hierarchy_bake[1];
+		a3_HierarchyPoseGroup poseGroup_bake[1];
+		a3_KeyframePool keyframePool_bake[1];
+		a3_ClipPool clipPool_bake[1];
+		a3_AnimationBake bake[1];
+		a3_AnimationBakeInstance bakeInstance[starterMaxCount_bakeInstance];
+		a3_Texture tex_bakePalette[1];
+		a3_UniformBuffer ubo_bakeInstance[1], ubo_bakeClip[1];
+		a3_VertexDrawable draw_bakeSkin[1];
+		a3_VertexArrayDescriptor vao_bakeSkin[1];
+		a3_VertexBuffer vbo_bakeSkin[1];
+
 		/*union {
 			a3_ClipController clipController[starterMaxCount_clipController];
 			struct {
@@ -61,6 +61,8 @@ void a3starter_render_controls(a3_DemoState const* demoState, a3_DemoMode0_Start
 	a3byte const* renderProgramName[starter_render_max] = {
 		"Solid color",
 		"Texture",
+		"Sprite batch",
+		"Baked crowd",
 	};
 
 	// forward display names
@@ -179,6 +181,20 @@ void a3starter_render(a3_DemoState const* demoState, a3_DemoMode0_Starter const*
 		* const grey = grey4[0].v, * const grey_t = grey4[1].v;
 	const a3ui32 hueCount = sizeof(rgba4) / sizeof(*rgba4);
 
+	// sprites per row in sprite batch mode
+	const a3i32 spriteColumns = 8;
+
+	// characters per row in baked crowd mode, and their placement: 
+	//	skeleton is Y-up in its own units, so turn it Z-up, scale it 
+	//	down and stand it on the plane
+	const a3i32 bakeColumns = 8;
+	const a3mat4 bakeModelMat = {
+		0.02f,  0.00f, 0.00f, 0.00f,
+		0.00f,  0.00f, 0.02f, 0.00f,
+		0.00f, -0.02f, 0.00f, 0.00f,
+		0.00f,  0.00f, -2.0f, 1.00f,
+	};
+
 	// camera used for drawing
 	const a3_DemoProjector* activeCamera = demoMode->projector + demoMode->activeCamera;
 	const a3_DemoSceneObject* activeCameraObject = activeCamera->sceneObject;
@@ -215,6 +231,8 @@ void a3starter_render(a3_DemoState const* demoState, a3_DemoMode0_Starter const*
 		{
 			demoState->prog_drawColorUnif,
 			demoState->prog_drawTexture,
+			demoState->prog_drawSprite_instanced,
+			demoState->prog_drawBakedSkin_instanced,
 		},
 	};
 
@@ -367,6 +385,36 @@ void a3starter_render(a3_DemoState const* demoState, a3_DemoMode0_Starter const*
 				a3vertexDrawableActivateAndRender(currentDrawable);
 			}
 			break;
+		case starter_renderSprites:
+			// whole batch shares one transform; the program lays sprites 
+			//	out in rows, reading each one's atlas rect from its block
+			a3textureActivate(demoMode->atlas_sprite->texture, a3tex_unit00);
+			a3shaderUniformSendFloatMat(a3unif_mat4, 0, currentDemoProgram->uMVP, 1, viewProjectionMat.mm);
+			a3shaderUniformSendFloat(a3unif_vec4, currentDemoProgram->uColor, 1, a3vec4_one.v);
+			a3shaderUniformSendInt(a3unif_single, currentDemoProgram->uCount, 1, &spriteColumns);
+			a3vertexDrawableActivate(demoState->draw_unit_plane_z);
+			// instance buffer contents are per-draw scratch
+			a3spriteAnimationBatchRender(demoMode->spriteBatch, (a3_UniformBuffer*)demoMode->ubo_sprite,
+				demoProg_blockSprite, a3sprite_instanceBlockMax, currentDemoProgram->uIndex);
+			break;
+		case starter_renderBakedCrowd:
+			// whole crowd shares one transform; the program finds each 
+			//	character's palette row from its (clip, time) and the 
+			//	clip table, and skins from the palette texture
+			if (!demoMode->draw_bakeSkin->vertexArray)
+				break;
+			a3real4x4Product(modelViewProjectionMat.m, viewProjectionMat.m, bakeModelMat.m);
+			a3real4x4Product(modelViewMat.m, activeCameraObject->modelMatInv.m, bakeModelMat.m);
+			a3shaderUniformSendFloatMat(a3unif_mat4, 0, currentDemoProgram->uMVP, 1, modelViewProjectionMat.mm);
+			a3shaderUniformSendFloatMat(a3unif_mat4, 0, currentDemoProgram->uMV_nrm, 1, modelViewMat.mm);
+			a3shaderUniformSendFloat(a3unif_vec4, currentDemoProgram->uColor, 1, aqua);
+			a3shaderUniformSendInt(a3unif_single, currentDemoProgram->uCount, 1, &bakeColumns);
+			a3textureActivate(demoMode->tex_bakePalette, a3tex_unit00);
+			a3shaderUniformBufferActivate(demoMode->ubo_bakeClip, demoProg_blockBakeClip);
+			a3vertexDrawableActivate(demoMode->draw_bakeSkin);
+			a3animationBakeRender(demoMode->bake, demoMode->bakeInstance, starterMaxCount_bakeInstance, (a3_UniformBuffer*)demoMode->ubo_bakeInstance,
+				demoProg_blockBakeInstance, a3animationBake_instanceBlockMax, currentDemoProgram->uIndex);
+			break;
 		}
 
 	}	break;
@@ -89,6 +89,13 @@ void a3starter_update(a3_DemoState* demoState, a3_DemoMode0_Starter* demoMode, a
 			demoMode->object_scene[i].modelMat.m, a3mat4_identity.m);
 	}
 
+	// advance sprite animation and baked crowd
+	if (demoState->updateAnimation)
+	{
+		a3spriteAnimationBatchUpdate(demoMode->spriteBatch, (a3real)dt);
+		a3animationBakeUpdateInstances(demoMode->bake, demoMode->bakeInstance, starterMaxCount_bakeInstance, (a3real)dt);
+	}
+
 	//a3clipControllerUpdate(activeClipController, dt);
 }
 
@@ -43,6 +43,8 @@ void a3starter_input_keyCharHold(a3_DemoState const* demoState, a3_DemoMode0_Sta
 
 void a3starter_loadValidate(a3_DemoState* demoState, a3_DemoMode0_Starter* demoMode)
 {
+	a3ui32 i;
+
 	// initialize callbacks
 	a3_DemoModeCallbacks* const callbacks = demoState->demoModeCallbacks + demoState_modeStarter;
 	callbacks->demoMode = demoMode;
@@ -58,6 +60,40 @@ void a3starter_loadValidate(a3_DemoState* demoState, a3_DemoMode0_Starter* demoM
 	a3demo_setProjectorSceneObject(demoMode->proj_camera_main, demoMode->obj_camera_main);
 
 	// initialize cameras not dependent on viewport
+
+	// re-link sprite animation pointers in case demo state address changed
+	if (demoMode->atlas_sprite->texture)
+		demoMode->atlas_sprite->texture = demoState->tex_testsprite;
+	for (i = 0; demoMode->clipPool_sprite->clip && i < demoMode->clipPool_sprite->count; ++i)
+		demoMode->clipPool_sprite->clip[i].keyframe_pool = demoMode->keyframePool_sprite;
+	if (demoMode->spriteBatch->data)
+	{
+		demoMode->spriteBatch->clipPool = demoMode->clipPool_sprite;
+		demoMode->spriteBatch->atlas = demoMode->atlas_sprite;
+	}
+
+	// same for baked crowd
+	if (demoMode->poseGroup_bake->hierarchy)
+		demoMode->poseGroup_bake->hierarchy = demoMode->hierarchy_bake;
+	if (demoMode->bake->data)
+		demoMode->bake->hierarchy = demoMode->hierarchy_bake;
+	for (i = 0; demoMode->clipPool_bake->clip && i < demoMode->clipPool_bake->count; ++i)
+		demoMode->clipPool_bake->clip[i].keyframe_pool = demoMode->keyframePool_bake;
+	if (demoMode->draw_bakeSkin->vertexArray)
+	{
+		demoMode->vao_bakeSkin->vertexBuffer = demoMode->vbo_bakeSkin;
+		demoMode->draw_bakeSkin->vertexArray = demoMode->vao_bakeSkin;
+		if (demoMode->draw_bakeSkin->indexType)
+			demoMode->draw_bakeSkin->indexBuffer = demoMode->vbo_bakeSkin;
+	}
+
+	// release callbacks of graphics objects owned by this mode
+	a3bufferHandleUpdateReleaseCallback(demoMode->ubo_sprite);
+	a3bufferHandleUpdateReleaseCallback(demoMode->ubo_bakeInstance);
+	a3bufferHandleUpdateReleaseCallback(demoMode->ubo_bakeClip);
+	a3bufferHandleUpdateReleaseCallback(demoMode->vbo_bakeSkin);
+	a3vertexArrayHandleUpdateReleaseCallback(demoMode->vao_bakeSkin);
+	a3textureHandleUpdateReleaseCallback(demoMode->tex_bakePalette);
 }
 
 
@@ -68,6 +104,8 @@ void a3starter_load(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMod
 	a3_DemoSceneObject* currentSceneObject;
 	a3_DemoProjector* projector;
 
+	a3_Clip* currentClip;
+
 	//a3_ClipController* currentClipController;
 
 
@@ -87,6 +125,37 @@ void a3starter_load(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMod
 	const a3f32 sceneObjectDistance = 8.0f;
 	const a3f32 sceneObjectHeight = 2.0f;
 
+	// sprite sheet is 8x8 cells; each clip plays two rows
+	const a3ui32 spriteSheetColumns = 8, spriteSheetRows = 8;
+	const a3ui32 spriteClipLength = spriteSheetColumns * spriteSheetRows / starterMaxCount_spriteClip;
+	const a3real spriteKeyframeDuration = 1.0f / 12.0f;
+	const a3byte* spriteClipName[starterMaxCount_spriteClip] = {
+		"sprite0", "sprite1", "sprite2", "sprite3",
+	};
+
+	// baked crowd: character clips (first and last pose, duration) from 
+	//	the clip file, baked at a fixed rate; the mesh is modelled at a 
+	//	tenth of the skeleton's scale
+	const a3byte* bakeClipName[starterMaxCount_bakeClip] = {
+		"calibration", "idle", "dance",
+	};
+	const a3ui32 bakeClipFrame[starterMaxCount_bakeClip][2] = {
+		{ 1, 27 }, { 28, 52 }, { 54, 78 },
+	};
+	const a3real bakeClipDuration[starterMaxCount_bakeClip] = {
+		1.0f, 4.0f, 1.5f,
+	};
+	const a3real bakeFrameRate = 30.0f;
+	const a3mat4 bakeMeshUpscale10x = {
+		10.0f,  0.0f,  0.0f, 0.0f,
+		 0.0f, 10.0f,  0.0f, 0.0f,
+		 0.0f,  0.0f, 10.0f, 0.0f,
+		 0.0f,  0.0f,  0.0f, 1.0f,
+	};
+	const a3byte* bakeNodeName[starterMaxCount_bakeNode];
+	a3_HierarchyState bakeState[1] = { 0 };
+	a3_GeometryData bakeMesh[1] = { 0 };
+
 
 	// all objects
 	for (i = 0; i < starterMaxCount_sceneObject; ++i)
@@ -154,6 +223,81 @@ void a3starter_load(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMod
 	projector->sceneObject->euler = sceneCameraStartEuler;
 
 
+	// set up sprite animation: one keyframe per sheet cell, clips of 
+	//	consecutive cells, sprites cycling through clips and directions
+	a3textureAtlasSetTexture(demoMode->atlas_sprite, (a3_Texture*)demoState->tex_testsprite);
+	a3textureAtlasAllocateEvenCells(demoMode->atlas_sprite, spriteSheetColumns, spriteSheetRows);
+	a3keyframePoolCreate(demoMode->keyframePool_sprite, demoMode->atlas_sprite->numCells);
+	for (i = 0; i < demoMode->keyframePool_sprite->count; ++i)
+	{
+		demoMode->keyframePool_sprite->keyframe[i].index = i;
+		a3keyframeInit(demoMode->keyframePool_sprite->keyframe + i, spriteKeyframeDuration, i);
+	}
+	a3clipPoolCreate(demoMode->clipPool_sprite, starterMaxCount_spriteClip);
+	for (i = 0; i < demoMode->clipPool_sprite->count; ++i)
+	{
+		currentClip = demoMode->clipPool_sprite->clip + i;
+		a3clipInit(currentClip, spriteClipName[i], demoMode->keyframePool_sprite, i * spriteClipLength, i * spriteClipLength + spriteClipLength - 1);
+		currentClip->index = i;
+		a3clipCalculateDuration(currentClip);
+	}
+	a3spriteAnimationBatchCreate(demoMode->spriteBatch, demoMode->clipPool_sprite, demoMode->atlas_sprite, starterMaxCount_sprite);
+	for (i = 0; i < starterMaxCount_sprite; ++i)
+		a3spriteAnimationBatchAdd(demoMode->spriteBatch, i % starterMaxCount_spriteClip, (i / starterMaxCount_spriteClip) % 2 ? -a3real_one : a3real_one);
+	a3bufferCreate(demoMode->ubo_sprite, "ubo:sprite", a3buffer_uniform, a3sprite_instanceBlockMax * a3sprite_instanceSize, 0);
+
+
+	// set up baked crowd: one keyframe per pose, clips over pose ranges, 
+	//	baked with the inverse of the base pose (pose 0) as bind pose
+	if (a3hierarchyPoseGroupLoadHTR(demoMode->poseGroup_bake, demoMode->hierarchy_bake,
+		"../../../../resource/animdata/egnaro/egnaro_skel_anim.htr") > 0
+		&& demoMode->hierarchy_bake->numNodes <= starterMaxCount_bakeNode)
+	{
+		a3keyframePoolCreate(demoMode->keyframePool_bake, demoMode->poseGroup_bake->hposeCount);
+		for (i = 0; i < demoMode->keyframePool_bake->count; ++i)
+		{
+			demoMode->keyframePool_bake->keyframe[i].index = i;
+			a3keyframeInit(demoMode->keyframePool_bake->keyframe + i, a3real_one / bakeFrameRate, i);
+		}
+		a3clipPoolCreate(demoMode->clipPool_bake, starterMaxCount_bakeClip);
+		for (i = 0; i < demoMode->clipPool_bake->count; ++i)
+		{
+			currentClip = demoMode->clipPool_bake->clip + i;
+			a3clipInit(currentClip, bakeClipName[i], demoMode->keyframePool_bake, bakeClipFrame[i][0], bakeClipFrame[i][1]);
+			currentClip->index = i;
+			a3clipDistributeDuration(currentClip, bakeClipDuration[i]);
+		}
+
+		a3hierarchyStateCreate(bakeState, demoMode->poseGroup_bake);
+		a3hierarchyPoseCopy(bakeState->localHPose, demoMode->poseGroup_bake->hpose, demoMode->hierarchy_bake->numNodes);
+		a3hierarchyPoseConvert(bakeState->localHPose, demoMode->hierarchy_bake->numNodes);
+		a3kinematicsSolveForward(bakeState);
+		a3hierarchyStateUpdateObjectInverse(bakeState, a3true);
+		a3animationBakeCreate(demoMode->bake, demoMode->poseGroup_bake, demoMode->clipPool_bake, 0, starterMaxCount_bakeClip, bakeFrameRate, bakeState->objectSpaceInverse);
+		a3hierarchyStateRelease(bakeState);
+
+		a3animationBakeCreateTexture(demoMode->bake, demoMode->tex_bakePalette, "tex:bake-palette");
+		a3bufferCreate(demoMode->ubo_bakeClip, "ubo:bake-clip", a3buffer_uniform, a3animationBake_clipMax * a3animationBake_clipSize, 0);
+		a3animationBakeUploadClipTable(demoMode->bake, demoMode->ubo_bakeClip);
+		a3bufferCreate(demoMode->ubo_bakeInstance, "ubo:bake-inst", a3buffer_uniform, a3animationBake_instanceBlockMax * a3animationBake_instanceSize, 0);
+		for (i = 0; i < starterMaxCount_bakeInstance; ++i)
+		{
+			demoMode->bakeInstance[i].clip = i % starterMaxCount_bakeClip;
+			demoMode->bakeInstance[i].time = (a3real)i * 0.37f;
+		}
+
+		// skin weights name their influences by node
+		for (i = 0; i < demoMode->hierarchy_bake->numNodes; ++i)
+			bakeNodeName[i] = demoMode->hierarchy_bake->nodes[i].name;
+		if (a3modelLoadOBJSkinWeights(bakeMesh, "../../../../resource/obj/egnaro/egnaro_mesh.obj", a3model_calculateVertexNormals,
+			"../../../../resource/obj/egnaro/egnaro_skin.xml", bakeNodeName, demoMode->hierarchy_bake->numNodes, bakeMeshUpscale10x.mm) > 0)
+		{
+			a3geometryGenerateDrawableSelfContained(demoMode->draw_bakeSkin, demoMode->vao_bakeSkin, demoMode->vbo_bakeSkin, bakeMesh);
+			a3geometryReleaseData(bakeMesh);
+		}
+	}
+
+
 	// set flags
 	demoMode->render = starter_renderTexture;
 	demoMode->display = starter_displayTexture;
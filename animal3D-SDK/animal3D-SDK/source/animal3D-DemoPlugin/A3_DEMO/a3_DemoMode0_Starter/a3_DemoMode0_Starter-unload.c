@@ -43,7 +43,25 @@ void a3starter_unloadValidate(a3_DemoState* demoState, a3_DemoMode0_Starter* dem
 
 void a3starter_unload(a3_DemoState const* demoState, a3_DemoMode0_Starter* demoMode)
 {
-
+	// sprite animation
+	a3bufferRelease(demoMode->ubo_sprite);
+	a3spriteAnimationBatchRelease(demoMode->spriteBatch);
+	a3clipPoolRelease(demoMode->clipPool_sprite);
+	a3keyframePoolRelease(demoMode->keyframePool_sprite);
+	a3textureAtlasRelease(demoMode->atlas_sprite);
+
+	// baked crowd
+	a3vertexDrawableRelease(demoMode->draw_bakeSkin);
+	a3vertexArrayReleaseDescriptor(demoMode->vao_bakeSkin);
+	a3bufferRelease(demoMode->vbo_bakeSkin);
+	a3bufferRelease(demoMode->ubo_bakeInstance);
+	a3bufferRelease(demoMode->ubo_bakeClip);
+	a3textureRelease(demoMode->tex_bakePalette);
+	a3animationBakeRelease(demoMode->bake);
+	a3clipPoolRelease(demoMode->clipPool_bake);
+	a3keyframePoolRelease(demoMode->keyframePool_bake);
+	a3hierarchyPoseGroupRelease(demoMode->poseGroup_bake);
+	a3hierarchyRelease(demoMode->hierarchy_bake);
 }
 
 
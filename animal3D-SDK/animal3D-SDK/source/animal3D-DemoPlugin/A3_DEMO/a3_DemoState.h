@@ -278,6 +278,9 @@ struct a3_DemoState
 			a3_DemoStateShaderProgram
 				prog_drawTangentBasis_instanced[1],			// draw vertex/face tangent bases and wireframe with instancing
 				prog_drawTangentBasis[1];					// draw vertex/face tangent bases and wireframe
+			a3_DemoStateShaderProgram
+				prog_drawSprite_instanced[1],				// draw animated sprite batch with instancing
+				prog_drawBakedSkin_instanced[1];			// draw baked-palette skinned crowd with instancing
 		};
 	};
 
@@ -399,6 +399,10 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 				passTangentBasis_transform_instanced_vs[1];//,
 			//	passTangentBasis_morph5_transform_instanced_vs[1],
 			//	passTangentBasis_skin_transform_instanced_vs[1];
+			// animation
+			a3_DemoStateShader
+				passTexcoord_sprite_transform_instanced_vs[1],
+				passNormal_skinBaked_transform_instanced_vs[1];
 
 			// geometry shaders
 			// 00-common
@@ -415,6 +419,10 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 				drawTexture_fs[1];//,
 			//	drawLambert_fs[1],
 			//	drawPhong_fs[1];
+			// animation
+			a3_DemoStateShader
+				drawTexture_sprite_fs[1],
+				drawNormalShaded_fs[1];
 		};
 	} shaderList = {
 		{
@@ -437,6 +445,9 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 			{ { { 0 },	"shdr-vs:pass-tbn-trans-inst",		a3shader_vertex  ,	1,{ A3_DEMO_VS"00-common/e/passTangentBasis_transform_instanced_vs4x.glsl" } } },
 		//	{ { { 0 },	"shdr-vs:pass-tb-morph5-t-inst",	a3shader_vertex  ,	1,{ A3_DEMO_VS"00-common/e/passTangentBasis_morph5_transform_instanced_vs4x.glsl" } } },
 		//	{ { { 0 },	"shdr-vs:pass-tb-skin-t-inst",		a3shader_vertex  ,	1,{ A3_DEMO_VS"00-common/e/passTangentBasis_skin_transform_instanced_vs4x.glsl" } } },
+			// animation
+			{ { { 0 },	"shdr-vs:pass-tex-sprite-inst",		a3shader_vertex  ,	1,{ A3_DEMO_VS"00-common/passTexcoord_transform_instanced_vs4x.glsl" } } },
+			{ { { 0 },	"shdr-vs:pass-nrm-bake-inst",		a3shader_vertex  ,	1,{ A3_DEMO_VS"00-common/passNormal_skinBaked_transform_instanced_vs4x.glsl" } } },
 
 			// gs
 			// 00-common
@@ -451,6 +462,9 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 			{ { { 0 },	"shdr-fs:draw-tex",					a3shader_fragment,	1,{ A3_DEMO_FS"00-common/e/drawTexture_fs4x.glsl" } } },
 		//	{ { { 0 },	"shdr-fs:draw-Lambert",				a3shader_fragment,	1,{ A3_DEMO_FS"00-common/e/drawLambert_fs4x.glsl" } } },
 		//	{ { { 0 },	"shdr-fs:draw-Phong",				a3shader_fragment,	1,{ A3_DEMO_FS"00-common/e/drawPhong_fs4x.glsl" } } },
+			// animation
+			{ { { 0 },	"shdr-fs:draw-tex-sprite",			a3shader_fragment,	1,{ A3_DEMO_FS"00-common/drawTexture_fs4x.glsl" } } },
+			{ { { 0 },	"shdr-fs:draw-nrm-shaded",			a3shader_fragment,	1,{ A3_DEMO_FS"00-common/drawNormalShaded_fs4x.glsl" } } },
 		}
 	};
 	a3_DemoStateShader *const shaderListPtr = (a3_DemoStateShader *)(&shaderList), *shaderPtr;
@@ -533,6 +547,18 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.drawTangentBasis_gs->shader);
 	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.drawColorAttrib_fs->shader);
 
+	// animation programs: 
+	// sprite batch with instancing
+	currentDemoProg = demoState->prog_drawSprite_instanced;
+	a3shaderProgramCreate(currentDemoProg->program, "prog:draw-sprite-inst");
+	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.passTexcoord_sprite_transform_instanced_vs->shader);
+	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.drawTexture_sprite_fs->shader);
+	// baked-palette skinned crowd with instancing
+	currentDemoProg = demoState->prog_drawBakedSkin_instanced;
+	a3shaderProgramCreate(currentDemoProg->program, "prog:draw-bake-skin-inst");
+	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.passNormal_skinBaked_transform_instanced_vs->shader);
+	a3shaderProgramAttachShader(currentDemoProg->program, shaderList.drawNormalShaded_fs->shader);
+
 
 	// activate a primitive for validation
 	// makes sure the specified geometry can draw using programs
@@ -599,6 +625,9 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 		a3demo_setUniformDefaultInteger(currentDemoProg, uImage06, defaultTexUnits + 6);
 		a3demo_setUniformDefaultInteger(currentDemoProg, uImage07, defaultTexUnits + 7);
 
+		// animation texture
+		a3demo_setUniformDefaultInteger(currentDemoProg, uBakePalette, defaultTexUnits + 0);
+
 		// common general
 		a3demo_setUniformDefaultInteger(currentDemoProg, uIndex, defaultInt);
 		a3demo_setUniformDefaultInteger(currentDemoProg, uCount, defaultInt);
@@ -613,6 +642,11 @@ void a3demo_loadShaders(a3_DemoState *demoState)
 		a3demo_setUniformDefaultBlock(currentDemoProg, ubTransformStack, 0);
 		a3demo_setUniformDefaultBlock(currentDemoProg, ubTransformMVP, 0);
 		a3demo_setUniformDefaultBlock(currentDemoProg, ubTransformMVPB, 1);
+
+		// animation uniform blocks
+		a3demo_setUniformDefaultBlock(currentDemoProg, ubSprite, demoProg_blockSprite);
+		a3demo_setUniformDefaultBlock(currentDemoProg, ubBakeInstance, demoProg_blockBakeInstance);
+		a3demo_setUniformDefaultBlock(currentDemoProg, ubBakeClip, demoProg_blockBakeClip);
 	}
 
 